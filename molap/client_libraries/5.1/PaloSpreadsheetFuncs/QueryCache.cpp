@@ -38,12 +38,62 @@
 
 #include "QueryCacheEntryNotFoundException.h"
 
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <list>
+
 using namespace Palo::SpreadsheetFuncs;
 using namespace Palo::Types;
 using namespace Palo::Util;
 using namespace jedox::palo;
 using namespace std;
 
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/*! \brief cells of one cell/values request */
+struct Batch {
+	std::vector<QueryCache::QueryCacheEntry *> entries;
+	StringArrayArray paths;
+	std::future<std::vector<CELL_VALUE> > values;
+	Clock::time_point start;
+	QueryCache::BatchStatistics statistics;
+};
+
+double seconds(Clock::time_point from, Clock::time_point to)
+{
+	return std::chrono::duration<double>(to - from).count();
+}
+
+/*! \brief translates the exception being handled into the error shown in the cells */
+ErrorInfo currentError()
+{
+	try {
+		throw;
+	} catch (const jedox::palo::PaloServerException& e) {
+		return ErrorInfo(XLError::VALUExl, e.code(), "Palo returned error: " + e.longDescription());
+	} catch (const jedox::palo::PaloException& e) {
+		return ErrorInfo(XLError::VALUExl, e.code(), "libpalo_ng returned error: " + e.longDescription());
+	} catch (const jedox::palo::SocketException& e) {
+		return ErrorInfo(XLError::VALUExl, -1, std::string("libpalo_ng returned error: ") + e.what());
+	} catch (const PSFException& e) {
+		return ErrorInfo(XLError::VALUExl, -1, std::string("PaloXLL error: ") + e.what());
+	}
+}
+
+template<typename I> void setError(I begin, I end, const ErrorInfo& error)
+{
+	for (I k = begin; k != end; ++k) {
+		*((*k)->result) = error;
+	}
+}
+
+}
+
+size_t QueryCache::batchSize = 10000;
+
 bool QueryCache::QueryCacheIndex::operator<(const QueryCache::QueryCacheIndex &r) const
 {
 	if (server_srv.get() == r.server_srv.get()) {
@@ -74,22 +124,27 @@ bool QueryCache::QueryCacheInnerIndex::operator<(const QueryCache::QueryCacheInn
 }
 
 QueryCache::QueryCacheIndex::QueryCacheIndex(boost::shared_ptr<jedox::palo::Server> s, const std::string& db, const std::string& c) :
-		server_srv(s), database(db), cube(c)
+		server_srv(s), database(db), cube(c), hash(0)
 {
+	boost::hash_combine(hash, s.get());
+	boost::hash_combine(hash, jedox::util::UTF8Comparer::hash(db));
+	boost::hash_combine(hash, jedox::util::UTF8Comparer::hash(c));
 }
 
-QueryCache::QueryCacheInnerIndex::QueryCacheInnerIndex(const StringArray& p)
+QueryCache::QueryCacheInnerIndex::QueryCacheInnerIndex(const StringArray& p) :
+		hash(0)
 {
 	pathOrigcase.reserve(p.size());
 
 	for (StringArray::const_iterator i = p.begin(); i != p.end(); i++) {
 		pathOrigcase.push_back(*i);
+		boost::hash_combine(hash, jedox::util::UTF8Comparer::hash(*i));
 	}
 }
 
 bool QueryCache::QueryCacheIndex::operator==(const QueryCacheIndex &r) const
 {
-	if (server_srv == r.server_srv) {
+	if (hash == r.hash && server_srv == r.server_srv) {
 		if (jedox::util::UTF8Comparer::compare(database, r.database) == 0) {
 			return jedox::util::UTF8Comparer::compare(cube, r.cube) == 0;
 		}
@@ -99,7 +154,7 @@ bool QueryCache::QueryCacheIndex::operator==(const QueryCacheIndex &r) const
 
 bool QueryCache::QueryCacheInnerIndex::operator==(const QueryCacheInnerIndex &r) const
 {
-	if (pathOrigcase.size() != r.pathOrigcase.size()) {
+	if (hash != r.hash || pathOrigcase.size() != r.pathOrigcase.size()) {
 		return false;
 	}
 
@@ -152,6 +207,21 @@ QueryCache::QueryCache() :
 }
 ;
 
+size_t QueryCache::getBatchSize()
+{
+	return batchSize;
+}
+
+void QueryCache::setBatchSize(size_t cells)
+{
+	batchSize = cells ? cells : 1;
+}
+
+const std::vector<QueryCache::BatchStatistics>& QueryCache::getStatistics() const
+{
+	return statistics;
+}
+
 QueryCache::Status QueryCache::getStatus() const
 {
 	return status;
@@ -250,73 +320,80 @@ bool QueryCache::exec(bool *lock_changed)
 		*lock_changed = false;
 	}
 
-	QueryCacheMap::iterator begin = cache.begin(), end = cache.end();
-	std::vector<CELL_VALUE> cv;
-	QueryCacheInnerMap::iterator k;
-	for (QueryCacheMap::iterator i = begin; i != end; i++) {
+	statistics.clear();
+
+	// send all batches before the first result is read
+	std::list<Batch> batches;
+	for (QueryCacheMap::iterator i = cache.begin(); i != cache.end(); i++) {
 		const QueryCacheIndex& idx = i->first;
 		QueryCacheInnerMap& im = i->second;
-
-		try {
-			StringArrayArray sa;
-			sa.reserve(im.size());
-			for (QueryCacheInnerMap::const_iterator j = im.begin(); j != im.end(); j++) {
-				sa.push_back(j->first.pathOrigcase); // TODO: solve "scharfes s" problem better way, hash-index calculation, etc.
+		boost::shared_ptr < jedox::palo::Server > server = idx.server_srv;
+
+		// assure that we are getting up-to-date data
+		server->forceNextCacheUpdate();
+
+		QueryCacheInnerMap::iterator j = im.begin();
+		while (j != im.end()) {
+			batches.push_back(Batch());
+			Batch& batch = batches.back();
+			batch.entries.reserve(std::min(im.size(), batchSize));
+			batch.paths.reserve(batch.entries.capacity());
+			for (; j != im.end() && batch.entries.size() < batchSize; j++) {
+				batch.entries.push_back(&j->second);
+				batch.paths.push_back(j->first.pathOrigcase);
 			}
+			batch.statistics.database = idx.database;
+			batch.statistics.cube = idx.cube;
+			batch.statistics.cells = batch.entries.size();
+			batch.statistics.failed = false;
+			batch.start = Clock::now();
+
+			try {
+				batch.values = (*server)[idx.database].cube[idx.cube].CellValuesAsync(batch.paths, 0, 1);
+			} catch (...) {
+				changed = true;
+				batch.statistics.failed = true;
+				setError(batch.entries.begin(), batch.entries.end(), currentError());
+			}
+			batch.statistics.prepareTime = seconds(batch.start, Clock::now());
+		}
+	}
 
-			boost::shared_ptr < jedox::palo::Server > server = idx.server_srv;
-
-			// assure that we are getting up-to-date data
-			cv.clear();
-			server->forceNextCacheUpdate();
-
-			(*server)[idx.database].cube[idx.cube].CellValues(cv, sa, 0, 1);
-
-			std::vector<CELL_VALUE>::const_iterator l = cv.begin();
-			for (k = im.begin(); l != cv.end() && k != im.end(); l++, k++) {
-				CellValue lcv(*l);
-				if (*(k->second.result) != lcv) {
-					changed = true;
+	// store the results in place
+	for (std::list<Batch>::iterator b = batches.begin(); b != batches.end(); ++b) {
+		if (b->values.valid()) {
+			std::vector<QueryCacheEntry *>::iterator k = b->entries.begin();
+			try {
+				std::vector<CELL_VALUE> cv = b->values.get();
+
+				std::vector<CELL_VALUE>::const_iterator l = cv.begin();
+				for (; l != cv.end() && k != b->entries.end(); l++, k++) {
+					CellValue lcv(*l);
+					if (*((*k)->result) != lcv) {
+						changed = true;
+					}
+
+					if (lock_changed && ((*k)->result->lock_status != l->lock_status)) {
+						*lock_changed = true;
+					}
+
+					*((*k)->result) = lcv;
 				}
-
-				if (lock_changed && (k->second.result->lock_status != l->lock_status)) {
-					*lock_changed = true;
+				if (k != b->entries.end()) {
+					changed = true;
+					setError(k, b->entries.end(), ErrorInfo(XLError::NAxl, 0, "No data returned!"));
 				}
-
-				*(k->second.result) = lcv;
-			}
-			while (k != im.end()) {
-				changed = true;
-				*(k->second.result) = ErrorInfo(XLError::NAxl, 0, "No data returned!");
-				++k;
-			}
-		} catch (const jedox::palo::PaloServerException& e) {
-			for (k = im.begin(); k != im.end(); k++) {
-				changed = true;
-				*(k->second.result) = ErrorInfo(XLError::VALUExl, e.code(), "Palo returned error: " + e.longDescription());
-			}
-		} catch (const jedox::palo::PaloException& e) {
-			for (k = im.begin(); k != im.end(); k++) {
-				changed = true;
-				*(k->second.result) = ErrorInfo(XLError::VALUExl, e.code(), "libpalo_ng returned error: " + e.longDescription());
-			}
-		} catch (const jedox::palo::SocketException& e) {
-			for (k = im.begin(); k != im.end(); k++) {
+			} catch (...) {
 				changed = true;
-				*(k->second.result) = ErrorInfo(XLError::VALUExl, -1, std::string("libpalo_ng returned error: ") + e.what());
-			}
-		} catch (const PSFException& e) {
-			for (k = im.begin(); k != im.end(); k++) {
-				changed = true;
-				*(k->second.result) = ErrorInfo(XLError::VALUExl, -1, std::string("PaloXLL error: ") + e.what());
+				b->statistics.failed = true;
+				setError(b->entries.begin(), b->entries.end(), currentError());
 			}
 		}
+		b->statistics.totalTime = seconds(b->start, Clock::now());
+		statistics.push_back(b->statistics);
 	}
 
-//  Try again with optimization
 	return changed;
-
-//	return begin != end;
 }
 
 void QueryCache::addRequest(boost::shared_ptr<jedox::palo::Server> s, const std::string& database, const std::string& cube, const StringArray& path, const CellValue* * const ptr)
@@ -41,6 +41,7 @@
 #include <PaloSpreadsheetFuncs/CellValue.h>
 
 #include <unordered_map>
+#include <vector>
 
 namespace Palo {
 namespace SpreadsheetFuncs {
@@ -53,6 +54,10 @@ using namespace Types;
  *  in order to add requests to it using addRequest().
  *  Changing it to "Return" later will execute all stored queries and you will be able to retrieve the
  *  results using getResult().
+ *
+ *  The requests of each cube are split into batches of at most getBatchSize() cells. All batches are
+ *  sent asynchronously before the first result is read, so the batches of different servers and
+ *  cubes are calculated concurrently.
  */
 class QueryCache {
 public:
@@ -71,14 +76,41 @@ public:
 	void addRequest(boost::shared_ptr<jedox::palo::Server> s, const std::string& database, const std::string& cube, const StringArray& path, const CellValue* * const ptr = 0);
 	const CellValue& getResult(boost::shared_ptr<jedox::palo::Server> s, const std::string& database, const std::string& cube, const StringArray& path) const;
 
+	/*! \brief Maximal number of cells requested by one cell/values request. */
+	static size_t getBatchSize();
+	static void setBatchSize(size_t cells);
+
+	/*! \brief Timing of one batch of the last execution. */
+	struct BatchStatistics {
+		std::string database;
+		std::string cube;
+		size_t cells;
+		/*! seconds needed to translate the paths and to queue the request */
+		double prepareTime;
+		/*! seconds from queuing the request until the values were stored */
+		double totalTime;
+		bool failed;
+	};
+
+	/*! \return one entry for each batch of the last execution in the order the batches were sent */
+	const std::vector<BatchStatistics>& getStatistics() const;
+
 	struct QueryCacheIndex {
 		QueryCacheIndex(boost::shared_ptr<jedox::palo::Server> s, const std::string& db, const std::string& c);
 		bool operator==(const QueryCacheIndex &r) const;
 		bool operator<(const QueryCacheIndex &r) const;
 
+		struct Hash {
+			size_t operator()(const QueryCacheIndex &i) const
+			{
+				return i.hash;
+			}
+		};
+
 		boost::shared_ptr<jedox::palo::Server> server_srv;
 		const std::string database;
 		const std::string cube;
+		size_t hash;
 
 	private:
 		QueryCacheIndex();
@@ -89,7 +121,15 @@ public:
 		bool operator==(const QueryCacheInnerIndex &r) const;
 		bool operator<(const QueryCacheInnerIndex &r) const;
 
+		struct Hash {
+			size_t operator()(const QueryCacheInnerIndex &i) const
+			{
+				return i.hash;
+			}
+		};
+
 		StringArray pathOrigcase;
+		size_t hash;
 
 	private:
 		QueryCacheInnerIndex();
@@ -108,13 +148,16 @@ public:
 	};
 
 private:
-	typedef std::map<QueryCacheInnerIndex, QueryCacheEntry> QueryCacheInnerMap;
-	typedef std::map<QueryCacheIndex, QueryCacheInnerMap> QueryCacheMap;
+	typedef std::unordered_map<QueryCacheInnerIndex, QueryCacheEntry, QueryCacheInnerIndex::Hash> QueryCacheInnerMap;
+	typedef std::unordered_map<QueryCacheIndex, QueryCacheInnerMap, QueryCacheIndex::Hash> QueryCacheMap;
 
 	bool exec(bool *lock_changed = 0);
 
 	Status status;
 	QueryCacheMap cache;
+	std::vector<BatchStatistics> statistics;
+
+	static size_t batchSize;
 
 	jedox::palo::Cell_Values_Coordinates _Make_Cell_Value_Coordinates(jedox::palo::Cube c, QueryCacheInnerMap& im);
 };
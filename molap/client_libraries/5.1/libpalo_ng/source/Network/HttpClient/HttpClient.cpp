@@ -31,11 +31,14 @@
 
 #include <iostream>
 #include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/stream.hpp>
 
 #if defined(WIN32) || defined(WIN64)
 #   pragma warning( pop )
 #endif
 
+#include <algorithm>
+
 #include <boost/range/iterator_range.hpp>
 #include <boost/iostreams/copy.hpp>
 #include <boost/shared_ptr.hpp>
@@ -134,7 +137,7 @@ static inline void getHeaders(jedox::palo::HEADER_LIST& headerList, std::iostrea
 	} while (line != "\r");
 }
 
-static inline jedox::palo::CLIENT_RESPONSE_APTR sendRequest(boost::shared_ptr<std::iostream> stream, const jedox::palo::HttpClientRequest& clientRequest, jedox::palo::HttpClient::ClientMode mode, bool &outClosesConnection, const std::string &Target, unsigned int TargetPort)
+static inline void writeRequest(boost::shared_ptr<std::iostream> stream, const jedox::palo::HttpClientRequest& clientRequest, jedox::palo::HttpClient::ClientMode mode, const std::string &Target, unsigned int TargetPort)
 {
 	static const char CRLF[] = "\r\n";
 	static const char END_OF_HEADER[] = "\r\n";
@@ -234,10 +237,12 @@ static inline jedox::palo::CLIENT_RESPONSE_APTR sendRequest(boost::shared_ptr<st
 
 	// Send the request
 	(*stream).flush();
+}
 
-	std::string protocolVersionText;
-	unsigned int statusCode = 0;
+static inline void readResponseHead(boost::shared_ptr<std::iostream> stream, std::string &protocolVersionText, unsigned int &statusCode, jedox::palo::HEADER_LIST &headerList)
+{
 	std::string statusText;
+	statusCode = 0;
 
 	/*	The first line of a Response message is the Status-Line, consisting of the protocol version followed by a numeric status
 	 code and its associated textual phrase, with each element separated by SP characters. No CR or LF is allowed except in
@@ -258,24 +263,27 @@ static inline jedox::palo::CLIENT_RESPONSE_APTR sendRequest(boost::shared_ptr<st
 	}
 
 	// Get response headers. See the documentation in the getHeaders function
-	jedox::palo::HEADER_LIST headerList;
 	getHeaders(headerList, *stream);
+}
 
-	/*	RFC 2616 - 4.4 Message Length extract
-	 Any response message which "MUST NOT" include a message-body (such as the 1xx, 204, and 304 responses and any response
-	 to a HEAD request) is always terminated by the first empty line after the header fields, regardless of the entity-header
-	 fields present in the message. */
-	std::vector<char> body;
-	bool responseHasBody = (statusCode < 100 || statusCode > 199) && statusCode != 204 && statusCode != 304;
-	if (responseHasBody) {
-		// Receive the body
-		enum {
-			BufferSize = 4096
-		};
-		size_t contentLength = BufferSize;
-		bool usesChunkedTransfer = false;
-		bool closesConnection = false;
-		bool usesContentLegth = false;
+namespace {
+
+/*	Reads the message-body of a response from the connection stream piece by piece. The body ends exactly at the end
+ of the response, so further responses can be read from the same stream afterwards. */
+class BodyReader {
+public:
+	BodyReader(boost::shared_ptr<std::iostream> stream, unsigned int statusCode, jedox::palo::HEADER_LIST &headerList) :
+		m_Stream(stream), m_HeaderList(headerList), m_Remaining(0), m_UsesChunkedTransfer(false), m_UsesContentLength(false), m_ClosesConnection(false), m_Finished(false)
+	{
+		/*	RFC 2616 - 4.4 Message Length extract
+		 Any response message which "MUST NOT" include a message-body (such as the 1xx, 204, and 304 responses and any response
+		 to a HEAD request) is always terminated by the first empty line after the header fields, regardless of the entity-header
+		 fields present in the message. */
+		bool responseHasBody = (statusCode < 100 || statusCode > 199) && statusCode != 204 && statusCode != 304;
+		if (!responseHasBody) {
+			m_Finished = true;
+			return;
+		}
 
 		/*	RFC 2616 - 4.4 Message Length extract
 		 2.If a Transfer-Encoding header field (section 14.41) is present and has any value other than "identity", then the
@@ -288,66 +296,182 @@ static inline jedox::palo::CLIENT_RESPONSE_APTR sendRequest(boost::shared_ptr<st
 		 Encoding header field and a Content-Length header field, the latter MUST be ignored. */
 		if (headerList.find("transfer-encoding") != headerList.end()) {
 			if (headerList["transfer-encoding"].compare("identity") == 0) {
-				usesChunkedTransfer = false;
+				m_UsesChunkedTransfer = false;
 			} else if (headerList["transfer-encoding"].compare("chunked") == 0) {
-				usesChunkedTransfer = true;
+				m_UsesChunkedTransfer = true;
 			}
 		} else if (headerList.find("content-length") != headerList.end()) {
-			contentLength = jedox::util::lexicalConversion(size_t, std::string, headerList["content-length"]);
-			usesContentLegth = true;
+			m_Remaining = jedox::util::lexicalConversion(size_t, std::string, headerList["content-length"]);
+			m_UsesContentLength = true;
 		} else {
 			// TODO Support multi part/byte ranges
 		}
 
 		if (headerList.find("connection") != headerList.end() && headerList["connection"].compare("Keep-Alive") == 0) {
-			closesConnection = false;
+			m_ClosesConnection = false;
 		} else {
-			closesConnection = true;
+			m_ClosesConnection = true;
 		}
+	}
 
-		if (usesChunkedTransfer == true) {
+	std::streamsize read(char *s, std::streamsize n)
+	{
+		if (m_Finished) {
+			return -1;
+		}
+		if (m_UsesChunkedTransfer) {
 			/*	The chunk-size field is a string of hex digits indicating the size of the chunk. The chunked encoding is ended by
 			 any chunk whose size is zero, followed by the trailer, which is terminated by an empty line. */
-			size_t bufferSize = contentLength;
-			boost::scoped_array<char> buffer(new char[bufferSize]);
-			do {
+			if (m_Remaining == 0) {
 				// Get the length of the content (provided as an hex string)
-				(*stream) >> std::hex >> contentLength;
-				// Only resize the buffer if we have to
-				if (contentLength > bufferSize) {
-					bufferSize = contentLength;
-					buffer.reset(new char[bufferSize]);
-				}
+				(*m_Stream) >> std::hex >> m_Remaining >> std::dec;
 				// Ignore the CRLF following the chunk length
-				(*stream).ignore(2);
-				(*stream).read(buffer.get(), contentLength);
-				body.insert(body.end(), buffer.get(), buffer.get() + (*stream).gcount());
-				getHeaders(headerList, *stream);
-			} while (contentLength > 0);
-		} else if (usesContentLegth == true) {
+				(*m_Stream).ignore(2);
+				if (!(*m_Stream)) {
+					m_Finished = true;
+					return -1;
+				}
+				if (m_Remaining == 0) {
+					getHeaders(m_HeaderList, *m_Stream);
+					m_Finished = true;
+					return -1;
+				}
+			}
+			(*m_Stream).read(s, std::min((std::streamsize)m_Remaining, n));
+			std::streamsize count = (*m_Stream).gcount();
+			m_Remaining -= (size_t)count;
+			if (m_Remaining == 0 && (*m_Stream)) {
+				// CRLF following the chunk
+				getHeaders(m_HeaderList, *m_Stream);
+			}
+			if (count == 0) {
+				m_Finished = true;
+				return -1;
+			}
+			return count;
+		} else if (m_UsesContentLength) {
 			/*	The Content-Length entity-header field indicates the size of the entity-body, in decimal number of OCTETs, sent to
 			 the recipient*/
-			boost::scoped_array<char> buffer(new char[contentLength]);
-			body.reserve(contentLength);
-			(*stream).read(buffer.get(), contentLength);
-			body.insert(body.end(), buffer.get(), buffer.get() + (*stream).gcount());
+			if (m_Remaining == 0) {
+				m_Finished = true;
+				return -1;
+			}
+			(*m_Stream).read(s, std::min((std::streamsize)m_Remaining, n));
+			std::streamsize count = (*m_Stream).gcount();
+			m_Remaining -= (size_t)count;
+			if (count == 0) {
+				m_Finished = true;
+				return -1;
+			}
+			return count;
 		} else {
 			// Reads until the connection closes or an timeout occurs
-			boost::scoped_array<char> buffer(new char[contentLength]);
-			body.reserve(contentLength);
-			while ((*stream).eof() == false) {
-				(*stream).read(buffer.get(), contentLength);
-				body.insert(body.end(), buffer.get(), buffer.get() + (*stream).gcount());
+			if ((*m_Stream).eof()) {
+				m_Finished = true;
+				return -1;
 			}
+			(*m_Stream).read(s, n);
+			return (*m_Stream).gcount();
 		}
+	}
+
+	// skips the rest of the body
+	void drain()
+	{
+		char buffer[4096];
+		while (read(buffer, sizeof(buffer)) >= 0) {
+		}
+	}
+
+	bool closesConnection() const
+	{
+		return m_ClosesConnection;
+	}
 
-		// If the connection supports keep-alive, return it to the ConnectionPool
-		outClosesConnection = closesConnection;
+private:
+	boost::shared_ptr<std::iostream> m_Stream;
+	jedox::palo::HEADER_LIST &m_HeaderList;
+	size_t m_Remaining;
+	bool m_UsesChunkedTransfer;
+	bool m_UsesContentLength;
+	bool m_ClosesConnection;
+	bool m_Finished;
+};
+
+class BodySource : public boost::iostreams::source {
+public:
+	BodySource(BodyReader &reader) : m_Reader(&reader) {}
+
+	std::streamsize read(char *s, std::streamsize n)
+	{
+		return m_Reader->read(s, n);
+	}
+
+private:
+	BodyReader *m_Reader;
+};
+
+}
+
+static inline jedox::palo::CLIENT_RESPONSE_APTR sendRequest(boost::shared_ptr<std::iostream> stream, const jedox::palo::HttpClientRequest& clientRequest, jedox::palo::HttpClient::ClientMode mode, bool &outClosesConnection, const std::string &Target, unsigned int TargetPort)
+{
+	writeRequest(stream, clientRequest, mode, Target, TargetPort);
+
+	std::string protocolVersionText;
+	unsigned int statusCode;
+	jedox::palo::HEADER_LIST headerList;
+	readResponseHead(stream, protocolVersionText, statusCode, headerList);
 
+	// Receive the body
+	enum {
+		BufferSize = 4096
+	};
+	std::vector<char> body;
+	BodyReader reader(stream, statusCode, headerList);
+	boost::scoped_array<char> buffer(new char[BufferSize]);
+	std::streamsize count;
+	while ((count = reader.read(buffer.get(), BufferSize)) >= 0) {
+		body.insert(body.end(), buffer.get(), buffer.get() + count);
 	}
 
+	// If the connection supports keep-alive, return it to the ConnectionPool
+	outClosesConnection = reader.closesConnection();
+
 	// Return the request result
-	return jedox::palo::CLIENT_RESPONSE_APTR(new jedox::palo::HttpClientResponse(clientRequest, protocolVersionText, statusCode, headerList, body));;
+	return jedox::palo::CLIENT_RESPONSE_APTR(new jedox::palo::HttpClientResponse(clientRequest, protocolVersionText, statusCode, headerList, body));
+}
+
+/*	HTTP/1.1 allows to send further requests on a persistent connection without waiting for the responses (RFC 2616 -
+ 8.1.2.2 Pipelining). The responses arrive in the same order, the body of each response is handed to the handler as a
+ stream while it is received. */
+template<typename C>
+static inline bool sendPipelinedRequests(C &connection, const std::vector<const jedox::palo::HttpClientRequest *> &clientRequests, const jedox::palo::HttpClient::RESPONSE_HANDLER &handler, jedox::palo::HttpClient::ClientMode mode, const std::string &Target, unsigned int TargetPort)
+{
+	boost::shared_ptr<std::iostream> stream = connection->getStream();
+	for (std::vector<const jedox::palo::HttpClientRequest *>::const_iterator it = clientRequests.begin(); it != clientRequests.end(); ++it) {
+		writeRequest(stream, **it, mode, Target, TargetPort);
+	}
+
+	bool closesConnection = false;
+	for (size_t i = 0; i < clientRequests.size(); i++) {
+		if (closesConnection) {
+			// the server closed the connection before all requests were answered
+			jedox::palo::HttpExceptionFactory::raise(jedox::palo::HttpExceptionFactory::HTTP_CLIENT_GENERAL_ERROR);
+		}
+		std::string protocolVersionText;
+		unsigned int statusCode;
+		jedox::palo::HEADER_LIST headerList;
+		readResponseHead(stream, protocolVersionText, statusCode, headerList);
+
+		BodyReader reader(stream, statusCode, headerList);
+		{
+			boost::iostreams::stream<BodySource> body(reader);
+			handler(i, statusCode, headerList, body);
+		}
+		reader.drain();
+		closesConnection = reader.closesConnection();
+	}
+	return closesConnection;
 }
 
 static inline jedox::palo::CLIENT_RESPONSE_APTR sendHttpsRequest(const jedox::palo::HttpClientRequest& clientRequest, jedox::palo::HttpClient::ClientMode mode, const std::string &Target, unsigned int TargetPort)
@@ -387,6 +511,30 @@ static inline jedox::palo::CLIENT_RESPONSE_APTR sendHttpRequest(const jedox::pal
 	return res;
 }
 
+static inline void sendHttpsPipelinedRequests(const std::vector<const jedox::palo::HttpClientRequest *> &clientRequests, const jedox::palo::HttpClient::RESPONSE_HANDLER &handler, jedox::palo::HttpClient::ClientMode mode, const std::string &Target, unsigned int TargetPort)
+{
+	static jedox::palo::HttpsClientConnectionPool &connectionPool = jedox::palo::HttpsClientConnectionPool::instance();
+	std::unique_ptr<jedox::palo::HttpsClientConnection> connection = connectionPool.adoptClientConnection(clientRequests.front()->getUrl());
+
+	if (!connection->hasValidCertificate()) {
+		jedox::palo::PaloExceptionFactory::raise(jedox::palo::PaloExceptionFactory::ERROR_SSL_FAILED, "Invalid server certificate.", "Server returned invalid certificate.");
+	}
+
+	if (!sendPipelinedRequests(connection, clientRequests, handler, mode, Target, TargetPort)) {
+		connectionPool.returnClientConnection(connection);
+	}
+}
+
+static inline void sendHttpPipelinedRequests(const std::vector<const jedox::palo::HttpClientRequest *> &clientRequests, const jedox::palo::HttpClient::RESPONSE_HANDLER &handler, jedox::palo::HttpClient::ClientMode mode, const std::string &Target, unsigned int TargetPort)
+{
+	static jedox::palo::HttpClientConnectionPool &connectionPool = jedox::palo::HttpClientConnectionPool::instance();
+	std::unique_ptr<jedox::palo::HttpClientConnection> connection = connectionPool.adoptClientConnection(clientRequests.front()->getUrl());
+
+	if (!sendPipelinedRequests(connection, clientRequests, handler, mode, Target, TargetPort)) {
+		connectionPool.returnClientConnection(connection);
+	}
+}
+
 namespace jedox {
 namespace palo {
 
@@ -440,6 +588,18 @@ CLIENT_RESPONSE_APTR HttpClient::sendRequest(bool UseHttps, const HttpClientRequ
 	return response;
 }
 
+void HttpClient::sendRequests(bool UseHttps, const std::vector<const HttpClientRequest *> &clientRequests, const RESPONSE_HANDLER &handler, const std::string &Target, unsigned int TargetPort) const
+{
+	if (clientRequests.empty()) {
+		return;
+	}
+	if (UseHttps) {
+		::sendHttpsPipelinedRequests(clientRequests, handler, m_ClientMode, Target, TargetPort);
+	} else {
+		::sendHttpPipelinedRequests(clientRequests, handler, m_ClientMode, Target, TargetPort);
+	}
+}
+
 const unsigned int HttpClient::REDIRECTION_LIMIT = 20;
 
 } /* palo */
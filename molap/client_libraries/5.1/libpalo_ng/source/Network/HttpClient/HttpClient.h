@@ -28,6 +28,12 @@
 
 #include <memory>
 #include <exception>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
 
 namespace jedox {
 namespace palo {
@@ -36,6 +42,7 @@ class HttpClientResponse;
 class HttpClientRequest;
 
 typedef std::unique_ptr<HttpClientResponse> CLIENT_RESPONSE_APTR;
+typedef std::map<std::string, std::string> HEADER_LIST;
 
 class HttpClient {
 public:
@@ -55,6 +62,12 @@ public:
 
 	CLIENT_RESPONSE_APTR sendRequest(bool UseHttps, const HttpClientRequest& clientRequest, const std::string &Target, unsigned int TargetPort) const;
 
+	// called for each response in the order of the requests with the index of the request and the body as a stream
+	typedef boost::function<void (size_t index, unsigned int code, const HEADER_LIST &headers, std::istream &body)> RESPONSE_HANDLER;
+
+	// sends all requests over one connection before the responses are read
+	void sendRequests(bool UseHttps, const std::vector<const HttpClientRequest *> &clientRequests, const RESPONSE_HANDLER &handler, const std::string &Target, unsigned int TargetPort) const;
+
 private:
 
 	static const unsigned int REDIRECTION_LIMIT;
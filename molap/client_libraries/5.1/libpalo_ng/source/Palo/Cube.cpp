@@ -46,6 +46,57 @@
 namespace jedox {
 namespace palo {
 
+/*!
+ * \brief
+ * parses the response of an asynchronous cell/values request
+ */
+class CellValuesHandler : public AsyncHandler {
+public:
+	CellValuesHandler(boost::shared_ptr<ServerImpl> serverImpl, unsigned int db, unsigned int sequenceNumber, size_t count) :
+		m_ServerImpl(serverImpl), m_Dat(db), m_SequenceNumber(sequenceNumber), m_Count(count)
+	{
+	}
+
+	std::future<std::vector<CELL_VALUE> > getFuture()
+	{
+		return m_Promise.get_future();
+	}
+
+	virtual void response(std::istream &body, unsigned int sSequenceNumber, unsigned int vSequenceNumber)
+	{
+		std::vector<CELL_VALUE> res;
+		res.reserve(m_Count);
+		CELL_VALUE tmp;
+		while (res.size() < m_Count && body.eof() == false) {
+			body >> csv >> tmp;
+			res.push_back(tmp);
+		}
+		if (body.bad() || res.size() < m_Count) {
+			// the error is passed to the promise by the client
+			PaloExceptionFactory::raise(PaloExceptionFactory::ERROR_INTERNAL, "internal error", "incomplete response of cell/values");
+		}
+		m_Promise.set_value(res);
+	}
+
+	virtual void error(std::exception_ptr e)
+	{
+		try {
+			std::rethrow_exception(e);
+		} catch (const TokenOutdatedException&) {
+			m_ServerImpl->invalidateCubes(m_SequenceNumber, m_Dat);
+		} catch (...) {
+		}
+		m_Promise.set_exception(e);
+	}
+
+private:
+	boost::shared_ptr<ServerImpl> m_ServerImpl;
+	unsigned int m_Dat;
+	unsigned int m_SequenceNumber;
+	size_t m_Count;
+	std::promise<std::vector<CELL_VALUE> > m_Promise;
+};
+
 /*!
  * \brief
  * little helper functions that return the id or ids of elements
@@ -215,6 +266,7 @@ void Cube::clear()
 
 	try {
 		m_PaloClient->request("/cube/clear", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 	} catch (const TokenOutdatedException& e) {
 		m_ServerImpl->invalidateCubes(sequencenumber, m_Dat);
 		throw e;
@@ -244,6 +296,7 @@ void Cube::clear(const std::vector<std::vector<std::string> > & coordinates)
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cube/clear", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		CUBE_INFO cubeinfo;
 		(*stream) >> csv >> cubeinfo;
 	} catch (const TokenOutdatedException& e) {
@@ -298,6 +351,7 @@ bool Cube::CellReplaceWithLock(const std::vector<std::string> & elements, const
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/replace", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result == '1';
 	} catch (const TokenOutdatedException& e) {
@@ -344,6 +398,7 @@ bool Cube::CellReplace(const ELEMENT_LIST & elements, const CELL_VALUE& cellvalu
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/replace", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result == '1';
 	} catch (const TokenOutdatedException& e) {
@@ -384,6 +439,7 @@ bool Cube::CellReplaceBulkWithLock(const std::vector<std::vector<std::string> >
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/replace_bulk", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result == '1';
 	} catch (const TokenOutdatedException& e) {
@@ -399,8 +455,18 @@ bool Cube::CellReplaceBulk(const std::vector<std::vector<std::string> > & coordi
 
 void Cube::CellValue(CELL_VALUE &result, const ELEMENT_LIST & elemids, unsigned short showRule, unsigned short showLockState, bool ForceServerCall)
 {
+	unsigned short mode = ServerImpl::getCellMode(showRule, showLockState);
+	std::vector<ELEMENT_LIST> paths(1, elemids);
+	std::vector<CELL_VALUE> values;
+	std::vector<size_t> missing;
+	bool useCache = !ForceServerCall && m_ServerImpl->findCells(m_PaloClient, m_Dat, m_Cube, mode, paths, values, missing);
+	if (useCache && missing.empty()) {
+		result = values[0];
+		return;
+	}
+
 	const CubeCache &cube = (*m_Cache)[m_Cube];
-	unsigned int dummy, sequencenumber = cube.getSequenceNumber();
+	unsigned int datasequencenumber = 0, sequencenumber = cube.getSequenceNumber();
 	CUBE_TOKEN token(sequencenumber);
 
 	std::stringstream query;
@@ -408,12 +474,15 @@ void Cube::CellValue(CELL_VALUE &result, const ELEMENT_LIST & elemids, unsigned
 	jedox::util::TListe(query, elemids, ',', false);
 	query << "&show_rule=" << ((showRule + showLockState > 0) ? 1 : 0) << "&show_lock_info=" << ((showLockState > 0) ? 1 : 0);
 	try {
-		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/value", query.str(), token, sequencenumber, dummy);
+		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/value", query.str(), token, sequencenumber, datasequencenumber);
 		(*stream) >> result;
 	} catch (const TokenOutdatedException& e) {
 		m_ServerImpl->invalidateCubes(sequencenumber, m_Dat);
 		throw e;
 	}
+	if (useCache) {
+		m_ServerImpl->storeCells(m_Dat, m_Cube, datasequencenumber, mode, paths, std::vector<CELL_VALUE>(1, result));
+	}
 }
 
 void Cube::CellValue(CELL_VALUE &result, const std::vector<std::string> & elements, unsigned short showRule, unsigned short showLockState, bool ForceServerCall)
@@ -562,6 +631,36 @@ std::vector<CELL_VALUE> Cube::CellValues(const std::vector<std::vector<std::stri
 }
 
 void Cube::CellValues(std::vector<CELL_VALUE> & res, const std::vector<ELEMENT_LIST> & coord, unsigned short showRule, unsigned short showLockState)
+{
+	unsigned short mode = ServerImpl::getCellMode(showRule, showLockState);
+	std::vector<CELL_VALUE> values;
+	std::vector<size_t> missing;
+	if (!m_ServerImpl->findCells(m_PaloClient, m_Dat, m_Cube, mode, coord, values, missing)) {
+		readCellValues(res, coord, showRule, showLockState);
+		return;
+	}
+
+	// only the cells missing in the cache are requested
+	if (!missing.empty()) {
+		std::vector<ELEMENT_LIST> missingCoord;
+		missingCoord.reserve(missing.size());
+		for (std::vector<size_t>::const_iterator it = missing.begin(); it != missing.end(); ++it) {
+			missingCoord.push_back(coord[*it]);
+		}
+		std::vector<CELL_VALUE> missingValues;
+		unsigned int datasequencenumber = readCellValues(missingValues, missingCoord, showRule, showLockState);
+		for (size_t i = 0; i < missingValues.size(); i++) {
+			values[missing[i]] = missingValues[i];
+		}
+		if (missingValues.size() < missing.size()) {
+			values.resize(missing[missingValues.size()]);
+		}
+		m_ServerImpl->storeCells(m_Dat, m_Cube, datasequencenumber, mode, missingCoord, missingValues);
+	}
+	res.insert(res.end(), values.begin(), values.end());
+}
+
+unsigned int Cube::readCellValues(std::vector<CELL_VALUE> & res, const std::vector<ELEMENT_LIST> & coord, unsigned short showRule, unsigned short showLockState)
 {
 	std::stringstream query;
 	query << "database=" << m_Dat << "&cube=" << m_Cube << "&paths=";
@@ -569,11 +668,11 @@ void Cube::CellValues(std::vector<CELL_VALUE> & res, const std::vector<ELEMENT_L
 	query << "&show_rule=" << ((showRule + showLockState > 0) ? 1 : 0) << "&show_lock_info=" << ((showLockState > 0) ? 1 : 0);
 
 	const CubeCache &cube = (*m_Cache)[m_Cube];
-	unsigned int dummy, sequencenumber = cube.getSequenceNumber();
+	unsigned int datasequencenumber = 0, sequencenumber = cube.getSequenceNumber();
 	CUBE_TOKEN token(sequencenumber);
 
 	try {
-		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/values", query.str(), token, sequencenumber, dummy);
+		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/values", query.str(), token, sequencenumber, datasequencenumber);
 		size_t i = 0, max = coord.size();
 
 		res.reserve(max);
@@ -587,9 +686,10 @@ void Cube::CellValues(std::vector<CELL_VALUE> & res, const std::vector<ELEMENT_L
 		m_ServerImpl->invalidateCubes(sequencenumber, m_Dat);
 		throw e;
 	}
+	return datasequencenumber;
 }
 
-void Cube::CellValues(std::vector<CELL_VALUE> & res, const std::vector<std::vector<std::string> > & coordinates, unsigned short showRule, unsigned short showLockState)
+std::vector<ELEMENT_LIST> Cube::getCellPaths(const std::vector<std::vector<std::string> > & coordinates)
 {
 	const CubeCache &cube = (*m_Cache)[m_Cube];
 	const DIMENSION_LIST& dimlist = cube.dimensions;
@@ -617,7 +717,29 @@ void Cube::CellValues(std::vector<CELL_VALUE> & res, const std::vector<std::vect
 		}
 		coord[i] = elemids;
 	}
-	CellValues(res, coord, showRule, showLockState);
+	return coord;
+}
+
+void Cube::CellValues(std::vector<CELL_VALUE> & res, const std::vector<std::vector<std::string> > & coordinates, unsigned short showRule, unsigned short showLockState)
+{
+	CellValues(res, getCellPaths(coordinates), showRule, showLockState);
+}
+
+std::future<std::vector<CELL_VALUE> > Cube::CellValuesAsync(const std::vector<std::vector<std::string> > & coordinates, unsigned short showRule, unsigned short showLockState)
+{
+	std::vector<ELEMENT_LIST> coord = getCellPaths(coordinates);
+
+	std::stringstream query;
+	query << "database=" << m_Dat << "&cube=" << m_Cube << "&paths=";
+	jedox::util::ListeTListe(query, coord, ',', ':', false);
+	query << "&show_rule=" << ((showRule + showLockState > 0) ? 1 : 0) << "&show_lock_info=" << ((showLockState > 0) ? 1 : 0);
+
+	unsigned int sequencenumber = (*m_Cache)[m_Cube].getSequenceNumber();
+	boost::shared_ptr<CellValuesHandler> handler(new CellValuesHandler(m_ServerImpl, m_Dat, sequencenumber, coord.size()));
+	std::future<std::vector<CELL_VALUE> > result = handler->getFuture();
+	// reading cells can safely be sent again after a connection failure
+	m_PaloClient->requestAsync("/cell/values", query.str(), CUBE_TOKEN(sequencenumber), handler, true);
+	return result;
 }
 
 /*
@@ -966,6 +1088,7 @@ bool Cube::CellGoalSeek(const std::vector<std::string> & path, double value, GOA
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/goalseek", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result == '1';
 	} catch (const TokenOutdatedException& e) {
@@ -1084,6 +1207,7 @@ bool Cube::CellCopy(COPY_FUNCTION func, const std::vector<std::string> *path, co
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cell/copy", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result == '1';
 	} catch (const TokenOutdatedException& e) {
@@ -1175,6 +1299,7 @@ bool Cube::destroy()
 	DATABASE_TOKEN token(sequencenumber);
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cube/destroy", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		m_ServerImpl->invalidateDatabases(sequencenumber);
 		(*stream) >> result;
 	} catch (const TokenOutdatedException& e) {
@@ -1230,6 +1355,7 @@ bool Cube::load()
 	CUBE_TOKEN token(sequencenumber);
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cube/load", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 	} catch (const TokenOutdatedException& e) {
 		m_ServerImpl->invalidateCubes(sequencenumber, m_Dat);
@@ -1268,6 +1394,7 @@ RULE_INFO Cube::RuleCreate(const std::string& definition, unsigned short use_ide
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/rule/create", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result;
 	} catch (const TokenOutdatedException& e) {
@@ -1301,6 +1428,7 @@ RULE_INFO Cube::RuleModify(long id, const std::string& definition, unsigned shor
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/rule/modify", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result;
 	} catch (const TokenOutdatedException& e) {
@@ -1328,6 +1456,7 @@ std::vector<RULE_INFO> Cube::RulesMove(const ELEMENT_LIST &ruleIds, double start
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/rule/modify", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		while ((*stream).eof() == false) {
 			(*stream) >> csv >> result;
 			res.push_back(result);
@@ -1355,6 +1484,7 @@ std::vector<RULE_INFO> Cube::RulesActivate(const ELEMENT_LIST &ruleIds, unsigned
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/rule/modify", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		while ((*stream).eof() == false) {
 			(*stream) >> csv >> result;
 			res.push_back(result);
@@ -1422,6 +1552,7 @@ bool Cube::RuleDestroy(IdentifierType identifier)
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/rule/destroy", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result == '1';
 	} catch (const TokenOutdatedException& e) {
@@ -1444,6 +1575,7 @@ bool Cube::RulesDestroy(const ELEMENT_LIST &ruleIds)
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/rule/destroy", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 		return result == '1';
 	} catch (const TokenOutdatedException& e) {
@@ -1589,6 +1721,7 @@ bool Cube::Rollback(IdentifierType LockID, long steps)
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cube/rollback", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		(*stream) >> result;
 	} catch (const TokenOutdatedException& e) {
 		m_ServerImpl->invalidateCubes(sequencenumber, m_Dat);
@@ -1608,6 +1741,7 @@ void Cube::convert(const CUBE_INFO::TYPE cubetype)
 
 	try {
 		std::unique_ptr<std::istringstream> stream = m_PaloClient->request("/cube/convert", query.str(), token, sequencenumber, dummy);
+		m_ServerImpl->invalidateCells(m_Dat);
 		m_ServerImpl->invalidateCubes(sequencenumber, m_Dat);
 	} catch (const TokenOutdatedException& e) {
 		m_ServerImpl->invalidateCubes(sequencenumber, m_Dat);
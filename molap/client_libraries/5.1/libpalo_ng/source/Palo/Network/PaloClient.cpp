@@ -47,7 +47,14 @@
 #include <openssl/md5.h>
 #include <iomanip>
 
+#include <atomic>
+#include <deque>
+#include <iterator>
+
+#include <boost/bind.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <boost/shared_array.hpp>
 
 #if defined (WIN32) || defined (WIN64)
@@ -66,11 +73,32 @@ enum Encryption {
 	HttpsNone = 0, HttpsOptional = 1, HttpsRequired = 2
 };
 
+// limits of the asynchronous requests of one client, read by all clients
+static std::atomic<size_t> asyncConnections(4);
+static std::atomic<size_t> asyncPipelineDepth(16);
+// seconds an idle worker of the asynchronous requests waits before it ends
+static const int asyncIdleTime = 10;
+
+struct AsyncJob {
+	AsyncJob(const std::string& command, const std::string& query, const TOKEN& token, ASYNC_HANDLER handler, PaloClient* client, bool resend) :
+		command(command), query(query), token(token), handler(handler), client(client), resend(resend), retried(false)
+	{
+	}
+
+	std::string command;
+	std::string query;
+	TOKEN token;
+	ASYNC_HANDLER handler;
+	PaloClient* client;
+	bool resend;
+	bool retried;
+};
+
 class PaloClientImpl {
 public:
 
 	PaloClientImpl(ServerProtocol protocol = Http, unsigned int port = 0) :
-		m_Port(port), m_Adopted(false), m_Protocol(protocol), m_Encrypt(0), m_HttpPort(port), m_HttpsPort(0), m_Target(""), m_TargetPort(port), m_Sid(""), m_TTL(0)
+		m_Port(port), m_Adopted(false), m_Protocol(protocol), m_Encrypt(0), m_HttpPort(port), m_HttpsPort(0), m_Target(""), m_TargetPort(port), m_Sid(""), m_TTL(0), m_AsyncWorkers(0), m_AsyncIdle(0), m_AsyncStop(false)
 	{
 	}
 
@@ -79,10 +107,34 @@ public:
 		m_WinSSO(other.m_WinSSO), m_automatic(other.m_automatic), m_finished(other.m_finished), m_negoString(other.m_negoString), m_negotiationId(other.m_negotiationId),
 		m_ServerSequenceNumber(other.m_ServerSequenceNumber), m_Adopted(other.m_Adopted), machineString(other.machineString), requiredFeatures(other.requiredFeatures),
 		optionalFeatures(other.optionalFeatures), optionalRetFeatures(other.optionalRetFeatures), description(other.description), m_Client(other.m_Client), m_Protocol(other.m_Protocol),
-		m_Encrypt(other.m_Encrypt), m_HttpPort(other.m_HttpPort), m_HttpsPort(other.m_HttpsPort), m_Target(other.m_Target), m_TargetPort(other.m_TargetPort), m_Sid(other.m_Sid), m_TTL(other.m_TTL)
+		m_Encrypt(other.m_Encrypt), m_HttpPort(other.m_HttpPort), m_HttpsPort(other.m_HttpsPort), m_Target(other.m_Target), m_TargetPort(other.m_TargetPort), m_Sid(other.m_Sid), m_TTL(other.m_TTL),
+		m_AsyncWorkers(0), m_AsyncIdle(0), m_AsyncStop(false)
 	{
 	}
 
+	~PaloClientImpl()
+	{
+		// the workers use this object, wait until they ended
+		boost::unique_lock<boost::mutex> lock(m_AsyncLock);
+		m_AsyncStop = true;
+		m_AsyncCond.notify_all();
+		while (m_AsyncWorkers) {
+			m_AsyncCond.wait(lock);
+		}
+	}
+
+	void requestAsync(const std::string& command, const std::string& query, const TOKEN& token, ASYNC_HANDLER handler, PaloClient* client, bool resend)
+	{
+		boost::unique_lock<boost::mutex> lock(m_AsyncLock);
+		m_AsyncJobs.push_back(AsyncJob(command, query, token, handler, client, resend));
+		if (!m_AsyncIdle && m_AsyncWorkers < asyncConnections) {
+			++m_AsyncWorkers;
+			boost::thread(boost::bind(&PaloClientImpl::asyncWorker, this)).detach();
+		} else {
+			m_AsyncCond.notify_one();
+		}
+	}
+
 	std::unique_ptr<std::istringstream> request(const std::string& command, const std::string& query, TOKEN& token, unsigned int& sSequenceNumber, unsigned int& vSequenceNumber, PaloClient* client, bool headRequest, const std::string *sid, int trials = 4, HEADER_LIST *argHeaders = NULL, unsigned int *responseCode = NULL, bool ignore401 = false)
 	{
 		std::stringstream querysid;
@@ -562,6 +614,149 @@ private:
 	std::string m_Sid;
 	unsigned int m_TTL;
 	boost::mutex sidLock;
+
+	// every worker owns one connection and sends the queued requests in batches of the pipeline depth
+	void asyncWorker()
+	{
+		boost::unique_lock<boost::mutex> lock(m_AsyncLock);
+		while (true) {
+			while (m_AsyncJobs.empty() && !m_AsyncStop) {
+				++m_AsyncIdle;
+				bool timeout = !m_AsyncCond.timed_wait(lock, boost::posix_time::seconds(asyncIdleTime));
+				--m_AsyncIdle;
+				if (timeout && m_AsyncJobs.empty()) {
+					--m_AsyncWorkers;
+					m_AsyncCond.notify_all();
+					return;
+				}
+			}
+
+			if (m_AsyncStop) {
+				std::deque<AsyncJob> jobs;
+				jobs.swap(m_AsyncJobs);
+				lock.unlock();
+				for (std::deque<AsyncJob>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+					try {
+						PaloExceptionFactory::raise(PaloExceptionFactory::ERROR_INTERNAL, "internal error", "client closed before the request was sent");
+					} catch (...) {
+						it->handler->error(std::current_exception());
+					}
+				}
+				lock.lock();
+				--m_AsyncWorkers;
+				m_AsyncCond.notify_all();
+				return;
+			}
+
+			size_t count = std::min(m_AsyncJobs.size(), asyncPipelineDepth.load());
+			std::vector<AsyncJob> batch(m_AsyncJobs.begin(), m_AsyncJobs.begin() + count);
+			m_AsyncJobs.erase(m_AsyncJobs.begin(), m_AsyncJobs.begin() + count);
+			lock.unlock();
+
+			std::vector<AsyncJob> retry;
+			sendAsync(batch, retry);
+
+			lock.lock();
+			m_AsyncJobs.insert(m_AsyncJobs.begin(), retry.begin(), retry.end());
+		}
+	}
+
+	void sendAsync(std::vector<AsyncJob>& batch, std::vector<AsyncJob>& retry)
+	{
+		std::string curSID;
+		{
+			boost::unique_lock<boost::mutex> wl(sidLock);
+			curSID = m_Sid;
+		}
+
+		std::deque<Url> urls;
+		std::vector<boost::shared_ptr<HttpClientRequest> > requests;
+		std::vector<const HttpClientRequest *> clientRequests;
+		for (std::vector<AsyncJob>::iterator it = batch.begin(); it != batch.end(); ++it) {
+			std::string querysid = it->query;
+			if (!curSID.empty()) {
+				if (!querysid.empty()) {
+					querysid += "&";
+				}
+				querysid += "sid=" + curSID;
+			}
+			HEADER_LIST headers;
+			headers[it->token.getTokenName()] = util::lexicalConversion(std::string, unsigned int, it->token.getSequenceNumber());
+			urls.push_back(Url(m_Hostname, m_Port, it->command, querysid));
+			requests.push_back(boost::shared_ptr<HttpClientRequest>(new HttpClientRequest(urls.back(), headers, HttpClientRequest::GET)));
+			clientRequests.push_back(requests.back().get());
+		}
+
+		size_t answered = 0;
+		try {
+			m_Client.sendRequests(m_Protocol == Https, clientRequests, boost::bind(&PaloClientImpl::asyncResponse, this, boost::ref(batch), boost::ref(answered), _1, _2, _3, _4), m_Target, m_TargetPort);
+		} catch (const HttpClientException& e) {
+			// the connection failed, the unanswered requests allowing it are sent once more over a new connection
+			for (size_t i = answered; i < batch.size(); i++) {
+				if (!batch[i].resend) {
+					batch[i].handler->error(std::current_exception());
+				} else if (batch[i].retried) {
+					batch[i].handler->error(std::make_exception_ptr(MaximumServerRetrysReachedException(e.longDescription())));
+				} else {
+					batch[i].retried = true;
+					retry.push_back(batch[i]);
+				}
+			}
+		} catch (...) {
+			std::exception_ptr e = std::current_exception();
+			for (size_t i = answered; i < batch.size(); i++) {
+				batch[i].handler->error(e);
+			}
+		}
+	}
+
+	void asyncResponse(std::vector<AsyncJob>& batch, size_t& answered, size_t index, unsigned int code, const HEADER_LIST& headers, std::istream& body)
+	{
+		AsyncJob& job = batch[index];
+		answered = index + 1;
+		try {
+			if (code == 200) {
+				unsigned int sSequenceNumber = job.token.getSequenceNumber();
+				unsigned int vSequenceNumber = 0;
+				HEADER_LIST::const_iterator it = headers.find(job.token.getTokenName());
+				if (it != headers.end()) {
+					sSequenceNumber = util::lexicalConversion(unsigned int, std::string, it->second);
+				}
+				it = headers.find(CUBEDATATOKENNAME);
+				if (it != headers.end()) {
+					vSequenceNumber = util::lexicalConversion(unsigned int, std::string, it->second);
+				}
+				job.handler->response(body, sSequenceNumber, vSequenceNumber);
+				return;
+			}
+
+			std::string error((std::istreambuf_iterator<char>(body)), std::istreambuf_iterator<char>());
+			if (error.empty()) {
+				PaloExceptionFactory::raise(PaloExceptionFactory::ERROR_INTERNAL, "internal error", "server return empty body");
+			}
+			util::TOKEN_LIST tokens = util::CsvLineDecoder::decode(error.substr(0, error.size() - 1));
+			unsigned int errorcode = util::lexicalConversion(unsigned int, std::string, tokens[0].token);
+			if (errorcode == PaloExceptionFactory::ERROR_INVALID_SESSION && !m_Username.empty()) {
+				// the synchronous request logs in again
+				TOKEN token(job.token);
+				unsigned int sSequenceNumber = token.getSequenceNumber();
+				unsigned int vSequenceNumber = 0;
+				std::unique_ptr<std::istringstream> stream = request(job.command, job.query, token, sSequenceNumber, vSequenceNumber, job.client, false, 0);
+				job.handler->response(*stream, sSequenceNumber, vSequenceNumber);
+				return;
+			}
+			PaloExceptionFactory::raise(errorcode, tokens[1].token, tokens.size() >= 3 ? tokens[2].token : tokens[1].token);
+		} catch (...) {
+			job.handler->error(std::current_exception());
+		}
+	}
+
+	std::deque<AsyncJob> m_AsyncJobs;
+	size_t m_AsyncWorkers;
+	size_t m_AsyncIdle;
+	bool m_AsyncStop;
+	boost::mutex m_AsyncLock;
+	boost::condition_variable m_AsyncCond;
 };
 
 PaloClient::~PaloClient()
@@ -664,6 +859,17 @@ std::unique_ptr<std::istringstream> PaloClient::request(const std::string& comma
 	return m_PaloClientImpl->request(command, par1, token, sSequenceNumber, vSequenceNumber, const_cast<PaloClient*> (this), false, &sid);
 }
 
+void PaloClient::requestAsync(const std::string& command, const std::string& query, const TOKEN& token, ASYNC_HANDLER handler, bool resend) const
+{
+	m_PaloClientImpl->requestAsync(command, query, token, handler, const_cast<PaloClient*> (this), resend);
+}
+
+void PaloClient::setAsyncLimits(size_t connections, size_t pipelineDepth)
+{
+	asyncConnections = connections ? connections : 1;
+	asyncPipelineDepth = pipelineDepth ? pipelineDepth : 1;
+}
+
 PaloClient& PaloClient::operator=(const PaloClient& rhs)
 {
 	m_PaloClientImpl.reset(new PaloClientImpl(*rhs.m_PaloClientImpl));
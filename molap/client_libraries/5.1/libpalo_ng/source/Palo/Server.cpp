@@ -386,6 +386,11 @@ void Server::forceNextCacheUpdate()
 	m_ServerImpl->forceNextUpdate();
 }
 
+void Server::setCellCacheSize(size_t maxCells)
+{
+	m_ServerImpl->setCellCacheSize(maxCells);
+}
+
 std::vector<DATABASE_INFO> Server::getAdvanced()
 {
 	std::stringstream query;
@@ -28,6 +28,7 @@
 #include "../Palo/Exception/PaloNGGeneralException.h"
 #include "../Util/CsvTokenFromStream.h"
 
+#include <algorithm>
 #include <set>
 #include <typeinfo>
 
@@ -150,7 +151,7 @@ bool SIElements::updateElement(const ElementCache &elem)
 	return iter == m_Ids.end();
 }
 
-ServerImpl::ServerImpl() : m_svsMode(false)
+ServerImpl::ServerImpl() : m_svsMode(false), m_CellCacheSize(0)
 {
 }
 
@@ -515,6 +516,155 @@ void ServerImpl::forceNextUpdate()
 	for (std::map<std::pair<unsigned int, unsigned int>, boost::shared_ptr<CacheItemBase> >::iterator it = m_Caches.begin(); it != m_Caches.end(); ++it) {
 		it->second->forceNextUpdate();
 	}
+	boost::unique_lock<boost::mutex> cellLock(m_CellLock);
+	for (std::map<DimKey, CellToken>::iterator it = m_CellTokens.begin(); it != m_CellTokens.end(); ++it) {
+		if (it->second.token) {
+			it->second.check_time = boost::posix_time::ptime(boost::posix_time::min_date_time);
+		}
+	}
+}
+
+void ServerImpl::setCellCacheSize(size_t maxCells)
+{
+	boost::unique_lock<boost::mutex> lock(m_CellLock);
+	m_CellCacheSize = maxCells;
+	if (!maxCells) {
+		m_Cells.clear();
+		m_CellsLru.clear();
+		m_CellTokens.clear();
+	} else {
+		while (m_Cells.size() > m_CellCacheSize) {
+			m_Cells.erase(m_Cells.find(*m_CellsLru.front()));
+			m_CellsLru.pop_front();
+		}
+	}
+}
+
+bool ServerImpl::findCells(boost::shared_ptr<PaloClient> paloClient, unsigned int db, unsigned int cube, unsigned short mode, const std::vector<ELEMENT_LIST> &paths, std::vector<CELL_VALUE> &values, std::vector<size_t> &missing)
+{
+	boost::unique_lock<boost::mutex> lock(m_CellLock);
+	if (!m_CellCacheSize) {
+		return false;
+	}
+	values.resize(paths.size());
+	missing.clear();
+
+	bool valid = false;
+	DimKey key = std::make_pair(db, cube);
+	std::map<DimKey, CellToken>::iterator it = m_CellTokens.find(key);
+	if (it != m_CellTokens.end()) {
+		boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+		if (!it->second.token) {
+			// server does not allow caching, try again later
+			if ((now - it->second.check_time) > boost::posix_time::milliseconds(uncachableinterval)) {
+				m_CellTokens.erase(it);
+			}
+		} else if (it->second.confirmed && (now - it->second.check_time) <= boost::posix_time::milliseconds(checkinterval)) {
+			valid = true;
+		} else {
+			// one request validates all cached cells of the cube, the cache stays usable by other threads meanwhile
+			unsigned int cachedToken = it->second.token;
+			lock.unlock();
+			unsigned int token = getCellsSequenceNumber(paloClient, db, cube);
+			lock.lock();
+
+			// the cells could have been stored with another token in the meantime
+			it = m_CellTokens.find(key);
+			if (it != m_CellTokens.end() && it->second.token == cachedToken) {
+				if (token == cachedToken) {
+					it->second.confirmed = true;
+					it->second.check_time = now;
+					valid = true;
+				} else {
+					invalidateCellsIntern(db, cube);
+					if (!it->second.confirmed) {
+						// token changed without confirmation, the server creates a new token for each request
+						it->second.token = 0;
+						it->second.check_time = now;
+					} else {
+						m_CellTokens.erase(it);
+					}
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < paths.size(); i++) {
+		if (valid) {
+			CellMap::iterator cit = m_Cells.find(CellKey(db, cube, mode, paths[i]));
+			if (cit != m_Cells.end()) {
+				values[i] = cit->second.value;
+				m_CellsLru.splice(m_CellsLru.end(), m_CellsLru, cit->second.lru);
+				continue;
+			}
+		}
+		missing.push_back(i);
+	}
+	return true;
+}
+
+void ServerImpl::storeCells(unsigned int db, unsigned int cube, unsigned int dataToken, unsigned short mode, const std::vector<ELEMENT_LIST> &paths, const std::vector<CELL_VALUE> &values)
+{
+	boost::unique_lock<boost::mutex> lock(m_CellLock);
+	if (!m_CellCacheSize || !dataToken) {
+		return;
+	}
+
+	DimKey key = std::make_pair(db, cube);
+	std::map<DimKey, CellToken>::iterator it = m_CellTokens.find(key);
+	if (it == m_CellTokens.end()) {
+		CellToken token = {dataToken, false, boost::posix_time::microsec_clock::universal_time()};
+		m_CellTokens.insert(std::make_pair(key, token));
+	} else if (!it->second.token) {
+		return;
+	} else if (it->second.token != dataToken) {
+		invalidateCellsIntern(db, cube);
+		it->second.token = dataToken;
+		it->second.confirmed = false;
+		it->second.check_time = boost::posix_time::microsec_clock::universal_time();
+	}
+
+	size_t count = std::min(paths.size(), values.size());
+	for (size_t i = 0; i < count; i++) {
+		std::pair<CellMap::iterator, bool> ins = m_Cells.insert(std::make_pair(CellKey(db, cube, mode, paths[i]), CellEntry()));
+		ins.first->second.value = values[i];
+		if (ins.second) {
+			ins.first->second.lru = m_CellsLru.insert(m_CellsLru.end(), &ins.first->first);
+		} else {
+			m_CellsLru.splice(m_CellsLru.end(), m_CellsLru, ins.first->second.lru);
+		}
+	}
+	while (m_Cells.size() > m_CellCacheSize) {
+		m_Cells.erase(m_Cells.find(*m_CellsLru.front()));
+		m_CellsLru.pop_front();
+	}
+}
+
+void ServerImpl::invalidateCells(unsigned int db)
+{
+	boost::unique_lock<boost::mutex> lock(m_CellLock);
+	invalidateCellsIntern(db);
+}
+
+void ServerImpl::invalidateCellsIntern(unsigned int db)
+{
+	ELEMENT_LIST empty;
+	eraseCells(m_Cells.lower_bound(CellKey(db, 0, 0, empty)), m_Cells.lower_bound(CellKey(db + 1, 0, 0, empty)));
+	m_CellTokens.erase(m_CellTokens.lower_bound(std::make_pair(db, 0u)), m_CellTokens.lower_bound(std::make_pair(db + 1, 0u)));
+}
+
+void ServerImpl::invalidateCellsIntern(unsigned int db, unsigned int cube)
+{
+	ELEMENT_LIST empty;
+	eraseCells(m_Cells.lower_bound(CellKey(db, cube, 0, empty)), m_Cells.lower_bound(CellKey(db, cube + 1, 0, empty)));
+}
+
+void ServerImpl::eraseCells(CellMap::iterator begin, CellMap::iterator end)
+{
+	for (CellMap::iterator it = begin; it != end; ++it) {
+		m_CellsLru.erase(it->second.lru);
+	}
+	m_Cells.erase(begin, end);
 }
 
 void ServerImpl::invalidateDatabasesIntern(unsigned int sequenceNumber, bool check)
@@ -523,6 +673,9 @@ void ServerImpl::invalidateDatabasesIntern(unsigned int sequenceNumber, bool che
 	if (it != m_Caches.end()) {
 		if (!check || it->second->getSequenceNumber() != sequenceNumber) {
 			m_Caches.clear();
+			boost::unique_lock<boost::mutex> cellLock(m_CellLock);
+			eraseCells(m_Cells.begin(), m_Cells.end());
+			m_CellTokens.clear();
 		}
 	}
 }
@@ -533,6 +686,7 @@ void ServerImpl::invalidateCubesIntern(unsigned int sequenceNumber, bool check,
 	if (it != m_Caches.end()) {
 		if (!check || it->second->getSequenceNumber() != sequenceNumber) {
 			m_Caches.erase(it);
+			invalidateCells(db);
 		}
 	}
 }
@@ -549,6 +703,7 @@ void ServerImpl::invalidateDimensionsIntern(unsigned int sequenceNumber, bool ch
 			for (std::vector<DimensionCacheB>::const_iterator i = dims->begin(); i != dims->end(); ++i) {
 				invalidateElementsIntern(0, false, db, i->dimension);
 			}
+			invalidateCells(db);
 		}
 	}
 }
@@ -559,6 +714,8 @@ void ServerImpl::invalidateElementsIntern(unsigned int sequenceNumber, bool chec
 	if (it != m_Caches.end()) {
 		if (!check || it->second->getSequenceNumber() != sequenceNumber) {
 			m_Caches.erase(it);
+			// consolidated values depend on the dimension
+			invalidateCells(db);
 		}
 	}
 }
@@ -731,6 +888,16 @@ unsigned int ServerImpl::getElementsSequenceNumber(boost::shared_ptr<PaloClient>
 	return sequencenumber;
 }
 
+unsigned int ServerImpl::getCellsSequenceNumber(boost::shared_ptr<PaloClient> paloClient, unsigned int db, unsigned int cube)
+{
+	unsigned int sequencenumber = 0, datasequencenumber = 0;
+	SERVER_TOKEN sequenceToken(sequencenumber);
+	std::stringstream query;
+	query << "database=" << db << "&cube=" << cube;
+	paloClient->request("/cube/info", query.str(), sequenceToken, sequencenumber, datasequencenumber);
+	return datasequencenumber;
+}
+
 std::unique_ptr<CubesCache::CacheIterator> CubesCache::getIterator() const
 {
 	return m_ServerImpl->getCubeIterator(m_PaloClient, m_db);
@@ -40,6 +40,7 @@
 #include <libpalo_ng/Util/StringUtils.h>
 
 #include <map>
+#include <list>
 #include <boost/thread/thread_time.hpp>
 
 namespace jedox {
@@ -289,9 +290,51 @@ public:
 
 	void forceNextUpdate();
 
+	// cell values cached on the client, validated by the client cache token of the cube
+	void setCellCacheSize(size_t maxCells);
+	bool findCells(boost::shared_ptr<PaloClient> paloClient, unsigned int db, unsigned int cube, unsigned short mode, const std::vector<ELEMENT_LIST> &paths, std::vector<CELL_VALUE> &values, std::vector<size_t> &missing);
+	void storeCells(unsigned int db, unsigned int cube, unsigned int dataToken, unsigned short mode, const std::vector<ELEMENT_LIST> &paths, const std::vector<CELL_VALUE> &values);
+	void invalidateCells(unsigned int db);
+	static unsigned short getCellMode(unsigned short showRule, unsigned short showLockState) {return (showRule + showLockState > 0 ? 1 : 0) | (showLockState > 0 ? 2 : 0);}
+
 private:
 	typedef std::pair<unsigned int, unsigned int> DimKey;
 
+	struct CellKey {
+		CellKey(unsigned int db, unsigned int cube, unsigned short mode, const ELEMENT_LIST &path) : db(db), cube(cube), mode(mode), path(path) {}
+		bool operator<(const CellKey &other) const
+		{
+			if (db != other.db) {
+				return db < other.db;
+			}
+			if (cube != other.cube) {
+				return cube < other.cube;
+			}
+			if (mode != other.mode) {
+				return mode < other.mode;
+			}
+			return path < other.path;
+		}
+
+		unsigned int db;
+		unsigned int cube;
+		unsigned short mode;
+		ELEMENT_LIST path;
+	};
+
+	struct CellEntry {
+		CELL_VALUE value;
+		std::list<const CellKey *>::iterator lru;
+	};
+
+	struct CellToken {
+		unsigned int token; // 0 if the server does not allow caching of the cube
+		bool confirmed;
+		boost::posix_time::ptime check_time;
+	};
+
+	typedef std::map<CellKey, CellEntry> CellMap;
+
 	void invalidateDatabasesIntern(unsigned int sequenceNumber, bool check);
 	void invalidateCubesIntern(unsigned int sequenceNumber, bool check, unsigned int db);
 	void invalidateDimensionsIntern(unsigned int sequenceNumber, bool check, unsigned int db);
@@ -304,6 +347,10 @@ private:
 	unsigned int getCubesSequenceNumber(boost::shared_ptr<PaloClient> paloClient, unsigned int db);
 	unsigned int getDimensionsSequenceNumber(boost::shared_ptr<PaloClient> paloClient, unsigned int db);
 	unsigned int getElementsSequenceNumber(boost::shared_ptr<PaloClient> paloClient, unsigned int db, unsigned int dim);
+	unsigned int getCellsSequenceNumber(boost::shared_ptr<PaloClient> paloClient, unsigned int db, unsigned int cube);
+	void invalidateCellsIntern(unsigned int db);
+	void invalidateCellsIntern(unsigned int db, unsigned int cube);
+	void eraseCells(CellMap::iterator begin, CellMap::iterator end);
 	template<typename T> void checkCache(CacheItemBase *cache, const std::string &expected, const DimKey &key)
 	{
 		std::string name = typeid(*cache).name();
@@ -326,6 +373,13 @@ private:
 	boost::mutex m_Lock;
 	bool m_svsMode;
 	static const int checkinterval = 500;
+
+	CellMap m_Cells;
+	std::list<const CellKey *> m_CellsLru;
+	std::map<DimKey, CellToken> m_CellTokens;
+	size_t m_CellCacheSize;
+	boost::mutex m_CellLock;
+	static const int uncachableinterval = 60000;
 };
 
 }
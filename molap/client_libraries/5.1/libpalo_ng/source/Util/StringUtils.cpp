@@ -31,6 +31,7 @@
 #include <unicode/ucasemap.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/tss.hpp>
+#include <boost/functional/hash.hpp>
 
 namespace jedox {
 namespace util {
@@ -256,6 +257,25 @@ int UTF8Comparer::compare(const std::string &s1, const std::string &s2)
 	return u8->col->compareUTF8(s1.c_str(), s2.c_str(), st);
 }
 
+size_t UTF8Comparer::hash(const std::string &s)
+{
+	UTF8ComparerInternal *u8 = utf8impl.get();
+	if (!u8) {
+		u8 = new UTF8ComparerInternal();
+		utf8impl.reset(u8);
+	}
+	// strings equal for the collator have equal sort keys
+	U_NAMESPACE_QUALIFIER UnicodeString us = U_NAMESPACE_QUALIFIER UnicodeString::fromUTF8(s);
+	uint8_t buf[256];
+	int32_t len = u8->col->getSortKey(us, buf, (int32_t)sizeof(buf));
+	if (len > (int32_t)sizeof(buf)) {
+		boost::shared_array<uint8_t> key(new uint8_t[len]);
+		len = u8->col->getSortKey(us, key.get(), len);
+		return boost::hash_range(key.get(), key.get() + len);
+	}
+	return boost::hash_range(buf, buf + len);
+}
+
 bool UTF8Comparer::operator()(const std::string& x, const std::string& y) const
 {
 	return compare(x, y) == UCOL_LESS;
@@ -30,6 +30,7 @@
 #define CUBE_H
 
 #include <string>
+#include <future>
 
 #include <libpalo_ng/Palo/types.h>
 
@@ -300,6 +301,17 @@ public:
 	 */
 	void CellValues(std::vector<CELL_VALUE> & res, const std::vector<std::vector<std::string> > & coordinates, unsigned short showRule = 0, unsigned short showLockState = 0);
 
+	/** @brief
+	 *  Get values from a set of cells without waiting for the server
+	 *  The request is sent in the background together with other asynchronous requests of the connection,
+	 *  the values are parsed while they are received. The cell cache is not used.
+	 *
+	 *  @param coordinates : a list of cell coordinates
+	 *  @param showRule : returns also the id of the rule, which is applied
+	 *  @param showLockState : returns also the lockstate
+	 */
+	std::future<std::vector<CELL_VALUE> > CellValuesAsync(const std::vector<std::vector<std::string> > & coordinates, unsigned short showRule = 0, unsigned short showLockState = 0);
+
 	/** @brief
 	 *  retrieve the value of a cell
 	 *
@@ -509,6 +521,8 @@ private:
 
 	void CellValue(CELL_VALUE &result, const ELEMENT_LIST & elemids, unsigned short showRule, unsigned short showLockState, bool ForceServerCall);
 	void CellValues(std::vector<CELL_VALUE> & res, const std::vector<ELEMENT_LIST> & coord, unsigned short showRule, unsigned short showLockState);
+	unsigned int readCellValues(std::vector<CELL_VALUE> & res, const std::vector<ELEMENT_LIST> & coord, unsigned short showRule, unsigned short showLockState);
+	std::vector<ELEMENT_LIST> getCellPaths(const std::vector<std::vector<std::string> > & coordinates);
 	void CellArea(std::vector<CELL_VALUE_PATH>& res, const std::vector<ELEMENT_LIST> & coord, unsigned short showRule = 0, unsigned short showLockState = 0);
 	bool CellCopy(COPY_FUNCTION func, const std::vector<std::string> *path, const std::vector<std::vector<std::string> > *area, const std::vector<std::string>& path_to, double *value, bool userule, const std::vector<std::vector<std::string> > &lockedCoordinates);
 };
@@ -37,8 +37,10 @@
 #include <memory>
 #include <map>
 #include <string>
+#include <exception>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <libpalo_ng/Palo/types.h>
 
@@ -52,6 +54,27 @@ enum ServerProtocol {
 };
 class PaloClientImpl;
 
+/** @brief
+ *  Receives the result of an asynchronous request. The methods are called by a worker thread
+ *  of the client and must not throw.
+ */
+class LIBPALO_NG_CLASS_EXPORT AsyncHandler {
+public:
+	virtual ~AsyncHandler() {}
+
+	/** @brief
+	 *  body of a successful response, the stream is read directly from the connection
+	 */
+	virtual void response(std::istream &body, unsigned int sSequenceNumber, unsigned int vSequenceNumber) = 0;
+
+	/** @brief
+	 *  the request failed
+	 */
+	virtual void error(std::exception_ptr e) = 0;
+};
+
+typedef boost::shared_ptr<AsyncHandler> ASYNC_HANDLER;
+
 class LIBPALO_NG_CLASS_EXPORT PaloClient {
 public:
 
@@ -68,6 +91,21 @@ public:
 	std::unique_ptr<std::istringstream> request(const std::string& command, TOKEN& token, unsigned int& ssequencenumber, unsigned int& vsequencenumber, bool headRequest = false) const;
 	std::unique_ptr<std::istringstream> request(const std::string& command, TOKEN& token, unsigned int& ssequencenumber, unsigned int& vsequencenumber, const std::string &sid) const;
 
+	/** @brief
+	 *  queues a request and returns immediately, the handler receives the result
+	 *  The queued requests are sent over at most the limited number of connections, several requests
+	 *  are in flight on one connection and the responses are parsed while they are received.
+	 *  Only requests with resend set are sent again when the connection fails before they are answered,
+	 *  it must be set for read-only commands only.
+	 */
+	void requestAsync(const std::string& command, const std::string& query, const TOKEN& token, ASYNC_HANDLER handler, bool resend = false) const;
+
+	/** @brief
+	 *  sets the maximal number of connections used by asynchronous requests of one client
+	 *  and the maximal number of requests in flight on one connection
+	 */
+	static void setAsyncLimits(size_t connections, size_t pipelineDepth);
+
 	PaloClient& operator=(const PaloClient& rhs);
 
 	std::string getSID() const;
@@ -245,6 +245,13 @@ public:
 
 	void forceNextCacheUpdate();
 
+	/** @brief
+	 *  enables the client cache of cell values, 0 disables it
+	 *  The cache is shared by all connections of the same user to the server and holds at most maxCells values.
+	 *  Cached values are validated by the client cache token of the cube, the server decides if cubes may be cached.
+	 */
+	void setCellCacheSize(size_t maxCells);
+
 	std::vector<DATABASE_INFO> getAdvanced();
 
 	std::string defineViewSubset(const std::string &database, const std::string &dimension, int indent, const std::vector<BasicFilterSettings> &basic, const TextFilterSettings &text, const SortingFilterSettings &sorting, const AliasFilterSettings &alias, const FieldFilterSettings &field, const std::vector<StructuralFilterSettings> &structural, const std::vector<DataFilterSettings> &data);
@@ -286,6 +286,7 @@ class LIBPALO_NG_CLASS_EXPORT UTF8Comparer
 public:
 	bool operator()(const std::string& x, const std::string& y) const;
 	static int compare(const std::string &s1, const std::string &s2);
+	static size_t hash(const std::string &s);
 	static std::string toUpper(const std::string &s);
 	static std::string toLower(const std::string &s);
 };
@@ -33,6 +33,9 @@
 /* enables time profiling support */
 #cmakedefine ENABLE_TIME_PROFILER
 
+/* enables native code compilation of numeric rules */
+#cmakedefine ENABLE_RULE_JIT
+
 /* enables support for option --trace */
 #cmakedefine ENABLE_TRACE_OPTION
 
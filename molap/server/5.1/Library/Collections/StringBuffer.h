@@ -30,7 +30,9 @@
 #ifndef COLLECTIONS_STRING_BUFFER_H
 #define COLLECTIONS_STRING_BUFFER_H 1
 
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "palo.h"
 
@@ -658,7 +660,84 @@ struct StringBuffer {
 #endif
 
 	////////////////////////////////////////////////////////////////////////////////
-	/// @brief appends integer with 8 bits
+	/// @brief formats a double exactly like "%.15g" without calling snprintf
+	///
+	/// Handles zero and all values between 1e-4 and 1e15 which are the nearest
+	/// double of a decimal with at most 15 significant digits, i.e. almost all
+	/// values stored in cubes. For such a value the decimal is the result of
+	/// "%.15g" as well. Returns 0 if the value has to be formatted by snprintf.
+	/// The buffer must have room for 32 characters.
+	////////////////////////////////////////////////////////////////////////////////
+
+	static size_t formatDecimal(char *buffer, double attr)
+	{
+		static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19};
+
+		char *p = buffer;
+		uint64_t bits;
+		memcpy(&bits, &attr, sizeof(bits));
+		if (bits >> 63) {
+			*p++ = '-';
+			attr = -attr;
+		}
+		if (attr == 0) {
+			*p++ = '0';
+			return p - buffer;
+		}
+		if (!(attr >= 1e-4 && attr < 1e15)) {
+			return 0;
+		}
+
+		for (int k = 0; k < 20; k++) {
+			double scaled = attr * pow10[k];
+			if (scaled >= 1e15) {
+				break;
+			}
+			double m = floor(scaled + 0.5);
+			if (m / pow10[k] != attr) {
+				continue;
+			}
+
+			// m * 10^-k is the decimal, print it with k fractional digits
+			uint64_t mantissa = (uint64_t)m;
+			while (k && mantissa % 10 == 0) {
+				mantissa /= 10;
+				k--;
+			}
+			char digits[20];
+			int n = 0;
+			do {
+				digits[n++] = (char)('0' + mantissa % 10);
+				mantissa /= 10;
+			} while (mantissa);
+
+			if (n <= k) {
+				*p++ = '0';
+				*p++ = '.';
+				for (int i = n; i < k; i++) {
+					*p++ = '0';
+				}
+				while (n) {
+					*p++ = digits[--n];
+				}
+			} else {
+				while (n > k) {
+					*p++ = digits[--n];
+				}
+				if (k) {
+					*p++ = '.';
+					while (n) {
+						*p++ = digits[--n];
+					}
+				}
+			}
+			return p - buffer;
+		}
+		return 0;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief appends double in "%.15g" format
 	///
 	/// This method is implemented here in order to allow inlining.
 	////////////////////////////////////////////////////////////////////////////////
@@ -666,7 +745,14 @@ struct StringBuffer {
 	void appendDecimal(double attr) 
 	{
 		char b[1024];
-		size_t written = snprintf(b, sizeof(b) - 1, "%.15g", attr);
+		size_t written = formatDecimal(b, attr);
+
+		if (written) {
+			appendText(b, written);
+			return;
+		}
+
+		written = snprintf(b, sizeof(b) - 1, "%.15g", attr);
 
 		// What should be done in case of an overflow? Should not happen
 		if (sizeof(b) <= written) {
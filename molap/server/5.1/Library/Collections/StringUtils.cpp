@@ -163,19 +163,19 @@ void UTF8Comparer::setDefault()
 	setlocale(LC_ALL, "C");
 }
 
-size_t UTF8Comparer::len(string &s)
+size_t UTF8Comparer::len(const string &s)
 {
 	return U_NAMESPACE_QUALIFIER UnicodeString::fromUTF8(s).length();
 }
 
-string UTF8Comparer::left(string &s, int32_t l)
+string UTF8Comparer::left(const string &s, int32_t l)
 {
 	string res;
 	U_NAMESPACE_QUALIFIER UnicodeString::fromUTF8(s).tempSubString(0, l).toUTF8String(res);
 	return res;
 }
 
-string UTF8Comparer::right(string &s, int32_t r)
+string UTF8Comparer::right(const string &s, int32_t r)
 {
 	string res;
 	U_NAMESPACE_QUALIFIER UnicodeString str = U_NAMESPACE_QUALIFIER UnicodeString::fromUTF8(s);
@@ -183,7 +183,7 @@ string UTF8Comparer::right(string &s, int32_t r)
 	return res;
 }
 
-string UTF8Comparer::mid(string &s, int32_t l, int32_t r)
+string UTF8Comparer::mid(const string &s, int32_t l, int32_t r)
 {
 	string res;
 	if (l >= 0) {
@@ -345,21 +345,102 @@ unsigned long StringUtils::stringToUnsignedInteger(const string& str)
 
 double StringUtils::stringToDouble(const string& str)
 {
-	if (str.empty()) {
-		throw ParameterException(ErrorException::ERROR_CONVERSION_FAILED, "error converting a string to a number, string is empty", "str", str);
-	}
+	return stringToDouble(str.c_str(), str.c_str() + str.size());
+}
 
-	char *p;
+double StringUtils::stringToDouble(const char *begin, const char *end)
+{
+	if (begin == end) {
+		throw ParameterException(ErrorException::ERROR_CONVERSION_FAILED, "error converting a string to a number, string is empty", "str", "");
+	}
 
-	double d = strtod(str.c_str(), &p);
+	double d;
 
-	if (*p != '\0') {
-		throw ParameterException(ErrorException::ERROR_CONVERSION_FAILED, "error converting a string to a number, string has illegal characters", "str", str);
+	if (!parseDouble(begin, end, d)) {
+		throw ParameterException(ErrorException::ERROR_CONVERSION_FAILED, "error converting a string to a number, string has illegal characters", "str", string(begin, end));
 	}
 
 	return d;
 }
 
+bool StringUtils::parseDouble(const char *begin, const char *end, double &value)
+{
+	static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+	const char *p = begin;
+	bool negative = false;
+
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool any = false;
+	bool exact = true;
+
+	for (; p < end && '0' <= *p && *p <= '9'; p++) {
+		any = true;
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa) {
+				digits++;
+			}
+		} else {
+			exact = false;
+		}
+	}
+	if (p < end && *p == '.') {
+		for (p++; p < end && '0' <= *p && *p <= '9'; p++) {
+			any = true;
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa) {
+					digits++;
+				}
+				exponent--;
+			} else {
+				exact = false;
+			}
+		}
+	}
+	if (any && p < end && (*p == 'e' || *p == 'E')) {
+		const char *e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')) {
+			negativeExponent = *e == '-';
+			e++;
+		}
+		if (e < end && '0' <= *e && *e <= '9') {
+			int n = 0;
+			for (; e < end && '0' <= *e && *e <= '9'; e++) {
+				if (n < 10000) {
+					n = n * 10 + (*e - '0');
+				}
+			}
+			exponent += negativeExponent ? -n : n;
+			p = e;
+		}
+	}
+
+	// exact if the mantissa and the power of ten are both exact doubles
+	if (any && exact && p == end && mantissa <= (uint64_t(1) << 53) && -22 <= exponent && exponent <= 22) {
+		double d = (double)mantissa;
+		d = exponent < 0 ? d / pow10[-exponent] : d * pow10[exponent];
+		value = negative ? -d : d;
+		return true;
+	}
+
+	string str(begin, end);
+	char *q;
+
+	value = strtod(str.c_str(), &q);
+
+	return *q == '\0';
+}
+
 string StringUtils::convertTimeToString(uint64_t tt) {
 	struct tm t;
 #if defined(_MSC_VER)
@@ -634,10 +715,47 @@ string StringUtils::getNextElement(string& buffer, size_t& pos, char seperator,
 	return result;
 }
 
-void StringUtils::splitString2(const char* ss, const char* se, vector<vector<string> >* elements, char separator1, char separator2, bool quote)
+const char *StringUtils::getNextElement(const char *begin, const char *end, char seperator, bool quote, string &result)
 {
+	const char *p = begin;
+
+	result.clear();
+
+	if (quote && p < end && *p == '"') {
+		for (p++; p < end;) {
+			char next = p + 1 < end ? p[1] : '\0';
+
+			if (p[0] == '"' && next == '"') {
+				result += '"';
+				p += 2;
+			} else if (p[0] == '"' && next == seperator) {
+				p += 2;
+				break;
+			} else if (p[0] == '"' && p + 1 == end) {
+				p += 1;
+				break;
+			} else {
+				result += *p++;
+			}
+		}
+
+		return p;
+	}
 
-	std::stringstream* sss = new std::stringstream();
+	const char *e = (const char *)memchr(p, seperator, end - p);
+
+	if (e) {
+		result.assign(p, e);
+		return e + 1;
+	}
+
+	result.assign(p, end);
+	return end;
+}
+
+void StringUtils::splitString2(const char* ss, const char* se, vector<vector<string> >* elements, char separator1, char separator2, bool quote)
+{
+	string part;
 
 	bool newline = true;
 	const char* lq = 0;
@@ -647,34 +765,31 @@ void StringUtils::splitString2(const char* ss, const char* se, vector<vector<str
 		if ((q % 2 == 0) && (ss == se || *ss == separator1 || *ss == separator2)) {
 			if (newline)
 				elements->push_back(vector<string> ());
-			elements->back().push_back(sss->str());
-			delete sss;
+			elements->back().push_back(part);
 			newline = (ss == se) || *ss == separator1;
 			if (ss == se)
 				return;
 			lq = 0;
 			q = 0;
-			sss = new std::stringstream();
+			part.clear();
 		} else if (quote && *ss == '"') {
 			++q;
 			if (q % 2 == 1 && lq + 1 == ss)
-				(*sss) << '"';
+				part += '"';
 			lq = ss;
 		} else
-			(*sss) << *ss;
+			part += *ss;
 	}
-	if (sss)
-		delete sss;
 }
 
 void StringUtils::splitString3(const string& line, vector<string> &elements, char seperator, bool empty)
 {
-	stringstream part;
+	string part;
 	char inquote = 0;
 	for (string::const_iterator it = line.begin(); it != line.end(); ++it) {
 		if (*it == seperator && !inquote) {
-			elements.push_back(part.str());
-			part.str("");
+			elements.push_back(part);
+			part.clear();
 			continue;
 		} else if (*it == '\'' || *it == '"') {
 			if (inquote) {
@@ -682,7 +797,7 @@ void StringUtils::splitString3(const string& line, vector<string> &elements, cha
 					string::const_iterator itn(it);
 					++itn;
 					if (itn != line.end() && (*itn == inquote)) {
-						part << *it++;
+						part += *it++;
 					} else {
 						inquote = 0;
 					}
@@ -691,10 +806,10 @@ void StringUtils::splitString3(const string& line, vector<string> &elements, cha
 				inquote = *it;
 			}
 		}
-		part << *it;
+		part += *it;
 	}
-	if (!part.str().empty() || empty) {
-		elements.push_back(part.str());
+	if (!part.empty() || empty) {
+		elements.push_back(part);
 	}
 }
 
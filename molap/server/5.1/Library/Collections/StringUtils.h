@@ -72,10 +72,10 @@ public:
 	static std::string capitalize(const std::string &s);
 	static std::string doubleToString(double d, int32_t padding, int32_t decimals);
 	static void setDefault();
-	static size_t len(std::string &s);
-	static std::string left(std::string &s, int32_t l);
-	static std::string right(std::string &s, int32_t r);
-	static std::string mid(std::string &s, int32_t l, int32_t r);
+	static size_t len(const std::string &s);
+	static std::string left(const std::string &s, int32_t l);
+	static std::string right(const std::string &s, int32_t r);
+	static std::string mid(const std::string &s, int32_t l, int32_t r);
 private:
 	static UTF8ComparerInternal *check() {UTF8ComparerInternal *u8 = u8impl.get(); if (!u8) {u8 = new UTF8ComparerInternal(); u8impl.reset(u8);} return u8;}
 	static boost::thread_specific_ptr<UTF8ComparerInternal> u8impl;
@@ -290,6 +290,21 @@ public:
 
 	static double stringToDouble(const string& str);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief converts a slice of a buffer to double
+	////////////////////////////////////////////////////////////////////////////////
+
+	static double stringToDouble(const char *begin, const char *end);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief parses a double, returns false for illegal characters
+	///
+	/// Decimals with at most 19 digits and a small exponent are converted
+	/// exactly without strtod, all other input is passed to strtod.
+	////////////////////////////////////////////////////////////////////////////////
+
+	static bool parseDouble(const char *begin, const char *end, double &value);
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief splits string along seperator
 	////////////////////////////////////////////////////////////////////////////////
@@ -302,6 +317,15 @@ public:
 
 	static string getNextElement(string& buffer, size_t& pos, const char seperator, bool quote, boost::scoped_array<char> &quoteBuffer);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief extracts next element from a slice of a buffer
+	///
+	/// Same as getNextElement but works on the original buffer and reuses the
+	/// memory of result. Returns the begin of the following element.
+	////////////////////////////////////////////////////////////////////////////////
+
+	static const char *getNextElement(const char *begin, const char *end, char seperator, bool quote, string &result);
+
 	static void splitString2(const char* ss, const char* se, vector<vector<string> >* elements, char separator1, char separator2, bool quote);
 	static void splitString3(const string& line, vector<string> &elements, char seperator, bool empty);
 	static string unQuote(const std::string &s);
@@ -96,6 +96,15 @@ public:
 
 	virtual void work() = 0;
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief moves an initialized job to the calling thread
+	///
+	/// Called before work if the job was initialized in another thread.
+	////////////////////////////////////////////////////////////////////////////////
+
+	virtual void attachThread() {
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief cleans up after work and delete
 	////////////////////////////////////////////////////////////////////////////////
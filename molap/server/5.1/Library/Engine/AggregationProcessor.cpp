@@ -409,8 +409,15 @@ void AggregationProcessor::aggregate()
 
 	// process all source values
 	const vector<PPlanNode> &sources = planNode->getChildren();
+	vector<PProcessorBase> prefetched;
+	prefetchProcessors(sources, false, prefetched);
 	for (vector<PPlanNode>::const_iterator source = sources.begin(); source != sources.end(); ++source) {
-		PCellStream sourceDataSP = createProcessor(*source, false);
+		PCellStream sourceDataSP = prefetched[source - sources.begin()];
+		if (sourceDataSP) {
+			prefetched[source - sources.begin()].reset();
+		} else {
+			sourceDataSP = createProcessor(*source, false);
+		}
 		CellValueStream *sourceData = sourceDataSP.get();
 
 		StorageCpu::Processor *cpuProc = dynamic_cast<StorageCpu::Processor *>(sourceData);
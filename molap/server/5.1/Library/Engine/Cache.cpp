@@ -265,24 +265,27 @@ void ValueCache::CacheWriteProcessor::onComplete()
 ValueCache::CacheWriteProcessor::~CacheWriteProcessor()
 {
 	Context *context = Context::getContext(0, false);
-	// remove cacheWriter from context stack
-	Context::CacheDependences &cacheDependences = context->getCacheDependences();
-	if (cacheDependences.find(this) == cacheDependences.end()) {
-		// something wrong with the list of cache writers
-		Logger::error << "Internal Error: Cache Dependences list is incomplete!" << endl;
-	} else {
-		if (Logger::isTrace()) {
-			ostringstream ss;
-			ss << "Cache dependences detected. Source Cubes: ";
-			for(CubesWithDBs::const_iterator srcCubeIt = sourceCubes.begin(); srcCubeIt != sourceCubes.end(); ++srcCubeIt) {
-				PDatabase db = context->getServer()->lookupDatabase(srcCubeIt->first, false);
-				PCube cube = db->lookupCube(srcCubeIt->second, false);
-				ss << db->getName() << "/" << cube->getName() << " ";
+	{
+		// remove cacheWriter from context stack
+		WriteLocker wl(&context->getCacheDependencesLock());
+		Context::CacheDependences &cacheDependences = context->getCacheDependences();
+		if (cacheDependences.find(this) == cacheDependences.end()) {
+			// something wrong with the list of cache writers
+			Logger::error << "Internal Error: Cache Dependences list is incomplete!" << endl;
+		} else {
+			if (Logger::isTrace()) {
+				ostringstream ss;
+				ss << "Cache dependences detected. Source Cubes: ";
+				for(CubesWithDBs::const_iterator srcCubeIt = sourceCubes.begin(); srcCubeIt != sourceCubes.end(); ++srcCubeIt) {
+					PDatabase db = context->getServer()->lookupDatabase(srcCubeIt->first, false);
+					PCube cube = db->lookupCube(srcCubeIt->second, false);
+					ss << db->getName() << "/" << cube->getName() << " ";
 
+				}
+				Logger::trace << ss.str() << endl;
 			}
-			Logger::trace << ss.str() << endl;
+			cacheDependences.erase(this);
 		}
-		cacheDependences.erase(this);
 	}
 	onComplete();
 }
@@ -375,8 +378,18 @@ bool ValueCache::clear()
 	storage.reset(new StorageCpu(PPathTranslator(), true));
 	storage->merge(CPCommitable(), PCommitable());
 	areas.reset(new CachedAreas());
-	result = !sourceCubes.empty();
+	result = !sourceCubes.empty() || inheritedAreas;
 	sourceCubes.clear();
+	if (valid) {
+		// caches which inherited the old values must not restore them
+		*valid = false;
+	}
+	valid.reset(new bool(true));
+	inheritedStorage.reset();
+	inheritedAreas.reset();
+	inheritedSourceCubes.clear();
+	inheritedMutex.reset();
+	inheritedValid.reset();
 	found = 0;
 	generation++;
 	time(&invalidationTime);
@@ -389,6 +402,7 @@ PProcessorBase ValueCache::getWriter(CPCube cube, CPCubeArea area, PCellStream i
 	boost::shared_ptr<QueryCache> qc = context->getQueryCache(cube, storage->valuesCount(), *this);
 	CacheWriteProcessor *cacheProc = new CacheWriteProcessor(*qc, area, input, ruleId, qc->getInitSize());
 	PProcessorBase result(cacheProc);
+	WriteLocker wl(&context->getCacheDependencesLock());
 	context->getCacheDependences().insert(cacheProc);
 	return result;
 }
@@ -440,4 +454,152 @@ bool ValueCache::isDepending(const dbID_cubeID &cubeId) const
 	return sourceCubes.find(cubeId) != sourceCubes.end();
 }
 
+void ValueCache::inherit(const ValueCache &other)
+{
+	PStorageCpu otherStorage;
+	PCachedAreas otherAreas;
+	CubesWithDBs otherSourceCubes;
+	boost::shared_ptr<bool> otherValid;
+	{
+		WriteLocker w(other.mutex->getLock());
+		otherStorage = other.storage;
+		otherAreas = other.areas;
+		otherSourceCubes = other.sourceCubes;
+		otherValid = other.valid;
+	}
+	WriteLocker w(mutex->getLock());
+	if (otherAreas && !otherAreas->empty()) {
+		inheritedStorage = otherStorage;
+		inheritedAreas = otherAreas;
+		inheritedSourceCubes = otherSourceCubes;
+		inheritedMutex = other.mutex;
+		inheritedValid = otherValid;
+	} else {
+		inheritedStorage.reset();
+		inheritedAreas.reset();
+		inheritedSourceCubes.clear();
+		inheritedMutex.reset();
+		inheritedValid.reset();
+	}
+}
+
+bool ValueCache::restoreInherited(CPDatabase db, CPCube cube, const Area &affected)
+{
+	PStorageCpu oldStorage;
+	PCachedAreas oldAreas;
+	CubesWithDBs oldSourceCubes;
+	PSharedMutex oldMutex;
+	boost::shared_ptr<bool> oldValid;
+	size_t oldGeneration;
+	{
+		// the inherited values are released on every path
+		WriteLocker w(mutex->getLock());
+		oldStorage.swap(inheritedStorage);
+		oldAreas.swap(inheritedAreas);
+		oldSourceCubes.swap(inheritedSourceCubes);
+		oldMutex.swap(inheritedMutex);
+		oldValid.swap(inheritedValid);
+		oldGeneration = generation;
+		if (!areas->empty()) {
+			// already filled with values of this version
+			return false;
+		}
+	}
+	if (!oldAreas || oldSourceCubes.find(dbID_cubeID(db->getId(), cube->getId())) != oldSourceCubes.end()) {
+		// nothing to restore or values read by PALO.DATA from the cube itself
+		return false;
+	}
+	{
+		// a source cube or a dimension changed since the values were cached
+		WriteLocker w(oldMutex->getLock());
+		if (!*oldValid) {
+			return false;
+		}
+	}
+
+	PCachedAreas newAreas;
+	oldStorage = removeArea(db, cube, *oldAreas, oldStorage, affected, newAreas);
+
+	WriteLocker wo(oldMutex->getLock());
+	if (!*oldValid) {
+		return false;
+	}
+	WriteLocker w(mutex->getLock());
+	if (generation != oldGeneration || !areas->empty()) {
+		return false;
+	}
+	storage = oldStorage;
+	areas = newAreas;
+	sourceCubes = oldSourceCubes;
+	return true;
+}
+
+bool ValueCache::invalidate(CPDatabase db, CPCube cube, const Area &affected)
+{
+	PStorageCpu oldStorage;
+	PCachedAreas oldAreas;
+	{
+		WriteLocker w(mutex->getLock());
+		oldStorage = storage;
+		oldAreas = areas;
+	}
+	if (oldAreas->empty()) {
+		return true;
+	}
+
+	PCachedAreas newAreas;
+	PStorageCpu newStorage = removeArea(db, cube, *oldAreas, oldStorage, affected, newAreas);
+
+	WriteLocker w(mutex->getLock());
+	if (areas != oldAreas) {
+		// filled meanwhile, the new values could depend on the changed cells
+		return false;
+	}
+	storage = newStorage;
+	areas = newAreas;
+	// caches which inherited the old values must not restore them
+	*valid = false;
+	valid.reset(new bool(true));
+	generation++;
+	time(&invalidationTime);
+	return true;
+}
+
+PStorageCpu ValueCache::removeArea(CPDatabase db, CPCube cube, const CachedAreas &oldAreas, PStorageCpu oldStorage, const Area &affected, PCachedAreas &newAreas) const
+{
+	newAreas.reset(new CachedAreas());
+	PDoubleCellMap removed = CreateDoubleCellMap(keySize);
+	for (CachedAreas::const_iterator ruleAreas = oldAreas.begin(); ruleAreas != oldAreas.end(); ++ruleAreas) {
+		boost::shared_ptr<SubCubeList> valid(new SubCubeList());
+		for (SubCubeList::const_iterator it = ruleAreas->second->begin(); it != ruleAreas->second->end(); ++it) {
+			if (it->second->isOverlapping(affected)) {
+				PCubeArea intersection;
+				SubCubeList complement;
+				it->second->intersection(affected, &intersection, &complement);
+				for (SubCubeList::const_iterator cit = complement.begin(); cit != complement.end(); ++cit) {
+					valid->push_back(CPCubeArea(new CubeArea(db, cube, *cit->second)));
+				}
+				if (intersection) {
+					// values of not cached cells have to be removed, the cells could be empty after recalculation
+					PProcessorBase values = oldStorage->getCellValues(intersection);
+					while (values->next()) {
+						removed->set(values->getKey(), 0);
+					}
+				}
+			} else {
+				valid->push_back(CPCubeArea(new CubeArea(db, cube, *it->second)));
+			}
+		}
+		if (!valid->empty()) {
+			newAreas->insert(make_pair(ruleAreas->first, valid));
+		}
+	}
+	if (removed->size()) {
+		oldStorage = COMMITABLE_CAST(StorageCpu, oldStorage->copy());
+		oldStorage->commitExternalChanges(false, removed->getValues(), removed->size(), false);
+		oldStorage->merge(CPCommitable(), PCommitable());
+	}
+	return oldStorage;
+}
+
 }
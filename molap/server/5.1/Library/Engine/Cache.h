@@ -108,11 +108,15 @@ public:
 	double getBarrier() const {return cacheBarrier;}
 	void increaseFound(double f);
 	bool isDepending(const dbID_cubeID &cubeId) const;
+	void inherit(const ValueCache &other);
+	bool restoreInherited(CPDatabase db, CPCube cube, const Area &affected);
+	bool invalidate(CPDatabase db, CPCube cube, const Area &affected);
 	size_t getGeneration() const {return generation;}
 	time_t getInvalidationTime() const {return invalidationTime;}
 
 private:
 	ValueCache(const ValueCache &);
+	PStorageCpu removeArea(CPDatabase db, CPCube cube, const CachedAreas &oldAreas, PStorageCpu oldStorage, const Area &affected, PCachedAreas &newAreas) const;
 
 	PSharedMutex mutex;
 	PStorageCpu storage;
@@ -123,6 +127,16 @@ private:
 	CubesWithDBs sourceCubes;
 	size_t generation;
 	time_t invalidationTime;
+
+	// false after the cache was cleared or invalidated, guarded by mutex
+	boost::shared_ptr<bool> valid;
+
+	// cache of the version the cube was merged with, see restoreInherited
+	PStorageCpu inheritedStorage;
+	PCachedAreas inheritedAreas;
+	CubesWithDBs inheritedSourceCubes;
+	PSharedMutex inheritedMutex;
+	boost::shared_ptr<bool> inheritedValid;
 };
 }
 
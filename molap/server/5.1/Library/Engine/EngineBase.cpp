@@ -38,6 +38,8 @@
 #include "Engine/TransformationProcessor.h"
 #include "Engine/ArithmeticProcessors.h"
 #include "Engine/DFilterProcessor.h"
+#include "Engine/ExchangeProcessor.h"
+#include "Engine/GroupByProcessor.h"
 
 #include "Engine/EngineBase.h"
 #include "Engine/Cache.h"
@@ -49,83 +51,140 @@ PIdHolder EngineBase::storageIdHolder(new IdHolder());
 const CellValue CellValue::NullString(false);
 const CellValue CellValue::NullNumeric(true);
 const CellValue CellValue::MarkerValue(1.0);
+const string CellValue::emptyString;
 
 CellValue::CellValue(bool isNumeric) :
-		value(0.0), isNum(isNumeric), isEmp(true), ruleId(NO_RULE), status(0), err((ErrorException::ErrorType)0)
+		value(0.0), ruleId(NO_RULE), kind(isNumeric ? NUMERIC_VALUE : STRING_VALUE), isEmp(true)
 {
+	if (!isNumeric) {
+		str = 0;
+	}
 }
 
-CellValue::CellValue(const string &str) :
-		string(str), value(0.0), isNum(false), isEmp(false), ruleId(NO_RULE), status(0), err((ErrorException::ErrorType)0)
+CellValue::CellValue(const string &text) :
+		ruleId(NO_RULE), kind(STRING_VALUE), isEmp(false)
 {
+	str = text.empty() ? 0 : new SharedString(text, 0.0);
 }
 
 CellValue::CellValue(double value) :
-		value(value), isNum(true), isEmp(value == 0.0), ruleId(NO_RULE), status(0), err((ErrorException::ErrorType)0)
+		value(value), ruleId(NO_RULE), kind(NUMERIC_VALUE), isEmp(value == 0.0)
+{
+}
+
+CellValue::CellValue(double value, const string &text) :
+		ruleId(NO_RULE), kind(STRING_VALUE), isEmp(false)
+{
+	str = text.empty() && value == 0.0 ? 0 : new SharedString(text, value);
+}
+
+CellValue::CellValue(ErrorException::ErrorType type) :
+		value(0.0), ruleId(NO_RULE), kind(ERROR_VALUE), isEmp(false)
+{
+	err = (uint32_t)type;
+}
+
+CellValue::CellValue(const CellValue &val) :
+		ruleId(val.ruleId), kind(val.kind), isEmp(val.isEmp)
 {
+	copyPayload(val);
 }
 
-CellValue::CellValue(double value, const string &str) :
-		string(str), value(value), isNum(false), isEmp(false), ruleId(NO_RULE), status(0), err((ErrorException::ErrorType)0)
+void CellValue::copyPayload(const CellValue &val)
 {
+	// only the active member of the union is read
+	switch (val.kind) {
+	case STRING_VALUE:
+		str = val.str;
+		if (str) {
+			++str->refCount;
+		}
+		break;
+	case ERROR_VALUE:
+		value = 0.0;
+		err = val.err;
+		break;
+	default:
+		value = val.value;
+		break;
+	}
+}
+
+void CellValue::release()
+{
+	if (--str->refCount == 0) {
+		delete str;
+	}
+	str = 0;
 }
 
-CellValue::CellValue(ErrorException::ErrorType err) :
-		value(0.0), isNum(false), isEmp(false), ruleId(NO_RULE), status(0), err(err)
+void CellValue::setString(const string &text, double value)
 {
+	if (kind == STRING_VALUE && str) {
+		release();
+	}
+	kind = STRING_VALUE;
+	str = text.empty() && value == 0.0 ? 0 : new SharedString(text, value);
+	ruleId = NO_RULE;
 }
 
 CellValue &CellValue::operator=(const CellValue &val)
 {
-	string::operator=(val);
-	value = val.value;
-	isNum = val.isNum;
-	isEmp = val.isEmp;
+	if (this == &val) {
+		return *this;
+	}
+	if (kind == STRING_VALUE && str) {
+		release();
+	}
+	copyPayload(val);
 	ruleId = val.ruleId;
-	status = val.status;
-	err = val.err;
+	kind = val.kind;
+	isEmp = val.isEmp;
 	return *this;
 }
 
-CellValue &CellValue::operator=(const string &str)
+CellValue &CellValue::operator=(const string &text)
 {
-	string::operator=(str);
-	value = 0.0;
-	isNum = false;
-	isEmp = string::empty();
-	ruleId = NO_RULE;
-	status = 0;
-	err = (ErrorException::ErrorType)0;
+	setString(text);
+	isEmp = text.empty();
 	return *this;
 }
 
-CellValue &CellValue::operator=(const char *str)
+CellValue &CellValue::operator=(const char *text)
 {
-	string::operator=(str);
-	value = 0.0;
-	isNum = false;
+	setString(text);
 	isEmp = false;
-	ruleId = NO_RULE;
-	status = 0;
-	err = (ErrorException::ErrorType)0;
 	return *this;
 }
 
 CellValue &CellValue::operator=(double val)
 {
-	clear();
+	if (kind == STRING_VALUE && str) {
+		release();
+	}
 	value = val;
-	isNum = true;
+	kind = NUMERIC_VALUE;
 	isEmp = value == 0.0;
 	ruleId = NO_RULE;
-	status = 0;
-	err = (ErrorException::ErrorType)0;
+	return *this;
+}
+
+CellValue &CellValue::operator+=(const CellValue &val)
+{
+	if (kind == NUMERIC_VALUE && val.kind == NUMERIC_VALUE) {
+		value += val.value;
+		isEmp = isEmp && val.isEmp;
+	} else if (kind == STRING_VALUE && !val.empty()) {
+		IdentifierType id = ruleId;
+		setString(getString() + val.getString(), getNumeric());
+		ruleId = id;
+	}
 	return *this;
 }
 
 bool CellValue::operator==(const CellValue &b) const
 {
-	return (isNumeric() && b.isNumeric() && getNumeric() == b.getNumeric()) || (isString() && b.isString() && (string &)*this == (string &)b);
+	return (isNumeric() && b.isNumeric() && getNumeric() == b.getNumeric()) || (isString() && b.isString() && getString() == b.getString());
 }
 
 bool CellValue::operator!=(const CellValue &b) const
@@ -138,71 +197,76 @@ bool CellValue::operator<(const CellValue &b) const
 	if (isNumeric() && b.isNumeric()) {
 		return getNumeric() < b.getNumeric();
 	} else {
-		return UTF8Comparer::compare(*this, b) < 0;
+		return UTF8Comparer::compare(getString(), b.getString()) < 0;
 	}
 }
 
-double CellValue::getNumeric() const
-{
-	return value;
-}
-
-CellValue::operator double() const
-{
-	return value;
-}
-
-ErrorException::ErrorType CellValue::getError() const
-{
-	return err;
-}
-
-bool CellValue::isNumeric() const
-{
-	return isError() ? false : isNum;
-}
-
-bool CellValue::isString() const
+string CellValue::toString() const
 {
-	return isError() ? false : !isNum;
+	double val = getNumeric();
+	if (kind != STRING_VALUE) {
+		char b[32];
+		size_t written = StringBuffer::formatDecimal(b, val);
+		if (written) {
+			return string(b, written);
+		}
+		StringBuffer s;
+		s.appendDecimal(val);
+		return s.str();
+	} else {
+		return StringUtils::escapeString(getString());
+	}
 }
 
-bool CellValue::isError() const
+ostream& operator<<(ostream& ostr, const CellValue& value)
 {
-	return err != 0;
+	ostr << value.toString();
+	return ostr;
 }
 
-bool CellValue::isEmpty() const
+void DeletedCells::add(const IdentifiersType &key)
 {
-	return isEmp;
+	if (++cells > MAX_CELLS) {
+		ids.clear();
+		return;
+	}
+	ids.resize(key.size());
+	for (size_t dim = 0; dim < key.size(); dim++) {
+		ids[dim].insert(key[dim]);
+	}
 }
 
-void CellValue::setRuleId(IdentifierType id)
+void DeletedCells::add(const DeletedCells &deleted)
 {
-	ruleId = id;
+	cells += deleted.cells;
+	if (cells > MAX_CELLS) {
+		ids.clear();
+		return;
+	}
+	ids.resize(max(ids.size(), deleted.ids.size()));
+	for (size_t dim = 0; dim < deleted.ids.size(); dim++) {
+		ids[dim].insert(deleted.ids[dim].begin(), deleted.ids[dim].end());
+	}
 }
 
-IdentifierType CellValue::getRuleId() const
+void DeletedCells::clear()
 {
-	return ruleId;
+	cells = 0;
+	ids.clear();
 }
 
-string CellValue::toString() const
+PArea DeletedCells::getArea() const
 {
-	double val = value;
-	if (isNum) {
-		StringBuffer s;
-		s.appendDecimal(val);
-		return s.str();
-	} else {
-		return StringUtils::escapeString(*this);
+	if (!isKnown() || ids.empty()) {
+		return PArea();
 	}
-}
-
-ostream& operator<<(ostream& ostr, const CellValue& value)
-{
-	ostr << value.toString();
-	return ostr;
+	PArea area(new Area(ids.size()));
+	for (size_t dim = 0; dim < ids.size(); dim++) {
+		PSet s(new Set);
+		s->insert(ids[dim].begin(), ids[dim].end());
+		area->insert(dim, s);
+	}
+	return area;
 }
 
 PCommitableList StorageList::createnew(const CommitableList& l) const
@@ -305,7 +369,9 @@ PProcessorBase EngineBase::createProcessor(CPPlanNode node, bool sortedOutput, b
 	case AGGREGATION: {
 		PProcessorBase ret;
 		const AggregationPlanNode *apn = dynamic_cast<const AggregationPlanNode *>(node.get());
-		if (apn->getAggregationType() == AggregationPlanNode::SUM) {
+		if (GroupByProcessor::isSupported(apn)) {
+			ret.reset(new GroupByProcessor(thisEngine, node));
+		} else if (apn->getAggregationType() == AggregationPlanNode::SUM) {
 			ret.reset(new AggregationProcessor(thisEngine, node));
 			if (useCache && node->getCache()) {
 				ret = node->getCache()->getWriter(node->getCacheCube(), PCubeArea(new CubeArea(CPDatabase(), CPCube(), *node->getArea())), ret, NO_IDENTIFIER);
@@ -633,7 +699,7 @@ bool CellMapPlanNode::isEqual(const PlanNode& b) const
 }
 
 PlanNode::PlanNode(PlanNodeType type, CPArea area, const vector<PPlanNode> &children, ValueCache *cache, CPCube cacheCube, double constValue) :
-		type(type), area(area), children(children), cache(cache), cacheCube(cacheCube), constValue(constValue)
+		type(type), area(area), children(children), cache(cache), cacheCube(cacheCube), constValue(constValue), exchange(false)
 {
 }
 
@@ -699,7 +765,7 @@ string PlanNode::toXML() const
 {
 	stringstream ss;
 	string ElementName = getTypeString();
-	ss << "<" << ElementName << getXMLAttributes() << ">";
+	ss << "<" << ElementName << getXMLAttributes() << (exchange ? " Exchange='1'" : "") << ">";
 	ss << getXMLContent();
 	ss << "</" << ElementName << ">";
 	return ss.str();
@@ -905,7 +971,24 @@ PProcessorBase ProcessorBase::createProcessor(CPPlanNode plan, bool sortedOutput
 	} else {
 		selectedEngine = selectEngine(plan);
 	}
+	if (plan->isExchange()) {
+		PProcessorBase exchange = ExchangeProcessor::create(selectedEngine, plan, sortedOutput, useCache);
+		if (exchange) {
+			return exchange;
+		}
+	}
 	return selectedEngine->createProcessor(plan, sortedOutput, useCache);
 }
 
+void ProcessorBase::prefetchProcessors(const vector<PPlanNode> &nodes, bool sortedOutput, vector<PProcessorBase> &processors)
+{
+	processors.clear();
+	processors.resize(nodes.size());
+	for (size_t i = 0; i < nodes.size(); i++) {
+		if (nodes[i] && nodes[i]->isExchange()) {
+			processors[i] = createProcessor(nodes[i], sortedOutput);
+		}
+	}
+}
+
 }
@@ -32,6 +32,9 @@
 #define OLAP_ENGINE_BASE_H 1
 
 #include "palo.h"
+
+#include <boost/detail/atomic_count.hpp>
+
 #include "Engine/Area.h"
 #include "Engine/Streams.h"
 #include "Olap/Commitable.h"
@@ -62,54 +65,162 @@ enum SplashMode {
 	DISABLED, DEFAULT, SET_BASE, ADD_BASE
 };
 
-class CellValue : public std::string {
+////////////////////////////////////////////////////////////////////////////////
+/// @brief value of a cell
+///
+/// A cell value is a 16 byte tagged value: a double, an error code or a
+/// handle of a shared immutable string. Copying a string value only
+/// increments the reference count of the string. The const part of the
+/// std::string interface is available for string values, numeric and error
+/// values behave like empty strings there.
+////////////////////////////////////////////////////////////////////////////////
+
+class CellValue {
 public:
 	CellValue(bool isNumeric = true);
 	CellValue(const string &str);
 	CellValue(double value);
 	CellValue(double value, const string &str);
 	CellValue(ErrorException::ErrorType type);
+	CellValue(const CellValue &val);
+	~CellValue() {
+		if (kind == STRING_VALUE && str) {
+			release();
+		}
+	}
 
 	CellValue &operator=(const CellValue &val);
 	CellValue &operator=(const string &str);
 	CellValue &operator=(const char *str);
 	CellValue &operator=(double val);
+	CellValue &operator+=(const CellValue &val);
 	bool operator==(const CellValue& b) const;
 	bool operator!=(const CellValue& b) const;
 	bool operator<(const CellValue &b) const;
 
-	double getNumeric() const;
-	operator double() const;
-
-	ErrorException::ErrorType getError() const;
-	bool isNumeric() const;
-	bool isString() const;
-	bool isError() const;
-	bool isEmpty() const;
-	void setEmpty(bool empty) {isEmp = empty;}
-	void setRuleId(IdentifierType id);
-	IdentifierType getRuleId() const;
+	double getNumeric() const {
+		return kind == NUMERIC_VALUE ? value : (kind == STRING_VALUE && str ? str->value : 0.0);
+	}
+
+	operator double() const {
+		return getNumeric();
+	}
+
+	ErrorException::ErrorType getError() const {
+		return kind == ERROR_VALUE ? (ErrorException::ErrorType)err : (ErrorException::ErrorType)0;
+	}
+
+	bool isNumeric() const {
+		return kind == NUMERIC_VALUE;
+	}
+
+	bool isString() const {
+		return kind == STRING_VALUE;
+	}
+
+	bool isError() const {
+		return kind == ERROR_VALUE;
+	}
+
+	bool isEmpty() const {
+		return isEmp;
+	}
+
+	void setEmpty(bool empty) {
+		isEmp = empty;
+	}
+
+	void setRuleId(IdentifierType id) {
+		ruleId = id;
+	}
+
+	IdentifierType getRuleId() const {
+		return ruleId;
+	}
+
 	string toString() const;
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief string of a string value, an empty string for other values
+	////////////////////////////////////////////////////////////////////////////////
+
+	const string &getString() const {
+		return kind == STRING_VALUE && str ? str->text : emptyString;
+	}
+
+	operator const string &() const {
+		return getString();
+	}
+
+	size_t length() const {
+		return getString().length();
+	}
+
+	size_t size() const {
+		return getString().size();
+	}
+
+	bool empty() const {
+		return getString().empty();
+	}
+
+	const char *c_str() const {
+		return getString().c_str();
+	}
+
+	const char *data() const {
+		return getString().data();
+	}
+
+	char operator[](size_t pos) const {
+		return getString()[pos];
+	}
+
+	string::const_iterator begin() const {
+		return getString().begin();
+	}
+
+	string::const_iterator end() const {
+		return getString().end();
+	}
+
 	static const CellValue NullString;
 	static const CellValue NullNumeric;
 	static const CellValue MarkerValue;
 private:
-	double value;
-	bool isNum;
-	bool isEmp;
+	enum Kind {
+		NUMERIC_VALUE, STRING_VALUE, ERROR_VALUE
+	};
+
+	struct SharedString {
+		SharedString(const string &text, double value) : refCount(1), value(value), text(text) {}
+		boost::detail::atomic_count refCount;
+		const double value;
+		const string text;
+	};
+
+	void setString(const string &text, double value = 0.0);
+	void copyPayload(const CellValue &val);
+	void release();
+
 	union {
-		IdentifierType ruleId;
-		SplashMode splashMode;
+		double value;
+		SharedString *str;
+		uint32_t err;
 	};
-	uint16_t status;
-	ErrorException::ErrorType err;
+	IdentifierType ruleId;
+	uint8_t kind;
+	bool isEmp;
+
+	static const string emptyString;
 
 	friend ostream& operator<<(ostream&, const CellValue&);
 };
 
 ostream& operator<<(ostream&, const CellValue&);
 
+static_assert(sizeof(CellValue) == 16, "CellValue has to be a 16 byte value");
+
 class SERVER_CLASS StorageList : public CommitableList {
 public:
 	StorageList(const PIdHolder &newidh) : CommitableList(newidh, true) {}
@@ -140,6 +251,8 @@ public:
 	CPCube getCacheCube() const {return cacheCube;}
 	double getConstValue() const {return constValue;}
 	void setChildren(const vector<PPlanNode> &children) {this->children = children;}
+	void setExchange(bool exchange) {this->exchange = exchange;}
+	bool isExchange() const {return exchange;}
 	virtual void write(FileWriter &w, CPArea parentArea) const;
 	bool operator==(const PlanNode &b) const;
 	virtual bool isEqual(const PlanNode &b) const {return true;}
@@ -152,6 +265,7 @@ protected:
 	ValueCache *cache;
 	CPCube cacheCube;
 	double constValue;
+	bool exchange;
 };
 
 class SERVER_CLASS CompleteNodeInfo {
@@ -203,6 +317,7 @@ public:
 	bool isEngineLocked() {return engineLocked;}
 	void setEngineLocked(bool locked) {engineLocked = locked;}
 	PProcessorBase createProcessor(CPPlanNode node, bool sortedOutput, bool useCache = true);
+	void prefetchProcessors(const vector<PPlanNode> &nodes, bool sortedOutput, vector<PProcessorBase> &processors);
 	PEngineBase getEngine() {return engine;}
 	static PEngineBase selectEngine(CPPlanNode node);
 protected:
@@ -211,6 +326,46 @@ protected:
 	bool engineLocked;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief element ids of deleted cells per dimension
+///
+/// The ids are kept for at most MAX_CELLS deleted cells, the area of more
+/// deleted cells is unknown.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS DeletedCells {
+public:
+	DeletedCells() : cells(0) {}
+
+	void add(const IdentifiersType &key);
+	void add(const DeletedCells &deleted);
+	void clear();
+
+	bool empty() const {
+		return !cells;
+	}
+
+	bool isKnown() const {
+		return cells <= MAX_CELLS;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief area containing all deleted cells, null if the area is unknown
+	////////////////////////////////////////////////////////////////////////////////
+
+	PArea getArea() const;
+
+	bool operator==(const DeletedCells &deleted) const {
+		return cells == deleted.cells && ids == deleted.ids;
+	}
+
+private:
+	static const size_t MAX_CELLS = 10000;
+
+	size_t cells;
+	vector<set<IdentifierType> > ids;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief OLAP Engine storage base class
 ///
@@ -419,6 +574,7 @@ class SERVER_CLASS UnionPlanNode : public PlanNode {
 public:
 	UnionPlanNode(CPArea area, const vector<PPlanNode> &children, IdentifierType ruleId) : PlanNode(UNION, area, children, 0, CPCube()), ruleId(ruleId) {}
 	virtual ~UnionPlanNode() {}
+	IdentifierType getRuleId() const {return ruleId;}
 	bool canHaveDuplicates() const;
 	virtual bool isEqual(const PlanNode& b) const;
 private:
@@ -577,7 +733,7 @@ typedef boost::shared_ptr<const CellRightsPlanNode> CPCellRightsPlanNode;
 class SERVER_CLASS EngineBase : public Commitable {
 public:
 	enum Type {
-		ANY = -1, CPU = 0, GPU = 1
+		ANY = -1, CPU = 0, GPU = 1, COLUMNAR = 2
 	};
 	enum StorageType {
 		Numeric, String, Marker
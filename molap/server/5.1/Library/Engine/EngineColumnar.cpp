@@ -0,0 +1,783 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "Engine/EngineColumnar.h"
+
+#include <boost/thread.hpp>
+
+#include "Engine/AggregationProcessor.h"
+#include "Engine/Cache.h"
+#include "Engine/StorageCpu.h"
+#include "Logger/Logger.h"
+#include "Olap/Context.h"
+#include "Olap/Cube.h"
+#include "Olap/Database.h"
+#include "Olap/Server.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/WriteLocker.h"
+
+namespace palo {
+
+size_t EngineColumnar::minCells = 1000000;
+double EngineColumnar::denseCells = 1 << 20;
+set<pair<string, string> > EngineColumnar::cubes;
+
+// rows filtered at once
+static const size_t BLOCK_ROWS = 1024;
+
+// maximal number of cells of all arrays of parallel scans
+static const double DENSE_CELLS_TOTAL = 1 << 23;
+
+// minimal number of rows scanned by one job
+static const size_t JOB_ROWS = 1 << 18;
+
+// /////////////////////////////////////////////////////////////////////////////
+// columnar storage
+// /////////////////////////////////////////////////////////////////////////////
+
+void ColumnarStorage::Column::setCode(size_t row, uint32_t code)
+{
+	if (!bits) {
+		return;
+	}
+	size_t bit = row * bits;
+	size_t word = bit >> 6;
+	uint32_t shift = (uint32_t)(bit & 63);
+	words[word] |= (uint64_t)code << shift;
+	if (shift + bits > 64) {
+		words[word + 1] |= (uint64_t)code >> (64 - shift);
+	}
+}
+
+ColumnarStorage::ColumnarStorage(PStorageBase storage) : source(storage), rows(0)
+{
+	// collect the used elements of every dimension
+	vector<vector<uint32_t> > codes;
+	PProcessorBase reader = storage->getCellValues(CPArea());
+	while (reader->next()) {
+		const IdentifiersType &key = reader->getKey();
+		if (codes.empty()) {
+			codes.resize(key.size());
+			columns.resize(key.size());
+		}
+		for (size_t dim = 0; dim < key.size(); dim++) {
+			vector<uint32_t> &dimCodes = codes[dim];
+			if (key[dim] >= dimCodes.size()) {
+				dimCodes.resize(key[dim] + 1, NO_IDENTIFIER);
+			}
+			dimCodes[key[dim]] = 0;
+		}
+		rows++;
+	}
+
+	// assign codes in the order of the identifiers
+	for (size_t dim = 0; dim < columns.size(); dim++) {
+		Column &column = columns[dim];
+		vector<uint32_t> &dimCodes = codes[dim];
+		for (IdentifierType id = 0; id < dimCodes.size(); id++) {
+			if (dimCodes[id] != NO_IDENTIFIER) {
+				dimCodes[id] = (uint32_t)column.dictionary.size();
+				column.dictionary.push_back(id);
+			}
+		}
+		while (((size_t)1 << column.bits) < column.dictionary.size()) {
+			column.bits++;
+		}
+		column.mask = column.bits == 64 ? ~(uint64_t)0 : ((uint64_t)1 << column.bits) - 1;
+		column.words.resize((rows * column.bits + 63) / 64 + 1, 0);
+	}
+	values.resize(rows);
+	usedCounts.resize(columns.size());
+	if (!columns.empty()) {
+		firstDimRows.resize(columns[0].dictionary.size() + 1, 0);
+	}
+
+	// pack the cells
+	bool sorted = true;
+	uint32_t lastFirst = 0;
+	size_t row = 0;
+	reader = storage->getCellValues(CPArea());
+	while (row < rows && reader->next()) {
+		const IdentifiersType &key = reader->getKey();
+		for (size_t dim = 0; dim < columns.size(); dim++) {
+			columns[dim].setCode(row, codes[dim][key[dim]]);
+		}
+		uint32_t first = codes[0][key[0]];
+		if (first < lastFirst) {
+			sorted = false;
+		} else {
+			for (uint32_t code = lastFirst + 1; code <= first; code++) {
+				firstDimRows[code] = row;
+			}
+			lastFirst = first;
+		}
+		values[row++] = reader->getDouble();
+	}
+	if (sorted && !firstDimRows.empty()) {
+		for (uint32_t code = lastFirst + 1; code < firstDimRows.size(); code++) {
+			firstDimRows[code] = row;
+		}
+	} else {
+		firstDimRows.clear();
+	}
+}
+
+double ColumnarStorage::estimateRows(const Area &area) const
+{
+	double result = (double)rows;
+	for (size_t dim = 0; dim < columns.size() && dim < area.dimCount(); dim++) {
+		const IdentifiersType &dictionary = columns[dim].dictionary;
+		result = dictionary.empty() ? 0 : result * countUsed(dim, area.getDim(dim)) / dictionary.size();
+	}
+	return result;
+}
+
+size_t ColumnarStorage::countUsed(size_t dim, CPSet set) const
+{
+	{
+		WriteLocker wl(&usedLock);
+		if (usedCounts[dim].set.lock() == set) {
+			return usedCounts[dim].count;
+		}
+	}
+
+	// the dictionary is sorted, the smaller side is iterated
+	const IdentifiersType &dictionary = columns[dim].dictionary;
+	size_t used = 0;
+	if (set->size() < dictionary.size()) {
+		for (Set::Iterator id = set->begin(); id != set->end(); ++id) {
+			if (binary_search(dictionary.begin(), dictionary.end(), *id)) {
+				used++;
+			}
+		}
+	} else {
+		for (IdentifiersType::const_iterator id = dictionary.begin(); id != dictionary.end(); ++id) {
+			if (set->find(*id) != set->end()) {
+				used++;
+			}
+		}
+	}
+
+	WriteLocker wl(&usedLock);
+	usedCounts[dim].set = set;
+	usedCounts[dim].count = used;
+	return used;
+}
+
+size_t ColumnarStorage::getMemoryUsage() const
+{
+	size_t result = values.size() * sizeof(double) + firstDimRows.size() * sizeof(size_t);
+	for (vector<Column>::const_iterator column = columns.begin(); column != columns.end(); ++column) {
+		result += column->words.size() * sizeof(uint64_t) + column->dictionary.size() * sizeof(IdentifierType);
+	}
+	return result;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// scan kernel
+// /////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scan-filter-aggregate kernel of one source area
+///
+/// For every dimension and dictionary code the targets of the element are
+/// precalculated: the offset of the target in the aggregation area and its
+/// weight. Codes outside of the source area have no targets. A block of rows
+/// is filtered dimension by dimension, the most selective dimension first,
+/// while the offsets and weights of the remaining rows are accumulated.
+////////////////////////////////////////////////////////////////////////////////
+
+class ColumnarKernel {
+public:
+	ColumnarKernel(const ColumnarStorage &columns, const Area &sourceArea, const Area &targetArea, const vector<const AggregationMap *> &parentMaps, bool dense);
+
+	bool isDense() const {
+		return dense;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief row ranges to scan
+	////////////////////////////////////////////////////////////////////////////////
+
+	const vector<pair<size_t, size_t> > &getRanges() const {
+		return ranges;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief filters a block of at most BLOCK_ROWS rows
+	////////////////////////////////////////////////////////////////////////////////
+
+	size_t filter(size_t begin, size_t end, uint32_t *rows, size_t *offsets, double *weights, uint8_t *multi) const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sums all rows of the range into the arrays
+	////////////////////////////////////////////////////////////////////////////////
+
+	void aggregate(size_t begin, size_t end, double *sums, uint8_t *used) const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief key of a row
+	////////////////////////////////////////////////////////////////////////////////
+
+	void getKey(size_t row, IdentifiersType &key) const {
+		for (size_t dim = 0; dim < key.size(); dim++) {
+			const ColumnarStorage::Column &column = columns.getColumn(dim);
+			key[dim] = column.dictionary[column.code(row)];
+		}
+	}
+
+	double getValue(size_t row) const {
+		return values[row];
+	}
+
+private:
+	void expand(size_t row, size_t dim, size_t offset, double weight, double value, double *sums, uint8_t *used) const;
+
+	const ColumnarStorage &columns;
+	const double *values;
+	size_t dimCount;
+	bool dense;
+	vector<size_t> order;
+	vector<vector<uint32_t> > first;
+	vector<vector<size_t> > offsets;
+	vector<vector<double> > weights;
+	vector<pair<size_t, size_t> > ranges;
+};
+
+ColumnarKernel::ColumnarKernel(const ColumnarStorage &columns, const Area &sourceArea, const Area &targetArea, const vector<const AggregationMap *> &parentMaps, bool dense) :
+	columns(columns), values(columns.getValues()), dimCount(columns.dimCount()), dense(dense), first(dimCount), offsets(dimCount), weights(dimCount)
+{
+	vector<size_t> strides(dimCount, 1);
+	for (size_t dim = dimCount; dim > 1; dim--) {
+		strides[dim - 2] = strides[dim - 1] * targetArea.elemCount(dim - 1);
+	}
+
+	vector<pair<double, size_t> > selectivity;
+	for (size_t dim = 0; dim < dimCount; dim++) {
+		const ColumnarStorage::Column &column = columns.getColumn(dim);
+		const Set *sourceSet = sourceArea.getDim(dim).get();
+
+		IdentifiersType targetIds;
+		if (dense) {
+			const Set *targetSet = targetArea.getDim(dim).get();
+			for (Set::Iterator it = targetSet->begin(); it != targetSet->end(); ++it) {
+				targetIds.push_back(*it);
+			}
+		}
+
+		vector<uint32_t> &dimFirst = first[dim];
+		vector<size_t> &dimOffsets = offsets[dim];
+		vector<double> &dimWeights = weights[dim];
+		size_t usedCodes = 0;
+		dimFirst.resize(column.dictionary.size() + 1);
+		for (uint32_t code = 0; code < column.dictionary.size(); code++) {
+			dimFirst[code] = (uint32_t)dimOffsets.size();
+			IdentifierType id = column.dictionary[code];
+			if (sourceSet->find(id) == sourceSet->end()) {
+				continue;
+			}
+			for (AggregationMap::TargetReader targets = parentMaps[dim]->getTargets(id); !targets.end(); ++targets) {
+				size_t offset = 0;
+				if (this->dense) {
+					IdentifiersType::const_iterator pos = lower_bound(targetIds.begin(), targetIds.end(), *targets);
+					if (pos == targetIds.end() || *pos != *targets) {
+						this->dense = false;
+					} else {
+						offset = (pos - targetIds.begin()) * strides[dim];
+					}
+				}
+				dimOffsets.push_back(offset);
+				dimWeights.push_back(targets.getWeight());
+			}
+			if (dimOffsets.size() > dimFirst[code]) {
+				usedCodes++;
+			}
+		}
+		dimFirst[column.dictionary.size()] = (uint32_t)dimOffsets.size();
+		selectivity.push_back(make_pair(column.dictionary.empty() ? 0.0 : (double)usedCodes / column.dictionary.size(), dim));
+	}
+
+	// most selective dimension first
+	sort(selectivity.begin(), selectivity.end());
+	for (vector<pair<double, size_t> >::const_iterator it = selectivity.begin(); it != selectivity.end(); ++it) {
+		order.push_back(it->second);
+	}
+
+	// skip the rows of elements of the first dimension outside of the source area
+	size_t begin;
+	size_t end;
+	if (dimCount && columns.getFirstDimRows(0, begin, end)) {
+		const vector<uint32_t> &dimFirst = first[0];
+		for (uint32_t code = 0; code + 1 < dimFirst.size(); code++) {
+			if (dimFirst[code] == dimFirst[code + 1]) {
+				continue;
+			}
+			columns.getFirstDimRows(code, begin, end);
+			if (!ranges.empty() && ranges.back().second == begin) {
+				ranges.back().second = end;
+			} else if (begin < end) {
+				ranges.push_back(make_pair(begin, end));
+			}
+		}
+	} else if (columns.rowCount()) {
+		ranges.push_back(make_pair((size_t)0, columns.rowCount()));
+	}
+}
+
+size_t ColumnarKernel::filter(size_t begin, size_t end, uint32_t *rows, size_t *rowOffsets, double *rowWeights, uint8_t *multi) const
+{
+	size_t count = end - begin;
+	for (size_t i = 0; i < count; i++) {
+		rows[i] = (uint32_t)(begin + i);
+		rowOffsets[i] = 0;
+		rowWeights[i] = 1.0;
+		multi[i] = 0;
+	}
+
+	for (vector<size_t>::const_iterator dim = order.begin(); dim != order.end() && count; ++dim) {
+		const ColumnarStorage::Column &column = columns.getColumn(*dim);
+		const uint32_t *dimFirst = &first[*dim][0];
+		const size_t *dimOffsets = offsets[*dim].empty() ? 0 : &offsets[*dim][0];
+		const double *dimWeights = weights[*dim].empty() ? 0 : &weights[*dim][0];
+		size_t selected = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			uint32_t code = column.code(rows[i]);
+			uint32_t target = dimFirst[code];
+			uint32_t targets = dimFirst[code + 1] - target;
+			if (!targets) {
+				continue;
+			}
+			rows[selected] = rows[i];
+			rowOffsets[selected] = rowOffsets[i] + dimOffsets[target];
+			rowWeights[selected] = rowWeights[i] * dimWeights[target];
+			multi[selected] = multi[i] | (targets > 1);
+			selected++;
+		}
+		count = selected;
+	}
+	return count;
+}
+
+void ColumnarKernel::aggregate(size_t begin, size_t end, double *sums, uint8_t *used) const
+{
+	uint32_t rows[BLOCK_ROWS];
+	size_t rowOffsets[BLOCK_ROWS];
+	double rowWeights[BLOCK_ROWS];
+	uint8_t multi[BLOCK_ROWS];
+
+	for (size_t block = begin; block < end; block += BLOCK_ROWS) {
+		size_t count = filter(block, min(block + BLOCK_ROWS, end), rows, rowOffsets, rowWeights, multi);
+		for (size_t i = 0; i < count; i++) {
+			if (multi[i]) {
+				expand(rows[i], 0, 0, 1.0, values[rows[i]], sums, used);
+			} else {
+				sums[rowOffsets[i]] += rowWeights[i] * values[rows[i]];
+				used[rowOffsets[i]] = 1;
+			}
+		}
+	}
+}
+
+void ColumnarKernel::expand(size_t row, size_t dim, size_t offset, double weight, double value, double *sums, uint8_t *used) const
+{
+	if (dim == dimCount) {
+		sums[offset] += weight * value;
+		used[offset] = 1;
+		return;
+	}
+	uint32_t code = columns.getColumn(dim).code(row);
+	for (uint32_t target = first[dim][code]; target < first[dim][code + 1]; target++) {
+		expand(row, dim + 1, offset + offsets[dim][target], weight * weights[dim][target], value, sums, used);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief aggregates a part of the row ranges into its own arrays
+////////////////////////////////////////////////////////////////////////////////
+
+class ColumnarScanJob : public ThreadPoolJob {
+public:
+	ColumnarScanJob(ThreadPool::ThreadGroup &tg, const ColumnarKernel &kernel, const vector<pair<size_t, size_t> > &ranges, size_t areaSize) :
+		ThreadPoolJob(tg), kernel(kernel), ranges(ranges), sums(areaSize, 0.0), used(areaSize, 0) {}
+
+	virtual void operator()() {
+		for (vector<pair<size_t, size_t> >::const_iterator range = ranges.begin(); range != ranges.end(); ++range) {
+			kernel.aggregate(range->first, range->second, &sums[0], &used[0]);
+		}
+	}
+
+	const ColumnarKernel &kernel;
+	vector<pair<size_t, size_t> > ranges;
+	vector<double> sums;
+	vector<uint8_t> used;
+};
+
+// /////////////////////////////////////////////////////////////////////////////
+// aggregation processor
+// /////////////////////////////////////////////////////////////////////////////
+
+class ColumnarAggregationProcessor : public AggregationProcessor {
+public:
+	ColumnarAggregationProcessor(PEngineBase engine, CPPlanNode node) : AggregationProcessor(engine, node) {}
+
+protected:
+	virtual void aggregate();
+
+private:
+	void aggregateDense(const ColumnarKernel &kernel);
+	void aggregateSparse(const ColumnarKernel &kernel);
+};
+
+void ColumnarAggregationProcessor::aggregate()
+{
+	EngineColumnar *columnarEngine = dynamic_cast<EngineColumnar *>(engine.get());
+	const vector<PPlanNode> &sources = planNode->getChildren();
+	vector<CPColumnarStorage> sourceColumns;
+
+	for (vector<PPlanNode>::const_iterator source = sources.begin(); source != sources.end(); ++source) {
+		PStorageBase sourceStorage = columnarEngine->getSourceStorage(source->get());
+		CPColumnarStorage columns;
+		if (sourceStorage) {
+			columns = columnarEngine->getColumns(static_cast<const SourcePlanNode *>(source->get())->getStorageId(), sourceStorage);
+		}
+		if (!columns || columns->dimCount() != aggregationPlan->getArea()->dimCount()) {
+			// storage was changed in between, read it row-wise until the new copy is ready
+			AggregationProcessor::aggregate();
+			return;
+		}
+		sourceColumns.push_back(columns);
+	}
+
+	double resultSize = aggregationPlan->getArea()->getSize();
+	if (resultSize < 1000) {
+		storage.reset(new HashValueStorage(aggregationPlan->getArea()));
+	} else {
+		storage = CreateDoubleCellMap(aggregationPlan->getArea()->dimCount());
+		storage->setLimit(IdentifiersType(), (aggregationPlan->getMaxCount() == 0 ? 0 : aggregationPlan->getMaxCount() + 1));
+	}
+
+	initIntern();
+
+	for (size_t i = 0; i < sources.size(); i++) {
+		ColumnarKernel kernel(*sourceColumns[i], *sources[i]->getArea(), *aggregationPlan->getArea(), parentMaps, resultSize <= EngineColumnar::getDenseCells());
+		if (kernel.isDense()) {
+			aggregateDense(kernel);
+		} else {
+			aggregateSparse(kernel);
+		}
+	}
+	if (Logger::isDebug()) {
+		Logger::debug << "Aggregated area of " << resultSize << " cells from columns." << endl;
+	}
+	storageReader = storage->getValues();
+}
+
+void ColumnarAggregationProcessor::aggregateDense(const ColumnarKernel &kernel)
+{
+	Context *con = Context::getContext();
+	PThreadPool tp = con->getServer()->getThreadPool();
+	size_t areaSize = (size_t)aggregationPlan->getArea()->getSize();
+	if (!areaSize) {
+		return;
+	}
+	const vector<pair<size_t, size_t> > &ranges = kernel.getRanges();
+
+	size_t rows = 0;
+	for (vector<pair<size_t, size_t> >::const_iterator range = ranges.begin(); range != ranges.end(); ++range) {
+		rows += range->second - range->first;
+	}
+	size_t jobCount = min(rows / JOB_ROWS + 1, tp->getCoreCount());
+	if (jobCount > 1 && (double)jobCount * areaSize > DENSE_CELLS_TOTAL) {
+		jobCount = max((size_t)(DENSE_CELLS_TOTAL / areaSize), (size_t)1);
+	}
+
+	// split the ranges into parts of equal size
+	vector<PThreadPoolJob> jobs;
+	ThreadPool::ThreadGroup tg = tp->createThreadGroup();
+	vector<pair<size_t, size_t> >::const_iterator range = ranges.begin();
+	size_t position = range == ranges.end() ? 0 : range->first;
+	for (size_t job = 0; job < jobCount; job++) {
+		size_t jobRows = job + 1 == jobCount ? rows : rows / (jobCount - job);
+		vector<pair<size_t, size_t> > jobRanges;
+		rows -= jobRows;
+		while (jobRows) {
+			size_t end = min(range->second, position + jobRows);
+			jobRanges.push_back(make_pair(position, end));
+			jobRows -= end - position;
+			position = end;
+			if (position == range->second && ++range != ranges.end()) {
+				position = range->first;
+			}
+		}
+		jobs.push_back(PThreadPoolJob(new ColumnarScanJob(tg, kernel, jobRanges, areaSize)));
+	}
+	for (vector<PThreadPoolJob>::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+		if (job + 1 != jobs.end() && tp->hasFreeCore(false)) {
+			tp->addJob(*job);
+		} else {
+			ColumnarScanJob *scan = static_cast<ColumnarScanJob *>(job->get());
+			(*scan)();
+		}
+	}
+	tp->join(tg);
+	con->check();
+
+	// merge the arrays and store the used cells
+	ColumnarScanJob *result = static_cast<ColumnarScanJob *>(jobs[0].get());
+	for (size_t job = 1; job < jobs.size(); job++) {
+		ColumnarScanJob *scan = static_cast<ColumnarScanJob *>(jobs[job].get());
+		for (size_t offset = 0; offset < areaSize; offset++) {
+			if (scan->used[offset]) {
+				result->sums[offset] += scan->sums[offset];
+				result->used[offset] = 1;
+			}
+		}
+	}
+	const Area *area = aggregationPlan->getArea().get();
+	// the offsets follow the order of the path iterator, the last dimension changes fastest
+	Area::PathIterator path = area->pathBegin();
+	for (size_t offset = 0; offset < areaSize; offset++, ++path) {
+		if (result->used[offset]) {
+			storage->add(*path, result->sums[offset]);
+		}
+	}
+}
+
+void ColumnarAggregationProcessor::aggregateSparse(const ColumnarKernel &kernel)
+{
+	Context *con = Context::getContext();
+	uint32_t rows[BLOCK_ROWS];
+	size_t rowOffsets[BLOCK_ROWS];
+	double rowWeights[BLOCK_ROWS];
+	uint8_t multi[BLOCK_ROWS];
+	IdentifiersType key(dimCount);
+	size_t counter = 0;
+
+	const vector<pair<size_t, size_t> > &ranges = kernel.getRanges();
+	for (vector<pair<size_t, size_t> >::const_iterator range = ranges.begin(); range != ranges.end(); ++range) {
+		for (size_t block = range->first; block < range->second; block += BLOCK_ROWS) {
+			if (!(++counter % 100)) {
+				con->check();
+			}
+			size_t count = kernel.filter(block, min(block + BLOCK_ROWS, range->second), rows, rowOffsets, rowWeights, multi);
+			for (size_t i = 0; i < count; i++) {
+				kernel.getKey(rows[i], key);
+				aggregateCell(key, kernel.getValue(rows[i]));
+			}
+		}
+	}
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// engine
+// /////////////////////////////////////////////////////////////////////////////
+
+EngineColumnar::EngineColumnar() :
+	EngineBase("COLUMNAR", EngineBase::COLUMNAR), copies(new Copies())
+{
+}
+
+EngineColumnar::EngineColumnar(const EngineColumnar &e) :
+	EngineBase(e), copies(e.copies)
+{
+}
+
+EngineColumnar::~EngineColumnar()
+{
+}
+
+PCommitable EngineColumnar::copy() const
+{
+	checkNotCheckedOut();
+	PEngineBase newd(new EngineColumnar(*this));
+	return newd;
+}
+
+PStorageBase EngineColumnar::getCreateStorage(IdentifierType &id, PPathTranslator pathTranslator, StorageType type)
+{
+	throw ErrorException(ErrorException::ERROR_INTERNAL, "EngineColumnar::getCreateStorage: columnar engine has no storages");
+}
+
+PProcessorBase EngineColumnar::createProcessor(CPPlanNode node, bool sortedOutput, bool useCache)
+{
+	if (node->getType() == AGGREGATION && isPlanSupported(node)) {
+		PProcessorBase ret;
+		const AggregationPlanNode *apn = static_cast<const AggregationPlanNode *>(node.get());
+
+		if (apn->getCacheCube()) {
+			Context *context = Context::getContext();
+			for (Context::CacheDependences::const_iterator cacheIt = context->getCacheDependences().begin(); cacheIt != context->getCacheDependences().end(); ++cacheIt) {
+				ValueCache::CacheWriteProcessor *cacheProc = (*cacheIt);
+				if (cacheProc->getCubeArea()->getCube() == apn->getCacheCube() && *node->getArea() == *cacheProc->getCubeArea()) {
+					AggregationProcessor *cachedAggrProc = dynamic_cast<AggregationProcessor*>(cacheProc->getInputProcessor().get());
+					if (cachedAggrProc) {
+						PProcessorBase result = cachedAggrProc->getCalculatedValues();
+						if (result) {
+							return result;
+						}
+					}
+				}
+			}
+		}
+
+		ret.reset(new ColumnarAggregationProcessor(COMMITABLE_CAST(EngineBase, shared_from_this()), node));
+		if (useCache && node->getCache()) {
+			ret = node->getCache()->getWriter(node->getCacheCube(), PCubeArea(new CubeArea(CPDatabase(), CPCube(), *node->getArea())), ret, NO_IDENTIFIER);
+		}
+		return ret;
+	}
+
+	// everything else is calculated by the cpu engine
+	return Context::getContext()->getServer()->getEngine(EngineBase::CPU)->createProcessor(node, sortedOutput, useCache);
+}
+
+bool EngineColumnar::isPlanSupported(CPPlanNode node) const
+{
+	if (!minCells || node->getType() != AGGREGATION) {
+		return false;
+	}
+	const AggregationPlanNode *apn = static_cast<const AggregationPlanNode *>(node.get());
+	if (apn->getAggregationType() != AggregationPlanNode::SUM || apn->getCondition() || apn->getDimIndex() != NO_DFILTER) {
+		return false;
+	}
+
+	const vector<PPlanNode> &sources = node->getChildren();
+	if (sources.empty()) {
+		return false;
+	}
+	for (vector<PPlanNode>::const_iterator source = sources.begin(); source != sources.end(); ++source) {
+		if ((*source)->getType() != SOURCE) {
+			return false;
+		}
+		PStorageBase storage = getSourceStorage(source->get());
+		if (!storage || storage->valuesCount() < minCells || (*source)->getArea()->getSize() < minCells) {
+			return false;
+		}
+		// the cpu engine calculates the plan until the copy is ready
+		CPColumnarStorage columns = getColumns(static_cast<const SourcePlanNode *>(source->get())->getStorageId(), storage);
+		if (!columns) {
+			return false;
+		}
+		// the row-wise storage skips unused parts faster than a scan
+		if (columns->estimateRows(*(*source)->getArea()) < minCells) {
+			return false;
+		}
+	}
+	return true;
+}
+
+PStorageBase EngineColumnar::getSourceStorage(const PlanNode *node) const
+{
+	const SourcePlanNode *sourceNode = dynamic_cast<const SourcePlanNode *>(node);
+	PServer server = Context::getContext()->getServer();
+	if (!sourceNode || !server || !isOptedIn(sourceNode->getStorageId())) {
+		return PStorageBase();
+	}
+	// storages of gpu cubes are mirrored by the gpu engine and calculated there
+	PEngineBase gpuEngine = server->getEngine(EngineBase::GPU);
+	if (gpuEngine && gpuEngine->getStorage(sourceNode->getStorageId())) {
+		return PStorageBase();
+	}
+	PEngineBase cpuEngine = server->getEngine(EngineBase::CPU);
+	PStorageBase storage = cpuEngine ? cpuEngine->getStorage(sourceNode->getStorageId()) : PStorageBase();
+	StorageBase *st = storage.get();
+	if (!st || st->isCheckedOut() || !dynamic_cast<StorageCpu *>(st) || dynamic_cast<StringStorageCpu *>(st) || dynamic_cast<MarkerStorageCpu *>(st)) {
+		return PStorageBase();
+	}
+	return storage;
+}
+
+bool EngineColumnar::isOptedIn(IdentifierType storageId) const
+{
+	PServer server = Context::getContext()->getServer();
+	for (set<pair<string, string> >::const_iterator it = cubes.begin(); it != cubes.end(); ++it) {
+		CPDatabase db = server->lookupDatabaseByName(it->first, false);
+		CPCube cube = db ? db->lookupCubeByName(it->second, false) : CPCube();
+		if (cube && cube->getNumericStorageId() == storageId) {
+			return true;
+		}
+	}
+	return false;
+}
+
+CPColumnarStorage EngineColumnar::getColumns(IdentifierType storageId, PStorageBase storage) const
+{
+	boost::shared_ptr<Copy> copy;
+	{
+		WriteLocker wl(&copies->lock);
+		map<IdentifierType, boost::shared_ptr<Copy> > &storages = copies->storages;
+		for (map<IdentifierType, boost::shared_ptr<Copy> >::iterator it = storages.begin(); it != storages.end();) {
+			// release copies of deleted and replaced storages
+			if (it->first != storageId && it->second->source.expired()) {
+				storages.erase(it++);
+			} else {
+				++it;
+			}
+		}
+		boost::shared_ptr<Copy> &entry = storages[storageId];
+		if (!entry) {
+			entry.reset(new Copy());
+		}
+		copy = entry;
+	}
+
+	WriteLocker cl(&copy->lock);
+	if (copy->columns && copy->columns->isCopyOf(storage)) {
+		return copy->columns;
+	}
+	if (!copy->building) {
+		// one thread builds the copy of the current storage, the queries do not wait for it
+		copy->building = true;
+		copy->source = storage;
+		copy->columns.reset();
+		boost::thread(&EngineColumnar::buildColumns, copy, storageId, storage);
+	}
+	return CPColumnarStorage();
+}
+
+void EngineColumnar::buildColumns(boost::shared_ptr<Copy> copy, IdentifierType storageId, PStorageBase storage)
+{
+	bool wasNew;
+	Context::getContext(&wasNew);
+	CPColumnarStorage columns;
+	try {
+		columns.reset(new ColumnarStorage(storage));
+		Logger::info << "columnar copy of storage " << storageId << " with " << columns->rowCount() << " cells created, " << columns->getMemoryUsage() / 1024 << "kB" << endl;
+	} catch (const ErrorException &e) {
+		Logger::error << "cannot create columnar copy of storage " << storageId << ": " << e.getMessage() << endl;
+	} catch (const std::bad_alloc &) {
+		Logger::error << "cannot create columnar copy of storage " << storageId << ": out of memory" << endl;
+	}
+	{
+		WriteLocker cl(&copy->lock);
+		copy->columns = columns;
+		copy->building = false;
+	}
+	Context::reset(wasNew);
+}
+
+}
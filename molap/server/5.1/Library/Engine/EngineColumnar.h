@@ -0,0 +1,256 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef OLAP_ENGINE_COLUMNAR_H
+#define OLAP_ENGINE_COLUMNAR_H 1
+
+#include "palo.h"
+#include "Engine/EngineBase.h"
+#include "Thread/Mutex.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief columnar copy of a numeric cpu storage
+///
+/// Every dimension is stored as a column of dictionary codes bit-packed with
+/// the minimal width, the values are stored in a separate column. The copy is
+/// immutable and belongs to exactly one committed version of the storage.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS ColumnarStorage {
+public:
+	struct Column {
+		Column() : bits(0), mask(0) {}
+
+		uint32_t code(size_t row) const {
+			if (!bits) {
+				return 0;
+			}
+			size_t bit = row * bits;
+			size_t word = bit >> 6;
+			uint32_t shift = (uint32_t)(bit & 63);
+			uint64_t result = words[word] >> shift;
+			if (shift + bits > 64) {
+				result |= words[word + 1] << (64 - shift);
+			}
+			return (uint32_t)(result & mask);
+		}
+
+		void setCode(size_t row, uint32_t code);
+
+		IdentifiersType dictionary;
+		uint32_t bits;
+		uint64_t mask;
+		vector<uint64_t> words;
+	};
+
+	ColumnarStorage(PStorageBase storage);
+
+	bool isCopyOf(CPStorageBase storage) const {
+		return source.lock() == storage;
+	}
+
+	size_t rowCount() const {
+		return rows;
+	}
+
+	size_t dimCount() const {
+		return columns.size();
+	}
+
+	const Column &getColumn(size_t dim) const {
+		return columns[dim];
+	}
+
+	const double *getValues() const {
+		return values.empty() ? 0 : &values[0];
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief rows of a code of the first dimension or false if not sorted
+	///
+	/// The cells are read in key order, the rows of one element of the first
+	/// dimension are therefore consecutive.
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool getFirstDimRows(uint32_t code, size_t &begin, size_t &end) const {
+		if (firstDimRows.empty()) {
+			return false;
+		}
+		begin = firstDimRows[code];
+		end = firstDimRows[code + 1];
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief estimated number of rows inside the area
+	////////////////////////////////////////////////////////////////////////////////
+
+	double estimateRows(const Area &area) const;
+
+	size_t getMemoryUsage() const;
+
+private:
+	struct UsedCount {
+		UsedCount() : count(0) {}
+
+		boost::weak_ptr<const Set> set;
+		size_t count;
+	};
+
+	size_t countUsed(size_t dim, CPSet set) const;
+
+	boost::weak_ptr<const StorageBase> source;
+	size_t rows;
+	vector<Column> columns;
+	vector<double> values;
+	vector<size_t> firstDimRows;
+
+	// number of used elements of the last set of each dimension
+	mutable Mutex usedLock;
+	mutable vector<UsedCount> usedCounts;
+};
+
+typedef boost::shared_ptr<const ColumnarStorage> CPColumnarStorage;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief OLAP columnar cpu engine
+///
+/// Calculates sum aggregations over large numeric base storages of opted-in
+/// cubes by scanning columnar copies of the storages of the cpu engine. The
+/// engine owns no storages, a copy is built in the background when a storage
+/// is first aggregated and rebuilt after the storage was changed. Until the
+/// copy of the current storage is ready the plans are calculated by the cpu
+/// engine. All other plans are delegated to the cpu engine.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS EngineColumnar : public EngineBase {
+public:
+	EngineColumnar();
+	EngineColumnar(const EngineColumnar &e);
+	virtual ~EngineColumnar();
+
+	virtual PCommitable copy() const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief columnar engine cannot create storages
+	////////////////////////////////////////////////////////////////////////////////
+
+	virtual PStorageBase getCreateStorage(IdentifierType &id, PPathTranslator pathTranslator, StorageType type);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief creates new processor providing data
+	////////////////////////////////////////////////////////////////////////////////
+
+	virtual PProcessorBase createProcessor(CPPlanNode node, bool sortedOutput, bool useCache = true);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief test of plan support
+	///
+	/// Only sum aggregations of numeric cpu storages of opted-in cubes with at
+	/// least minCells filled cells and source areas of at least minCells cells
+	/// are supported, as soon as the columnar copies of the storages are ready.
+	////////////////////////////////////////////////////////////////////////////////
+
+	virtual bool isPlanSupported(CPPlanNode node) const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the cpu storage read by a source node if it can be copied
+	///
+	/// The storage has to be the numeric storage of an opted-in cube.
+	////////////////////////////////////////////////////////////////////////////////
+
+	PStorageBase getSourceStorage(const PlanNode *node) const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the columnar copy of a storage
+	///
+	/// Starts building the copy in the background if it is missing or belongs
+	/// to another version of the storage, null is returned until it is ready.
+	////////////////////////////////////////////////////////////////////////////////
+
+	CPColumnarStorage getColumns(IdentifierType storageId, PStorageBase storage) const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sets the minimal number of cells, 0 disables the engine
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void setMinCells(size_t cells) {
+		minCells = cells;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief opts a cube in, only cubes opted in are calculated by the engine
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void addCube(const string &database, const string &cube) {
+		cubes.insert(make_pair(database, cube));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sets the maximal number of cells of an area summed up in an array
+	///
+	/// Larger areas and areas not containing all targets are summed up in a map.
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void setDenseCells(double cells) {
+		denseCells = cells;
+	}
+
+	static double getDenseCells() {
+		return denseCells;
+	}
+
+private:
+	struct Copy {
+		Copy() : building(false) {}
+
+		Mutex lock;
+		boost::weak_ptr<const StorageBase> source;
+		CPColumnarStorage columns;
+		bool building;
+	};
+
+	struct Copies {
+		Mutex lock;
+		map<IdentifierType, boost::shared_ptr<Copy> > storages;
+	};
+
+	static void buildColumns(boost::shared_ptr<Copy> copy, IdentifierType storageId, PStorageBase storage);
+
+	bool isOptedIn(IdentifierType storageId) const;
+
+	boost::shared_ptr<Copies> copies;
+
+	static size_t minCells;
+	static double denseCells;
+	static set<pair<string, string> > cubes;
+};
+
+}
+
+#endif
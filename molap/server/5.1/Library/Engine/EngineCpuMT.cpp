@@ -202,8 +202,15 @@ void AggregationProcessorMT::aggregate()
 	initIntern();
 
 	const vector<PPlanNode> &sources = planNode->getChildren();
+	vector<PProcessorBase> prefetched;
+	prefetchProcessors(sources, false, prefetched);
 	for (vector<PPlanNode>::const_iterator source = sources.begin(); source != sources.end(); ++source) {
-		PCellStream sourceDataSP = createProcessor(*source, false);
+		PCellStream sourceDataSP = prefetched[source - sources.begin()];
+		if (sourceDataSP) {
+			prefetched[source - sources.begin()].reset();
+		} else {
+			sourceDataSP = createProcessor(*source, false);
+		}
 
 		reader = dynamic_cast<StorageCpu::Processor *>(sourceDataSP.get());
 		if (reader && (*source)->getType() == SOURCE) {
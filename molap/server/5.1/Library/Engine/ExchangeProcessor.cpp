@@ -0,0 +1,255 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "Engine/ExchangeProcessor.h"
+#include "Olap/Context.h"
+#include "Olap/Server.h"
+
+namespace palo {
+
+// cells handed over at once
+static const size_t BLOCK_CELLS = 4096;
+
+// blocks the producer calculates ahead of the consumer
+static const size_t MAX_BLOCKS = 16;
+
+// /////////////////////////////////////////////////////////////////////////////
+// producer job
+// /////////////////////////////////////////////////////////////////////////////
+
+class ExchangeJob : public ThreadPoolJob {
+public:
+	ExchangeJob(ThreadPool::ThreadGroup &tg, PEngineBase engine, CPPlanNode node, bool sortedOutput, bool useCache, PServer server, const set<EngineBase::Type> &engines, Context *parent, boost::shared_ptr<PaloSession> session, boost::shared_ptr<ExchangeProcessor::Buffer> buffer) :
+		ThreadPoolJob(tg), engine(engine), node(node), sortedOutput(sortedOutput), useCache(useCache), server(server), engines(engines), parent(parent), session(session), buffer(buffer) {}
+
+	virtual void operator()();
+
+private:
+	// finishes the buffer also if the calculation failed, the error is thrown by join
+	struct Finisher {
+		Finisher(ExchangeProcessor::Buffer &buffer) : buffer(buffer) {}
+		~Finisher() {
+			boost::unique_lock<boost::mutex> lock(buffer.m);
+			buffer.finished = true;
+			buffer.changed.notify_all();
+		}
+		ExchangeProcessor::Buffer &buffer;
+	};
+
+	// the subtree is calculated in an own context pinned to the server of the requesting job,
+	// the rights are checked for the user of its session and the requesting job's stop is honored
+	struct ContextGuard {
+		ContextGuard(PServer server, const set<EngineBase::Type> &engines, Context *parent, boost::shared_ptr<PaloSession> session) {
+			Context::reset();
+			Context *con = Context::getContext();
+			con->setServer(server);
+			con->setSession(session);
+			con->setParentJob(parent);
+			set<EngineBase::Type> available = con->getAvailableEngines();
+			for (set<EngineBase::Type>::const_iterator it = available.begin(); it != available.end(); ++it) {
+				if (engines.find(*it) == engines.end()) {
+					con->disableEngine(*it);
+				}
+			}
+		}
+		~ContextGuard() {
+			Context::reset();
+		}
+	};
+
+	bool push(boost::shared_ptr<ExchangeProcessor::Block> block);
+
+	PEngineBase engine;
+	CPPlanNode node;
+	bool sortedOutput;
+	bool useCache;
+	PServer server;
+	set<EngineBase::Type> engines;
+	Context *parent;
+	boost::shared_ptr<PaloSession> session;
+	boost::shared_ptr<ExchangeProcessor::Buffer> buffer;
+};
+
+void ExchangeJob::operator()()
+{
+	Finisher finisher(*buffer);
+	ContextGuard guard(server, engines, parent, session);
+
+	PProcessorBase child = engine->createProcessor(node, sortedOutput, useCache);
+	boost::shared_ptr<ExchangeProcessor::Block> block;
+	while (child->next()) {
+		if (!block) {
+			block.reset(new ExchangeProcessor::Block());
+			block->values.reserve(BLOCK_CELLS);
+		}
+		const IdentifiersType &key = child->getKey();
+		block->keys.insert(block->keys.end(), key.begin(), key.end());
+		block->values.push_back(child->getValue());
+		if (block->values.size() >= BLOCK_CELLS) {
+			if (!push(block)) {
+				return;
+			}
+			block.reset();
+		}
+	}
+	if (block) {
+		push(block);
+	}
+}
+
+bool ExchangeJob::push(boost::shared_ptr<ExchangeProcessor::Block> block)
+{
+	boost::unique_lock<boost::mutex> lock(buffer->m);
+	while (buffer->blocks.size() >= MAX_BLOCKS && !buffer->cancelled) {
+		buffer->changed.wait(lock);
+	}
+	if (buffer->cancelled) {
+		return false;
+	}
+	buffer->blocks.push_back(block);
+	buffer->changed.notify_all();
+	return true;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// exchange processor
+// /////////////////////////////////////////////////////////////////////////////
+
+PProcessorBase ExchangeProcessor::create(PEngineBase engine, CPPlanNode node, bool sortedOutput, bool useCache)
+{
+	PServer server = Context::getContext()->getServer();
+	if (!server || server->isCheckedOut()) {
+		return PProcessorBase();
+	}
+	PThreadPool tp = server->getThreadPool();
+	if (!tp || !tp->hasFreeCore(false)) {
+		return PProcessorBase();
+	}
+	return PProcessorBase(new ExchangeProcessor(engine, node, sortedOutput, useCache, server, tp));
+}
+
+ExchangeProcessor::ExchangeProcessor(PEngineBase engine, CPPlanNode node, bool sortedOutput, bool useCache, PServer server, PThreadPool tp) :
+	ProcessorBase(sortedOutput, engine), node(node), useCache(useCache), server(server), engines(Context::getContext()->getAvailableEngines()), parent(Context::getContext()), session(parent->getSession()), tp(tp), running(false), position(0), pathTranslator(node->getArea()->getPathTranslator())
+{
+	start();
+}
+
+ExchangeProcessor::~ExchangeProcessor()
+{
+	stop();
+}
+
+void ExchangeProcessor::start()
+{
+	buffer.reset(new Buffer());
+	current.reset();
+	position = 0;
+	key.clear();
+
+	tg = tp->createThreadGroup();
+	running = true;
+	// high priority, the requesting thread waits for the job
+	tp->addJob(PThreadPoolJob(new ExchangeJob(tg, engine, node, sorted, useCache, server, engines, parent, session, buffer)), 1);
+}
+
+void ExchangeProcessor::stop()
+{
+	if (running) {
+		{
+			boost::unique_lock<boost::mutex> lock(buffer->m);
+			buffer->cancelled = true;
+			buffer->changed.notify_all();
+		}
+		running = false;
+		tp->join(tg, false);
+	}
+}
+
+bool ExchangeProcessor::next()
+{
+	if (current && ++position < current->values.size()) {
+		size_t dims = key.size();
+		key.assign(current->keys.begin() + position * dims, current->keys.begin() + (position + 1) * dims);
+		return true;
+	}
+	current.reset();
+	position = 0;
+	if (running) {
+		boost::unique_lock<boost::mutex> lock(buffer->m);
+		while (buffer->blocks.empty() && !buffer->finished) {
+			buffer->changed.wait(lock);
+		}
+		if (!buffer->blocks.empty()) {
+			current = buffer->blocks.front();
+			buffer->blocks.pop_front();
+			buffer->changed.notify_all();
+		}
+	}
+	if (!current) {
+		if (running) {
+			running = false;
+			// throws the error of the calculation
+			tp->join(tg);
+		}
+		key.clear();
+		return false;
+	}
+	size_t dims = current->keys.size() / current->values.size();
+	key.assign(current->keys.begin(), current->keys.begin() + dims);
+	return true;
+}
+
+const CellValue &ExchangeProcessor::getValue()
+{
+	if (!current) {
+		throw ErrorException(ErrorException::ERROR_INTERNAL, "invalid path in ExchangeProcessor::getValue()");
+	}
+	return current->values[position];
+}
+
+double ExchangeProcessor::getDouble()
+{
+	return getValue().getNumeric();
+}
+
+const IdentifiersType &ExchangeProcessor::getKey() const
+{
+	return key;
+}
+
+const GpuBinPath &ExchangeProcessor::getBinKey() const
+{
+	pathTranslator->pathToBinPath(getKey(), const_cast<GpuBinPath &>(binPath));
+	return binPath;
+}
+
+void ExchangeProcessor::reset()
+{
+	stop();
+	start();
+}
+
+}
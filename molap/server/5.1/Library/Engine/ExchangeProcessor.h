@@ -0,0 +1,107 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef OLAP_EXCHANGE_PROCESSOR_H
+#define OLAP_EXCHANGE_PROCESSOR_H 1
+
+#include "palo.h"
+#include "Engine/EngineBase.h"
+#include "Thread/ThreadPool.h"
+
+namespace palo {
+class Context;
+class PaloSession;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief exchange processor
+///
+/// Evaluates a plan node on a thread of the pool and hands the cells over in
+/// blocks through a bounded buffer, the requesting thread reads them while
+/// the sibling subtrees are calculated. The planner marks the nodes worth an
+/// own thread, see Planner::markExchanges.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS ExchangeProcessor : public ProcessorBase {
+public:
+	struct Block {
+		IdentifiersType keys;
+		vector<CellValue> values;
+	};
+
+	struct Buffer {
+		Buffer() : finished(false), cancelled(false) {}
+
+		boost::mutex m;
+		boost::condition_variable changed;
+		deque<boost::shared_ptr<Block> > blocks;
+		bool finished;
+		bool cancelled;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief creates the processor or returns 0 if no core is free
+	///
+	/// Only read jobs exchange cells, nodes of a checked out server are always
+	/// evaluated in the requesting thread.
+	////////////////////////////////////////////////////////////////////////////////
+
+	static PProcessorBase create(PEngineBase engine, CPPlanNode node, bool sortedOutput, bool useCache);
+
+	virtual ~ExchangeProcessor();
+
+	virtual bool next();
+	virtual const CellValue &getValue();
+	virtual double getDouble();
+	virtual const IdentifiersType &getKey() const;
+	virtual const GpuBinPath &getBinKey() const;
+	virtual void reset();
+
+private:
+	ExchangeProcessor(PEngineBase engine, CPPlanNode node, bool sortedOutput, bool useCache, PServer server, PThreadPool tp);
+
+	void start();
+	void stop();
+
+	CPPlanNode node;
+	bool useCache;
+	PServer server;
+	set<EngineBase::Type> engines;
+	Context *parent;
+	boost::shared_ptr<PaloSession> session;
+	PThreadPool tp;
+	ThreadPool::ThreadGroup tg;
+	bool running;
+	boost::shared_ptr<Buffer> buffer;
+	boost::shared_ptr<Block> current;
+	size_t position;
+	IdentifiersType key;
+	CPPathTranslator pathTranslator;
+	GpuBinPath binPath;
+};
+
+}
+
+#endif
@@ -0,0 +1,249 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "Engine/GroupByProcessor.h"
+#include "InputOutput/Condition.h"
+
+namespace palo {
+
+static const uint32_t NO_POSITION = (uint32_t)-1;
+
+bool GroupByProcessor::enabled = true;
+
+GroupByProcessor::GroupByProcessor(PEngineBase engine, CPPlanNode node) :
+	ProcessorBase(true, engine), planNode(node), init(true), started(false), position(0)
+{
+	aggregationPlan = dynamic_cast<const AggregationPlanNode *>(node.get());
+	CPArea area = aggregationPlan->getArea();
+	dimCount = area->dimCount();
+	filteredDim = (size_t)aggregationPlan->getDimIndex();
+	if (aggregationPlan->getDimIndex() == NO_DFILTER || filteredDim >= dimCount) {
+		throw ErrorException(ErrorException::ERROR_INTERNAL, "GroupByProcessor: invalid filtered dimension");
+	}
+	maps.resize(dimCount);
+	for (size_t dim = 0; dim < dimCount; dim++) {
+		maps[dim] = &aggregationPlan->getAggregationMaps()->at(dim);
+	}
+
+	CPSet filteredSet = area->getDim(filteredDim);
+	elements.reserve(filteredSet->size());
+	for (Set::Iterator it = filteredSet->begin(); it != filteredSet->end(); ++it) {
+		elements.push_back(*it);
+	}
+	if (!elements.empty()) {
+		positions.resize(elements.back() + 1, NO_POSITION);
+		for (size_t i = 0; i < elements.size(); i++) {
+			positions[elements[i]] = (uint32_t)i;
+		}
+	}
+	key = *area->pathBegin();
+}
+
+bool GroupByProcessor::isSupported(const AggregationPlanNode *node)
+{
+	return enabled && node->getDimIndex() != NO_DFILTER && (node->getAggregationType() == AggregationPlanNode::SUM || node->getAggregationType() == AggregationPlanNode::AVG);
+}
+
+bool GroupByProcessor::next()
+{
+	if (init) {
+		aggregate();
+		init = false;
+	}
+	if (started) {
+		++position;
+	} else {
+		position = 0;
+		started = true;
+	}
+	while (position < elements.size() && !used[position]) {
+		++position;
+	}
+	if (position >= elements.size()) {
+		return false;
+	}
+	key[filteredDim] = elements[position];
+	value = sums[position];
+	return true;
+}
+
+const CellValue &GroupByProcessor::getValue()
+{
+	return value;
+}
+
+double GroupByProcessor::getDouble()
+{
+	return sums[position];
+}
+
+const IdentifiersType &GroupByProcessor::getKey() const
+{
+	return key;
+}
+
+void GroupByProcessor::reset()
+{
+	started = false;
+}
+
+void GroupByProcessor::aggregate()
+{
+	sums.assign(elements.size(), 0.0);
+	used.assign(elements.size(), 0);
+
+	const vector<PPlanNode> &children = planNode->getChildren();
+	for (vector<PPlanNode>::const_iterator child = children.begin(); child != children.end(); ++child) {
+		if (isFusable(child->get())) {
+			const AggregationPlanNode *childPlan = static_cast<const AggregationPlanNode *>(child->get());
+			const vector<PPlanNode> &sources = childPlan->getChildren();
+			for (vector<PPlanNode>::const_iterator source = sources.begin(); source != sources.end(); ++source) {
+				PCellStream sourceData = createProcessor(*source, false);
+				aggregateStream(*sourceData, childPlan->getAggregationMaps().get());
+			}
+		} else {
+			PCellStream childData = createProcessor(*child, false);
+			aggregateStream(*childData, 0);
+		}
+	}
+
+	if (aggregationPlan->getAggregationType() == AggregationPlanNode::AVG) {
+		double cellsPerElement = aggregationPlan->getCellsPerElement();
+		const Condition *cond = aggregationPlan->getCondition().get();
+		bool addZero = !cond || cond->check(0.0);
+		for (size_t i = 0; i < elements.size(); i++) {
+			if (used[i]) {
+				sums[i] /= cellsPerElement;
+			} else if (addZero) {
+				used[i] = 1;
+			}
+		}
+	}
+}
+
+bool GroupByProcessor::isFusable(const PlanNode *node) const
+{
+	if (node->getType() != AGGREGATION) {
+		return false;
+	}
+	const AggregationPlanNode *childPlan = static_cast<const AggregationPlanNode *>(node);
+	if (childPlan->getAggregationType() != AggregationPlanNode::SUM || childPlan->getCondition() || childPlan->getDimIndex() != NO_DFILTER || childPlan->getArea()->dimCount() != dimCount) {
+		return false;
+	}
+	const vector<PPlanNode> &sources = childPlan->getChildren();
+	for (vector<PPlanNode>::const_iterator source = sources.begin(); source != sources.end(); ++source) {
+		if ((*source)->getType() != SOURCE) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void GroupByProcessor::aggregateStream(CellValueStream &stream, const AggregationMaps *childMaps)
+{
+	IdentifiersType lastIds(dimCount, NO_IDENTIFIER);
+	vector<double> weights(dimCount, 1.0);
+	vector<pair<uint32_t, double> > targets;
+	double weight = 1.0;
+
+	while (stream.next()) {
+		const IdentifiersType &sourceKey = stream.getKey();
+		bool changed = false;
+		for (size_t dim = 0; dim < dimCount; dim++) {
+			IdentifierType id = sourceKey[dim];
+			if (id == lastIds[dim]) {
+				continue;
+			}
+			lastIds[dim] = id;
+			const AggregationMap *childMap = childMaps ? &childMaps->at(dim) : 0;
+			if (dim == filteredDim) {
+				getTargets(id, childMap, targets);
+			} else {
+				weights[dim] = getWeight(dim, id, childMap);
+				changed = true;
+			}
+		}
+		if (changed) {
+			weight = 1.0;
+			for (size_t dim = 0; dim < dimCount; dim++) {
+				if (dim != filteredDim) {
+					weight *= weights[dim];
+				}
+			}
+		}
+		if (!weight || targets.empty()) {
+			continue;
+		}
+		double val = stream.getDouble() * weight;
+		for (vector<pair<uint32_t, double> >::const_iterator target = targets.begin(); target != targets.end(); ++target) {
+			sums[target->first] += val * target->second;
+			used[target->first] = 1;
+		}
+	}
+}
+
+double GroupByProcessor::getWeight(size_t dim, IdentifierType id, const AggregationMap *childMap) const
+{
+	// all elements of the dimension are collapsed to one target
+	double result = 0;
+	if (childMap) {
+		for (AggregationMap::TargetReader childTargets = childMap->getTargets(id); !childTargets.end(); ++childTargets) {
+			for (AggregationMap::TargetReader parentTargets = maps[dim]->getTargets(*childTargets); !parentTargets.end(); ++parentTargets) {
+				result += childTargets.getWeight() * parentTargets.getWeight();
+			}
+		}
+	} else {
+		for (AggregationMap::TargetReader parentTargets = maps[dim]->getTargets(id); !parentTargets.end(); ++parentTargets) {
+			result += parentTargets.getWeight();
+		}
+	}
+	return result;
+}
+
+void GroupByProcessor::getTargets(IdentifierType id, const AggregationMap *childMap, vector<pair<uint32_t, double> > &targets) const
+{
+	// every element of the filtered dimension keeps its own sum
+	targets.clear();
+	if (childMap) {
+		for (AggregationMap::TargetReader childTargets = childMap->getTargets(id); !childTargets.end(); ++childTargets) {
+			addTargets(*childTargets, childTargets.getWeight(), targets);
+		}
+	} else {
+		addTargets(id, 1.0, targets);
+	}
+}
+
+void GroupByProcessor::addTargets(IdentifierType id, double weight, vector<pair<uint32_t, double> > &targets) const
+{
+	for (AggregationMap::TargetReader parentTargets = maps[filteredDim]->getTargets(id); !parentTargets.end(); ++parentTargets) {
+		IdentifierType element = *parentTargets;
+		if (element < positions.size() && positions[element] != NO_POSITION) {
+			targets.push_back(make_pair(positions[element], weight * parentTargets.getWeight()));
+		}
+	}
+}
+
+}
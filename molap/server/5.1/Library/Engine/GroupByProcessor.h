@@ -0,0 +1,100 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef OLAP_GROUP_BY_PROCESSOR_H
+#define OLAP_GROUP_BY_PROCESSOR_H 1
+
+#include "palo.h"
+#include "Engine/EngineBase.h"
+#include "Engine/AggregationMap.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sum or average per element of one dimension
+///
+/// Evaluates the data filter aggregations: every other dimension of the area
+/// is collapsed to a single element, the result holds one value per element of
+/// the filtered dimension. Child sum aggregations reading only storages are not
+/// evaluated, their sources are aggregated directly with the composed maps in
+/// one pass. The values are kept in arrays indexed by the position of the
+/// element in the filtered set.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS GroupByProcessor : public ProcessorBase {
+public:
+	GroupByProcessor(PEngineBase engine, CPPlanNode node);
+	virtual ~GroupByProcessor() {}
+
+	virtual bool next();
+	virtual const CellValue &getValue();
+	virtual double getDouble();
+	virtual const IdentifiersType &getKey() const;
+	virtual void reset();
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief true if the aggregation can be grouped
+	////////////////////////////////////////////////////////////////////////////////
+
+	static bool isSupported(const AggregationPlanNode *node);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief enables the grouping, disabled data filters aggregate by element
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void setEnabled(bool enabled) {
+		GroupByProcessor::enabled = enabled;
+	}
+
+private:
+	void aggregate();
+	void aggregateStream(CellValueStream &stream, const AggregationMaps *childMaps);
+	bool isFusable(const PlanNode *node) const;
+	double getWeight(size_t dim, IdentifierType id, const AggregationMap *childMap) const;
+	void getTargets(IdentifierType id, const AggregationMap *childMap, vector<pair<uint32_t, double> > &targets) const;
+	void addTargets(IdentifierType id, double weight, vector<pair<uint32_t, double> > &targets) const;
+
+	const AggregationPlanNode *aggregationPlan;
+	CPPlanNode planNode;
+	size_t dimCount;
+	size_t filteredDim;
+	vector<const AggregationMap *> maps;
+	IdentifiersType elements;
+	vector<uint32_t> positions;
+	vector<double> sums;
+	vector<uint8_t> used;
+	bool init;
+	bool started;
+	size_t position;
+	IdentifiersType key;
+	CellValue value;
+
+	static bool enabled;
+};
+
+}
+
+#endif
@@ -297,6 +297,8 @@ void ERule::init()
 	}
 
 	arule->genCode(generator);
+
+	native = native_code::get(*this);
 }
 
 ERule::~ERule()
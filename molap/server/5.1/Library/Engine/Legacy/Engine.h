@@ -35,6 +35,7 @@
 #include "Olap/Context.h"
 #include "Olap/Cube.h"
 #include "Engine/Legacy/SimpleCache.h"
+#include "Engine/Legacy/NativeCode.h"
 
 #ifdef _MSC_VER
 #undef max
@@ -212,6 +213,8 @@ public:
 
 	uint8_t		precalcStet;
 
+	PNativeCode	native; /* compiled program, empty if not compilable */
+
 	const Rule *arule;
 private:
 	static const size_t MAX_MASK_SIZE = 256;
@@ -0,0 +1,361 @@
+/* 
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ * 
+ *
+ */
+
+#include "Engine/Legacy/NativeCode.h"
+#include "Engine/Legacy/Engine.h"
+#include "VirtualMachine/BytecodeGenerator.h"
+#include "Olap/Rule.h"
+
+#if defined(ENABLE_RULE_JIT) && defined(__x86_64__) && defined(__linux__)
+#define RULE_JIT_X86_64 1
+#include <sys/mman.h>
+#endif
+
+namespace paloLegacy {
+
+bool native_code::enabled = true;
+
+#if defined(RULE_JIT_X86_64)
+
+// registers: rdi = count, rsi = sources, rdx = consts, rcx = results, r8 = cell index
+// xmm0 = val_0, xmm1 - xmm13 = value stack, xmm14 and xmm15 = scratch
+static const size_t MAX_NATIVE_STACK = 13;
+
+class x86_64_assembler {
+public:
+	enum Prefix {
+		NONE = 0, PD = 0x66, SD = 0xF2
+	};
+
+	enum Opcode {
+		SQRT = 0x51, AND = 0x54, XOR = 0x57, ADD = 0x58, MUL = 0x59, SUB = 0x5C, DIV = 0x5E, MOVAPS = 0x28, CMP = 0xC2
+	};
+
+	enum Compare {
+		CMP_LE = 2, CMP_NEQ = 4
+	};
+
+	void emit(uint8_t b) {
+		code.push_back(b);
+	}
+
+	void emit32(int32_t d) {
+		for (int i = 0; i < 4; i++) {
+			emit((uint8_t)(d >> (i * 8)));
+		}
+	}
+
+	void emit64(uint64_t q) {
+		for (int i = 0; i < 8; i++) {
+			emit((uint8_t)(q >> (i * 8)));
+		}
+	}
+
+	// <prefix> [rex] 0F <opcode> modrm(xmm dst, xmm src)
+	void sse(Prefix prefix, Opcode opcode, int dst, int src) {
+		if (prefix != NONE) {
+			emit(prefix);
+		}
+		if (dst >= 8 || src >= 8) {
+			emit(0x40 | (dst >= 8 ? 4 : 0) | (src >= 8 ? 1 : 0));
+		}
+		emit(0x0F);
+		emit(opcode);
+		emit(0xC0 | ((dst & 7) << 3) | (src & 7));
+	}
+
+	void movaps(int dst, int src) {
+		if (dst != src) {
+			sse(NONE, MOVAPS, dst, src);
+		}
+	}
+
+	void cmpsd(int dst, int src, Compare predicate) {
+		sse(SD, CMP, dst, src);
+		emit(predicate);
+	}
+
+	// movsd xmm0, [rdx + 8 * constant]
+	void load_const(uint32_t constant) {
+		emit(0xF2); emit(0x0F); emit(0x10); emit(0x82);
+		emit32((int32_t)(constant * sizeof(double)));
+	}
+
+	// mov rax, [rsi + 8 * source]; movsd xmm0, [rax + 8 * r8]
+	void load_source(uint32_t source) {
+		emit(0x48); emit(0x8B); emit(0x86);
+		emit32((int32_t)(source * sizeof(double *)));
+		emit(0xF2); emit(0x42); emit(0x0F); emit(0x10); emit(0x04); emit(0xC0);
+	}
+
+	// movsd [rcx + 8 * r8], xmm0
+	void store_result() {
+		emit(0xF2); emit(0x42); emit(0x0F); emit(0x11); emit(0x04); emit(0xC1);
+	}
+
+	// mov rax, imm64; movq xmm15, rax
+	void load_mask(uint64_t mask) {
+		emit(0x48); emit(0xB8);
+		emit64(mask);
+		emit(0x66); emit(0x4C); emit(0x0F); emit(0x6E); emit(0xF8);
+	}
+
+	// xor r8d, r8d; test rdi, rdi; jz <end>
+	size_t prologue() {
+		emit(0x45); emit(0x31); emit(0xC0);
+		emit(0x48); emit(0x85); emit(0xFF);
+		emit(0x0F); emit(0x84);
+		size_t patch = code.size();
+		emit32(0);
+		return patch;
+	}
+
+	// inc r8; cmp r8, rdi; jb <loop>; ret
+	void epilogue(size_t loop, size_t patch) {
+		emit(0x49); emit(0xFF); emit(0xC0);
+		emit(0x49); emit(0x39); emit(0xF8);
+		emit(0x0F); emit(0x82);
+		emit32((int32_t)loop - (int32_t)(code.size() + 4));
+		int32_t end = (int32_t)code.size() - (int32_t)(patch + 4);
+		for (int i = 0; i < 4; i++) {
+			code[patch + i] = (uint8_t)(end >> (i * 8));
+		}
+		emit(0xC3);
+	}
+
+	vector<uint8_t> code;
+};
+
+static inline int stackRegister(size_t slot)
+{
+	return (int)slot + 1;
+}
+
+bool native_code::is_compilable(const ERule &rule)
+{
+	if (!rule.bytecode) {
+		return false;
+	}
+	size_t depth = 0;
+	for (uint32_t pos = 0; pos < rule.gc_bc_nr; pos++) {
+		switch (rule.bytecode[pos]) {
+		case bytecode_generator::NOP:
+		case bytecode_generator::OP1_ABS_DBL:
+		case bytecode_generator::OP1_SQRT_DBL:
+			break;
+
+		case bytecode_generator::HALT:
+			return depth == 1;
+
+		case bytecode_generator::LD_CONST_DBL:
+		case bytecode_generator::LD_SRC_HIT_DBL:
+		case bytecode_generator::LD_SRC_DBL:
+			pos++;
+			// no break
+		case bytecode_generator::PUSH_DBL:
+			if (++depth > MAX_NATIVE_STACK) {
+				return false;
+			}
+			break;
+
+		case bytecode_generator::PULL_DBL:
+		case bytecode_generator::OP2_SUM_DBL:
+		case bytecode_generator::OP2_DIFF_DBL:
+		case bytecode_generator::OP2_PROD_DBL:
+		case bytecode_generator::OP2_QUO_DBL:
+			if (!depth--) {
+				return false;
+			}
+			break;
+
+		case bytecode_generator::SWAP_DBL:
+			if (!depth) {
+				return false;
+			}
+			break;
+
+		default:
+			return false;
+		}
+	}
+	return false;
+}
+
+PNativeCode native_code::compile(const ERule &rule)
+{
+	PNativeCode result(new native_code());
+	if (!is_compilable(rule)) {
+		return result;
+	}
+
+	x86_64_assembler a;
+	size_t patch = a.prologue();
+	size_t loop = a.code.size();
+	size_t sp = 0;
+	int top;
+
+	for (uint32_t pos = 0; pos < rule.gc_bc_nr; pos++) {
+		Bytecode op = rule.bytecode[pos];
+		if (op == bytecode_generator::HALT) {
+			a.store_result();
+			break;
+		}
+		switch (op) {
+		case bytecode_generator::NOP:
+			break;
+
+		case bytecode_generator::PUSH_DBL:
+			a.movaps(stackRegister(sp++), 0);
+			break;
+
+		case bytecode_generator::PULL_DBL:
+			a.movaps(0, stackRegister(--sp));
+			break;
+
+		case bytecode_generator::SWAP_DBL:
+			a.movaps(15, 0);
+			a.movaps(0, stackRegister(sp - 1));
+			a.movaps(stackRegister(sp - 1), 15);
+			break;
+
+		case bytecode_generator::LD_CONST_DBL:
+			a.movaps(stackRegister(sp++), 0);
+			a.load_const(rule.bytecode[++pos]);
+			break;
+
+		case bytecode_generator::LD_SRC_HIT_DBL:
+		case bytecode_generator::LD_SRC_DBL:
+			a.movaps(stackRegister(sp++), 0);
+			a.load_source(rule.bytecode[++pos]);
+			break;
+
+		case bytecode_generator::OP2_SUM_DBL:
+			top = stackRegister(--sp);
+			a.sse(x86_64_assembler::SD, x86_64_assembler::ADD, top, 0);
+			a.movaps(0, top);
+			break;
+
+		case bytecode_generator::OP2_DIFF_DBL:
+			top = stackRegister(--sp);
+			a.sse(x86_64_assembler::SD, x86_64_assembler::SUB, top, 0);
+			a.movaps(0, top);
+			break;
+
+		case bytecode_generator::OP2_PROD_DBL:
+			top = stackRegister(--sp);
+			a.sse(x86_64_assembler::SD, x86_64_assembler::MUL, top, 0);
+			a.movaps(0, top);
+			break;
+
+		case bytecode_generator::OP2_QUO_DBL:
+			// division by zero results in zero
+			top = stackRegister(--sp);
+			a.sse(x86_64_assembler::PD, x86_64_assembler::XOR, 14, 14);
+			a.cmpsd(14, 0, x86_64_assembler::CMP_NEQ);
+			a.sse(x86_64_assembler::SD, x86_64_assembler::DIV, top, 0);
+			a.sse(x86_64_assembler::PD, x86_64_assembler::AND, top, 14);
+			a.movaps(0, top);
+			break;
+
+		case bytecode_generator::OP1_ABS_DBL:
+			a.load_mask(0x7FFFFFFFFFFFFFFFULL);
+			a.sse(x86_64_assembler::PD, x86_64_assembler::AND, 0, 15);
+			break;
+
+		case bytecode_generator::OP1_SQRT_DBL:
+			// square root of negative numbers results in zero
+			a.sse(x86_64_assembler::PD, x86_64_assembler::XOR, 14, 14);
+			a.cmpsd(14, 0, x86_64_assembler::CMP_LE);
+			a.sse(x86_64_assembler::SD, x86_64_assembler::SQRT, 0, 0);
+			a.sse(x86_64_assembler::PD, x86_64_assembler::AND, 0, 14);
+			break;
+		}
+	}
+	a.epilogue(loop, patch);
+
+	size_t size = a.code.size();
+	void *memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		Logger::warning << "cannot allocate memory for native code of rule " << rule.nr_rule << endl;
+		return result;
+	}
+	memcpy(memory, &a.code[0], size);
+	if (mprotect(memory, size, PROT_READ | PROT_EXEC)) {
+		Logger::warning << "cannot make native code of rule " << rule.nr_rule << " executable" << endl;
+		munmap(memory, size);
+		return result;
+	}
+	result->memory = memory;
+	result->size = size;
+	result->function = (function_type)memory;
+	Logger::trace << "rule " << rule.nr_rule << " compiled to " << size << " bytes of native code" << endl;
+	return result;
+}
+
+native_code::~native_code()
+{
+	if (memory) {
+		munmap(memory, size);
+	}
+}
+
+#else
+
+bool native_code::is_compilable(const ERule &rule)
+{
+	return false;
+}
+
+PNativeCode native_code::compile(const ERule &rule)
+{
+	return PNativeCode(new native_code());
+}
+
+native_code::~native_code()
+{
+}
+
+#endif
+
+native_code::native_code() :
+	memory(0), size(0), function(0)
+{
+}
+
+PNativeCode native_code::get(const ERule &rule)
+{
+	if (!enabled || !rule.arule) {
+		return PNativeCode();
+	}
+	PNativeCode code = rule.arule->getNativeCode();
+	if (!code) {
+		code = compile(rule);
+		rule.arule->setNativeCode(code);
+	}
+	return code->is_compiled() ? code : PNativeCode();
+}
+
+}
@@ -0,0 +1,93 @@
+/* 
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ * 
+ *
+ */
+
+#ifndef NATIVE_CODE_H
+#define NATIVE_CODE_H
+
+#include "palo.h"
+
+namespace paloLegacy {
+
+class ERule;
+class native_code;
+typedef boost::shared_ptr<native_code> PNativeCode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief rule program compiled to native code
+///
+/// The numeric straight-line programs accepted by vector_machine are
+/// translated to x86-64 SSE2 code looping over a batch of cells. The code is
+/// generated once per rule definition and cached with the Rule, ERules of
+/// later requests reuse it. On other platforms or for programs using opcodes
+/// the compiler does not know, no code is generated and vector_machine
+/// interprets the program.
+////////////////////////////////////////////////////////////////////////////////
+class native_code {
+public:
+	typedef void (*function_type)(size_t count, const double * const *sources, const double *consts, double *results);
+
+	~native_code();
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the compiled program of the rule, compiles it if needed
+	////////////////////////////////////////////////////////////////////////////////
+	static PNativeCode get(const ERule &rule);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief checks if the program of the rule can be compiled
+	////////////////////////////////////////////////////////////////////////////////
+	static bool is_compilable(const ERule &rule);
+
+	bool is_compiled() const {
+		return function != 0;
+	}
+
+	void compute(size_t count, const double * const *sources, const double *consts, double *results) const {
+		function(count, sources, consts, results);
+	}
+
+	static void setEnabled(bool enabled) {
+		native_code::enabled = enabled;
+	}
+
+	static bool isEnabled() {
+		return enabled;
+	}
+
+private:
+	native_code();
+	static PNativeCode compile(const ERule &rule);
+
+	void *memory;
+	size_t size;
+	function_type function;
+
+	static bool enabled;
+};
+
+}
+
+#endif
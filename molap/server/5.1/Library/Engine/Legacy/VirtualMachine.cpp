@@ -439,7 +439,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 			if (cubeIndex == -1) {
 				adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-				if (!val_0.empty() && adb->getName() != val_0) {
+				if (!val_0.empty() && adb->getName() != val_0.getString()) {
 					CPServer asrv = context->getServer();
 					adb = asrv->lookupDatabaseByName(val_0, false);
 				} else {
@@ -456,7 +456,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 					if (val_0.empty()) {
 						val_0 = rule->cube->acube->getName();
 					}
-					if (!acube || acube->getName() != val_0) {
+					if (!acube || acube->getName() != val_0.getString()) {
 						acube = adb->lookupCubeByName(val_0, false);
 					} else if (!acube) {
 						acube = CONST_COMMITABLE_CAST(Cube, rule->cube->acube->shared_from_this());
@@ -1018,7 +1018,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::FUNC_CONCATENATE: /* S <- S,S */
 			if (checkStackErrors(2)) {
-				val_0 = *(--sp) + val_0;
+				val_0 = (--sp)->getString() + val_0.getString();
 			}
 			break;
 
@@ -1046,9 +1046,9 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 		case bytecode_generator::FUNC_DATEVALUE: /* D <- S */
 			if (checkStackErrors(1)) {
 				if (val_0.length() > 6) {
-					t.tm_mday = StringToInt(val_0.substr(3, 2));
-					t.tm_mon = StringToInt(val_0.substr(0, 2)) - 1;
-					t.tm_year = StringToInt(val_0.substr(6, 4));
+					t.tm_mday = StringToInt(val_0.getString().substr(3, 2));
+					t.tm_mon = StringToInt(val_0.getString().substr(0, 2)) - 1;
+					t.tm_year = StringToInt(val_0.getString().substr(6, 4));
 					if (t.tm_year >= 1970 && t.tm_year < 2038) {
 						t.tm_year -= 1900;
 					} else if (t.tm_year >= 0 && t.tm_year < 100) {
@@ -1130,9 +1130,9 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 				str_t = *--sp; /* str */
 				if (0 <= ((int)dbl_t) && ((unsigned int)dbl_t) < str_t.length() && 0 <= ((int)d)) {
 					if (((unsigned int)dbl_t) + ((unsigned int)d) <= str_t.length()) {
-						val_0 = str_t.substr(0, ((int)dbl_t)) + val_0 + str_t.substr(((int)dbl_t) + ((int)d));
+						val_0 = str_t.getString().substr(0, ((int)dbl_t)) + val_0.getString() + str_t.getString().substr(((int)dbl_t) + ((int)d));
 					} else {
-						val_0 = str_t.substr(0, ((int)dbl_t)) + val_0;
+						val_0 = str_t.getString().substr(0, ((int)dbl_t)) + val_0.getString();
 					}
 				} else {
 					val_0 = "";
@@ -1178,8 +1178,8 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 				str_t = *--sp; /* str */
 				if (!str_s.empty()) {
 					size_t i = 0;
-					while ((i = str_t.find(str_s, i)) != string::npos) {
-						str_t = str_t.substr(0, i) + val_0 + str_t.substr(i + str_s.size());
+					while ((i = str_t.getString().find(str_s.getString(), i)) != string::npos) {
+						str_t = str_t.getString().substr(0, i) + val_0.getString() + str_t.getString().substr(i + str_s.size());
 						i += val_0.size();
 					}
 				}
@@ -1189,10 +1189,10 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::FUNC_TRIM: { /* S <- S */
 			if (checkStackErrors(1)) {
-				size_t i = val_0.find_first_not_of(" \t\n\r");
-				size_t j = val_0.find_last_not_of(" \t\n\r");
+				size_t i = val_0.getString().find_first_not_of(" \t\n\r");
+				size_t j = val_0.getString().find_last_not_of(" \t\n\r");
 				if (i != std::string::npos) {
-					val_0 = val_0.substr(i, j - i + 1);
+					val_0 = val_0.getString().substr(i, j - i + 1);
 				} else {
 					val_0 = "";
 				}
@@ -1320,7 +1320,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 		case bytecode_generator::PALO_CUBEDIMENSION: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
 			CPCube acube;
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			} else {
@@ -1335,7 +1335,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 				if (val_0.empty()) {
 					val_0 = rule->cube->acube->getName();
 				}
-				if (!acube || acube->getName() != val_0) {
+				if (!acube || acube->getName() != val_0.getString()) {
 					acube = adb->lookupCubeByName(val_0, false);
 				} else if (!acube) {
 					acube = CONST_COMMITABLE_CAST(Cube, rule->cube->acube->shared_from_this());
@@ -1358,7 +1358,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_ECHILD: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1392,7 +1392,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_ECHILDCOUNT: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1420,7 +1420,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_ECOUNT: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1441,7 +1441,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_EFIRST: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1465,7 +1465,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_EINDENT: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1493,7 +1493,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_EINDEX: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1521,7 +1521,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_EISCHILD: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1563,7 +1563,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_ELEVEL: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1591,7 +1591,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_ENAME: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1618,7 +1618,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_ENEXT: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1655,7 +1655,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_EPARENT: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1689,7 +1689,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_EPARENTCOUNT: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1717,7 +1717,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_EPREV: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1755,7 +1755,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 		case bytecode_generator::PALO_ESIBLING:
 		{
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1856,7 +1856,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 		case bytecode_generator::PALO_EOFFSET:
 		{
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1902,7 +1902,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_ETOPLEVEL: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1923,7 +1923,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_ETYPE: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -1958,7 +1958,7 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 
 		case bytecode_generator::PALO_EWEIGHT: {
 			CPDatabase adb = CONST_COMMITABLE_CAST(Database, rule->cube->database->shared_from_this());
-			if (!val_0.empty() && adb->getName() != val_0) {
+			if (!val_0.empty() && adb->getName() != val_0.getString()) {
 				CPServer asrv = context->getServer();
 				adb = asrv->lookupDatabaseByName(val_0, false);
 			}
@@ -2000,4 +2000,223 @@ void virtual_machine::compute(EngineBase *engine, IdentifierType *path, ERule* s
 		}
 	}
 }
+
+vector_machine::vector_machine(RulesContext* mem_context, ERule* rule) :
+	m_mem_context(mem_context), rule(rule), stackDepth(0)
+{
+	if (!is_vectorizable(rule, stackDepth)) {
+		throw ErrorException(ErrorException::ERROR_INTERNAL, "rule cannot be computed in vector mode", rule->nr_rule);
+	}
+	columns.resize((stackDepth + 1) * BATCH_SIZE);
+	slots.resize(stackDepth);
+}
+
+bool vector_machine::is_vectorizable(const ERule* rule, size_t &stackDepth)
+{
+	if (!rule->bytecode) {
+		return false;
+	}
+	// simulate the stack pointer of virtual_machine, the value stack has to be balanced at HALT
+	size_t depth = 0;
+	stackDepth = 0;
+	for (uint32_t pos = 0; pos < rule->gc_bc_nr; pos++) {
+		switch (rule->bytecode[pos]) {
+		case bytecode_generator::NOP:
+			break;
+
+		case bytecode_generator::HALT:
+			return depth == 1;
+
+		case bytecode_generator::PUSH_DBL:
+			depth++;
+			break;
+
+		case bytecode_generator::PULL_DBL:
+			if (!depth) {
+				return false;
+			}
+			depth--;
+			break;
+
+		case bytecode_generator::SWAP_DBL:
+			if (!depth) {
+				return false;
+			}
+			break;
+
+		case bytecode_generator::LD_CONST_DBL:
+			pos++;
+			depth++;
+			break;
+
+		case bytecode_generator::LD_SRC_HIT_DBL:
+		case bytecode_generator::LD_SRC_DBL:
+			pos++;
+			if (pos >= rule->gc_bc_nr || rule->bytecode[pos] >= rule->gc_copy_nr || !rule->source_precalc[rule->bytecode[pos]]) {
+				return false;
+			}
+			depth++;
+			break;
+
+		case bytecode_generator::OP2_SUM_DBL:
+		case bytecode_generator::OP2_DIFF_DBL:
+		case bytecode_generator::OP2_PROD_DBL:
+		case bytecode_generator::OP2_QUO_DBL:
+			if (!depth) {
+				return false;
+			}
+			depth--;
+			break;
+
+		case bytecode_generator::OP1_ABS_DBL:
+		case bytecode_generator::OP1_CEILING_DBL:
+		case bytecode_generator::OP1_FLOOR_DBL:
+		case bytecode_generator::OP1_INT_DBL:
+		case bytecode_generator::OP1_TRUNC_DBL:
+		case bytecode_generator::OP1_SIGN_DBL:
+		case bytecode_generator::OP1_SQRT_DBL:
+			break;
+
+		default:
+			return false;
+		}
+		if (stackDepth < depth) {
+			stackDepth = depth;
+		}
+	}
+	return false;
+}
+
+void vector_machine::compute(size_t count, const double * const *sources, const IdentifierType * const *paths, double *results)
+{
+	m_mem_context->context->check();
+
+	if (rule->native) {
+		rule->native->compute(count, sources, rule->dbl_consts, results);
+	} else {
+		interpret(count, sources, results);
+	}
+
+	CPCube acube = CONST_COMMITABLE_CAST(Cube, rule->cube->acube->shared_from_this());
+	for (size_t n = 0; n < count; n++) {
+		m_mem_context->writeQueryCache(acube, paths[n], results[n], false);
+		rule->arule->increaseEvalCounter(results[n] == 0.0);
+	}
+}
+
+void vector_machine::interpret(size_t count, const double * const *sources, double *results)
+{
+	// the accumulator column plays the role of val_0, slots are the value stack
+	double *acc = &columns[0];
+	for (size_t slot = 0; slot < stackDepth; slot++) {
+		slots[slot] = &columns[(slot + 1) * BATCH_SIZE];
+	}
+	size_t sp = 0;
+	size_t n;
+	const Bytecode *pc = rule->bytecode;
+
+	while (1) {
+		switch (*pc++) {
+		case bytecode_generator::NOP:
+			break;
+
+		case bytecode_generator::HALT:
+			memcpy(results, acc, count * sizeof(double));
+			return;
+
+		case bytecode_generator::PUSH_DBL:
+			memcpy(slots[sp++], acc, count * sizeof(double));
+			break;
+
+		case bytecode_generator::PULL_DBL:
+			std::swap(acc, slots[--sp]);
+			break;
+
+		case bytecode_generator::SWAP_DBL:
+			std::swap(acc, slots[sp - 1]);
+			break;
+
+		case bytecode_generator::LD_CONST_DBL: {
+			std::swap(acc, slots[sp++]);
+			double d = rule->dbl_consts[*pc++];
+			std::fill(acc, acc + count, d);
+			break;
+		}
+
+		case bytecode_generator::LD_SRC_HIT_DBL:
+		case bytecode_generator::LD_SRC_DBL:
+			std::swap(acc, slots[sp++]);
+			memcpy(acc, sources[*pc++], count * sizeof(double));
+			break;
+
+		case bytecode_generator::OP2_SUM_DBL: {
+			const double *a = slots[--sp];
+			for (n = 0; n < count; n++) {
+				acc[n] = a[n] + acc[n];
+			}
+			break;
+		}
+
+		case bytecode_generator::OP2_DIFF_DBL: {
+			const double *a = slots[--sp];
+			for (n = 0; n < count; n++) {
+				acc[n] = a[n] - acc[n];
+			}
+			break;
+		}
+
+		case bytecode_generator::OP2_PROD_DBL: {
+			const double *a = slots[--sp];
+			for (n = 0; n < count; n++) {
+				acc[n] = a[n] * acc[n];
+			}
+			break;
+		}
+
+		case bytecode_generator::OP2_QUO_DBL: {
+			const double *a = slots[--sp];
+			for (n = 0; n < count; n++) {
+				acc[n] = acc[n] == 0 ? 0.0 : a[n] / acc[n];
+			}
+			break;
+		}
+
+		case bytecode_generator::OP1_ABS_DBL:
+			for (n = 0; n < count; n++) {
+				acc[n] = 0 <= acc[n] ? acc[n] : -acc[n];
+			}
+			break;
+
+		case bytecode_generator::OP1_CEILING_DBL:
+			for (n = 0; n < count; n++) {
+				acc[n] = ceil(acc[n]);
+			}
+			break;
+
+		case bytecode_generator::OP1_FLOOR_DBL:
+		case bytecode_generator::OP1_INT_DBL:
+		case bytecode_generator::OP1_TRUNC_DBL:
+			for (n = 0; n < count; n++) {
+				acc[n] = floor(acc[n]);
+			}
+			break;
+
+		case bytecode_generator::OP1_SIGN_DBL:
+			for (n = 0; n < count; n++) {
+				acc[n] = 0 < acc[n] ? 1.0 : (acc[n] < 0 ? -1.0 : 0.0);
+			}
+			break;
+
+		case bytecode_generator::OP1_SQRT_DBL:
+			for (n = 0; n < count; n++) {
+				acc[n] = 0.0 <= acc[n] ? sqrt(acc[n]) : 0.0;
+			}
+			break;
+
+		default:
+			throw ErrorException(ErrorException::ERROR_INTERNAL, "unsupported opcode in vector mode", rule->nr_rule);
+		}
+	}
+}
+
 }
@@ -330,6 +330,46 @@ public:
 	void setCache(VMCache *vmCache) {this->vmCache = vmCache;}
 	void setUser(PUser user) {this->user = user;}
 };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief vector mode of the rule virtual machine
+///
+/// Executes the bytecode of a purely numeric rule over a batch of cells at
+/// once. Every register of virtual_machine becomes a column of doubles and
+/// every source is read from a column prefetched by the caller from the
+/// precalculated source streams. Only straight-line programs consisting of
+/// numeric opcodes are accepted, everything else (jumps, strings, functions,
+/// CALL_DATA, CONTINUE, STET, not precalculated sources) has to be evaluated
+/// by virtual_machine cell by cell. If the rule program was compiled to
+/// native_code, the compiled function replaces the interpreter loop.
+////////////////////////////////////////////////////////////////////////////////
+class vector_machine {
+public:
+	static const size_t BATCH_SIZE = 1024;
+
+	vector_machine(RulesContext* mem_context, ERule* rule);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief checks if the program of the rule can be executed in vector mode
+	////////////////////////////////////////////////////////////////////////////////
+	static bool is_vectorizable(const ERule* rule, size_t &stackDepth);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief computes count cells, sources[i] holds count values of source i
+	///
+	/// paths are used for the query cache only, results receive count values
+	////////////////////////////////////////////////////////////////////////////////
+	void compute(size_t count, const double * const *sources, const IdentifierType * const *paths, double *results);
+
+private:
+	void interpret(size_t count, const double * const *sources, double *results);
+
+	RulesContext* m_mem_context;
+	ERule* rule;
+	size_t stackDepth;
+	vector<double> columns;
+	vector<double *> slots;
+};
 }
 
 #endif
@@ -41,7 +41,7 @@ using namespace paloLegacy;
 namespace palo {
 
 LegacyRule::LegacyRule(PEngineBase engine, CPPlanNode node) :
-		ProcessorBase(true, engine), engine(engine), isValidPath(false), node(node)
+		ProcessorBase(true, engine), engine(engine), isValidPath(false), batchCount(0), batchPos(0), node(node)
 {
 	Context *context = Context::getContext();
 	legacyRulePlanNode = dynamic_cast<const LegacyRulePlanNode *>(node.get());
@@ -56,6 +56,10 @@ LegacyRule::LegacyRule(PEngineBase engine, CPPlanNode node) :
 	erule = ecube->findRule(rule->getId());
 	if (erule && erule->arule) {
 		generateSources();
+		size_t stackDepth;
+		if (!globalError.isError() && vector_machine::is_vectorizable(erule, stackDepth)) {
+			vectorMachine.reset(new vector_machine(mem_context, erule));
+		}
 	} else {
 		stringstream msg;
 		msg << "rule " << rule->getId() << " not found in database " <<  db->getName() << ", cube " << cube->getName() << ", erule";
@@ -238,7 +242,29 @@ void LegacyRule::generateSources()
 	}
 }
 
-void LegacyRule::computeCell()
+void LegacyRule::moveSources(vector<CellValueStream *> &sourceStreamsCopy)
+{
+	size_t precalculatedSourcesCount = sourceStreamsSP.size();
+	sourceStreamsCopy.assign(precalculatedSourcesCount, 0);
+	for (uint32_t source = 0; source < precalculatedSourcesCount; source++) {
+		if (!sourceStreamsNext[source]) {
+			continue;
+		}
+		bool exactMatch = false;
+		sourceStreamsNext[source] = sourceStreams[source]->move(vkey, &exactMatch);
+		if (sourceStreamsNext[source]) {
+			// something found
+			if (exactMatch) {
+				sourceStreamsCopy[source] = sourceStreams[source];
+			}
+		} else {
+			sourceStreamsSP[source].reset();
+			sourceStreams[source] = 0;
+		}
+	}
+}
+
+void LegacyRule::computeCell(vector<CellValueStream *> *positionedSources)
 {
 
 	if (globalError.isError()) {
@@ -251,23 +277,11 @@ void LegacyRule::computeCell()
 		bool notFoundStatus = true;
 
 		// find sources
-		size_t precalculatedSourcesCount = sourceStreamsSP.size();
-		vector<CellValueStream *> sourceStreamsCopy(precalculatedSourcesCount, 0);
-		for (uint32_t source = 0; source < precalculatedSourcesCount; source++) {
-			if (!sourceStreamsNext[source]) {
-				continue;
-			}
-			bool exactMatch = false;
-			sourceStreamsNext[source] = sourceStreams[source]->move(vkey, &exactMatch);
-			if (sourceStreamsNext[source]) {
-				// something found
-				if (exactMatch) {
-					sourceStreamsCopy[source] = sourceStreams[source];
-				}
-			} else {
-				sourceStreamsSP[source].reset();
-				sourceStreams[source] = 0;
-			}
+		vector<CellValueStream *> sourceStreamsCopy;
+		if (positionedSources) {
+			sourceStreamsCopy.swap(*positionedSources);
+		} else {
+			moveSources(sourceStreamsCopy);
 		}
 
 		// apply the rule
@@ -295,8 +309,121 @@ void LegacyRule::computeCell()
 	value.setRuleId(erule->nr_rule);
 }
 
+bool LegacyRule::computeBatch()
+{
+	batchCount = 0;
+	batchPos = 0;
+	if (batchKeys.empty()) {
+		batchKeys.resize(vector_machine::BATCH_SIZE);
+		batchValues.resize(vector_machine::BATCH_SIZE);
+		batchSources.resize(erule->gc_copy_nr);
+		for (uint32_t source = 0; source < erule->gc_copy_nr; source++) {
+			if (erule->source_precalc[source]) {
+				batchSources[source].resize(vector_machine::BATCH_SIZE);
+			}
+		}
+	}
+
+	// read the sources of the next cells, cells with non-numeric sources are computed by the scalar machine
+	vector<size_t> lanes;
+	lanes.reserve(vector_machine::BATCH_SIZE);
+	vector<CellValueStream *> sourceStreamsCopy;
+	while (batchCount < vector_machine::BATCH_SIZE) {
+		if (isValidPath) {
+			++path;
+		} else {
+			path = area->pathBegin();
+			isValidPath = true;
+		}
+		if (path == area->pathEnd()) {
+			break;
+		}
+		vkey = *path;
+		size_t lane = lanes.size();
+		bool numeric = true;
+		try {
+			moveSources(sourceStreamsCopy);
+			for (uint32_t source = 0; source < erule->gc_copy_nr; source++) {
+				if (!erule->source_precalc[source]) {
+					continue;
+				}
+				if (sourceStreamsCopy[source]) {
+					const CellValue &sourceValue = sourceStreamsCopy[source]->getValue();
+					if (sourceValue.isError() || sourceValue.isString()) {
+						numeric = false;
+						break;
+					}
+					batchSources[source][lane] = sourceValue.getNumeric();
+				} else {
+					batchSources[source][lane] = 0.0;
+				}
+			}
+		} catch (ErrorException& e) {
+			if (e.getErrorType() == ErrorException::ERROR_STOPPED_BY_ADMIN) {
+				throw e;
+			}
+			value = CellValue(e.getErrorType());
+			value.setRuleId(erule->nr_rule);
+			batchValues[batchCount] = value;
+			batchKeys[batchCount++] = vkey;
+			continue;
+		}
+		if (numeric) {
+			lanes.push_back(batchCount);
+		} else {
+			computeCell(&sourceStreamsCopy);
+			batchValues[batchCount] = value;
+		}
+		batchKeys[batchCount++] = vkey;
+	}
+
+	if (!lanes.empty()) {
+		vector<const double *> sources(erule->gc_copy_nr, (const double *)0);
+		for (uint32_t source = 0; source < erule->gc_copy_nr; source++) {
+			if (erule->source_precalc[source]) {
+				sources[source] = &batchSources[source][0];
+			}
+		}
+		vector<const IdentifierType *> paths(lanes.size());
+		for (size_t lane = 0; lane < lanes.size(); lane++) {
+			paths[lane] = &batchKeys[lanes[lane]][0];
+		}
+		vector<double> results(lanes.size());
+		vectorMachine->compute(lanes.size(), &sources[0], &paths[0], &results[0]);
+		for (size_t lane = 0; lane < lanes.size(); lane++) {
+			CellValue &result = batchValues[lanes[lane]];
+			result = results[lane];
+			if (result.isEmpty() && generateEmptyResults) {
+				result = *legacyRulePlanNode->getDefaultValue();
+			}
+			result.setRuleId(erule->nr_rule);
+		}
+	}
+	return batchCount != 0;
+}
+
+bool LegacyRule::nextBatch()
+{
+	for (;;) {
+		while (batchPos < batchCount) {
+			size_t lane = batchPos++;
+			if (generateEmptyResults || !batchValues[lane].isEmpty()) {
+				vkey = batchKeys[lane];
+				value = batchValues[lane];
+				return true;
+			}
+		}
+		if (!computeBatch()) {
+			return false;
+		}
+	}
+}
+
 bool LegacyRule::next()
 {
+	if (vectorMachine) {
+		return nextBatch();
+	}
 	for (;;) {
 		if (isValidPath) {
 			++path;
@@ -349,6 +476,8 @@ const GpuBinPath &LegacyRule::getBinKey() const
 void LegacyRule::reset()
 {
 	isValidPath = false;
+	batchCount = 0;
+	batchPos = 0;
 	vkey.clear();
 	for (size_t src = 0; src < sourceStreams.size(); ++src) {
 		if(sourceStreams[src]) {
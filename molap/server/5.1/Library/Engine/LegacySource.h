@@ -35,6 +35,8 @@
 #include "Engine/Legacy/Engine.h"
 #include "Engine/Legacy/VirtualMachine.h"
 
+#include <boost/scoped_ptr.hpp>
+
 using namespace paloLegacy;
 
 namespace paloLegacy {
@@ -73,14 +75,25 @@ private:
 	vector<ProcessorBase *> sourceStreams;
 	vector<bool> sourceStreamsNext;
 	VMCache vmCache;
+
+	// vector mode
+	boost::scoped_ptr<vector_machine> vectorMachine;
+	vector<IdentifiersType> batchKeys;
+	vector<CellValue> batchValues;
+	vector<vector<double> > batchSources;
+	size_t batchCount;
+	size_t batchPos;
 private:
 	// Engine
 	RulesContext *mem_context;
 	ERule *erule;
 	bool generateEmptyResults;
 	void generateSources();
+	void moveSources(vector<CellValueStream *> &sourceStreamsCopy);
+	bool nextBatch();
+	bool computeBatch();
 protected:
-	void computeCell();
+	void computeCell(vector<CellValueStream *> *positionedSources = 0);
 	IdentifiersType vkey;
 	CellValue value;
 	CPPlanNode node;
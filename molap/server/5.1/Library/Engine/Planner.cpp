@@ -27,6 +27,7 @@
  *
  */
 
+#include "Olap/Context.h"
 #include "Olap/Server.h"
 #include "Olap/SubCubeList.h"
 #include "Olap/Rule.h"
@@ -37,6 +38,7 @@
 #include "Parser/FunctionNodeSimple.h"
 
 #include "Engine/Planner.h"
+#include "InputOutput/Metrics.h"
 
 namespace palo {
 
@@ -336,6 +338,71 @@ PPlanNode Planner::createRulePlan(CPCubeArea area, CPRule rule, double &constRes
 //	return result;
 }
 
+PPlanNode Planner::createRestrictedRulePlan(CPCubeArea area, CPRule rule, const Area *restrictedArea)
+{
+	PCubeArea exprArea;
+	SubCubeList stetAreas;
+	vector<PPlanNode> nodes;
+
+	area->intersection(*restrictedArea, &exprArea, &stetAreas);
+	if (exprArea) {
+		Node *exprNode = rule->restrictedRule.get();
+		Variability varDimensions;
+		if (!exprNode->isPlanCompatible(exprArea, varDimensions)) {
+			return PPlanNode();
+		}
+		double constResult = 0;
+		bool valid;
+		PPlanNode node = createRulePlan(exprArea, rule, constResult, valid, exprNode);
+		if (!node || !valid) {
+			return PPlanNode();
+		}
+		nodes.push_back(node);
+	}
+	for (SubCubeList::const_iterator it = stetAreas.begin(); it != stetAreas.end(); ++it) {
+		// STET - values of the cells without this rule
+		Planner planner(cube, PCubeArea(new CubeArea(*it->second)), this);
+		planner.setCurrentRule(rule);
+		PPlanNode node = planner.createPlan(CubeArea::ALL, RulesType(INDIRECT_RULES | NO_RULE_IDS), true, UNLIMITED_SORTED_PLAN);
+		if (node) {
+			nodes.push_back(node);
+		}
+	}
+
+	if (nodes.empty()) {
+		return PPlanNode();
+	} else if (nodes.size() == 1) {
+		return nodes[0];
+	} else {
+		return PPlanNode(new UnionPlanNode(area, nodes, NO_IDENTIFIER));
+	}
+}
+
+void Planner::addDependence(PStorageCpu cacheStorage)
+{
+	Planner *rootPlanner = getRootPlanner();
+	if (rootPlanner->cube == cube) {
+		return;
+	}
+	dbID_cubeID id(area->getDatabase()->getId(), cube->getId());
+	PlanCache::Dependences &dependences = rootPlanner->dependences;
+	for (PlanCache::Dependences::const_iterator it = dependences.begin(); it != dependences.end(); ++it) {
+		if (it->id == id) {
+			return;
+		}
+	}
+	if (!cacheStorage) {
+		// the snapshot is compared even if this sub-plan doesn't read it
+		ValueCache::PCachedAreas cachedAreas;
+		cube->getCache()->getAreasAndStorage(cacheStorage, cachedAreas);
+	}
+	PlanCache::Dependence dependence;
+	dependence.id = id;
+	dependence.cube = cube;
+	dependence.cacheStorage = cacheStorage;
+	dependences.push_back(dependence);
+}
+
 size_t Planner::saveNode(PPlanNode node)
 {
 	Planner *rootPlanner = getRootPlanner();
@@ -370,9 +437,16 @@ void Planner::createRuleNodes(vector<PPlanNode> &nodes, RulesAreas &rulesAreas,
 				(!outerDefaultValue || !outerDefaultValue->isString())) {
 				// try to build a rule plan, use LegacyRule if building fails
 				Variability varDimensions;
-				bool simpleRule = rule ? rule->isSimpleRule(ruleArea->second, varDimensions) : false;
+				const Area *restrictedArea = rule && !rule->hasMarkers() ? rule->getRestrictedArea(ruleArea->second->getDatabase()) : 0;
+				bool simpleRule = rule && !restrictedArea ? rule->isSimpleRule(ruleArea->second, varDimensions) : false;
 
-				if (simpleRule /* && !varDimensions.empty() */) {
+				if (restrictedArea) {
+					// IF(restriction, expression, STET()) - expression and STET parts are planned separately
+					rulePlanNode = createRestrictedRulePlan(ruleArea->second, rule, restrictedArea);
+					if (rulePlanNode && (completeRuleId || ruleDefaultValue)) {
+						rulePlanNode = PPlanNode(new CompletePlanNode(ruleArea->second, rulePlanNode, ruleDefaultValue, completeRuleId ? rule->getId() : NO_RULE));
+					}
+				} else if (simpleRule /* && !varDimensions.empty() */) {
 					double constResult = 0;
 					bool valid;
 					// try to build the plan here, insert it into nodes and continue the loop
@@ -448,6 +522,7 @@ PPlanNode Planner::createPlan(CubeArea::CellType cellType, RulesType useRulesTyp
 	if (useCache) {
 		cube->getCache()->getAreasAndStorage(cacheStorage, cachedArs);
 	}
+	addDependence(cacheStorage);
 
 	if (CubeArea::baseOnly(cellType) && calcRules == NO_RULES && skipEmpty) {
 		// No Rules just base values - filter whole area
@@ -581,6 +656,9 @@ PPlanNode Planner::createPlan(CubeArea::CellType cellType, RulesType useRulesTyp
 				planNodes.push_back(aggregationNode);
 			}
 		}
+		if (useCache && (anyConsolidation || anyDirectRules)) {
+			Metrics::count(anyCached || anyQueryCached ? Metrics::VALUE_CACHE_HIT : Metrics::VALUE_CACHE_MISS);
+		}
 		if (anyDirectRules) {
 			bool completeRuleId = !(useRulesType & NO_RULE_IDS); // processors will generate ruleId if not disabled explicitly
 			createRuleNodes(planNodes, numericConsRulesAreas, defaultNumValue, completeRuleId, false);
@@ -644,4 +722,90 @@ PPlanNode Planner::createPlan(CubeArea::CellType cellType, RulesType useRulesTyp
 	}
 }
 
+// estimated cost of a cell calculated by a rule relative to a cell read from a storage
+static const double RULE_CELL_COST = 10.0;
+
+// subtrees cheaper than this are not worth a thread
+static const double EXCHANGE_MIN_COST = 100000.0;
+
+static double storageCells(PEngineBase engine, IdentifierType storageId, double areaSize)
+{
+	PStorageBase storage = engine ? engine->getStorage(storageId) : PStorageBase();
+	return storage ? min(areaSize, (double)storage->valuesCount()) : areaSize;
+}
+
+void Planner::markExchanges(PPlanNode plan)
+{
+	PServer server = Context::getContext()->getServer();
+	if (plan && server) {
+		map<const PlanNode *, double> visited;
+		markSubtree(plan, server->getEngine(EngineBase::CPU), visited);
+	}
+}
+
+double Planner::markSubtree(PPlanNode node, PEngineBase engine, map<const PlanNode *, double> &visited)
+{
+	if (!node) {
+		return 0;
+	}
+	// shared subtrees are costed and marked once
+	map<const PlanNode *, double>::const_iterator vit = visited.find(node.get());
+	if (vit != visited.end()) {
+		return vit->second;
+	}
+	const vector<PPlanNode> &children = node->getChildren();
+	vector<double> costs(children.size());
+	double cost = 0;
+	for (size_t i = 0; i < children.size(); i++) {
+		costs[i] = markSubtree(children[i], engine, visited);
+		cost += costs[i];
+	}
+	double areaSize = node->getArea() ? node->getArea()->getSize() : 0;
+
+	switch (node->getType()) {
+	case SOURCE:
+		cost += storageCells(engine, static_cast<const SourcePlanNode *>(node.get())->getStorageId(), areaSize);
+		break;
+	case LEGACY_RULE: {
+		const LegacyRulePlanNode *ruleNode = dynamic_cast<const LegacyRulePlanNode *>(node.get());
+		double cells = areaSize;
+		if (ruleNode && ruleNode->useMarkers()) {
+			// only the marked cells are calculated
+			cells = storageCells(engine, ruleNode->getCube()->getMarkerStorageId(), areaSize);
+		}
+		cost += cells * RULE_CELL_COST;
+		break;
+	}
+	case UNION:
+	case AGGREGATION:
+	case ADDITION:
+	case SUBTRACTION:
+	case MULTIPLICATION:
+	case DIVISION: {
+		size_t expensive = 0;
+		size_t mostExpensive = 0;
+		for (size_t i = 0; i < children.size(); i++) {
+			if (costs[i] >= EXCHANGE_MIN_COST) {
+				expensive++;
+			}
+			if (costs[i] > costs[mostExpensive]) {
+				mostExpensive = i;
+			}
+		}
+		if (expensive > 1) {
+			for (size_t i = 0; i < children.size(); i++) {
+				if (i != mostExpensive && costs[i] >= EXCHANGE_MIN_COST && !(node->getType() == AGGREGATION && children[i]->getType() == SOURCE)) {
+					children[i]->setExchange(true);
+				}
+			}
+		}
+		break;
+	}
+	default:
+		break;
+	}
+	visited[node.get()] = cost;
+	return cost;
+}
+
 }
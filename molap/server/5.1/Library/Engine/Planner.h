@@ -32,6 +32,7 @@
 
 #include "palo.h"
 #include "Parser/RuleNode.h"
+#include "Olap/PlanCache.h"
 
 namespace palo {
 
@@ -46,11 +47,31 @@ public:
 	bool extractRules(SubCubeList &areas, RuleNode::RuleOption ruleType, RulesAreas *rulesAreas, RulesAreas *markedRulesAreas);
 	void setContinueRule(CPRule rule) {continueRule = rule;}
 	void setCurrentRule(CPRule rule) {currentRule = rule;}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief other cubes read by the plan, filled in the root planner
+	////////////////////////////////////////////////////////////////////////////////
+
+	const PlanCache::Dependences &getDependences() const {return dependences;}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief marks the subtrees evaluated on threads of the pool
+	///
+	/// Children of unions, aggregations and arithmetic nodes are marked if at
+	/// least two siblings are expensive, the most expensive one is left to the
+	/// requesting thread. Source children of aggregations are not marked, they
+	/// are aggregated in parallel by the engine already.
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void markExchanges(PPlanNode plan);
 private:
+	static double markSubtree(PPlanNode node, PEngineBase engine, map<const PlanNode *, double> &visited);
+	void addDependence(PStorageCpu cacheStorage);
 	bool extractCached(SubCubeList &areas, RulesAreas &cached, const ValueCache::CPCachedAreas &cache, IdentifierType ruleIdFilter);
 	bool extractQueryCached(SubCubeList &areas, RulesAreas &cached, IdentifierType ruleIdFilter);
     void extractAreas(SubCubeList &areas, SubCubeList &inputAreas, bool &result, RulesAreas &cached, IdentifierType ruleId);
 	PPlanNode createRulePlan(CPCubeArea area, CPRule rule, double &constResult, bool &supported, Node *node = 0);
+	PPlanNode createRestrictedRulePlan(CPCubeArea area, CPRule rule, const Area *restrictedArea);
 	size_t saveNode(PPlanNode node);
 	PPlanNode checkInfiniteRecursion();
 private:
@@ -70,6 +91,7 @@ private:
 	vector<PRule> activeRules;
 	CPRule continueRule;
 	CPRule currentRule;
+	PlanCache::Dependences dependences;
 };
 
 }
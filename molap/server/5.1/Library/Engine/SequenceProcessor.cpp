@@ -32,6 +32,7 @@ namespace palo {
 
 SequenceProcessor::SequenceProcessor(PEngineBase engine, CPPlanNode node) : ProcessorBase(false, engine), engine(engine), children(node->getChildren()), currentStream(0), moveToNext(true), index(-1), pathTranslator(node->getArea()->getPathTranslator())
 {
+	prefetchProcessors(children, false, prefetched);
 }
 
 bool SequenceProcessor::next()
@@ -43,7 +44,12 @@ bool SequenceProcessor::next()
 			pStream.reset();
 			if (index + 1 < (int)children.size()) {
 				++index;
-				pStream = createProcessor(children[index], false);
+				if (prefetched[index]) {
+					pStream = prefetched[index];
+					prefetched[index].reset();
+				} else {
+					pStream = createProcessor(children[index], false);
+				}
 				currentStream = pStream.get();
 			} else {
 				return false;
@@ -52,6 +52,7 @@ public:
 private:
 	PEngineBase engine;
 	const vector<PPlanNode> children;
+	vector<PProcessorBase> prefetched;
 	PCellStream pStream;
 	CellValueStream *currentStream;
 	bool moveToNext;
@@ -81,7 +81,7 @@ static const int VALUE_SIZE[] = {0,1,4,8,4};
 
 StorageCpu::StorageCpu(PPathTranslator pathTranslator, bool indexEnabled) :
 	StorageBase(pathTranslator), valCount(0), emptySpace(0), index2(indexEnabled ? new vector<Bookmark> : 0),
-	delCount(0), indexEnabled(indexEnabled), pageList(new SlimVector<uint8_t>(STORAGE_PAGE_SIZE))
+	delCount(0), collectDeleted(false), indexEnabled(indexEnabled), pageList(new SlimVector<uint8_t>(STORAGE_PAGE_SIZE))
 {
 	if (!pINSTR) {
 		pINSTR = new INSTR[256];
@@ -98,7 +98,7 @@ StorageCpu::StorageCpu(PPathTranslator pathTranslator, bool indexEnabled) :
 
 StorageCpu::StorageCpu(const StorageCpu &storage) :
 	StorageBase(storage), endStack(storage.endStack), valCount(storage.valCount), emptySpace(storage.emptySpace), index2(storage.index2),
-	delCount(0), longJumps(storage.longJumps), indexEnabled(storage.indexEnabled), changedCells(storage.changedCells), changeNodes(storage.changeNodes), pageList(storage.pageList)
+	delCount(0), collectDeleted(storage.collectDeleted), longJumps(storage.longJumps), indexEnabled(storage.indexEnabled), changedCells(storage.changedCells), changeNodes(storage.changeNodes), pageList(storage.pageList)
 {
 }
 
@@ -445,6 +445,19 @@ void StorageCpu::setCellValue(const IdentifiersType &key, const CellValue &val)
 	changedCells->set(key, convertToDouble(val));
 }
 
+void StorageCpu::setNumericValue(const IdentifiersType &key, double value, bool add)
+{
+	checkCheckedOut();
+	if (!changedCells) {
+		changedCells = CreateDoubleCellMap(key.size());
+	}
+	if (add) {
+		changedCells->add(key, value);
+	} else {
+		changedCells->set(key, value);
+	}
+}
+
 void StorageCpu::setCellValue(CPArea area, const CellValue &value, OperationType opType)
 {
 	if (value.isString()) {
@@ -660,6 +673,7 @@ PStorageBase StorageCpuCommitWorker::mergeParts(PStorageBase s1SP, PStorageBase
 	}
 	s1->valCount = newCount;
 	s1->delCount += s2->delCount;
+	s1->deleted.add(s2->deleted);
 
 	return s1SP;
 }
@@ -848,6 +862,9 @@ PStorageBase StorageCpuCommitWorker::mergeSegment(bool additive, PProcessorBase
 				} else {
 					if (diffValue) {
 						mergedSegment->delCount++;
+						if (segmentReader->storage.collectDeleted) {
+							mergedSegment->deleted.add(key);
+						}
 					}
 					--valsDiff;
 				}
@@ -859,6 +876,9 @@ PStorageBase StorageCpuCommitWorker::mergeSegment(bool additive, PProcessorBase
 				} else {
 					if (diffValue) {
 						mergedSegment->delCount++;
+						if (segmentReader->storage.collectDeleted) {
+							mergedSegment->deleted.add(key);
+						}
 					}
 				}
 				if (lockedChanges) {
@@ -1189,6 +1209,7 @@ PCellStream StorageCpu::commitExternalChanges(bool checkLocks, PProcessorBase ch
 			}
 			longJumps.swap(mergedStorage->longJumps);
 			delCount = mergedStorage->delCount;
+			deleted.add(mergedStorage->deleted);
 			if (Logger::isDebug() && longJumps.size()) {
 				Logger::debug << "Merged jumps: " << longJumps << endl;
 			}
@@ -4145,4 +4166,11 @@ uint64_t StorageCpu::getLastDeletionCount()
 	return d;
 }
 
+DeletedCells StorageCpu::getLastDeletedCells()
+{
+	DeletedCells d = deleted;
+	deleted.clear();
+	return d;
+}
+
 }
@@ -248,6 +248,21 @@ public:
 	virtual bool setCellValue(PPlanNode plan, PEngineBase engine);
     virtual void setCellValue(CPPlanNode plan, PEngineBase engine, CPArea area, const CellValue &value, OperationType opType){}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sets or adds one numeric base cell without creating an area
+	///
+	/// Used by bulk writes, the changes are sorted and merged into the pages
+	/// in one pass by commitChanges.
+	////////////////////////////////////////////////////////////////////////////////
+	void setNumericValue(const IdentifiersType &key, double value, bool add);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief replaces one base cell of any storage type without creating an area
+	////////////////////////////////////////////////////////////////////////////////
+	void replaceCellValue(const IdentifiersType &key, const CellValue &value) {
+		setCellValue(key, value);
+	}
+
 	virtual PCellStream commitChanges(bool checkLocks, bool add, bool disjunctive);
 	PCellStream commitExternalChanges(bool checkLocks, PProcessorBase changes, size_t valuesCount, bool add);
 	size_t valuesCount() const {
@@ -255,6 +270,18 @@ public:
 	}
 	uint64_t getLastDeletionCount();
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the cells deleted by the commits since the last call
+	////////////////////////////////////////////////////////////////////////////////
+	DeletedCells getLastDeletedCells();
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief enables recording of the cells deleted by commits
+	////////////////////////////////////////////////////////////////////////////////
+	void setCollectDeleted(bool collect) {
+		collectDeleted = collect;
+	}
+
 	// Commitable
 	bool merge(const CPCommitable &o, const PCommitable &p);
 	PCommitable copy() const;
@@ -307,6 +334,8 @@ private:
 	boost::shared_ptr<vector<Bookmark> > index2;
 
 	uint64_t delCount;
+	DeletedCells deleted;
+	bool collectDeleted;
 	const static size_t LONG_JUMP_START_VALUE = 4000000000ul; // 1; //80000000000ul; //16 * 1024;
 	vector<size_t> longJumps;
 protected:
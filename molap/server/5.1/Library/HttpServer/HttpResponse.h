@@ -149,6 +149,14 @@ public:
 		return clientData;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the response code
+	////////////////////////////////////////////////////////////////////////////////
+
+	HttpResponseCode getResponseCode() const {
+		return code;
+	}
+
     ////////////////////////////////////////////////////////////////////////////////
     /// @brief sets additional header fields and values
     ////////////////////////////////////////////////////////////////////////////////
@@ -186,6 +186,11 @@ HttpRequest* HttpServer::createHttpRequest(const string& path)
 }
 
 void HttpServer::handleRequest(HttpServerTask* task, HttpRequest* request)
+{
+	task->handleJobRequest(createJobRequest(task, request));
+}
+
+HttpJobRequest *HttpServer::createJobRequest(HttpServerTask* task, HttpRequest* request)
 {
 	HttpJobRequest * jobRequest = 0;
 
@@ -205,7 +210,7 @@ void HttpServer::handleRequest(HttpServerTask* task, HttpRequest* request)
 		jobRequest = handleException(e, request);
 	}
 
-	task->handleJobRequest(jobRequest);
+	return jobRequest;
 }
 
 HttpJobRequest *HttpServer::handleException(const ErrorException& e, HttpRequest* request)
@@ -112,6 +112,15 @@ public:
 	////////////////////////////////////////////////////////////////////////////////
 
 	void handleRequest(HttpServerTask*, HttpRequest*);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief converts a client request into a job request
+	///
+	/// Errors are converted into a job request carrying the error response.
+	////////////////////////////////////////////////////////////////////////////////
+
+	HttpJobRequest *createJobRequest(HttpServerTask*, HttpRequest*);
+
 	HttpJobRequest *handleException(const ErrorException& e, HttpRequest* request);
 
 public:
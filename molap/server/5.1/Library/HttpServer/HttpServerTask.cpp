@@ -39,6 +39,9 @@
 #include "PaloHttpServer/PaloSSORequestHandler.h"
 #include "Logger/Logger.h"
 #include "Dispatcher/Job.h"
+#include "Olap/Context.h"
+#include "Olap/Server.h"
+#include "Thread/ThreadPool.h"
 
 #ifdef ENABLE_TEST_MODE
 	#include "Timer/PTS_Timer.h"
@@ -47,15 +50,40 @@
 
 namespace palo {
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes an initialized read job of a pipeline in the thread pool
+////////////////////////////////////////////////////////////////////////////////
+
+class PipelinedReadJob : public ThreadPoolJob {
+public:
+	PipelinedReadJob(ThreadPool::ThreadGroup &tg, Job *job, HttpJobRequest *jobRequest, PServer server) :
+		ThreadPoolJob(tg), job(job), jobRequest(jobRequest), server(server) {
+	}
+
+	virtual void operator()() {
+		Context::getContext()->setServer(server);
+		job->attachThread();
+		job->work();
+		jobRequest->handleDone(job);
+		job->cleanup();
+	}
+
+private:
+	Job *job;
+	HttpJobRequest *jobRequest;
+	PServer server;
+};
+
 // /////////////////////////////////////////////////////////////////////////////
 // constructors and destructors
 // /////////////////////////////////////////////////////////////////////////////
 
 HttpServerTask::HttpServerTask(socket_t fd, HttpServer* server, JobAnalyser* analyzer) :
-	IoTask(fd, fd), ReadWriteTask(fd, fd), analyzer(analyzer), server(server), readPosition(0), bodyPosition(0), bodyLength(0), work(false), bShutdown(false)
+	IoTask(fd, fd), ReadWriteTask(fd, fd), analyzer(analyzer), server(server), requestStart(0), readPosition(0), bodyPosition(0), bodyLength(0), work(false), bShutdown(false)
 {
 	httpRequestPending = false;
 	httpRequest = 0;
+	parsedRequest = 0;
 	readRequestBody = false;
 	httpJobRequest = 0;
 }
@@ -71,6 +99,10 @@ HttpServerTask::~HttpServerTask()
 		delete httpRequest;
 	}
 
+	if (parsedRequest != 0) {
+		delete parsedRequest;
+	}
+
 	writeBuffers.clear();
 }
 
@@ -122,6 +154,81 @@ void HttpServerTask::handleJobRequest(HttpJobRequest* jobRequest)
 	handleDone();
 }
 
+void HttpServerTask::executeRequests(vector<HttpJobRequest*>& jobRequests, vector<HttpResponse*>& responses)
+{
+	PThreadPool tp = Context::getContext()->getServer()->getThreadPool();
+	ThreadPool::ThreadGroup tg;
+	bool readJobsRunning = false;
+	PServer snapshot;
+
+	for (vector<HttpJobRequest*>::iterator i = jobRequests.begin(); i != jobRequests.end(); ++i) {
+		HttpJobRequest* jobRequest = *i;
+
+		if (jobRequest->isDone()) {
+			continue;
+		}
+
+		Job* job = analyzer->analyse(jobRequest);
+		job->setTask(this);
+
+		// all read jobs between two write jobs see the same server
+		if (!snapshot) {
+			snapshot = Server::getInstance(false);
+		}
+		Context::getContext()->setServer(snapshot);
+
+		bool initialized = job->initialize();
+
+		if (initialized && job->getType() == READ_JOB) {
+			if (!readJobsRunning) {
+				tg = tp->createThreadGroup();
+				readJobsRunning = true;
+			}
+
+			boost::shared_ptr<PipelinedReadJob> readJob(new PipelinedReadJob(tg, job, jobRequest, snapshot));
+
+			if (tp->hasFreeCore(false)) {
+				tp->addJob(readJob);
+			} else {
+				(*readJob)();
+			}
+			continue;
+		}
+
+		if (initialized) {
+			if (readJobsRunning) {
+				tp->join(tg, false);
+				readJobsRunning = false;
+			}
+			snapshot.reset();
+
+			job->work();
+		}
+
+		jobRequest->handleDone(job);
+		bShutdown = bShutdown || job->getShutdown();
+
+		job->cleanup();
+	}
+
+	if (readJobsRunning) {
+		tp->join(tg, false);
+	}
+
+	for (vector<HttpJobRequest*>::iterator i = jobRequests.begin(); i != jobRequests.end(); ++i) {
+		HttpResponse* response = (*i)->getResponse();
+
+		if (response == 0) {
+			response = new HttpResponse(HttpResponse::NO_RESPONSE);
+		}
+
+		responses.push_back(response);
+		delete *i;
+	}
+
+	jobRequests.clear();
+}
+
 // /////////////////////////////////////////////////////////////////////////////
 // IoTask
 // /////////////////////////////////////////////////////////////////////////////
@@ -194,28 +301,7 @@ void HttpServerTask::handleDone()
 		response = new HttpResponse(HttpResponse::NO_RESPONSE);
 	}
 
-	// trace
-#ifdef ENABLE_TRACE_OPTION
-	{
-		string requestString = "";
-
-		if (httpRequest != 0) {
-			requestString = httpRequest->getHeaderString();
-
-			const string bs = httpRequest->getBodyString();
-
-			if (!bs.empty()) {
-				if (requestString.find("?") == string::npos) {
-					requestString += "?";
-				}
-
-				requestString += bs;
-			}
-		}
-
-		server->traceRequest(requestString + response->getBody().c_str());
-	}
-#endif
+	traceResponse(httpRequest, response);
 
 	// add response to output buffer
 	addResponse(response);
@@ -235,12 +321,6 @@ void HttpServerTask::handleDone()
 	}
 
 	httpRequestPending = false;
-
-	// remove body from read buffer and reset read position
-	readBuffer.erase_front(bodyPosition + bodyLength);
-	readPosition = 0;
-	bodyPosition = 0;
-	bodyLength = 0;
 }
 
 // /////////////////////////////////////////////////////////////////////////////
@@ -249,8 +329,8 @@ void HttpServerTask::handleDone()
 
 string HttpServerTask::extractRequestPath()
 {
-	const char* begin = readBuffer.c_str();
-	const char* end = begin + readPosition;
+	const char* begin = readBuffer.c_str() + requestStart;
+	const char* end = readBuffer.c_str() + readPosition;
 
 	for (; begin < end && *begin != ' '; ++begin) {
 	}
@@ -269,85 +349,128 @@ string HttpServerTask::extractRequestPath()
 	return string(begin, reqe);
 }
 
-bool HttpServerTask::processRead()
+HttpServerTask::ParseResult HttpServerTask::parseRequest()
 {
-	if (httpRequestPending) {
-		return true;
-	}
-
-	bool handleRequest = false;
+	if (!readRequestBody) {
+		const char * ptr = readBuffer.c_str() + readPosition;
+		const char * end = readBuffer.end() - 3;
 
-	try {
-		if (!readRequestBody) {
-			const char * ptr = readBuffer.c_str() + readPosition;
-			const char * end = readBuffer.end() - 3;
+		for (; ptr < end; ptr++) {
+			if (ptr[0] == '\r' && ptr[1] == '\n' && ptr[2] == '\r' && ptr[3] == '\n') {
+				break;
+			}
+		}
 
-			for (; ptr < end; ptr++) {
-				if (ptr[0] == '\r' && ptr[1] == '\n' && ptr[2] == '\r' && ptr[3] == '\n') {
-					break;
-				}
+		if (ptr >= end) {
+			if (readBuffer.c_str() + readPosition < end) {
+				readPosition = end - readBuffer.c_str();
 			}
+			return REQUEST_INCOMPLETE;
+		}
 
-			if (ptr < end) {
-				readPosition = ptr - readBuffer.c_str() + 4;
-				string url = extractRequestPath();
-				httpRequest = server->createHttpRequest(url);
-				httpRequest->extractHeader(readBuffer.str(), readBuffer.str() + readPosition);
-				bodyPosition = readPosition;
-
-				switch (httpRequest->getRequestType()) {
-				case HttpRequest::HTTP_REQUEST_GET:
-					handleRequest = true;
-					break;
-
-				case HttpRequest::HTTP_REQUEST_POST:
-					bodyLength = httpRequest->getContentLength();
-
-					if (bodyLength > 0) {
-						readRequestBody = true;
-					} else {
-						handleRequest = true;
-					}
-					break;
-
-				default:
-					Logger::warning << "got corrupted HTTP request" << endl;
-					//handleHangup();
-					//handleRequest = true;
-					return false;
-				}
+		readPosition = ptr - readBuffer.c_str() + 4;
+		string url = extractRequestPath();
+		parsedRequest = server->createHttpRequest(url);
+		bodyPosition = readPosition;
+		bodyLength = 0;
+		parsedRequest->extractHeader(readBuffer.str() + requestStart, readBuffer.str() + readPosition);
 
-			} else {
-				if (readBuffer.c_str() < end) {
-					readPosition = end - readBuffer.c_str();
-				}
+		switch (parsedRequest->getRequestType()) {
+		case HttpRequest::HTTP_REQUEST_GET:
+			return REQUEST_COMPLETE;
+
+		case HttpRequest::HTTP_REQUEST_POST:
+			bodyLength = parsedRequest->getContentLength();
+
+			if (bodyLength == 0) {
+				return REQUEST_COMPLETE;
 			}
+			readRequestBody = true;
+			break;
+
+		default:
+			Logger::warning << "got corrupted HTTP request" << endl;
+			return REQUEST_CORRUPTED;
 		}
+	}
 
-		// readRequestBody might have changed, so cannot use else
-		if (readRequestBody) {
-			if (readBuffer.length() - bodyPosition < bodyLength) {
-				return true;
-			}
+	if (readBuffer.length() - bodyPosition < bodyLength) {
+		return REQUEST_INCOMPLETE;
+	}
 
-			// read "bodyLength" from read buffer and add this body to "httpRequest"
-			httpRequest->extractBody(readBuffer.str() + bodyPosition, readBuffer.str() + bodyPosition + bodyLength);
+	// read "bodyLength" from read buffer and add this body to "parsedRequest"
+	readRequestBody = false;
+	parsedRequest->extractBody(readBuffer.str() + bodyPosition, readBuffer.str() + bodyPosition + bodyLength);
+
+	return REQUEST_COMPLETE;
+}
 
-			// handle request
+bool HttpServerTask::processRead()
+{
+	if (httpRequestPending) {
+		return true;
+	}
+
+	// a client may send further requests without waiting for the responses,
+	// collect all complete requests and answer them in order
+	vector<HttpRequest*> requests;
+	vector<HttpJobRequest*> jobRequests;
+	ParseResult result;
+
+	do {
+		try {
+			result = parseRequest();
+
+			if (result == REQUEST_COMPLETE) {
+				jobRequests.push_back(server->createJobRequest(this, parsedRequest));
+			}
+		} catch (const ErrorException& e) {
 			readRequestBody = false;
-			handleRequest = true;
+			jobRequests.push_back(server->handleException(e, parsedRequest));
+			result = REQUEST_COMPLETE;
 		}
 
-		if (handleRequest) {
-			httpRequestPending = true;
-			server->handleRequest(this, httpRequest);
+		if (result == REQUEST_COMPLETE) {
+			requests.push_back(parsedRequest);
+			parsedRequest = 0;
+
+			requestStart = bodyPosition + bodyLength;
+			readPosition = requestStart;
+			bodyPosition = requestStart;
+			bodyLength = 0;
+		}
+	} while (result == REQUEST_COMPLETE);
+
+	// a request whose body is not yet complete stays in "parsedRequest",
+	// "httpRequest" only holds the request being answered
+	if (jobRequests.size() == 1) {
+		httpRequest = requests[0];
+		httpRequestPending = true;
+		handleJobRequest(jobRequests[0]);
+	} else if (!jobRequests.empty()) {
+		vector<HttpResponse*> responses;
+
+		httpRequestPending = true;
+		executeRequests(jobRequests, responses);
+		httpRequestPending = false;
+
+		for (size_t i = 0; i < responses.size(); i++) {
+			traceResponse(requests[i], responses[i]);
+			addResponse(responses[i]);
+			delete responses[i];
+
+			requests[i]->releaseBuffers();
+			delete requests[i];
 		}
-	} catch (const ErrorException& e) {
-		httpJobRequest = server->handleException(e, httpRequest);
-		handleDone();
 	}
 
-	return true;
+	// remove the answered requests from the read buffer
+	readBuffer.erase_front(requestStart);
+	readPosition -= requestStart;
+	bodyPosition -= requestStart;
+	requestStart = 0;
+
+	return result != REQUEST_CORRUPTED;
 }
 
 void HttpServerTask::addResponse(HttpResponse* response)
@@ -368,6 +491,29 @@ void HttpServerTask::addResponse(HttpResponse* response)
 	fillWriteBuffer();
 }
 
+void HttpServerTask::traceResponse(const HttpRequest* request, HttpResponse* response)
+{
+#ifdef ENABLE_TRACE_OPTION
+	string requestString = "";
+
+	if (request != 0) {
+		requestString = request->getHeaderString();
+
+		const string bs = request->getBodyString();
+
+		if (!bs.empty()) {
+			if (requestString.find("?") == string::npos) {
+				requestString += "?";
+			}
+
+			requestString += bs;
+		}
+	}
+
+	server->traceRequest(requestString + response->getBody().c_str());
+#endif
+}
+
 void HttpServerTask::completedWriteBuffer()
 {
 	fillWriteBuffer();
@@ -79,6 +79,25 @@ public:
 
 	void handleJobRequest(HttpJobRequest*);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief executes job requests and returns the responses in the same order
+	///
+	/// Consecutive read jobs are executed in parallel in the thread pool and
+	/// see the same version of the server. Any other job waits for the running
+	/// read jobs and is executed alone. The job requests are deleted, the
+	/// responses belong to the caller.
+	////////////////////////////////////////////////////////////////////////////////
+
+	void executeRequests(vector<HttpJobRequest*>& jobRequests, vector<HttpResponse*>& responses);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the http server
+	////////////////////////////////////////////////////////////////////////////////
+
+	HttpServer * getHttpServer() {
+		return server;
+	}
+
 public:
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -183,8 +202,14 @@ protected:
 	bool processRead();
 
 private:
+	enum ParseResult {
+		REQUEST_INCOMPLETE, REQUEST_COMPLETE, REQUEST_CORRUPTED
+	};
+
+	ParseResult parseRequest();
 	void fillWriteBuffer();
 	void addResponse(HttpResponse*);
+	void traceResponse(const HttpRequest*, HttpResponse*);
 	string extractRequestPath();
 
 private:
@@ -192,11 +217,13 @@ private:
 	HttpServer * server;
 	HttpJobRequest * httpJobRequest;
 	deque<StringBuffer*> writeBuffers;
+	size_t requestStart;
 	size_t readPosition;
 	size_t bodyPosition;
 
 	bool httpRequestPending;
 	HttpRequest * httpRequest;
+	HttpRequest * parsedRequest;
 	bool readRequestBody;
 	size_t bodyLength;
 	bool work;
@@ -40,6 +40,7 @@
 #include "InputOutput/FileReader.h"
 #include "InputOutput/FileUtils.h"
 #include "InputOutput/FileWriterBF.h"
+#include "InputOutput/Metrics.h"
 #include "Logger/Logger.h"
 #include "Olap/Context.h"
 #include "Thread/WriteLocker.h"
@@ -252,6 +253,7 @@ void JournalFile::archiveJournalFiles(const FileName& fileName)
 
 void JournalFile::flush(ContextStream &str)
 {
+	Metrics::ScopedTimer timer(Metrics::JOURNAL_FLUSH);
 	bool cont = true;
 	if (db != (IdentifierType) - 1) {
 		PDatabase d = Context::getContext()->getServer()->lookupDatabase(db, false);
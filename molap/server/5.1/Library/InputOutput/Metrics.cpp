@@ -0,0 +1,404 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "InputOutput/Metrics.h"
+
+#if defined(_MSC_VER)
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <boost/thread/tss.hpp>
+
+#include "Collections/StringBuffer.h"
+#include "Thread/WriteLocker.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief metrics of one thread
+///
+/// The histograms of the requests are created by the owning thread when the
+/// request is recorded first. The mutex only protects these pointers.
+////////////////////////////////////////////////////////////////////////////////
+
+struct MetricsBlock {
+	MetricsBlock() {
+		memset(counters, 0, sizeof(counters));
+		memset(requests, 0, sizeof(requests));
+	}
+
+	~MetricsBlock() {
+		for (IdentifierType i = 0; i < Metrics::MAX_REQUESTS; i++) {
+			delete requests[i];
+		}
+	}
+
+	Metrics::Histogram timers[Metrics::TIMER_COUNT];
+	uint64_t counters[Metrics::COUNTER_COUNT];
+	Metrics::Histogram *requests[Metrics::MAX_REQUESTS];
+	Mutex requestsLock;
+};
+
+static Mutex blocksLock;
+static vector<MetricsBlock *> blocks;
+static vector<MetricsBlock *> freeBlocks;
+static vector<string> requestPaths;
+static map<string, IdentifierType> requestIds;
+
+static void releaseBlock(MetricsBlock *block)
+{
+	WriteLocker wl(&blocksLock);
+	freeBlocks.push_back(block);
+}
+
+static boost::thread_specific_ptr<MetricsBlock> threadBlock(releaseBlock);
+
+static MetricsBlock *getBlock()
+{
+	MetricsBlock *block = threadBlock.get();
+
+	if (block == 0) {
+		WriteLocker wl(&blocksLock);
+
+		if (freeBlocks.empty()) {
+			block = new MetricsBlock();
+			blocks.push_back(block);
+		} else {
+			block = freeBlocks.back();
+			freeBlocks.pop_back();
+		}
+
+		threadBlock.reset(block);
+	}
+
+	return block;
+}
+
+static int highestBit(uint64_t value)
+{
+	int result = 0;
+
+	for (int shift = 32; shift > 0; shift >>= 1) {
+		if (value >> shift) {
+			value >>= shift;
+			result += shift;
+		}
+	}
+
+	return result;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// histogram
+// /////////////////////////////////////////////////////////////////////////////
+
+Metrics::Histogram::Histogram() :
+	count(0), sum(0), max(0)
+{
+	memset(buckets, 0, sizeof(buckets));
+}
+
+void Metrics::Histogram::merge(const Histogram &other)
+{
+	count += other.count;
+	sum += other.sum;
+	if (other.max > max) {
+		max = other.max;
+	}
+	for (size_t i = 0; i < BUCKET_COUNT; i++) {
+		buckets[i] += other.buckets[i];
+	}
+}
+
+uint64_t Metrics::Histogram::percentile(double fraction) const
+{
+	uint64_t total = 0;
+
+	for (size_t i = 0; i < BUCKET_COUNT; i++) {
+		total += buckets[i];
+	}
+
+	uint64_t rank = (uint64_t)(fraction * total + 0.5);
+	uint64_t seen = 0;
+
+	for (size_t i = 0; i < BUCKET_COUNT; i++) {
+		seen += buckets[i];
+		if (seen && seen >= rank) {
+			uint64_t limit = bucketLimit(i);
+			return limit < max ? limit : max;
+		}
+	}
+
+	return max;
+}
+
+size_t Metrics::Histogram::bucket(uint64_t value)
+{
+	if (value < (1 << SUB_BUCKET_BITS)) {
+		return (size_t)value;
+	}
+
+	int exponent = highestBit(value);
+
+	if (exponent > MAX_EXPONENT) {
+		return BUCKET_COUNT - 1;
+	}
+
+	return ((size_t)(exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + (size_t)((value >> (exponent - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1));
+}
+
+uint64_t Metrics::Histogram::bucketLimit(size_t bucket)
+{
+	if (bucket < (1 << SUB_BUCKET_BITS)) {
+		return bucket;
+	}
+
+	int shift = (int)(bucket >> SUB_BUCKET_BITS) - 1;
+	uint64_t lower = (uint64_t)((1 << SUB_BUCKET_BITS) + (bucket & ((1 << SUB_BUCKET_BITS) - 1))) << shift;
+
+	return lower + ((uint64_t)1 << shift) - 1;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// recording
+// /////////////////////////////////////////////////////////////////////////////
+
+uint64_t Metrics::now()
+{
+#if defined(_MSC_VER)
+	static LARGE_INTEGER frequency = {0};
+	LARGE_INTEGER counter;
+
+	if (frequency.QuadPart == 0) {
+		QueryPerformanceFrequency(&frequency);
+	}
+	QueryPerformanceCounter(&counter);
+
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart * 1000000 + counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+#else
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+void Metrics::record(Timer timer, uint64_t micros)
+{
+	getBlock()->timers[timer].add(micros);
+}
+
+void Metrics::recordRequest(IdentifierType request, uint64_t micros)
+{
+	if (request >= MAX_REQUESTS) {
+		return;
+	}
+
+	MetricsBlock *block = getBlock();
+	Histogram *histogram = block->requests[request];
+
+	if (histogram == 0) {
+		histogram = new Histogram();
+
+		WriteLocker wl(&block->requestsLock);
+		block->requests[request] = histogram;
+	}
+
+	histogram->add(micros);
+}
+
+void Metrics::count(Counter counter, uint64_t value)
+{
+	getBlock()->counters[counter] += value;
+}
+
+IdentifierType Metrics::registerRequest(const string &path)
+{
+	WriteLocker wl(&blocksLock);
+
+	map<string, IdentifierType>::iterator i = requestIds.find(path);
+
+	if (i != requestIds.end()) {
+		return i->second;
+	}
+
+	if (requestPaths.size() >= MAX_REQUESTS) {
+		return NO_IDENTIFIER;
+	}
+
+	IdentifierType id = (IdentifierType)requestPaths.size();
+
+	requestPaths.push_back(path);
+	requestIds[path] = id;
+
+	return id;
+}
+
+IdentifierType Metrics::lookupRequest(const string &path)
+{
+	map<string, IdentifierType>::const_iterator i = requestIds.find(path);
+
+	return i == requestIds.end() ? NO_IDENTIFIER : i->second;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// output
+// /////////////////////////////////////////////////////////////////////////////
+
+static const char *timerNames[Metrics::TIMER_COUNT] = {
+	"palo_planner_duration_microseconds",
+	"palo_engine_stream_duration_microseconds",
+	"palo_commit_duration_microseconds",
+	"palo_merge_duration_microseconds",
+	"palo_journal_flush_duration_microseconds",
+	"palo_pool_queue_wait_microseconds"
+};
+
+static const char *counterNames[Metrics::COUNTER_COUNT] = {
+	"palo_plan_cache_hits_total",
+	"palo_plan_cache_misses_total",
+	"palo_plan_cache_rebinds_total",
+	"palo_value_cache_hits_total",
+	"palo_value_cache_misses_total",
+	"palo_request_errors_total",
+	"palo_commit_conflicts_total"
+};
+
+static void appendSample(StringBuffer &sb, const char *name, const char *suffix, const string &labels, uint64_t value)
+{
+	sb.appendText(name);
+	sb.appendText(suffix);
+	if (!labels.empty()) {
+		sb.appendChar('{');
+		sb.appendText(labels);
+		sb.appendChar('}');
+	}
+	sb.appendChar(' ');
+	sb.appendInteger(value);
+	sb.appendEol();
+}
+
+static void appendType(StringBuffer &sb, const char *name, const char *suffix, const char *type)
+{
+	sb.appendText("# TYPE ");
+	sb.appendText(name);
+	sb.appendText(suffix);
+	sb.appendChar(' ');
+	sb.appendText(type);
+	sb.appendEol();
+}
+
+static void appendSummary(StringBuffer &sb, const char *name, const string &labels, const Metrics::Histogram &histogram)
+{
+	static const char *quantiles[] = {"0.5", "0.9", "0.99", "0.999"};
+	static const double fractions[] = {0.5, 0.9, 0.99, 0.999};
+
+	for (size_t i = 0; i < sizeof(fractions) / sizeof(fractions[0]); i++) {
+		sb.appendText(name);
+		sb.appendChar('{');
+		sb.appendText(labels);
+		if (!labels.empty()) {
+			sb.appendChar(',');
+		}
+		sb.appendText("quantile=\"");
+		sb.appendText(quantiles[i]);
+		sb.appendText("\"} ");
+		sb.appendInteger(histogram.percentile(fractions[i]));
+		sb.appendEol();
+	}
+
+	appendSample(sb, name, "_sum", labels, histogram.sum);
+	appendSample(sb, name, "_count", labels, histogram.count);
+}
+
+void Metrics::appendText(StringBuffer &sb)
+{
+	vector<Histogram> timers(TIMER_COUNT);
+	vector<uint64_t> counters(COUNTER_COUNT, 0);
+	vector<string> paths;
+	map<IdentifierType, Histogram> requests;
+	size_t threads = 0;
+
+	{
+		WriteLocker wl(&blocksLock);
+
+		paths = requestPaths;
+		threads = blocks.size() - freeBlocks.size();
+
+		for (vector<MetricsBlock *>::const_iterator b = blocks.begin(); b != blocks.end(); ++b) {
+			MetricsBlock *block = *b;
+
+			for (int i = 0; i < TIMER_COUNT; i++) {
+				timers[i].merge(block->timers[i]);
+			}
+
+			for (int i = 0; i < COUNTER_COUNT; i++) {
+				counters[i] += block->counters[i];
+			}
+
+			WriteLocker rl(&block->requestsLock);
+
+			for (IdentifierType i = 0; i < paths.size(); i++) {
+				if (block->requests[i]) {
+					requests[i].merge(*block->requests[i]);
+				}
+			}
+		}
+	}
+
+	// the maximum is not part of a summary, it is a gauge of its own
+	const char *requestName = "palo_request_duration_microseconds";
+	appendType(sb, requestName, "", "summary");
+	for (map<IdentifierType, Histogram>::const_iterator i = requests.begin(); i != requests.end(); ++i) {
+		appendSummary(sb, requestName, "path=\"" + paths[i->first] + "\"", i->second);
+	}
+	appendType(sb, requestName, "_max", "gauge");
+	for (map<IdentifierType, Histogram>::const_iterator i = requests.begin(); i != requests.end(); ++i) {
+		appendSample(sb, requestName, "_max", "path=\"" + paths[i->first] + "\"", i->second.max);
+	}
+
+	for (int i = 0; i < TIMER_COUNT; i++) {
+		appendType(sb, timerNames[i], "", "summary");
+		appendSummary(sb, timerNames[i], "", timers[i]);
+		appendType(sb, timerNames[i], "_max", "gauge");
+		appendSample(sb, timerNames[i], "_max", "", timers[i].max);
+	}
+
+	for (int i = 0; i < COUNTER_COUNT; i++) {
+		appendType(sb, counterNames[i], "", "counter");
+		appendSample(sb, counterNames[i], "", "", counters[i]);
+	}
+
+	sb.appendText("# TYPE palo_metrics_threads gauge");
+	sb.appendEol();
+	sb.appendText("palo_metrics_threads ");
+	sb.appendInteger((uint64_t)threads);
+	sb.appendEol();
+}
+
+}
@@ -0,0 +1,190 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef INPUT_OUTPUT_METRICS_H
+#define INPUT_OUTPUT_METRICS_H 1
+
+#include "palo.h"
+
+namespace palo {
+
+class StringBuffer;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief always-on counters and latency histograms
+///
+/// Every thread records into its own block, so recording needs neither locks
+/// nor atomic operations. The blocks are merged when the metrics are
+/// requested. A block is written by its thread only, a concurrent merge may
+/// therefore miss the latest values but never blocks the recording thread.
+/// Blocks of finished threads are reused by new threads and keep their values.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS Metrics {
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief measured durations
+	////////////////////////////////////////////////////////////////////////////////
+
+	enum Timer {
+		PLANNER,
+		ENGINE_STREAM,
+		COMMIT,
+		MERGE,
+		JOURNAL_FLUSH,
+		POOL_QUEUE_WAIT,
+		TIMER_COUNT
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief counted events
+	////////////////////////////////////////////////////////////////////////////////
+
+	enum Counter {
+		PLAN_CACHE_HIT,
+		PLAN_CACHE_MISS,
+		PLAN_CACHE_REBIND,
+		VALUE_CACHE_HIT,
+		VALUE_CACHE_MISS,
+		REQUEST_ERROR,
+		COMMIT_CONFLICT,
+		COUNTER_COUNT
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief maximal number of request paths
+	////////////////////////////////////////////////////////////////////////////////
+
+	static const IdentifierType MAX_REQUESTS = 192;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief latency histogram with logarithmic buckets
+	///
+	/// Values below 8 have their own bucket, larger values are split into 8
+	/// buckets per power of two, so a bucket is at most 12.5% wide.
+	////////////////////////////////////////////////////////////////////////////////
+
+	struct Histogram {
+		static const int SUB_BUCKET_BITS = 3;
+		static const int MAX_EXPONENT = 40;
+		static const size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) << SUB_BUCKET_BITS;
+
+		Histogram();
+
+		void add(uint64_t value) {
+			count++;
+			sum += value;
+			if (value > max) {
+				max = value;
+			}
+			buckets[bucket(value)]++;
+		}
+
+		void merge(const Histogram &other);
+		uint64_t percentile(double fraction) const;
+
+		static size_t bucket(uint64_t value);
+		static uint64_t bucketLimit(size_t bucket);
+
+		uint64_t count;
+		uint64_t sum;
+		uint64_t max;
+		uint64_t buckets[BUCKET_COUNT];
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief measures the lifetime of the object
+	////////////////////////////////////////////////////////////////////////////////
+
+	class ScopedTimer {
+	public:
+		ScopedTimer(Timer timer) : timer(timer), start(now()) {
+		}
+
+		~ScopedTimer() {
+			record(timer, now() - start);
+		}
+
+	private:
+		ScopedTimer(const ScopedTimer&);
+		ScopedTimer& operator=(const ScopedTimer&);
+
+		Timer timer;
+		uint64_t start;
+	};
+
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief monotonic time in microseconds
+	////////////////////////////////////////////////////////////////////////////////
+
+	static uint64_t now();
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief records a duration in microseconds
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void record(Timer timer, uint64_t micros);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief records the duration of a request in microseconds
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void recordRequest(IdentifierType request, uint64_t micros);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief increments a counter
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void count(Counter counter, uint64_t value = 1);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief registers a request path
+	///
+	/// Must be called before the server accepts requests, the list of paths is
+	/// read without locking afterwards.
+	////////////////////////////////////////////////////////////////////////////////
+
+	static IdentifierType registerRequest(const string &path);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief identifier of a registered request path or NO_IDENTIFIER
+	////////////////////////////////////////////////////////////////////////////////
+
+	static IdentifierType lookupRequest(const string &path);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief appends the merged metrics in the prometheus text format
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void appendText(StringBuffer &sb);
+};
+
+}
+
+#endif
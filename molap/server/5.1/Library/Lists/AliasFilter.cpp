@@ -158,7 +158,7 @@ struct AliasFilter::FilterOperator {
 			if (!cval.isString() && !cval.empty() && ((boost::get<2>(f)).str() != "^.*")) {
 				throw ErrorException(ErrorException::ERROR_INVALID_TYPE, "String expected but double/error found as cell value");
 			} else {
-				if (!boost::regex_search(cval, boost::get<2>(f))) {
+				if (!boost::regex_search(cval.getString(), boost::get<2>(f))) {
 					return false;
 				}
 			}
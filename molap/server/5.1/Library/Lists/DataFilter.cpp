@@ -427,20 +427,54 @@ struct less {
 	bool operator()(double x, double y) const {return x < y;}
 };
 
+double DataFilter::getElementValue(Element *el)
+{
+	if (m_subset_ref.getDimension()->getDimensionType() == Dimension::VIRTUAL) {
+		return m_subset_ref.getValue((IdentifierType)(size_t)el).getNumeric();
+	} else {
+		return m_subset_ref.getValue(el->getIdentifier()).getNumeric();
+	}
+}
+
+template<class T> void DataFilter::Ranking<T>::add(double value, Element *el)
+{
+	entries.push_back(Entry(value, entries.size(), el));
+}
+
+template<class T> bool DataFilter::Ranking<T>::next()
+{
+	if (!built) {
+		make_heap(entries.begin(), entries.end(), After());
+		count = entries.size();
+		built = true;
+	}
+	if (!count) {
+		current = 0;
+		return false;
+	}
+	pop_heap(entries.begin(), entries.begin() + count, After());
+	--count;
+	current = &entries[count];
+	return true;
+}
+
+template<class T> void DataFilter::Ranking<T>::insertRest(multiset<Element *> &elements) const
+{
+	size_t end = built ? count : entries.size();
+	for (size_t i = 0; i < end; i++) {
+		elements.insert(entries[i].el);
+	}
+}
+
 ElementsType DataFilter::top(int top_num, const ElementsType &subset)
 {
-	multimap<double, Element *, greater> sort;
+	Ranking<greater> sort;
 	for (ElementsType::const_iterator it = subset.begin(); it != subset.end(); ++it) {
-		if (m_subset_ref.getDimension()->getDimensionType() == Dimension::VIRTUAL) {
-			sort.insert(make_pair(m_subset_ref.getValue((IdentifierType)(size_t)*it).getNumeric(), *it));
-		} else {
-			sort.insert(make_pair(m_subset_ref.getValue((*it)->getIdentifier()).getNumeric(), *it));
-		}
+		sort.add(getElementValue(*it), *it);
 	}
-	multimap<double, Element *, greater>::iterator it = sort.begin();
 	ElementsType ret;
-	for (int i = 0; it != sort.end() && i < top_num; ++i, ++it) {
-		ret.push_back(it->second);
+	for (int i = 0; i < top_num && sort.next(); ++i) {
+		ret.push_back(sort.getElement());
 	}
 	return ret;
 }
@@ -455,13 +489,8 @@ template<class T> DataFilter::PercentageAccumulator<T>::PercentageAccumulator(Da
 		if ((df.queryFlag(DataFilterBase::ONLY_LEAVES) && !children) || (df.queryFlag(DataFilterBase::ONLY_CONSOLIDATED) && children)) {
 			m_others.push_back(*it_beg);
 		} else {
-			double val;
-			if (df.m_subset_ref.getDimension()->getDimensionType() == Dimension::VIRTUAL) {
-				val = df.m_subset_ref.getValue((IdentifierType)(size_t)*it_beg).getNumeric();
-			} else {
-				val = df.m_subset_ref.getValue((*it_beg)->getIdentifier()).getNumeric();
-			}
-			sort.insert(make_pair(val, *it_beg));
+			double val = df.getElementValue(*it_beg);
+			sort.add(val, *it_beg);
 			total += (val * (((double)percentage) / 100.0));
 		}
 	}
@@ -485,11 +514,15 @@ template<class T> bool DataFilter::PercentageAccumulator<T>::check(double value)
 template<class T> multiset<Element *> DataFilter::PercentageAccumulator<T>::apply()
 {
 	multiset<Element *> ret;
-	for (typename multimap<double, Element *, T>::iterator it = sort.begin(); it != sort.end(); ++it) {
-		if (!check(it->first)) {
-			ret.insert(it->second);
+	while (m_sum < m_limit && sort.next()) {
+		if (!check(sort.getValue())) {
+			ret.insert(sort.getElement());
 		}
 	}
+	// behind the limit all values are checked the same way, they need no order
+	if (m_sum >= m_limit && !check(0.0)) {
+		sort.insertRest(ret);
+	}
 	ret.insert(m_others.begin(), m_others.end());
 	return ret;
 }
@@ -60,12 +60,44 @@ private:
 	void applySettings();
 	int getFuncType(bool &isAggrFunc) const;
 
+	double getElementValue(Element *el);
+
+	// elements ordered by value, equal values in subset order, built lazily with a heap
+	template<class T> class Ranking {
+	public:
+		Ranking() : built(false), count(0), current(0) {}
+		void add(double value, Element *el);
+		bool next();
+		double getValue() const {return current->value;}
+		Element *getElement() const {return current->el;}
+		void insertRest(multiset<Element *> &elements) const;
+
+	private:
+		struct Entry {
+			Entry(double value, size_t index, Element *el) : value(value), index(index), el(el) {}
+			double value;
+			size_t index;
+			Element *el;
+		};
+		struct After {
+			bool operator()(const Entry &e1, const Entry &e2) const {
+				T before;
+				return before(e2.value, e1.value) || (!before(e1.value, e2.value) && e1.index > e2.index);
+			}
+		};
+
+		vector<Entry> entries;
+		bool built;
+		size_t count;
+		const Entry *current;
+	};
+
 	template<class T> class PercentageAccumulator {
 	protected:
 		long double m_sum;
 		long double m_limit;
 		ElementsType m_others;
-		multimap<double, Element *, T> sort;
+		Ranking<T> sort;
 
 	public:
 		PercentageAccumulator(DataFilter &df, const ElementsType &ids, double percentage);
@@ -191,12 +191,13 @@ struct SortElem {
 	IdentifierType cons;
 	U_NAMESPACE_QUALIFIER UnicodeString uname;
 	CellValue val;
+	const CellValue *value;
 
-	SortElem() : sub(0), el(0), dep(NO_IDENTIFIER), ind(NO_IDENTIFIER), cons(0) {}
-	SortElem(SubSet *sub, Element *el, IndentType ind, DepthType dep, IdentifierType cons) : sub(sub), el(el), dep(dep), ind(ind), cons(cons) {}
+	SortElem() : sub(0), el(0), dep(NO_IDENTIFIER), ind(NO_IDENTIFIER), cons(0), value(0) {}
+	SortElem(SubSet *sub, Element *el, IndentType ind, DepthType dep, IdentifierType cons) : sub(sub), el(el), dep(dep), ind(ind), cons(cons), value(0) {}
 	const U_NAMESPACE_QUALIFIER UnicodeString &getUName() const {if (uname.isEmpty()) const_cast<SortElem *>(this)->uname = U_NAMESPACE_QUALIFIER UnicodeString::fromUTF8(el->getName(sub->dim->getElemNamesVector()).c_str()); return uname;}
 	const CellValue &getSearchAlias() const {if (val.isEmpty()) {const_cast<SortElem *>(this)->val = el->getName(sub->dim->getElemNamesVector()); const_cast<SortElem *>(this)->val = sub->getSearchAlias(el->getIdentifier(), val);} return val;}
-	const CellValue &getValue() const {return sub->getValue(el->getIdentifier());}
+	const CellValue &getValue() const {if (!value) const_cast<SortElem *>(this)->value = &sub->getValue(el->getIdentifier()); return *value;}
 	const CellValue &getSortingAlias() const {if (val.isEmpty()) {const_cast<SortElem *>(this)->val = el->getName(sub->dim->getElemNamesVector()); const_cast<SortElem *>(this)->val = sub->getSortingAlias(el->getIdentifier(), val);} return val;}
 };
 
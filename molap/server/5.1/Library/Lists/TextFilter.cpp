@@ -68,7 +68,7 @@ void TextFilter::findRegexInAttribute(const boost::regex& rx, const long attr_id
 			const CellValue &val = cs->getValue();
 			const IdentifiersType &key = cs->getKey();
 			if (val.isString()) {
-				if (boost::regex_search(val, rx)) {
+				if (boost::regex_search(val.getString(), rx)) {
 					m_matches[key[1]] = true;
 				}
 			}
@@ -81,7 +81,7 @@ void TextFilter::findRegexInAlias(const boost::regex& rx)
 	SubSet::Iterator it = m_subset_ref.begin(true);
 	for (match_vec_type::size_type idx = 0; !it.end(); ++it, ++idx) {
 		if (!m_matches[idx]) {
-			if (boost::regex_search(it.getSearchAlias(true), rx)) {
+			if (boost::regex_search(it.getSearchAlias(true).getString(), rx)) {
 				m_matches[idx] = true;
 			}
 		}
@@ -79,7 +79,7 @@ ResultStatus ConfigurationCube::setCellValue(PServer server, PDatabase db, PCube
 		size_t l = value.length();
 
 		if (l != 1) {
-			throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "value not allowed here", "value", value);
+			throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "value not allowed here", "value", value.getString());
 		}
 
 		string okStrings;
@@ -93,7 +93,7 @@ ResultStatus ConfigurationCube::setCellValue(PServer server, PDatabase db, PCube
 		newValue = string(1, valueChar);
 
 		if (newValue.find_first_not_of(okStrings) != string::npos) {
-			throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "value not allowed here", "value", value);
+			throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "value not allowed here", "value", value.getString());
 		}
 	}
 
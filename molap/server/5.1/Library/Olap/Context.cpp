@@ -34,11 +34,12 @@
 
 #include "Engine/Legacy/Engine.h"
 #include "Olap/Rule.h"
+#include "Thread/WriteLocker.h"
 
 namespace palo {
 
 Context::Context() : svsChangeStatusContext(SVS_NONE), updateToken(true), refreshUsers(false), optimistic(true), worker(false),
-	filteredFromMarkers(0), rulesContext(0), stopJob(NO_STOP), ignoreStopJob(false), inJournal(false), task(0), saveToCache(true)
+	filteredFromMarkers(0), rulesContext(0), stopJob(NO_STOP), ignoreStopJob(false), inJournal(false), task(0), parentJob(0), saveToCache(true)
 {
 	if (getServer()) {
 		PEngineList engineList = getServer()->getEngineList(false);
@@ -430,6 +431,13 @@ boost::shared_ptr<ValueCache::QueryCache> Context::getQueryCache(CPCube cube)
 
 void Context::setCacheDependence(const dbID_cubeID &dbCubeId)
 {
+	// the producers of an exchange run in their own context, the cache writers
+	// waiting for their cells belong to the parent
+	if (parentJob) {
+		parentJob->setCacheDependence(dbCubeId);
+	}
+
+	WriteLocker wl(&cacheDependencesLock);
 	for (Context::CacheDependences::iterator cdit = cacheDependences.begin(); cdit != cacheDependences.end(); ++cdit) {
 		(*cdit)->addSourceCube(dbCubeId);
 	}
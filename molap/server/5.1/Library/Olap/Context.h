@@ -187,6 +187,14 @@ public:
 	////////////////////////////////////////////////////////////////////////////////
 	PServer getServerCopy();
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief Pins the server returned by getServer.
+	/// Used to run several read jobs against the same version of the server.
+	////////////////////////////////////////////////////////////////////////////////
+	void setServer(PServer server) {
+		this->server = server;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief Stores parent child relationship.
 	/// Used in lookup... functions to store parent child relationship like
@@ -214,6 +222,16 @@ public:
 		c->setWorker(true);
 		context.reset(c);
 	}
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief Takes the context away from the thread, the next getContext
+	/// creates a new one until the taken context is restored
+	////////////////////////////////////////////////////////////////////////////////
+	static Context *detachContext() {
+		return context.release();
+	}
+	static void attachContext(Context *c) {
+		context.reset(c);
+	}
 	bool isWorker() {
 		return worker;
 	}
@@ -421,6 +439,9 @@ public:
 				}
 				return false;
 			}
+			if (parentJob) {
+				return parentJob->check(th);
+			}
 		}
 		return true;
 	}
@@ -447,6 +468,8 @@ public:
 	void clearQueryCache() {queryCache.clear();}
 
 	CacheDependences &getCacheDependences() {return cacheDependences;}
+	// guards the cache writers against dependences reported by exchange producers
+	Mutex &getCacheDependencesLock() {return cacheDependencesLock;}
 	void setCacheDependence(const dbID_cubeID &dbCubeId);
 
 	void setInJournal(bool value) {
@@ -461,6 +484,15 @@ public:
 		task = t;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief Sets the context of the job this thread calculates a part of
+	/// The job stays stopped together with the parent, the parent context has
+	/// to outlive this one.
+	////////////////////////////////////////////////////////////////////////////////
+	void setParentJob(Context *parent) {
+		parentJob = parent;
+	}
+
 private:
 	enum JobStatus {
 		NO_STOP, ADMIN_STOP, LOGOUT_STOP
@@ -494,8 +526,10 @@ private:
 	JobStatus stopJob;
 	bool ignoreStopJob;
 	CacheDependences cacheDependences;
+	Mutex cacheDependencesLock;
 	bool inJournal;
 	IoTask *task;
+	Context *parentJob;
 	bool saveToCache;
 };
 
@@ -67,6 +67,7 @@
 #include "InputOutput/FileReader.h"
 #include "InputOutput/FileWriter.h"
 #include "InputOutput/FileUtils.h"
+#include "InputOutput/Metrics.h"
 #include "InputOutput/Statistics.h"
 #include "Collections/CellSet.h"
 #include "Parser/RuleParserDriver.h"
@@ -167,7 +168,7 @@ void Cube::setSaveCSV(bool save)
 Cube::Cube(PDatabase db, const string& name, const IdentifiersType *dimensions, Cube::SaveType saveType) :
 	Commitable(name), token(rand()), clientCacheToken(new IdHolder), dimensions(*dimensions), rules(new RuleList()), deletable(true),
 	renamable(true), numericStorageId(NO_IDENTIFIER), stringStorageId(NO_IDENTIFIER), markerStorageId(NO_IDENTIFIER), locks(new LockList()),
-	filelock(new PaloSharedMutex), rulefilelock(new PaloSharedMutex), saveType(saveType), wholeCubeLocked(false),
+	filelock(new PaloSharedMutex), rulefilelock(new PaloSharedMutex), commitlock(new PaloSharedMutex), saveType(saveType), wholeCubeLocked(false),
 	cache(dimensions->size(), cacheBarrier, 0), additiveCommit(false), delCount(0)
 {
 	if (!token) {
@@ -204,9 +205,9 @@ Cube::Cube(const Cube& c) :
 	renamable(c.renamable), cubeWorker(c.cubeWorker), hasArea(c.hasArea), workerAreaIdentifiers(c.workerAreaIdentifiers), workerAreas(c.workerAreas),
 	numericStorageId(c.numericStorageId), stringStorageId(c.stringStorageId), markerStorageId(c.markerStorageId), cellsStatus(c.cellsStatus),
 	rulesStatus(c.rulesStatus), fileName(c.fileName), ruleFileName(c.ruleFileName), journalFile(c.journalFile), journal(Server::ignoreJournal || !journalFile ? 0 : new JournalMem(journalFile.get())), hasLock(c.hasLock), locks(c.locks),
-	fromMarkers(c.fromMarkers), toMarkers(c.toMarkers), filelock(c.filelock), rulefilelock(c.rulefilelock), saveType(c.saveType),
+	fromMarkers(c.fromMarkers), toMarkers(c.toMarkers), filelock(c.filelock), rulefilelock(c.rulefilelock), commitlock(c.commitlock), saveType(c.saveType),
 	wholeCubeLocked(c.wholeCubeLocked), pathTranslator(c.pathTranslator), cache(c.dimensions.size(), cacheBarrier, c.getCache()->getGeneration()),
-	additiveCommit(c.additiveCommit), delCount(c.delCount)
+	additiveCommit(c.additiveCommit), delCount(c.delCount), deletedCells(c.deletedCells)
 {
 }
 
@@ -536,16 +537,16 @@ void Cube::processJournalCommand(PServer server, PDatabase db, CPCube thisCube,
 		int sr = history.getDataInteger(5);
 		int build = history.getDataInteger(7);
 		history.setVersion(release, sr, build);
-	} else if (history.getVersion().isUnknown()) {
-		throw ErrorException(ErrorException::ERROR_INVALID_VERSION, "cube " + StringUtils::convertToString(getId()) + " has nonempty journal file from old version");
-	} else if (command == JournalFileReader::JOURNAL_RULE_MOVE) {
-		IdentifierType id = history.getDataInteger(4);
-		double position = history.getDataDouble(5);
-		PRule rule = findRule(id);
-		setRulesPosition(server, db, vector<PRule>(1, rule), position, 0, PUser(), false);
-	} else if (history.getVersion().isOld()) {
-		// MOVE_RULE only above is allowed also in old versions due to a bug fixed in 5720
-		throw ErrorException(ErrorException::ERROR_INVALID_VERSION, "cube " + StringUtils::convertToString(getId()) + " has nonempty journal file from old version");
+	} else if (history.getVersion().isUnknown()) {
+		throw ErrorException(ErrorException::ERROR_INVALID_VERSION, "cube " + StringUtils::convertToString(getId()) + " has nonempty journal file from old version");
+	} else if (command == JournalFileReader::JOURNAL_RULE_MOVE) {
+		IdentifierType id = history.getDataInteger(4);
+		double position = history.getDataDouble(5);
+		PRule rule = findRule(id);
+		setRulesPosition(server, db, vector<PRule>(1, rule), position, 0, PUser(), false);
+	} else if (history.getVersion().isOld()) {
+		// MOVE_RULE only above is allowed also in old versions due to a bug fixed in 5720
+		throw ErrorException(ErrorException::ERROR_INVALID_VERSION, "cube " + StringUtils::convertToString(getId()) + " has nonempty journal file from old version");
 	} else if (command == JournalFileReader::JOURNAL_CELL_REPLACE_BULK_START) {
 		replaceBulkState = Cube::First;
 	} else if (command == JournalFileReader::JOURNAL_CELL_REPLACE_BULK_STOP) {
@@ -2127,7 +2128,7 @@ ResultStatus Cube::setCellValue(PServer server, PDatabase db, PCubeArea spCellPa
 			if (value.isNumeric()) {
 				return cubeWorker->setCellValue(strArea, session ? session->getSid() : "", *pathBegin, value.getNumeric(), splashMode, addValue);
 			} else {
-				return cubeWorker->setCellValue(strArea, session ? session->getSid() : "", *pathBegin, value, splashMode, addValue);
+				return cubeWorker->setCellValue(strArea, session ? session->getSid() : "", *pathBegin, value.getString(), splashMode, addValue);
 			}
 		}
 	}
@@ -2377,11 +2378,21 @@ void Cube::commitChangesIntern(bool checkLocks, PUser user, bool disjunctive)
 {
 	Context *context = Context::getContext();
 	PEngineBase engine = context->getServerCopy()->getEngine(EngineBase::CPU, true);
+	// deleted cells are only needed to update the markers from this cube
+	bool collectDeleted = !fromMarkers.empty();
 	PStorageBase storage = engine->getCreateStorage(stringStorageId, pathTranslator, EngineBase::String);
+	StorageCpu *st = dynamic_cast<StorageCpu *>(storage.get());
+	if (st) {
+		st->setCollectDeleted(collectDeleted);
+	}
 	PCellStream roll;
 	roll = storage->commitChanges(checkLocks && hasLock && !wholeCubeLocked, false, false);
 	checkValueLocks(roll, user, storage.get());
 	storage = engine->getCreateStorage(numericStorageId, pathTranslator, EngineBase::Numeric);
+	st = dynamic_cast<StorageCpu *>(storage.get());
+	if (st) {
+		st->setCollectDeleted(collectDeleted);
+	}
 	roll = storage->commitChanges(checkLocks && hasLock && !wholeCubeLocked, additiveCommit, disjunctive);
 	checkValueLocks(roll, user, storage.get());
 	storage = engine->getCreateStorage(markerStorageId, pathTranslator, EngineBase::Marker);
@@ -2450,6 +2461,132 @@ static ostream& operator<<(ostream& ostr, const IdentifiersType& v)
 	return ostr;
 }
 
+bool Cube::setBaseNumericValues(const CellValueContext *cvc, User::RightSetting &rs)
+{
+	const vector<CellValueContext::PathVectorAndValue> &values = cvc->pathVectorAndValue;
+	if (values.empty() || cvc->vElemTypes || getType() != NORMALTYPE || !fromMarkers.empty() || (cvc->checkArea && cubeWorker != 0)) {
+		return false;
+	}
+	if (cvc->user && ConfigDatabase::isConfigCube(cvc->db->getName(), getName())) {
+		return false;
+	}
+	PSubCubeList lockedSubcubes = cvc->lockedCells ? cvc->lockedCells->getLockedAreas() : PSubCubeList();
+	if (lockedSubcubes && !lockedSubcubes->empty()) {
+		return false;
+	}
+
+	size_t dimCount = dimensions.size();
+	vector<IdentifiersType> ids(dimCount);
+	bool anyZero = false;
+	for (vector<CellValueContext::PathVectorAndValue>::const_iterator it = values.begin(); it != values.end(); ++it) {
+		if (it->cellType != CubeArea::BASE_NUMERIC || it->sepRight != values[0].sepRight) {
+			return false;
+		}
+		for (size_t i = 0; i < dimCount; i++) {
+			ids[i].push_back(it->cellPath[i]);
+		}
+		anyZero |= it->value.isEmpty();
+	}
+
+	CPCube cube = CONST_COMMITABLE_CAST(Cube, shared_from_this());
+	if (User::checkUser(cvc->user)) {
+		// rights of the bounding area are the minimum of the rights of its cells
+		PCubeArea boundingArea(new CubeArea(cvc->db, cube, ids));
+		rs.checkSepRight = values[0].sepRight;
+		try {
+			checkAreaAccessRight(cvc->db, cvc->user, boundingArea, rs, anyZero, anyZero ? RIGHT_DELETE : RIGHT_WRITE, 0);
+		} catch (ErrorException &) {
+			// some cells of the bounding area aren't writable, check the cells one by one
+			return false;
+		}
+	}
+
+	Context *context = Context::getContext();
+	PServer server = context->getServerCopy();
+	PEngineBase engineCpu = server->getEngine(EngineBase::CPU, true);
+	PStorageCpu storage = COMMITABLE_CAST(StorageCpu, engineCpu->getCreateStorage(numericStorageId, pathTranslator, EngineBase::Numeric));
+
+	for (vector<CellValueContext::PathVectorAndValue>::const_iterator it = values.begin(); it != values.end(); ++it) {
+		storage->setNumericValue(it->cellPath, it->value.getNumeric(), cvc->addValue);
+	}
+
+	if (journal) {
+		string username = server->getUsername(cvc->user);
+		const string &event = server->getEvent();
+		CPPaths lockedPaths = cvc->lockedCells ? cvc->lockedCells->getLockedPaths() : CPPaths();
+		SplashMode splashMode = (SplashMode)cvc->splashMode;
+		for (vector<CellValueContext::PathVectorAndValue>::const_iterator it = values.begin(); it != values.end(); ++it) {
+			journal->appendCommand(username, event, JournalFileReader::JOURNAL_CELL_REPLACE_DOUBLE);
+			journal->appendIdentifiers(it->cellPath.begin(), it->cellPath.end());
+			journal->appendInteger(it->value.isEmpty() && splashMode == DEFAULT ? SET_BASE : splashMode);
+			journal->appendDouble(it->value.getNumeric());
+			journal->appendBool(cvc->addValue);
+			journal->appendPaths(lockedPaths);
+			journal->nextLine();
+		}
+	}
+
+	cellsStatus = CHANGED;
+	additiveCommit = cvc->addValue;
+	updateClientCacheToken();
+	return true;
+}
+
+bool Cube::restoreCellValues(PServer server, PCellStream values, PUser user)
+{
+	if (getType() != NORMALTYPE || !fromMarkers.empty()) {
+		return false;
+	}
+
+	checkCheckedOut();
+	if (additiveCommit) {
+		commitChangesIntern(true, user, false);
+		additiveCommit = false;
+	}
+
+	PEngineBase engineCpu = Context::getContext()->getServerCopy()->getEngine(EngineBase::CPU, true);
+	PStorageCpu numericStorage;
+	PStorageCpu stringStorage;
+	string username = journal ? server->getUsername(user) : "";
+
+	while (values->next()) {
+		const IdentifiersType &key = values->getKey();
+		const CellValue &value = values->getValue();
+
+		if (value.isString()) {
+			if (!stringStorage) {
+				stringStorage = COMMITABLE_CAST(StorageCpu, engineCpu->getCreateStorage(stringStorageId, pathTranslator, EngineBase::String));
+			}
+			stringStorage->replaceCellValue(key, value);
+		} else {
+			if (!numericStorage) {
+				numericStorage = COMMITABLE_CAST(StorageCpu, engineCpu->getCreateStorage(numericStorageId, pathTranslator, EngineBase::Numeric));
+			}
+			numericStorage->replaceCellValue(key, value);
+		}
+
+		if (journal) {
+			if (value.isString()) {
+				journal->appendCommand(username, server->getEvent(), JournalFileReader::JOURNAL_CELL_REPLACE_STRING);
+				journal->appendIdentifiers(key.begin(), key.end());
+				journal->appendEscapeString(value);
+			} else {
+				journal->appendCommand(username, server->getEvent(), JournalFileReader::JOURNAL_CELL_REPLACE_DOUBLE);
+				journal->appendIdentifiers(key.begin(), key.end());
+				journal->appendInteger(value.isEmpty() ? SET_BASE : DEFAULT);
+				journal->appendDouble(value.getNumeric());
+				journal->appendBool(false);
+				journal->appendPaths(CPPaths());
+			}
+			journal->nextLine();
+		}
+	}
+
+	cellsStatus = CHANGED;
+	updateClientCacheToken();
+	return true;
+}
+
 ResultStatus Cube::setCellValue(bool isBulk)
 {
 	checkCheckedOut();
@@ -2468,7 +2605,9 @@ ResultStatus Cube::setCellValue(bool isBulk)
 	}
 
 	bool disjunctive = isBulk && cvc->vElemTypes /*&& cvc->addValue*/;
-	if (disjunctive) {
+	if (isBulk && setBaseNumericValues(cvc, rs)) {
+		status = RESULT_OK;
+	} else if (disjunctive) {
 		const vector<vector<char> > &vElemTypes = *cvc->vElemTypes;
 		map<IdentifiersType, pair<double, bool> > paths;
 		CubeArea::CellType cellGroup = CubeArea::NONE;
@@ -2636,10 +2775,47 @@ CellValue Cube::getCellValue(PCubeArea cellPath, bool bUseRules) const
 	bool planWritterOpen = false;
 #endif
 
+bool Cube::isPlanCachable(CPCube thisCube, RulesType rulesType) const
+{
+	if ((rulesType & ALL_RULES) == NO_RULES || isCheckedOut()) {
+		// plans without rules are cheap and may be modified by the caller (splashing)
+		return false;
+	}
+	if (Context::getContext()->getQueryCache(thisCube)) {
+		return false;
+	}
+	for (RuleList::ConstIterator it = rules->const_begin(); it != rules->const_end(); ++it) {
+		if (CONST_COMMITABLE_CAST(Rule, *it)->isCustom()) {
+			// plans of custom rules depend on the rights of the user
+			return false;
+		}
+	}
+	return true;
+}
+
 PPlanNode Cube::createPlan(PCubeArea area, CubeArea::CellType type, RulesType paramRulesType, bool skipEmpty, uint64_t blockSize) const
 {
-	Planner planner(CONST_COMMITABLE_CAST(Cube, shared_from_this()), area);
+	Metrics::ScopedTimer timer(Metrics::PLANNER);
+	CPCube thisCube = CONST_COMMITABLE_CAST(Cube, shared_from_this());
+	PStorageCpu cacheStorage;
+	bool cachePlan = isPlanCachable(thisCube, paramRulesType);
+	if (cachePlan) {
+		ValueCache::PCachedAreas cachedAreas;
+		getCache()->getAreasAndStorage(cacheStorage, cachedAreas);
+		PPlanNode pn = planCache.find(area, type, paramRulesType, skipEmpty, blockSize, rules, cacheStorage);
+		if (pn) {
+			Metrics::count(Metrics::PLAN_CACHE_HIT);
+			return pn;
+		}
+		Metrics::count(Metrics::PLAN_CACHE_MISS);
+	}
+
+	Planner planner(thisCube, area);
 	PPlanNode pn = planner.createPlan(type, paramRulesType, skipEmpty, blockSize);
+	Planner::markExchanges(pn);
+	if (cachePlan && pn) {
+		planCache.insert(area, type, paramRulesType, skipEmpty, blockSize, rules, cacheStorage, planner.getDependences(), pn);
+	}
 #ifdef SAVE_PLANS_PATH
 	if (pn) {
 		if (!planWritterOpen) {
@@ -2656,6 +2832,22 @@ PPlanNode Cube::createPlan(PCubeArea area, CubeArea::CellType type, RulesType pa
 	return pn;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief records the lifetime of a result stream when it is released
+////////////////////////////////////////////////////////////////////////////////
+
+struct StreamTimer {
+	StreamTimer(PProcessorBase processor) : processor(processor), start(Metrics::now()) {}
+
+	void operator()(ProcessorBase *) {
+		Metrics::record(Metrics::ENGINE_STREAM, Metrics::now() - start);
+		processor.reset();
+	}
+
+	PProcessorBase processor;
+	uint64_t start;
+};
+
 PProcessorBase Cube::evaluatePlan(PPlanNode plan, EngineBase::Type engineType, bool sortedOutput) const
 {
 	PEngineBase engine;
@@ -2670,6 +2862,9 @@ PProcessorBase Cube::evaluatePlan(PPlanNode plan, EngineBase::Type engineType, b
 		throw ErrorException(ErrorException::ERROR_INTERNAL, "no engine found!");
 	}
 	PProcessorBase result = engine->createProcessor(plan, sortedOutput);
+	if (result) {
+		result = PProcessorBase(result.get(), StreamTimer(result));
+	}
 	return result;
 
 #ifdef undefined
@@ -2714,6 +2909,37 @@ bool Cube::invalidateCache()
 	return res;
 }
 
+bool Cube::updateCache(CPDatabase db, const Area &affected)
+{
+	CPCube thisCube = CONST_COMMITABLE_CAST(Cube, shared_from_this());
+	bool res = cache.restoreInherited(db, thisCube, affected);
+	if (res) {
+		Logger::debug << "Cache of cube: " << getName() << " has been invalidated for the area depending on the changed cells." << endl;
+	}
+	return res;
+}
+
+bool Cube::invalidateCachedArea(CPDatabase db, const Area &affected)
+{
+	CPCube thisCube = CONST_COMMITABLE_CAST(Cube, shared_from_this());
+	bool res = cache.invalidate(db, thisCube, affected);
+	if (res) {
+		Logger::debug << "Cache of cube: " << getName() << " has been invalidated for the area depending on the changed cells of another cube." << endl;
+	}
+	return res;
+}
+
+static Mutex ruleDependenciesLock;
+
+CPRuleDependencies Cube::getRuleDependencies() const
+{
+	WriteLocker wl(&ruleDependenciesLock);
+	if (!ruleDependencies || !ruleDependencies->isBuiltFrom(rules)) {
+		ruleDependencies.reset(new RuleDependencies(rules, dimensions.size()));
+	}
+	return ruleDependencies;
+}
+
 void Cube::cellGoalSeek(PServer server, PDatabase db, CellValueContext::GoalSeekType gsType, PCubeArea cellPath, PArea gsArea, PUser user, boost::shared_ptr<PaloSession> session, const double &value, bool useJournal)
 {
 	checkCheckedOut();
@@ -3911,6 +4137,9 @@ bool Cube::merge(const CPCommitable &o, const PCommitable &p)
 		if (delCount == oldcube->delCount) {
 			delCount = cube->delCount;
 		}
+		if (deletedCells == oldcube->deletedCells) {
+			deletedCells = cube->deletedCells;
+		}
 	}
 	if (ret && cube != 0 && context->doTokenUpdate()) {
 		CPDatabase db = CONST_COMMITABLE_CAST(Database, p);
@@ -3921,6 +4150,10 @@ bool Cube::merge(const CPCommitable &o, const PCommitable &p)
 			rule->onCubeChange(db, cube);
 		}
 	}
+	if (ret && cube != 0) {
+		// values cached by the committed version, restored by updateCache
+		cache.inherit(cube->cache);
+	}
 	if (ret) {
 		commitintern();
 	}
@@ -4299,12 +4532,218 @@ bool Cube::hitMarkerRebuildLimit()
 	PServer server = Context::getContext()->getServerCopy();
 	if (server->enforceBuildMarkers()) {
 		delCount = 0;
+		deletedCells.clear();
 		return true;
 	} else {
 		StorageCpu *st = dynamic_cast<StorageCpu *>(server->getEngine()->getStorage(numericStorageId).get());
 		delCount += st->getLastDeletionCount();
-		return delCount >= markerRebuildLimit;
+		deletedCells.add(st->getLastDeletedCells());
+		st = dynamic_cast<StorageCpu *>(server->getEngine()->getStorage(stringStorageId).get());
+		if (st) {
+			deletedCells.add(st->getLastDeletedCells());
+		}
+		if (delCount >= markerRebuildLimit) {
+			delCount = 0;
+			deletedCells.clear();
+			return true;
+		}
+		return false;
+	}
+}
+
+bool Cube::updateDeletedMarkers()
+{
+	checkCheckedOut();
+	if (deletedCells.empty()) {
+		return false;
+	}
+	PArea deletedArea = deletedCells.getArea();
+	if (!deletedArea) {
+		return false;
+	}
+	Context *context = Context::getContext();
+	PServer server = context->getServerCopy();
+
+	// all targets are checked before the first marker is changed
+	vector<pair<dbID_cubeID, PArea> > targets;
+	for (RuleMarkerSet::iterator i = fromMarkers.begin(); i != fromMarkers.end(); ++i) {
+		const RuleMarker *marker = i->get();
+		dbID_cubeID toDbCube = marker->getToDbCube();
+		PDatabase toDB = server->lookupDatabase(toDbCube.first, false);
+		PCube toCube = toDB ? toDB->lookupCube(toDbCube.second, false) : PCube();
+		if (!toCube || toCube->getStatus() <= UNLOADED || toCube->isLocked()) {
+			return false;
+		}
+		PArea targetArea = getMarkerTarget(marker, deletedArea.get(), toDB, toCube);
+		if (targetArea) {
+			targets.push_back(make_pair(toDbCube, targetArea));
+		}
+	}
+	Logger::trace << "updating markers of " << targets.size() << " target areas of deleted cells in cube '" << getName() << "'" << endl;
+
+	PEngineBase engine = server->getEngine(EngineBase::CPU, true);
+	set<PCube> changedCubes;
+	for (vector<pair<dbID_cubeID, PArea> >::iterator i = targets.begin(); i != targets.end(); ++i) {
+		PCube toCube = addCubeToDatabase(server, i->first);
+		toCube->updateTargetMarkers(server, engine, server->lookupDatabase(i->first.first, false), i->second, changedCubes);
+	}
+	delCount = 0;
+	deletedCells.clear();
+
+	commitChanges(false, PUser(), changedCubes, false);
+	return true;
+}
+
+void Cube::updateTargetMarkers(PServer server, PEngineBase engine, CPDatabase db, CPArea targetArea, set<PCube> &changedCubes)
+{
+	PStorageBase storage = engine->getCreateStorage(markerStorageId, pathTranslator, EngineBase::Marker);
+	MarkerStorageCpu *st = dynamic_cast<MarkerStorageCpu*>(storage.get());
+
+	// remove the markers of the area
+	st->commitChanges(false, false, false);
+	PProcessorBase markers = engine->createProcessor(PPlanNode(new SourcePlanNode(markerStorageId, targetArea, getObjectRevision())), true);
+	size_t removed = 0;
+	while (markers->next()) {
+		st->setCellValue(markers->getKey(), CellValue::NullNumeric);
+		removed++;
+	}
+	if (!removed) {
+		return;
+	}
+	st->commitChanges(false, false, false);
+	changedCubes.insert(COMMITABLE_CAST(Cube, shared_from_this()));
+
+	// and generate them again from all sources
+	for (RuleMarkerSet::iterator i = toMarkers.begin(); i != toMarkers.end(); ++i) {
+		PRuleMarker marker = *i;
+		PArea sourceArea = getMarkerSource(marker.get(), targetArea.get());
+		if (!sourceArea) {
+			continue;
+		}
+		dbID_cubeID fromDbCube = marker->getFromDbCube();
+		PDatabase fromDB = server->lookupDatabase(fromDbCube.first, false);
+		PCube fromCube = fromDB ? fromDB->lookupCube(fromDbCube.second, false) : PCube();
+		if (!fromCube || fromCube->getStatus() <= UNLOADED) {
+			continue;
+		}
+
+		vector<Dimension*> markerDimensions;
+		if (marker->isMultiplicating()) {
+			const int16_t* perms = marker->getPermutations();
+			for (IdentifiersType::const_iterator idsIt = dimensions.begin(); idsIt != dimensions.end(); ++idsIt, perms++) {
+				if (*perms == MarkerStorage::ALL_ELEMENTS) {
+					markerDimensions.push_back(db->lookupDimension(*idsIt, false).get());
+				} else {
+					markerDimensions.push_back((Dimension*)0);
+				}
+			}
+		}
+
+		MarkerStorage ms(marker, dimensions.size(), marker->isMultiplicating() ? &markerDimensions : 0);
+		ms.generateMarkers(fromCube, sourceArea.get(), targetArea);
+
+		PCellStream cs = ms.getMarkers()->getValues();
+		while (cs->next()) {
+			setCellMarker(engine.get(), st, cs->getKey(), changedCubes);
+		}
+	}
+	Logger::trace << "removed " << removed << " markers of deleted cells in cube '" << getName() << "'" << endl;
+}
+
+PArea Cube::getMarkerTarget(const RuleMarker *marker, const Area *sourceArea, CPDatabase toDB, CPCube toCube)
+{
+	const Area *fromBase = marker->getFromBase().get();
+	for (size_t dim = 0; dim < fromBase->dimCount(); dim++) {
+		CPSet base = fromBase->getDim(dim);
+		if (!base || !base->size()) {
+			continue;
+		}
+		CPSet deleted = sourceArea->getDim(dim);
+		Set::Iterator id = deleted->begin();
+		while (id != deleted->end() && base->find(*id) == base->end()) {
+			++id;
+		}
+		if (id == deleted->end()) {
+			// no deleted cell inside the source of the marker
+			return PArea();
+		}
 	}
+
+	const IdentifiersType *dimIds = toCube->getDimensions();
+	const int16_t *perms = marker->getPermutations();
+	const uint32_t *fixed = marker->getFixed();
+	const RuleMarker::PMappingType *maps = marker->getMapping();
+
+	PArea result(new Area(dimIds->size()));
+	for (size_t dim = 0; dim < dimIds->size(); dim++) {
+		PSet s(new Set);
+		if (perms[dim] == MarkerStorage::FIXED_ELEMENT) {
+			s->insert(fixed[dim]);
+		} else if (perms[dim] == MarkerStorage::ALL_ELEMENTS) {
+			s = toDB->lookupDimension(dimIds->at(dim), false)->getElemIds(CubeArea::BASE_ELEMENTS);
+		} else {
+			CPSet base = fromBase->getDim(perms[dim]);
+			CPSet deleted = sourceArea->getDim(perms[dim]);
+			for (Set::Iterator id = deleted->begin(); id != deleted->end(); ++id) {
+				if (base && base->size() && base->find(*id) == base->end()) {
+					continue;
+				}
+				if (maps && maps[dim]) {
+					pair<RuleMarker::MappingType::const_iterator, RuleMarker::MappingType::const_iterator> range = maps[dim]->equal_range(*id);
+					for (RuleMarker::MappingType::const_iterator it = range.first; it != range.second; ++it) {
+						s->insert(it->second);
+					}
+				} else {
+					s->insert(*id);
+				}
+			}
+		}
+		if (s->empty()) {
+			return PArea();
+		}
+		result->insert(dim, s);
+	}
+	return result;
+}
+
+PArea Cube::getMarkerSource(const RuleMarker *marker, const Area *targetArea)
+{
+	const Area *fromBase = marker->getFromBase().get();
+	const int16_t *perms = marker->getPermutations();
+	const uint32_t *fixed = marker->getFixed();
+	const RuleMarker::PMappingType *maps = marker->getMapping();
+
+	PArea result(new Area(*fromBase));
+	for (size_t dim = 0; dim < targetArea->dimCount(); dim++) {
+		CPSet target = targetArea->getDim(dim);
+		if (perms[dim] == MarkerStorage::FIXED_ELEMENT) {
+			if (target->find(fixed[dim]) == target->end()) {
+				return PArea();
+			}
+		} else if (perms[dim] != MarkerStorage::ALL_ELEMENTS) {
+			// source elements mapped inside the target area
+			CPSet base = result->getDim(perms[dim]);
+			PSet s(new Set);
+			if (maps && maps[dim]) {
+				for (RuleMarker::MappingType::const_iterator it = maps[dim]->begin(); it != maps[dim]->end(); ++it) {
+					if (target->find(it->second) != target->end() && (!base || !base->size() || base->find(it->first) != base->end())) {
+						s->insert(it->first);
+					}
+				}
+			} else {
+				for (Set::Iterator id = target->begin(); id != target->end(); ++id) {
+					if (!base || !base->size() || base->find(*id) != base->end()) {
+						s->insert(*id);
+					}
+				}
+			}
+			if (s->empty()) {
+				return PArea();
+			}
+			result->insert(perms[dim], s);
+		}
+	}
+	return result;
 }
 
 void Cube::clearAllMarkers()
@@ -4327,6 +4766,7 @@ void Cube::rebuildAllMarkers()
 		addFromMarker(*i, &changedCubes);
 	}
 	delCount = 0;
+	deletedCells.clear();
 
 	commitChanges(false, PUser(), changedCubes, false);
 }
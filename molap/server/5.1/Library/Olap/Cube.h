@@ -45,6 +45,8 @@
 #include "Olap/Element.h"
 #include "Worker/CubeWorker.h"
 #include "Olap/RulesList.h"
+#include "Olap/RuleDependencies.h"
+#include "Olap/PlanCache.h"
 #include "Olap/Context.h"
 #include "Engine/EngineBase.h"
 #include "Engine/Streams.h"
@@ -540,6 +542,16 @@ public:
 		changedCubes.clear();
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief restores the base cells of a stream without splashing
+	///
+	/// Used by rollbacks. The values are journaled and written to the storages
+	/// until the next commitChanges. Returns false without reading the stream
+	/// if the cube needs the cell by cell path (markers or gpu).
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool restoreCellValues(PServer server, PCellStream values, PUser user);
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief sets a value to a cell
 	////////////////////////////////////////////////////////////////////////////////
@@ -577,6 +589,32 @@ public:
 
 	virtual bool invalidateCache();
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief restores the cache of the version this cube was merged with
+	///
+	/// Keeps all cached values except the ones in the affected area, the cells
+	/// depending on the changed cells according to the rule dependency graph.
+	/// Returns false if the cache has to be invalidated completely or the old
+	/// cache was cleared meanwhile.
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool updateCache(CPDatabase db, const Area &affected);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief removes the cached values of the affected area
+	///
+	/// Used for cubes reading changed cells of another cube. Returns false if
+	/// the cache has to be invalidated completely.
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool invalidateCachedArea(CPDatabase db, const Area &affected);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the dependency graph of the active rules
+	////////////////////////////////////////////////////////////////////////////////
+
+	CPRuleDependencies getRuleDependencies() const;
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief disable all dim's rules when dim is cleared
 	////////////////////////////////////////////////////////////////////////////////
@@ -623,6 +661,17 @@ public:
 
 	bool hitMarkerRebuildLimit();
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief updates the markers of the cells deleted since the last rebuild
+	///
+	/// The markers inside the targets of the deleted cells are removed and
+	/// generated again from all sources of the target cubes. Returns false if
+	/// no cell was deleted or the area of the deleted cells is unknown, the
+	/// markers are then kept until the next rebuild.
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool updateDeletedMarkers();
+
 	void clearAllMarkers();
 
 	void rebuildAllMarkers();
@@ -711,10 +760,15 @@ private:
 	void checkFromMarkers(EngineBase *engine, const IdentifiersType &key, set<PCube> &changedCubes);
 	bool checkMarkerInvalidation(const Area *area, StorageBase *storageCpu) const;
 	bool checkMarkerInvalidation(SubCubeList &areas) const;
+	void updateTargetMarkers(PServer server, PEngineBase engine, CPDatabase db, CPArea targetArea, set<PCube> &changedCubes);
+	static PArea getMarkerTarget(const RuleMarker *marker, const Area *sourceArea, CPDatabase toDB, CPCube toCube);
+	static PArea getMarkerSource(const RuleMarker *marker, const Area *targetArea);
 	PLock findCellLock(const IdentifiersType &key) const;
 	bool checkDimensions(CPDatabase db);
 	void checkValueLocks(PCellStream oldvals, PUser user, StorageBase *storage);
 	void commitChangesIntern(bool checkLocks, PUser user, bool disjunctive);
+	bool isPlanCachable(CPCube thisCube, RulesType rulesType) const;
+	bool setBaseNumericValues(const CellValueContext *cvc, User::RightSetting &rs);
 
 public:
 	void checkCubeRuleRight(PUser user, RightsType minimumRight) const;
@@ -746,6 +800,16 @@ public:
 
 	ValueCache *getCache() const {return const_cast<ValueCache *>(&cache);}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief lock serializing cell writers of this cube
+	///
+	/// Two writers of the same cube can't be merged, the second one would have
+	/// to repeat its work. Cell jobs hold this lock while they compute and commit
+	/// their changes, writers of other cubes and databases are not affected.
+	////////////////////////////////////////////////////////////////////////////////
+
+	PSharedMutex getCommitLock() const {return commitlock;}
+
 #ifdef ENABLE_GPU_SERVER
 	bool optimizeNumericStorage(PEngineBase engine);
 #endif
@@ -791,6 +855,7 @@ protected:
 
 	PSharedMutex filelock;
 	PSharedMutex rulefilelock;
+	PSharedMutex commitlock; // shared by all versions of the cube
 
 	SaveType saveType;
 
@@ -799,11 +864,14 @@ protected:
 	PPathTranslator pathTranslator;
 
 	ValueCache cache;
+	mutable CPRuleDependencies ruleDependencies;
+	mutable PlanCache planCache;
 
 	AsyncResults pendingWrites;
 	bool additiveCommit;
 
 	uint64_t delCount;
+	DeletedCells deletedCells;
 };
 
 }
@@ -52,6 +52,7 @@
 #include "InputOutput/JournalFileReader.h"
 
 #include "Worker/DimensionWorker.h"
+#include "Thread/ThreadPool.h"
 
 
 #define NEW_RIGHTS_CALC
@@ -59,6 +60,8 @@
 namespace palo {
 
 const size_t Dimension::MAX_ELEMS_IN_VECTOR = 100000;
+const size_t Dimension::PARALLEL_INFO_ELEMENTS = 100000;
+bool Dimension::incrementalUpdate = true;
 
 ////////////////////////////////////////////////////////////////////////////////
 // functions to load and save a dimension
@@ -477,6 +480,7 @@ void Dimension::loadDimension(PServer server, PDatabase db, FileReader* file)
 	setStatus(db, LOADED);
 
 	changedElementsInfo = true;
+	incrementalElementsInfo = false;
 
 	updateElementsInfo();
 }
@@ -766,6 +770,8 @@ void Dimension::clearElements(PServer server, PDatabase db, PUser user, bool use
 		maxDepth = 0;
 
 		changedElementsInfo = false;
+		changedParents.clear();
+		changedChildren.clear();
 
 		PJournalMem journal = db->getJournal();
 
@@ -1139,6 +1145,9 @@ Element* Dimension::addElement(PServer server, PDatabase db, IdentifierType idEl
 	maxId = max(maxId, newElement.getIdentifier());
 	minId = min(minId, newElement.getIdentifier());
 
+	// an element created with an explicit identifier can lie inside a gap of the merge index
+	removeFromMergeIndex(newElement.getIdentifier());
+
 	PJournalMem journal = db->getJournal();
 
 	if (useJournal && journal != 0) {
@@ -1183,6 +1192,30 @@ void Dimension::addElementEvent(PServer server, PDatabase db, IdentifierType ele
 	}
 }
 
+void Dimension::addElementsEvent(PServer server, PDatabase db, const ElementsType &elements)
+{
+	PDimensionWorker worker = server->getDimensionWorker();
+	if (worker && !elements.empty()) {
+		bool ok = worker->start();
+		if (!ok) {
+			throw ErrorException(ErrorException::ERROR_WORKER_MESSAGE, "cannot start dimension worker");
+		}
+
+		long function;
+		if (worker->triggerCreateElement(db->getId(), getId(), function)) {
+			IdentifiersType elemIds;
+			for (ElementsType::const_iterator it = elements.begin(); it != elements.end(); ++it) {
+				elemIds.push_back((*it)->getIdentifier());
+			}
+			boost::shared_ptr<PaloSession> session = Context::getContext()->getSession();
+			ResultStatus status = worker->notifyElementsCreated(db->getId(), getId(), elemIds, function, session ? session->getSid() : "");
+			if (status != RESULT_OK) {
+				throw ErrorException(ErrorException::ERROR_WORKER_MESSAGE, "cannot send element create notification to worker");
+			}
+		}
+	}
+}
+
 void Dimension::changeElementName(PServer server, PDatabase db, Element *element, const string &name, PUser user, bool useJournal, bool useDimWorker)
 {
 	checkElementAccessRight(user.get(), db, RIGHT_WRITE);
@@ -1466,6 +1499,7 @@ void Dimension::updateLevel(Element *element, const vector<Element *> &newChildr
 void Dimension::addChildren(PServer server, PDatabase db, Element *parent, const IdentifiersWeightType *children, PUser user, CubeRulesArray* disabledRules, bool preserveOrder, bool updateElementInfo, bool useJournal, IdentifiersType *elemsToDeleteFromCubes)
 {
 	bool changedElementsInfoOld = changedElementsInfo;
+	bool incrementalOld = !changedElementsInfo || incrementalElementsInfo;
 	checkCheckedOut();
 	elementList->checkCheckedOut();
 
@@ -1549,6 +1583,7 @@ void Dimension::addChildren(PServer server, PDatabase db, Element *parent, const
 
 	Element::Type oldType = parent->getElementType();
 	bool oldISC = parent->isStringConsolidation();
+	bool hadChildren = !parent->getChildren()->empty();
 
 	// set type of parent
 	bool baseToCons = false;
@@ -1573,9 +1608,23 @@ void Dimension::addChildren(PServer server, PDatabase db, Element *parent, const
 		}
 	}
 
-	if (!updateElementInfo || changedElementsInfoOld) { // we dont want to update just one element || there is already more changes anyway
+	if (!updateElementInfo || changedElementsInfoOld || !incrementalUpdate) { // we dont want to update just one element || there is already more changes anyway
 		// elements info will be updated in merge or before (in jobs)
 		changedElementsInfo = true;
+
+		// new children only change the ancestors of the parent and the descendants of the children
+		incrementalElementsInfo = incrementalUpdate && incrementalOld && (preserveOrder || !hadChildren);
+		if (incrementalElementsInfo) {
+			changedParents.push_back(parent->getIdentifier());
+			for (IdentifiersWeightType::const_iterator it = children->begin(); it != children->end(); ++it) {
+				if (oldWeights.find(it->first) == oldWeights.end()) {
+					changedChildren.push_back(it->first);
+				}
+			}
+		} else {
+			changedParents.clear();
+			changedChildren.clear();
+		}
 	} else {
 		// update element info right here
 		changedElementsInfo = false;
@@ -1654,6 +1703,7 @@ void Dimension::addChildrenNC(PServer server, PDatabase db, PUser user, Element
 {
 	// the level structure will change
 	changedElementsInfo = true;
+	incrementalElementsInfo = false;
 
 	// get our children
 	IdentifiersWeightType *elementChildren = parent->getChildren(true);
@@ -1849,6 +1899,7 @@ void Dimension::removeChildren(PServer server, PDatabase db, PUser user, Element
 
 	// the level structure will change
 	changedElementsInfo = true;
+	incrementalElementsInfo = false;
 
 	// element found in mapping "parent to children", remove element in parents
 	removeParentInChildren(element, children);
@@ -1924,6 +1975,7 @@ void Dimension::removeChildrenNotIn(PServer server, PDatabase db, PUser user, El
 
 	// the level structure will change
 	changedElementsInfo = true;
+	incrementalElementsInfo = false;
 
 	// element found in mapping "parent to children", remove element in parents
 	removeParentInChildren(element, children, keep);
@@ -2059,6 +2111,7 @@ void Dimension::changeElementType(PServer server, PDatabase db, Element *element
 
 	// elements info will be updated in merge or before (in jobs)
 	changedElementsInfo = true;
+	incrementalElementsInfo = false;
 
 	PJournalMem journal = db->getJournal();
 
@@ -2135,6 +2188,7 @@ void Dimension::deleteElements(PServer server, PDatabase db, IdentifiersType ele
 
 	// the level structure might change
 	changedElementsInfo = true;
+	incrementalElementsInfo = false;
 
 	std::vector<pair<PositionType, Element*> > deletedPositions;
 	vector<string> deletedNames;
@@ -2214,6 +2268,7 @@ void Dimension::deleteElements(PServer server, PDatabase db, IdentifiersType ele
 
 	// elements info will be updated in merge or before (in jobs)
 	changedElementsInfo = true;
+	incrementalElementsInfo = false;
 
 	if (useDimWorker) {
 		updateElementsInfo();
@@ -2243,11 +2298,9 @@ void Dimension::deleteElementsEvent(PServer server, PDatabase db, const vector<s
 		long function;
 		if (worker->triggerDestroyElement(db->getId(), getId(), function)) {
 			boost::shared_ptr<PaloSession> session = Context::getContext()->getSession();
-			for (vector<string>::const_iterator it = deletedNames.begin(); it != deletedNames.end(); ++it) {
-				ResultStatus status = worker->notifyElementDestroyed(db->getId(), getId(), *it, function, session ? session->getSid() : "");
-				if (status != RESULT_OK) {
-					throw ErrorException(ErrorException::ERROR_WORKER_MESSAGE, "cannot send element destroy notification to worker");
-				}
+			ResultStatus status = worker->notifyElementsDestroyed(db->getId(), getId(), deletedNames, function, session ? session->getSid() : "");
+			if (status != RESULT_OK) {
+				throw ErrorException(ErrorException::ERROR_WORKER_MESSAGE, "cannot send element destroy notification to worker");
 			}
 		}
 	}
@@ -2395,7 +2448,14 @@ void Dimension::updateElementBaseElements(IdentifiersType &sortedElements)
 	// as we are rebuilding merge info in the following loop let's clear the merge index first
 	clearMergeIndex();
 
-	for (IdentifiersType::reverse_iterator i = sortedElements.rbegin(); i != sortedElements.rend(); ++i) {
+	if (!updateBaseElementsParallel(sortedElements)) {
+		updateBaseElements(sortedElements);
+	}
+}
+
+void Dimension::updateBaseElements(const IdentifiersType &sortedElements)
+{
+	for (IdentifiersType::const_reverse_iterator i = sortedElements.rbegin(); i != sortedElements.rend(); ++i) {
 		Element *element = &(*elementList)[*i];
 
 		if (element->getElementType() == Element::UNDEFINED || element->getElementType() == Element::STRING) {
@@ -2403,35 +2463,132 @@ void Dimension::updateElementBaseElements(IdentifiersType &sortedElements)
 		}
 
 		element = lookupElement(element->getIdentifier(), true);
+		buildBaseElements(element);
+		addToMergeIndex(element);
+	}
+}
 
-		if (element->getBaseElements() && element->getBaseElements()->size() > 0) {
-			element->baseElementsClear();
-		}
+void Dimension::buildBaseElements(Element *element) const
+{
+	if (element->getBaseElements() && element->getBaseElements()->size() > 0) {
+		element->baseElementsClear();
+	}
 
-		const IdentifiersWeightType *childrenIds = element->getChildren();
-		if (childrenIds && childrenIds->size()) {
+	const IdentifiersWeightType *childrenIds = element->getChildren();
+	if (childrenIds && childrenIds->size()) {
 
-			WeightedSet *baseElements = element->getBaseElements(true);
+		WeightedSet *baseElements = element->getBaseElements(true);
 
-			for (IdentifiersWeightType::const_iterator i = childrenIds->begin(); i != childrenIds->end(); ++i) {
-				Element *child = lookupElement(i->first, false);
-				const WeightedSet *basesOfChild = child->getBaseElements();
-				double weight = i->second;
+		for (IdentifiersWeightType::const_iterator i = childrenIds->begin(); i != childrenIds->end(); ++i) {
+			Element *child = lookupElement(i->first, false);
+			const WeightedSet *basesOfChild = child->getBaseElements();
+			double weight = i->second;
 
-				if (!basesOfChild || basesOfChild->size() == 0) {
-					baseElements->fastAdd(child->getIdentifier(), weight);
-				} else {
-					for (WeightedSet::const_iterator c = basesOfChild->begin(); c != basesOfChild->end(); ++c) {
-						baseElements->fastAdd(c.first(), weight * c.second());
-					}
+			if (!basesOfChild || basesOfChild->size() == 0) {
+				baseElements->fastAdd(child->getIdentifier(), weight);
+			} else {
+				for (WeightedSet::const_iterator c = basesOfChild->begin(); c != basesOfChild->end(); ++c) {
+					baseElements->fastAdd(c.first(), weight * c.second());
 				}
 			}
+		}
+
+		baseElements->consolidate();
+	}
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// base elements of a part of one level
+// /////////////////////////////////////////////////////////////////////////////
 
-			baseElements->consolidate();
+class Dimension::BaseElementsJob : public ThreadPoolJob {
+public:
+	BaseElementsJob(ThreadPool::ThreadGroup &tg, const Dimension &dimension, vector<Element *>::const_iterator begin, vector<Element *>::const_iterator end) :
+		ThreadPoolJob(tg), dimension(dimension), begin(begin), end(end) {}
+
+	// the elements were checked out by the requesting thread, the children of a level are only read
+	virtual void operator()() {
+		for (vector<Element *>::const_iterator it = begin; it != end; ++it) {
+			dimension.buildBaseElements(*it);
 		}
+	}
 
-		addToMergeIndex(element);
+private:
+	const Dimension &dimension;
+	vector<Element *>::const_iterator begin;
+	vector<Element *>::const_iterator end;
+};
+
+bool Dimension::updateBaseElementsParallel(const IdentifiersType &sortedElements)
+{
+	if (sortedElements.size() < PARALLEL_INFO_ELEMENTS) {
+		return false;
 	}
+
+	Context *context = Context::getContext();
+	PServer server = context->getServer();
+	PThreadPool tp = server ? server->getThreadPool() : PThreadPool();
+
+	if (!tp || tp->getCoreCount() < 2 || !tp->hasFreeCore(false)) {
+		return false;
+	}
+
+	// check out all elements in this thread, base elements of level 0 are built right here
+	vector<vector<Element *> > levels(maxLevel + 1);
+	vector<Element *> elements;
+	elements.reserve(sortedElements.size());
+
+	for (IdentifiersType::const_reverse_iterator i = sortedElements.rbegin(); i != sortedElements.rend(); ++i) {
+		Element *element = &(*elementList)[*i];
+
+		if (element->getElementType() == Element::UNDEFINED || element->getElementType() == Element::STRING) {
+			continue;
+		}
+
+		element = lookupElement(element->getIdentifier(), true);
+		elements.push_back(element);
+
+		if (element->getLevel() == 0) {
+			buildBaseElements(element);
+		} else {
+			levels[element->getLevel()].push_back(element);
+		}
+	}
+
+	// children have lower levels, all elements of one level can be built at once
+	size_t cores = tp->getCoreCount();
+	for (vector<vector<Element *> >::const_iterator level = levels.begin(); level != levels.end(); ++level) {
+		if (level->empty()) {
+			continue;
+		}
+
+		size_t parts = min(cores, level->size() / 1000 + 1);
+		ThreadPool::ThreadGroup tg = tp->createThreadGroup();
+		vector<PThreadPoolJob> jobs;
+
+		vector<Element *>::const_iterator begin = level->begin();
+		for (size_t part = 0; part < parts; part++) {
+			vector<Element *>::const_iterator end = begin + (level->end() - begin) / (parts - part);
+			jobs.push_back(PThreadPoolJob(new BaseElementsJob(tg, *this, begin, end)));
+			begin = end;
+		}
+
+		for (vector<PThreadPoolJob>::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+			if (job + 1 != jobs.end() && tp->hasFreeCore(false)) {
+				tp->addJob(*job);
+			} else {
+				(*static_cast<BaseElementsJob *>(job->get()))();
+			}
+		}
+		tp->join(tg);
+	}
+
+	// the merge index is not synchronized
+	for (vector<Element *>::const_iterator it = elements.begin(); it != elements.end(); ++it) {
+		addToMergeIndex(*it);
+	}
+
+	return true;
 }
 
 void Dimension::updateElementsInfo()
@@ -2443,12 +2600,20 @@ void Dimension::updateElementsInfo()
 	checkCheckedOut();
 	elementList->checkCheckedOut();
 
+	if (incrementalElementsInfo && !changedParents.empty()) {
+		updateChangedElementsInfo();
+		return;
+	}
+
 	// clear all info
 	maxLevel = 0;
 	maxIndent = 0;
 	maxDepth = 0;
 
 	changedElementsInfo = false;
+	incrementalElementsInfo = false;
+	changedParents.clear();
+	changedChildren.clear();
 
 	IdentifiersType sortedElements;
 	BitVector knownElements;
@@ -2459,46 +2624,91 @@ void Dimension::updateElementsInfo()
 	// update the topological sorted list of elements
 	updateTopologicalSortedElements(sortedElements, knownElements);
 
+	// update level, the parallel update of base elements needs the levels
+	updateLevel(sortedElements);
+
 	// Need to make sure base elements are correctly specified
 	updateElementBaseElements(sortedElements);
 
-	// update level
-	updateLevel(sortedElements);
-
 	// update depth and indent
-	for (IdentifiersType::const_iterator i = sortedElements.begin(); i != sortedElements.end(); ++i) {
-		Element *element = &(*elementList)[*i];
-
-		DepthType depth = 0;
-		IndentType indent = 1;
+	updateDepthAndIndent(sortedElements);
+}
 
-		CPParents parents = element->getParents();
-		if (parents) {
-			// depth
-			for (Parents::const_iterator i = parents->begin(); i != parents->end(); ++i) {
-				Element *parent = lookupElement(*i, false);
+void Dimension::updateChangedElementsInfo()
+{
+	BitVector knownElements;
+	knownElements.resize(elementList->size());
 
-				if (indent == 1) {
-					// first parent
-					indent = parent->indent + 1;
-				}
-				DepthType d = parent->depth; // firstParent->getDepth(this);
-				if (depth <= d) {
-					depth = d + 1;
-				}
-			}
+	// changed parents and all their ancestors, parents first
+	IdentifiersType ancestors;
+	for (IdentifiersType::const_iterator it = changedParents.begin(); it != changedParents.end(); ++it) {
+		Element *parent = lookupElement(*it, false);
+		if (!parent) {
+			continue;
+		}
+		IdentifierType internalId = (*idsMap)[*it];
+		if (!knownElements[internalId]) {
+			addParrentsToSortedList(parent, ancestors, knownElements);
+			ancestors.push_back(internalId);
+			knownElements[internalId] = true;
 		}
+	}
 
-		if (maxDepth < depth) {
-			maxDepth = depth;
+	// new children and all their descendants, children first
+	knownElements.assign(knownElements.size(), false);
+	IdentifiersType descendants;
+	for (IdentifiersType::const_iterator it = changedChildren.begin(); it != changedChildren.end(); ++it) {
+		Element *child = lookupElement(*it, false);
+		if (!child) {
+			continue;
+		}
+		IdentifierType internalId = (*idsMap)[*it];
+		if (!knownElements[internalId]) {
+			addChildrenToSortedList(child, descendants, knownElements);
+			descendants.push_back(internalId);
+			knownElements[internalId] = true;
 		}
 
-		if (maxIndent < indent) {
-			maxIndent = indent;
+		// a new child can lie inside a gap of the merge index
+		removeFromMergeIndex(*it);
+	}
+	reverse(descendants.begin(), descendants.end());
+
+	changedElementsInfo = false;
+	incrementalElementsInfo = false;
+	changedParents.clear();
+	changedChildren.clear();
+
+	// the levels of other elements are unchanged, maximal values can only grow
+	updateLevel(ancestors);
+	updateBaseElements(ancestors);
+	updateDepthAndIndent(descendants);
+}
+
+void Dimension::addChildrenToSortedList(Element *parent, IdentifiersType &sortedElements, BitVector &knownElements)
+{
+	const IdentifiersWeightType *children = parent->getChildren();
+
+	if (!children) {
+		return;
+	}
+
+	for (IdentifiersWeightType::const_iterator it = children->begin(); it != children->end(); ++it) {
+		Element *child = lookupElement(it->first, false);
+
+		if (!child) {
+			throw ParameterException(ErrorException::ERROR_ELEMENT_NOT_FOUND, "element with id '" + StringUtils::convertToString(it->first) + "' not found in dimension '" + getName() + "'", "id", it->first);
 		}
 
-		element->setDepth(depth);
-		element->setIndent(indent);
+		IdentifierType internalId = (*idsMap)[child->getIdentifier()];
+
+		if (!knownElements[internalId]) {
+			// add children
+			addChildrenToSortedList(child, sortedElements, knownElements);
+			// add element
+			sortedElements.push_back(internalId);
+			knownElements[internalId] = true;
+		}
 	}
 }
 
@@ -2506,7 +2716,7 @@ void Dimension::updateLevel(IdentifiersType &sortedElements)
 {
 	//called from Dimension.merge
 	for (IdentifiersType::reverse_iterator i = sortedElements.rbegin(); i != sortedElements.rend(); ++i) {
-		Element *element = &(*elementList)[*i];
+		Element *element = lookupElementByInternal(*i, true);
 
 		LevelType level = 0;
 
@@ -2529,6 +2739,44 @@ void Dimension::updateLevel(IdentifiersType &sortedElements)
 	}
 }
 
+void Dimension::updateDepthAndIndent(const IdentifiersType &sortedElements)
+{
+	for (IdentifiersType::const_iterator i = sortedElements.begin(); i != sortedElements.end(); ++i) {
+		Element *element = lookupElementByInternal(*i, true);
+
+		DepthType depth = 0;
+		IndentType indent = 1;
+
+		CPParents parents = element->getParents();
+		if (parents) {
+			// depth
+			for (Parents::const_iterator i = parents->begin(); i != parents->end(); ++i) {
+				Element *parent = lookupElement(*i, false);
+
+				if (indent == 1) {
+					// first parent
+					indent = parent->indent + 1;
+				}
+				DepthType d = parent->depth; // firstParent->getDepth(this);
+				if (depth <= d) {
+					depth = d + 1;
+				}
+			}
+		}
+
+		if (maxDepth < depth) {
+			maxDepth = depth;
+		}
+
+		if (maxIndent < indent) {
+			maxIndent = indent;
+		}
+
+		element->setDepth(depth);
+		element->setIndent(indent);
+	}
+}
+
 void Dimension::removeElementFromCubes(PServer server, PDatabase db, PUser user, IdentifierType element, CubeRulesArray* disabledRules, DeleteCellType delType, bool completeRemove)
 {
 	db->checkCheckedOut(); // database can be modified
@@ -2587,6 +2835,17 @@ void Dimension::checkElementName(const string& name)
 }
 
 
+void Dimension::removeFromMergeIndex(IdentifierType elementIdentifier)
+{
+	map<IdentifierType, IdentifierType>::iterator gap = mergeNext.lower_bound(elementIdentifier);
+	if (gap != mergeNext.begin()) {
+		--gap;
+		if (elementIdentifier < gap->second) {
+			mergeNext.erase(gap);
+		}
+	}
+}
+
 void Dimension::addToMergeIndex(Element *element)
 {
 	bool showDebug = false;
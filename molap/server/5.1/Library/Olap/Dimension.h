@@ -117,7 +117,7 @@ public:
 	Dimension(const string& name, SaveType saveType) :
 		Commitable(name), token(rand()), status(CHANGED), deletable(true), renamable(true), changable(true), saveType(saveType),
 		elementList(PElementList(new ElementList())), idsMap(PIdIdSlimMap(new IdIdSlimMap(4096))), namesMap(PNameIdSlimMap(new NameIdSlimMap(4096))),
-		posIndex(PIdVector(new IdVector())), maxId(0), minId(0), maxLevel(0), maxIndent(0), maxDepth(0), changedElementsInfo(false), m_bIsRightObject(false),
+		posIndex(PIdVector(new IdVector())), maxId(0), minId(0), maxLevel(0), maxIndent(0), maxDepth(0), changedElementsInfo(false), incrementalElementsInfo(false), m_bIsRightObject(false),
 		attribCube(false), rightCube(false)
 	{
 		if (!token) {
@@ -144,7 +144,8 @@ public:
 	Dimension(const Dimension &dim) :
 		Commitable(dim), token(dim.token), status(dim.status), deletable(dim.deletable), renamable(dim.renamable), changable(dim.changable), protectedElems(dim.protectedElems), saveType(dim.saveType),
 		elementList(dim.elementList), idsMap(dim.idsMap), namesMap(dim.namesMap), posIndex(dim.posIndex), maxId(dim.maxId), minId(dim.minId), maxLevel(dim.maxLevel),
-		maxIndent(dim.maxIndent), maxDepth(dim.maxDepth), changedElementsInfo(dim.changedElementsInfo), m_bIsRightObject(dim.m_bIsRightObject),
+		maxIndent(dim.maxIndent), maxDepth(dim.maxDepth), changedElementsInfo(dim.changedElementsInfo), incrementalElementsInfo(dim.incrementalElementsInfo),
+		changedParents(dim.changedParents), changedChildren(dim.changedChildren), m_bIsRightObject(dim.m_bIsRightObject), mergeNext(dim.mergeNext),
 		attribCube(dim.attribCube), rightCube(dim.rightCube)
 	{
 	}
@@ -340,6 +341,7 @@ public:
 
 	void addElementEvent(PServer server, PDatabase db, Element *element);
 	void addElementEvent(PServer server, PDatabase db, IdentifierType elemId, string sessionId = "");
+	void addElementsEvent(PServer server, PDatabase db, const ElementsType &elements);
 
 	virtual void deleteElement(PServer server, PDatabase db, Element *element, PUser user, bool useJournal, CubeRulesArray* disabledRules, bool useDimWorker);
 
@@ -431,6 +433,15 @@ public:
 
 	void updateElementsInfo();
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief updates only the elements affected by new children if enabled,
+	/// tests and benchmarks compare it with the update of all elements
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void setIncrementalElementsInfo(bool enabled) {
+		incrementalUpdate = enabled;
+	}
+
 	virtual const StringVector & getElemNamesVector() const {
 		return namesMap->getStringVector();
 	}
@@ -516,16 +527,52 @@ private:
 
 	void updateLevel(IdentifiersType &sortedElements);
 
+	void updateDepthAndIndent(const IdentifiersType &sortedElements);
+
 	void checkElementName(const string& name);
 
 	void addParrentsToSortedList(Element *child, IdentifiersType &sortedElements, BitVector &knownElements);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief adds all descendants of the element, children before parents
+	////////////////////////////////////////////////////////////////////////////////
+
+	void addChildrenToSortedList(Element *parent, IdentifiersType &sortedElements, BitVector &knownElements);
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief updates base element list of each element and rebuilds merge index
+	///
+	/// The levels must be up to date. Large dimensions are updated level by
+	/// level, the elements of one level are distributed to the thread pool.
 	////////////////////////////////////////////////////////////////////////////////
 
 	void updateElementBaseElements(IdentifiersType &sortedElements);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief updates base element lists of the sorted elements, children first
+	////////////////////////////////////////////////////////////////////////////////
+
+	void updateBaseElements(const IdentifiersType &sortedElements);
+
+	bool updateBaseElementsParallel(const IdentifiersType &sortedElements);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief builds the base element list of a checked out element
+	////////////////////////////////////////////////////////////////////////////////
+
+	void buildBaseElements(Element *element) const;
+
+	class BaseElementsJob;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief updates the elements info of the ancestors of the changed parents
+	///
+	/// Base elements and levels are updated for all ancestors of the changed
+	/// parents, depth and indent for all descendants of the changed children.
+	////////////////////////////////////////////////////////////////////////////////
+
+	void updateChangedElementsInfo();
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief updates the list of topological sorted elements
 	////////////////////////////////////////////////////////////////////////////////
@@ -552,6 +599,12 @@ private:
 		mergeNext.clear();
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief removes the gap of the merge index containing the element
+	////////////////////////////////////////////////////////////////////////////////
+
+	void removeFromMergeIndex(IdentifierType elementIdentifier);
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief creates a writable copy of elementList and indexes
 	////////////////////////////////////////////////////////////////////////////////
@@ -602,6 +655,13 @@ private:
 	bool changedElementsInfo;	// true if the list of elements has to be updated, base elements, Levels, Indent, Depth, maxLevel -
 	// can be set only in new version copy and commit must update element and reset this flag
 
+	bool incrementalElementsInfo;	// true if all changes since the last update are new children listed below
+	IdentifiersType changedParents;		// elements with new children since the last update
+	IdentifiersType changedChildren;	// elements with new parents since the last update
+
+	static const size_t PARALLEL_INFO_ELEMENTS;	// minimal number of elements for a parallel update of base elements
+	static bool incrementalUpdate;
+
 	bool m_bIsRightObject; // this is #_RIGHT_OBJECT_ dimension
 
 	static const size_t MAX_ELEMS_IN_VECTOR;
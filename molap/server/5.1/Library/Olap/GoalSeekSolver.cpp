@@ -28,8 +28,10 @@
 
 #include "GoalSeekSolver.h"
 #include "Exceptions/ParameterException.h"
-
-#include <time.h>
+#include "InputOutput/Metrics.h"
+#include "Olap/Context.h"
+#include "Olap/Server.h"
+#include "Thread/ThreadPool.h"
 
 namespace palo {
 namespace goalseeksolver {
@@ -56,11 +58,11 @@ struct State {
 	std::vector<std::map<int, std::vector<double> > > pm_rows;
 	std::vector<double> variable;
 	std::vector<bool> variable_set;
-	time_t timeoutExpiryTime;
+	uint64_t timeoutExpiryTime;
 	bool checkTimeout;
 
 	void CheckTimeout() const {
-		if (checkTimeout && clock() > timeoutExpiryTime)
+		if (checkTimeout && Metrics::now() > timeoutExpiryTime)
 			throw CalculationTimeoutException();
 	}
 
@@ -239,7 +241,188 @@ void set_variable(State& s, int c, double v, bool diagonal)
 	}
 }
 
-Result solve(const Problem& p, int timeoutMiliSec)
+//minimal number of variables for the sparse solver
+static int sparseVariables = 200;
+
+void setSparseVariables(int count)
+{
+	sparseVariables = count;
+}
+
+//minimal number of matrix elements for a parallel multiplication
+const static int parallelNonzeros = 50000;
+
+class MultiplyJob : public ThreadPoolJob {
+public:
+	MultiplyJob(ThreadPool::ThreadGroup &tg, const CSR& m, const std::vector<double>& x, std::vector<double>& y, int beginRow, int endRow) :
+		ThreadPoolJob(tg), m(m), x(x), y(y), beginRow(beginRow), endRow(endRow) {
+	}
+
+	virtual void operator()() {
+		m.multiply(x, y, beginRow, endRow);
+	}
+
+private:
+	const CSR& m;
+	const std::vector<double>& x;
+	std::vector<double>& y;
+	int beginRow;
+	int endRow;
+};
+
+void multiply(const CSR& m, const std::vector<double>& x, std::vector<double>& y, PThreadPool tp)
+{
+	y.resize(m.row_count());
+	int parts = tp ? (int)min(tp->getCoreCount(), (size_t)(m.nonzero_count() / parallelNonzeros)) : 0;
+	if (parts < 2 || !tp->hasFreeCore(false)) {
+		m.multiply(x, y, 0, m.row_count());
+		return;
+	}
+
+	ThreadPool::ThreadGroup tg = tp->createThreadGroup();
+	std::vector<PThreadPoolJob> jobs;
+	int beginRow = 0;
+	for (int part = 0; part < parts; part++) {
+		int endRow = beginRow + (m.row_count() - beginRow) / (parts - part);
+		jobs.push_back(PThreadPoolJob(new MultiplyJob(tg, m, x, y, beginRow, endRow)));
+		beginRow = endRow;
+	}
+	for (std::vector<PThreadPoolJob>::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+		if (job + 1 != jobs.end() && tp->hasFreeCore(false)) {
+			tp->addJob(*job);
+		} else {
+			(*static_cast<MultiplyJob *>(job->get()))();
+		}
+	}
+	tp->join(tg);
+}
+
+double dot(const std::vector<double>& a, const std::vector<double>& b)
+{
+	double sum = 0;
+	for (size_t i = 0; i < a.size(); i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+double max_abs(const std::vector<double>& a)
+{
+	double m = 0;
+	for (size_t i = 0; i < a.size(); i++)
+		m = max(m, fabs(a[i]));
+	return m;
+}
+
+//one row for each line of siblings, the weighted sums of the rows have to be kept
+void build_sparse(State& s, CSR& m, std::vector<double>& sums)
+{
+	int dc = (int)s.p.dimensionElementWeight.size();
+	std::vector<int> stride(dc);
+	int st = 1;
+	for (int d = dc - 1; d >= 0; d--) {
+		stride[d] = st;
+		st *= (int)s.p.dimensionElementWeight[d].size();
+	}
+
+	for (int d = 0; d < dc; d++) {
+		const std::vector<double>& weights = s.p.dimensionElementWeight[d];
+		int ec = (int)weights.size();
+		int lines = s.variableCount / ec;
+		for (int l = 0; l < lines; l++) {
+			int start = l / stride[d] * stride[d] * ec + l % stride[d];
+			double sum = 0;
+			for (int e = 0; e < ec; e++) {
+				if (eps::zero(weights[e]))
+					continue;
+				int cellInd = start + e * stride[d];
+				m.add(cellInd, weights[e]);
+				sum += weights[e] * s.p.cellValue[cellInd];
+				s.dimensionElementSum[d][e] += weights[e] * s.p.cellValue[cellInd];
+			}
+			if (!m.last_row_empty()) {
+				m.end_row();
+				sums.push_back(sum);
+			}
+		}
+		s.CheckTimeout();
+	}
+}
+
+//starts with the estimated values and adds the smallest correction keeping all sums (conjugate gradients on the normal equations)
+Result solve_sparse(State& s)
+{
+	PServer server = Context::getContext()->getServer();
+	PThreadPool tp = server ? server->getThreadPool() : PThreadPool();
+
+	CSR m(s.variableCount);
+	std::vector<double> sums;
+	build_sparse(s, m, sums);
+	CSR mt = m.transpose();
+
+	std::vector<double> x(s.variableCount);
+	for (int i = 0; i < s.variableCount; i++) {
+		if (i == s.fixedIndex) {
+			x[i] = s.p.fixedValue;
+		} else {
+			x[i] = estimate(s, s.p.fixedCoord, s.p.fixedValue, s.p.cellValue.get_coords(i));
+		}
+		if ((i & 0xfff) == 0)
+			s.CheckTimeout();
+	}
+
+	double scale = max(1.0, max(max_abs(sums), fabs(s.p.fixedValue)));
+	std::vector<double> r;
+	std::vector<double> u;
+	std::vector<double> q;
+
+	multiply(m, x, r, tp);
+	for (size_t i = 0; i < r.size(); i++)
+		r[i] = sums[i] - r[i];
+
+	std::vector<double> dir = r;
+	double rr = dot(r, r);
+	int maxIterations = 2 * m.row_count() + 100;
+
+	for (int it = 0; it < maxIterations && max_abs(r) > eps::eps * scale; it++) {
+		s.CheckTimeout();
+
+		multiply(mt, dir, u, tp);
+		u[s.fixedIndex] = 0; //fixed cell is not changed
+		double uu = dot(u, u);
+		if (uu <= 0)
+			break;
+
+		double alpha = rr / uu;
+		for (int i = 0; i < s.variableCount; i++)
+			x[i] += alpha * u[i];
+
+		multiply(m, u, q, tp);
+		for (size_t i = 0; i < r.size(); i++)
+			r[i] -= alpha * q[i];
+
+		double rrNew = dot(r, r);
+		double beta = rrNew / rr;
+		rr = rrNew;
+		for (size_t i = 0; i < dir.size(); i++)
+			dir[i] = r[i] + beta * dir[i];
+	}
+
+	//check the sums with the final values
+	multiply(m, x, q, tp);
+	for (size_t i = 0; i < q.size(); i++)
+		q[i] -= sums[i];
+
+	Result res;
+	res.valid = max_abs(q) <= eps::eps * scale;
+	if (res.valid) {
+		res.cellValue = s.p.cellValue;
+		for (int i = 0; i < s.variableCount; i++)
+			res.cellValue[i] = x[i];
+	}
+	return res;
+}
+
+Result solve(const Problem& p, int timeoutMiliSec, bool sparse)
 {
 
 	State s;
@@ -254,7 +437,7 @@ Result solve(const Problem& p, int timeoutMiliSec)
 	s.pm.col_count(s.variableCount + 1);
 
 	s.checkTimeout = timeoutMiliSec > 0;
-	s.timeoutExpiryTime = (clock_t)(clock() + timeoutMiliSec / 1000.0 * CLOCKS_PER_SEC);
+	s.timeoutExpiryTime = Metrics::now() + (uint64_t)timeoutMiliSec * 1000;
 
 	bool simple_estimate = s.variableCount > 50;
 
@@ -262,6 +445,9 @@ Result solve(const Problem& p, int timeoutMiliSec)
 	for (int i = 0; i < (int)s.p.dimensionElementWeight.size(); i++)
 		s.dimensionElementSum[i].resize(p.dimensionElementWeight[i].size());
 
+	if (sparse && s.variableCount > sparseVariables)
+		return solve_sparse(s);
+
 	s.pm_rows.resize(s.p.dimensionElementWeight.size());
 
 	std::vector<int> c;
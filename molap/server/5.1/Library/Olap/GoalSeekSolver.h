@@ -201,6 +201,80 @@ public:
 	}
 };
 
+//compressed sparse row matrix
+class CSR {
+public:
+	std::vector<int> rowStart;
+	std::vector<int> column;
+	std::vector<double> value;
+	int colCount;
+
+public:
+	CSR() :
+		rowStart(1, 0), colCount(0) {
+	}
+	;
+	CSR(int c) :
+		rowStart(1, 0), colCount(c) {
+	}
+	;
+	int col_count() const {
+		return colCount;
+	}
+	;
+	int row_count() const {
+		return (int)rowStart.size() - 1;
+	}
+	;
+	int nonzero_count() const {
+		return (int)value.size();
+	}
+	;
+
+	//adds element to the last row, columns have to be ascending
+	void add(int c, double v) {
+		column.push_back(c);
+		value.push_back(v);
+	}
+
+	void end_row() {
+		rowStart.push_back((int)value.size());
+	}
+
+	bool last_row_empty() const {
+		return rowStart.back() == (int)value.size();
+	}
+
+	//y[r] = row r * x for rows [beginRow, endRow)
+	void multiply(const std::vector<double>& x, std::vector<double>& y, int beginRow, int endRow) const {
+		for (int r = beginRow; r < endRow; r++) {
+			double sum = 0;
+			for (int i = rowStart[r]; i < rowStart[r + 1]; i++)
+				sum += value[i] * x[column[i]];
+			y[r] = sum;
+		}
+	}
+
+	CSR transpose() const {
+		CSR t(row_count());
+		t.rowStart.assign(colCount + 1, 0);
+		for (int i = 0; i < nonzero_count(); i++)
+			t.rowStart[column[i] + 1]++;
+		for (int c = 0; c < colCount; c++)
+			t.rowStart[c + 1] += t.rowStart[c];
+		t.column.resize(value.size());
+		t.value.resize(value.size());
+		std::vector<int> pos(t.rowStart.begin(), t.rowStart.end() - 1);
+		for (int r = 0; r < row_count(); r++)
+			for (int i = rowStart[r]; i < rowStart[r + 1]; i++) {
+				int ind = pos[column[i]]++;
+				t.column[ind] = r;
+				t.value[ind] = value[i];
+			}
+		return t;
+	}
+};
+
 struct Problem {
 	std::vector<std::vector<double> > dimensionElementWeight;
 	MDM<double> cellValue;
@@ -213,7 +287,11 @@ struct Result {
 	MDM<double> cellValue;
 };
 
-Result solve(const Problem& p, int timeoutMiliSec);
+//problems with more than 200 cells are solved iteratively on sparse matrices unless sparse is false
+Result solve(const Problem& p, int timeoutMiliSec, bool sparse = true);
+
+//sets the minimal number of cells for the sparse solver
+void setSparseVariables(int count);
 }
 }
 
@@ -32,6 +32,7 @@
 #include "Olap/MarkerStorage.h"
 #include "Olap/Context.h"
 #include "Collections/CellMap.h"
+#include "Thread/ThreadPool.h"
 
 namespace palo {
 
@@ -54,11 +55,39 @@ MarkerStorage::MarkerStorage(PRuleMarker marker, size_t targetDimCount, vector<D
 	markerSet = CreateCellSet(targetDimCount);
 }
 
+MarkerStorage::MarkerStorage(const MarkerStorage &parent) :
+	numberDimensions(parent.numberDimensions), tmpKeyBuffer(parent.tmpKeyBuffer), permutations(parent.permutations), maps(parent.maps), dimensions(parent.dimensions), targetArea(parent.targetArea)
+{
+	markerSet = CreateCellSet(numberDimensions);
+}
+
 MarkerStorage::~MarkerStorage()
 {
 }
 
-void MarkerStorage::generateMarkers(PCube fromCube, const Area* fromArea)
+// /////////////////////////////////////////////////////////////////////////////
+// scan of one part of the source area
+// /////////////////////////////////////////////////////////////////////////////
+
+class MarkerStorage::PartitionJob : public ThreadPoolJob {
+public:
+	PartitionJob(ThreadPool::ThreadGroup &tg, const MarkerStorage &parent, const vector<PProcessorBase> &sources) :
+		ThreadPoolJob(tg), markers(parent), sources(sources) {}
+
+	// the storage readers were created by the requesting thread, no context is needed
+	virtual void operator()() {
+		for (vector<PProcessorBase>::iterator it = sources.begin(); it != sources.end(); ++it) {
+			markers.addMarkers(*it);
+		}
+	}
+
+	MarkerStorage markers;
+
+private:
+	vector<PProcessorBase> sources;
+};
+
+void MarkerStorage::generateMarkers(PCube fromCube, const Area* fromArea, CPArea targetArea)
 {
 	Context* context = Context::getContext();
 	CPDatabase db = CONST_COMMITABLE_CAST(Database, context->getParent(fromCube));
@@ -66,31 +95,89 @@ void MarkerStorage::generateMarkers(PCube fromCube, const Area* fromArea)
 
 	PCubeArea ca(new CubeArea(db, fromCube, *fromArea));
 	PArea area = ca->expandStar(CubeArea::BASE_ELEMENTS);
+	this->targetArea = targetArea;
 
-	//go through string storage
-	PSourcePlanNode sn(new SourcePlanNode(fromCube->getStringStorageId(), area, fromCube->getObjectRevision()));
-	PProcessorBase cs = engine->createProcessor(sn, true);
-	while (cs->next()) {
-		addMarker(cs->getKey());
-	}
-	//go through numeric storage
-	sn.reset(new SourcePlanNode(fromCube->getNumericStorageId(), area, fromCube->getObjectRevision()));
-	cs = engine->createProcessor(sn, true);
-	while (cs->next()) {
-		addMarker(cs->getKey());
+	//string, numeric and marker storage
+	vector<IdentifierType> storageIds;
+	storageIds.push_back(fromCube->getStringStorageId());
+	storageIds.push_back(fromCube->getNumericStorageId());
+	storageIds.push_back(fromCube->getMarkerStorageId()); // TODO: -jj- right version object?
+
+	size_t storedCells = 0;
+	for (vector<IdentifierType>::const_iterator it = storageIds.begin(); it != storageIds.end(); ++it) {
+		PStorageBase storage = engine->getStorage(*it);
+		if (storage) {
+			storedCells += storage->valuesCount();
+		}
 	}
-	//go through marker storage
-	sn.reset(new SourcePlanNode(fromCube->getMarkerStorageId(), area, fromCube->getObjectRevision())); // TODO: -jj- right version object?
-	cs = engine->createProcessor(sn, true);
-	while (cs->next()) {
-		addMarker(cs->getKey());
+	PThreadPool tp = context->getServer()->getThreadPool();
+	size_t parts = tp ? min(storedCells / PARTITION_MIN_CELLS, tp->getCoreCount()) : 0;
+
+	if (parts > 1 && tp->hasFreeCore(false)) {
+		generateParallel(engine, storageIds, area, fromCube->getObjectRevision(), parts);
+	} else {
+		for (vector<IdentifierType>::const_iterator it = storageIds.begin(); it != storageIds.end(); ++it) {
+			PSourcePlanNode sn(new SourcePlanNode(*it, area, fromCube->getObjectRevision()));
+			addMarkers(engine->createProcessor(sn, true));
+		}
 	}
 
-	//go through changedCells
+	//go through changedCells, they belong to the context of this thread
 	PCellMapPlanNode cmpn(new CellMapPlanNode(fromCube->getMarkerStorageId(), area));
-	cs = engine->createProcessor(cmpn, true);
-	while (cs->next()) {
-		addMarker(cs->getKey());
+	addMarkers(engine->createProcessor(cmpn, true));
+}
+
+void MarkerStorage::generateParallel(PEngineBase engine, const vector<IdentifierType> &storageIds, CPArea area, uint64_t revision, size_t parts)
+{
+	// split the largest dimension
+	size_t splitDim = 0;
+	for (size_t dim = 1; dim < area->dimCount(); dim++) {
+		if (area->elemCount(dim) > area->elemCount(splitDim)) {
+			splitDim = dim;
+		}
+	}
+	size_t elemCount = area->elemCount(splitDim);
+	parts = min(parts, elemCount);
+
+	Context* context = Context::getContext();
+	PThreadPool tp = context->getServer()->getThreadPool();
+	ThreadPool::ThreadGroup tg = tp->createThreadGroup();
+	vector<PThreadPoolJob> jobs;
+
+	Area::ConstElemIter elem = area->elemBegin(splitDim);
+	for (size_t part = 0; part < parts; part++) {
+		size_t partElems = elemCount / (parts - part);
+		elemCount -= partElems;
+
+		PSet subset(new Set);
+		for (size_t i = 0; i < partElems; i++, ++elem) {
+			subset->insert(*elem);
+		}
+		PArea partArea(new Area(*area));
+		partArea->insert(splitDim, subset);
+
+		vector<PProcessorBase> sources;
+		for (vector<IdentifierType>::const_iterator it = storageIds.begin(); it != storageIds.end(); ++it) {
+			sources.push_back(engine->createProcessor(PPlanNode(new SourcePlanNode(*it, partArea, revision)), true));
+		}
+		jobs.push_back(PThreadPoolJob(new PartitionJob(tg, *this, sources)));
+	}
+	for (vector<PThreadPoolJob>::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+		if (job + 1 != jobs.end() && tp->hasFreeCore(false)) {
+			tp->addJob(*job);
+		} else {
+			PartitionJob *scan = static_cast<PartitionJob *>(job->get());
+			(*scan)();
+		}
+	}
+	tp->join(tg);
+
+	// merge the markers of all parts
+	for (vector<PThreadPoolJob>::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+		PCellStream cs = static_cast<PartitionJob *>(job->get())->markers.getMarkers()->getValues();
+		while (cs->next()) {
+			markerSet->set(cs->getKey());
+		}
 	}
 }
 
@@ -99,6 +186,13 @@ const MarkerStorage::PMarkerSet MarkerStorage::getMarkers() const
 	return markerSet;
 }
 
+void MarkerStorage::addMarkers(PProcessorBase cs)
+{
+	while (cs->next()) {
+		addMarker(cs->getKey());
+	}
+}
+
 void MarkerStorage::addMarker(const IdentifiersType& key)
 {
 	const uint32_t* path = &key[0];
@@ -130,7 +224,9 @@ void MarkerStorage::addMarker(const IdentifiersType& key)
 			++mmi; // next combination
 		}
 
-		pMarkerSet->set(tmpKeyBuffer);
+		if (!targetArea || Cube::isInArea(&tmpKeyBuffer[0], targetArea.get())) {
+			pMarkerSet->set(tmpKeyBuffer);
+		}
 	} while (!mmi.isEndOfCombinations());
 }
 
@@ -51,11 +51,35 @@ public:
 	MarkerStorage(PRuleMarker marker, size_t targetDimCount, vector<Dimension*>* dimensions);
 	~MarkerStorage();
 
-	void generateMarkers(PCube fromCube, const Area* fromArea);
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief generates the markers of all filled cells of the source area
+	///
+	/// Large source areas are split along their largest dimension, the parts
+	/// are scanned by jobs of the thread pool. Only markers inside targetArea
+	/// are generated if targetArea is given.
+	////////////////////////////////////////////////////////////////////////////////
+
+	void generateMarkers(PCube fromCube, const Area* fromArea, CPArea targetArea = CPArea());
 	const PMarkerSet getMarkers() const;
 
 private:
+	class PartitionJob;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief copy with an own empty marker set used by one part of the area
+	////////////////////////////////////////////////////////////////////////////////
+
+	MarkerStorage(const MarkerStorage &parent);
+
 	void addMarker(const IdentifiersType& key);
+	void addMarkers(PProcessorBase cs);
+	void generateParallel(PEngineBase engine, const vector<IdentifierType> &storageIds, CPArea area, uint64_t revision, size_t parts);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief minimal number of stored cells per part of a parallel generation
+	////////////////////////////////////////////////////////////////////////////////
+
+	static const size_t PARTITION_MIN_CELLS = 100000;
 
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief total number of dimensions in destination cube
@@ -85,6 +109,12 @@ private:
 
 	const vector<Dimension*> *dimensions;
 	PMarkerSet markerSet;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief optional restriction of the generated markers
+	////////////////////////////////////////////////////////////////////////////////
+
+	CPArea targetArea;
 };
 
 class SERVER_CLASS MarkerMappingIterator {
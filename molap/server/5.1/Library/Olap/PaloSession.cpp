@@ -48,7 +48,37 @@
 #include <iomanip>
 
 namespace palo {
-map<string, boost::shared_ptr<PaloSession> > PaloSession::sessions;
+boost::shared_ptr<PaloSession> SessionTable::find(const string &sid) const
+{
+	boost::shared_ptr<const Shard> shard = boost::atomic_load(&shards[shardIndex(sid)]);
+	if (shard) {
+		Shard::const_iterator it = shard->find(sid);
+		if (it != shard->end()) {
+			return it->second;
+		}
+	}
+	return boost::shared_ptr<PaloSession>();
+}
+
+void SessionTable::insert(const string &sid, boost::shared_ptr<PaloSession> session)
+{
+	boost::shared_ptr<const Shard> &shard = shards[shardIndex(sid)];
+	boost::shared_ptr<Shard> newShard(shard ? new Shard(*shard) : new Shard());
+	(*newShard)[sid] = session;
+	boost::atomic_store(&shard, boost::shared_ptr<const Shard>(newShard));
+}
+
+void SessionTable::erase(const string &sid)
+{
+	boost::shared_ptr<const Shard> &shard = shards[shardIndex(sid)];
+	if (shard && shard->find(sid) != shard->end()) {
+		boost::shared_ptr<Shard> newShard(new Shard(*shard));
+		newShard->erase(sid);
+		boost::atomic_store(&shard, boost::shared_ptr<const Shard>(newShard));
+	}
+}
+
+SessionTable PaloSession::sessions;
 map<IdentifierType, boost::shared_ptr<PaloSession> > PaloSession::sessionIds;
 list<PaloSession::JOB_INFO> PaloSession::finishedJobs;
 
@@ -86,8 +116,11 @@ boost::shared_ptr<PaloSession> PaloSession::createSession(string sid, Identifier
 	if (!testSession) {
 		Context::getContext()->getServer()->reserveLicense(session, machine, required, optional);
 		Logger::debug << "session key " << shortenSid(sid, 3) << endl;
-		sessions[sid] = session;
-		sessionIds[sidId] = session;
+		{
+			WriteLocker write_locker(&m_main_Lock);
+			sessions.insert(sid, session);
+			sessionIds[sidId] = session;
+		}
 
 		if (user) {
 			Logger::info << "user '" << user->getName() << "' logged in" << endl;
@@ -159,7 +192,7 @@ boost::shared_ptr<PaloSession> PaloSession::createSession(PUser user, bool worke
 					sidString[3 + 16 + i*4] = str[i]; // 19,23,27,31
 				}
 			}
-		} while (sidString == FAKE_SESSION || sidString == NO_SESSION || sessions.find(sidString) != sessions.end());
+		} while (sidString == FAKE_SESSION || sidString == NO_SESSION || sessions.find(sidString));
 
 		result = createSession(sidString, testSession ? 0 : ++lastSessionId, user, worker, ttlIntervall, testSession, peerName, machine, required, optional, description, locale);
 	}
@@ -181,18 +214,17 @@ void PaloSession::deleteSession(boost::shared_ptr<PaloSession> session, bool for
 
 boost::shared_ptr<PaloSession> PaloSession::findSession(const string &sid, bool setWorkerContext)
 {
-	WriteLocker read_locker(&m_main_Lock);
-
-	map<string, boost::shared_ptr<PaloSession> >::iterator iter = sessions.find(sid);
+	boost::shared_ptr<PaloSession> session = sessions.find(sid);
 
-	if (iter == sessions.end()) {
+	if (!session) {
 		throw ParameterException(ErrorException::ERROR_INVALID_SESSION, "wrong session identifier", "session identifier", sid);
 	}
 
-	boost::shared_ptr<PaloSession> session = iter->second;
-
 	if (session->activeJobs.size() == 0 && time(0) > session->getTtl()) {
-		Context::getContext()->getServer()->freeLicense(session);
+		{
+			WriteLocker write_locker(&m_main_Lock);
+			Context::getContext()->getServer()->freeLicense(session);
+		}
 		throw ParameterException(ErrorException::ERROR_INVALID_SESSION, "old session identifier", "session identifier", sid);
 	}
 
@@ -209,7 +241,7 @@ boost::shared_ptr<PaloSession> PaloSession::findSession(const string &sid, bool
 void PaloSession::printActiveJobs(const string &prefix, const string &sufix)
 {
 	WriteLocker read_locker(&m_main_Lock);
-	for (map<string, boost::shared_ptr<PaloSession> >::iterator it = sessions.begin(); it != sessions.end(); ++it) {
+	for (map<IdentifierType, boost::shared_ptr<PaloSession> >::iterator it = sessionIds.begin(); it != sessionIds.end(); ++it) {
 		boost::shared_ptr<PaloSession> session = it->second;
 		WriteLocker sl(&session->thisLock);
 		for (set<const PaloJob *>::iterator itj = session->activeJobs.begin(); itj != session->activeJobs.end(); ++itj) {
@@ -298,7 +330,7 @@ void PaloSession::clearOldSessions()
 {
 	WriteLocker write_locker(&m_main_Lock);
 
-	for (map<string, boost::shared_ptr<PaloSession> >::iterator iter = sessions.begin(); iter != sessions.end();) {
+	for (map<IdentifierType, boost::shared_ptr<PaloSession> >::iterator iter = sessionIds.begin(); iter != sessionIds.end();) {
 		boost::shared_ptr<PaloSession> session = iter->second;
 		if (session->activeJobs.size() > 0) {
 			session->updateTtl();
@@ -306,8 +338,8 @@ void PaloSession::clearOldSessions()
 		} else if (time(0) > session->getTtl()) {
 			Logger::debug << "old session removed " << shortenSid(session->getSid(), 3) << endl;
 			Context::getContext()->getServer()->freeLicense(session);
-			sessionIds.erase(sessionIds.find(session->getInternalId()));
-			sessions.erase(iter++);
+			sessions.erase(session->getSid());
+			sessionIds.erase(iter++);
 		} else {
 			++iter;
 		}
@@ -340,7 +372,7 @@ void PaloSession::requestRecord(string req, string ext)
 	if (recorderFile) {
 		*recorderFile << "#" << StringUtils::convertTimeToString(time(0)) << endl;
 		*recorderFile << "#USER" << '\t' << "START" << '\t' << "REVISION" << '\t' << "DURATION" << '\t' << "REQUEST" << endl;
-		for (map<string, boost::shared_ptr<PaloSession> >::iterator iter = sessions.begin(); iter != sessions.end(); ++iter) {
+		for (map<IdentifierType, boost::shared_ptr<PaloSession> >::iterator iter = sessionIds.begin(); iter != sessionIds.end(); ++iter) {
 			iter->second->writeActiveJobsRecords(recorderFile);
 		}
 
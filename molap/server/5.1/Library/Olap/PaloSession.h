@@ -37,6 +37,7 @@
 
 #include <map>
 #include <deque>
+#include <unordered_map>
 
 extern "C" {
 #include <time.h>
@@ -50,6 +51,34 @@ extern "C" {
 namespace palo {
 class User;
 class PaloJob;
+class PaloSession;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief table of sessions indexed by the session identifier string
+///
+/// Lookups don't take any lock. The table is split into shards and every
+/// shard is an immutable hash map published with an atomic pointer store.
+/// Modifications copy the affected shard and have to be serialized by the
+/// caller.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS SessionTable {
+public:
+	static const size_t SHARDS = 16;
+
+	boost::shared_ptr<PaloSession> find(const string &sid) const;
+	void insert(const string &sid, boost::shared_ptr<PaloSession> session);
+	void erase(const string &sid);
+
+private:
+	typedef unordered_map<string, boost::shared_ptr<PaloSession> > Shard;
+
+	size_t shardIndex(const string &sid) const {
+		return std::hash<string>()(sid) % SHARDS;
+	}
+
+	boost::shared_ptr<const Shard> shards[SHARDS];
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief session handler for http
@@ -205,7 +234,7 @@ private:
 	};
 
 private:
-	static map<string, boost::shared_ptr<PaloSession> > sessions;
+	static SessionTable sessions;
 	static map<IdentifierType, boost::shared_ptr<PaloSession> > sessionIds;
 	static list<JOB_INFO> finishedJobs;
 	static Mutex m_main_Lock;
@@ -0,0 +1,345 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "Olap/PlanCache.h"
+#include "Olap/Context.h"
+#include "Olap/Cube.h"
+#include "Olap/Database.h"
+#include "Olap/Server.h"
+#include "Olap/Dimension.h"
+#include "Olap/Element.h"
+#include "Olap/Rule.h"
+#include "Olap/RulesList.h"
+#include "Engine/Cache.h"
+#include "Engine/EngineCpu.h"
+#include "InputOutput/Metrics.h"
+#include "Logger/Logger.h"
+#include "Thread/WriteLocker.h"
+
+namespace palo {
+
+PPlanNode PlanCache::find(CPCubeArea area, CubeArea::CellType type, RulesType rulesType, bool skipEmpty, uint64_t blockSize, CPRuleList rules, PStorageCpu cacheStorage)
+{
+	vector<uint32_t> tokens = getTokens(area);
+	PPlanNode plan;
+	Dependences dependences;
+	vector<pair<CPCubeArea, PPlanNode> > templates;
+	{
+		WriteLocker wl(&lock);
+		for (list<Entry>::iterator it = entries.begin(); it != entries.end();) {
+			if (it->cacheStorage != cacheStorage || it->rules != rules || it->tokens != tokens) {
+				// the value cache, the rules or the dimensions changed, the plan can't be used anymore
+				it = entries.erase(it);
+			} else if (it->type == type && it->rulesType == rulesType && it->skipEmpty == skipEmpty && it->blockSize == blockSize) {
+				if (*it->area == *area) {
+					if (it != entries.begin()) {
+						entries.splice(entries.begin(), entries, it);
+					}
+					plan = entries.front().plan;
+					dependences = entries.front().dependences;
+					break;
+				}
+				if (it->isTemplate) {
+					templates.push_back(make_pair(it->area, it->plan));
+				}
+				++it;
+			} else {
+				++it;
+			}
+		}
+	}
+
+	// the other cubes are looked up without holding the lock
+	if (plan && !isValid(dependences)) {
+		WriteLocker wl(&lock);
+		for (list<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+			if (it->plan == plan) {
+				entries.erase(it);
+				break;
+			}
+		}
+		plan.reset();
+	}
+
+	if (!plan) {
+		for (vector<pair<CPCubeArea, PPlanNode> >::const_iterator it = templates.begin(); it != templates.end(); ++it) {
+			Bindings bindings;
+			if (canRebind(*it->first, *area, rules, bindings)) {
+				plan = rebind(it->second.get(), *area, bindings);
+				insert(area, type, rulesType, skipEmpty, blockSize, rules, cacheStorage, Dependences(), plan);
+				Metrics::count(Metrics::PLAN_CACHE_REBIND);
+				WriteLocker wl(&lock);
+				rebinds++;
+				break;
+			}
+		}
+	}
+
+	WriteLocker wl(&lock);
+	if (plan) {
+		hits++;
+	} else {
+		misses++;
+	}
+	return plan;
+}
+
+void PlanCache::insert(CPCubeArea area, CubeArea::CellType type, RulesType rulesType, bool skipEmpty, uint64_t blockSize, CPRuleList rules, PStorageCpu cacheStorage, const Dependences &dependences, PPlanNode plan)
+{
+	Entry entry;
+	entry.area = area;
+	entry.tokens = getTokens(area);
+	entry.isTemplate = dependences.empty() && isTemplate(plan.get());
+	entry.type = type;
+	entry.rulesType = rulesType;
+	entry.skipEmpty = skipEmpty;
+	entry.blockSize = blockSize;
+	entry.rules = rules;
+	entry.cacheStorage = cacheStorage;
+	entry.dependences = dependences;
+	entry.plan = plan;
+
+	WriteLocker wl(&lock);
+	entries.push_front(entry);
+	if (entries.size() > MAX_PLANS) {
+		entries.pop_back();
+	}
+	if (Logger::isTrace() && (hits + misses) % 1000 == 0) {
+		Logger::trace << "plan cache hits/misses/rebinds: " << hits << "/" << misses << "/" << rebinds << endl;
+	}
+}
+
+vector<uint32_t> PlanCache::getTokens(CPCubeArea area)
+{
+	CPDatabase db = area->getDatabase();
+	CPCube cube = area->getCube();
+	vector<uint32_t> tokens(1, cube->getToken());
+	const IdentifiersType &dimensions = *cube->getDimensions();
+	for (IdentifiersType::const_iterator it = dimensions.begin(); it != dimensions.end(); ++it) {
+		CPDimension dimension = db->lookupDimension(*it, false);
+		tokens.push_back(dimension ? dimension->getToken() : 0);
+	}
+	return tokens;
+}
+
+bool PlanCache::isTemplate(const PlanNode *node)
+{
+	// the areas of these nodes are the only element dependent parts of the plan
+	switch (node->getType()) {
+	case UNION:
+	case SOURCE:
+	case COMPLETE:
+	case LEGACY_RULE:
+	case CONSTANT:
+	case ADDITION:
+	case SUBTRACTION:
+	case MULTIPLICATION:
+	case DIVISION:
+		break;
+	case TRANSFORMATION: {
+		// only sources of the cube itself mapping every dimension one to one
+		const TransformationPlanNode *transformation = static_cast<const TransformationPlanNode *>(node);
+		if (transformation->getSetMultiMaps() || !transformation->getDimMapping().empty() || transformation->getSourceCubeId().first != NO_IDENTIFIER) {
+			return false;
+		}
+		break;
+	}
+	default:
+		return false;
+	}
+	const vector<PPlanNode> &children = node->getChildren();
+	for (vector<PPlanNode>::const_iterator it = children.begin(); it != children.end(); ++it) {
+		if (*it && !isTemplate(it->get())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool contains(const Area *area, size_t dim, IdentifierType id)
+{
+	// an empty set stands for all elements of the dimension
+	CPSet elements = area->getDim(dim);
+	return !elements || !elements->size() || elements->find(id) != elements->end();
+}
+
+bool PlanCache::canRebind(const CubeArea &cached, const CubeArea &area, CPRuleList rules, Bindings &bindings)
+{
+	if (cached.dimCount() != area.dimCount()) {
+		return false;
+	}
+	CPDatabase db = area.getDatabase();
+	CPCube cube = area.getCube();
+	const IdentifiersType &dimensions = *cube->getDimensions();
+	CPRuleDependencies dependencies = cube->getRuleDependencies();
+	if (!dependencies->isBuiltFrom(rules)) {
+		return false;
+	}
+	for (size_t dim = 0; dim < area.dimCount(); dim++) {
+		if (cached.elemCount(dim) != 1 || area.elemCount(dim) != 1) {
+			if (cached.elemCount(dim) == 1 || area.elemCount(dim) == 1 || !(*cached.getDim(dim) == *area.getDim(dim))) {
+				return false;
+			}
+			continue;
+		}
+		IdentifierType from = *cached.elemBegin(dim);
+		IdentifierType to = *area.elemBegin(dim);
+		if (from == to) {
+			continue;
+		}
+
+		// both elements have to be base elements of the same type
+		CPDimension dimension = db->lookupDimension(dimensions[dim], false);
+		Element *fromElement = dimension ? dimension->lookupElement(from, false) : 0;
+		Element *toElement = dimension ? dimension->lookupElement(to, false) : 0;
+		if (!fromElement || !toElement || fromElement->getElementType() != toElement->getElementType() || fromElement->getElementType() == Element::CONSOLIDATED) {
+			return false;
+		}
+
+		// no rule may apply to only one of them
+		for (RuleList::ConstIterator it = rules->const_begin(); it != rules->const_end(); ++it) {
+			CPRule rule = CONST_COMMITABLE_CAST(Rule, *it);
+			const Area *destination = rule->getDestinationArea();
+			if (destination && contains(destination, dim, from) != contains(destination, dim, to)) {
+				return false;
+			}
+			const Area *restricted = rule->getRestrictedArea(db);
+			if (restricted && contains(restricted, dim, from) != contains(restricted, dim, to)) {
+				return false;
+			}
+		}
+
+		// sources naming or shifting the old element are not re-bound
+		if (!dependencies->passesThrough(dim, from)) {
+			return false;
+		}
+		Binding binding = {dim, from, to};
+		bindings.push_back(binding);
+	}
+	return !bindings.empty();
+}
+
+PPlanNode PlanCache::rebind(const PlanNode *node, const CubeArea &target, const Bindings &bindings)
+{
+	vector<PPlanNode> children;
+	for (vector<PPlanNode>::const_iterator it = node->getChildren().begin(); it != node->getChildren().end(); ++it) {
+		children.push_back(*it ? rebind(it->get(), target, bindings) : PPlanNode());
+	}
+
+	// the old elements are replaced by the new ones, the other sets are shared
+	const Area *nodeArea = node->getArea().get();
+	PCubeArea area(new CubeArea(target.getDatabase(), target.getCube(), nodeArea->dimCount()));
+	Bindings::const_iterator binding = bindings.begin();
+	for (size_t dim = 0; dim < nodeArea->dimCount(); dim++) {
+		CPSet dimSet;
+		bool bound = binding != bindings.end() && binding->dim == dim;
+		if (bound && nodeArea->elemCount(dim) == 1 && *nodeArea->elemBegin(dim) == binding->from) {
+			PSet s(new Set);
+			s->insert(binding->to);
+			dimSet = s;
+		} else if (nodeArea->elemCount(dim) == 1) {
+			PSet s(new Set);
+			s->insert(*nodeArea->elemBegin(dim));
+			dimSet = s;
+		} else {
+			dimSet = nodeArea->getDim(dim);
+		}
+		if (bound) {
+			++binding;
+		}
+		area->insert(dim, dimSet, dim + 1 == nodeArea->dimCount());
+	}
+
+	PPlanNode result;
+	switch (node->getType()) {
+	case UNION:
+		result.reset(new UnionPlanNode(area, children, static_cast<const UnionPlanNode *>(node)->getRuleId()));
+		break;
+	case SOURCE: {
+		const SourcePlanNode *source = static_cast<const SourcePlanNode *>(node);
+		result.reset(new SourcePlanNode(source->getStorageId(), area, source->getRevision()));
+		break;
+	}
+	case COMPLETE: {
+		const CompletePlanNode *complete = static_cast<const CompletePlanNode *>(node);
+		result.reset(new CompletePlanNode(area, children[0], complete->getDefaultValue(), complete->getRuleId()));
+		break;
+	}
+	case LEGACY_RULE: {
+		const LegacyRulePlanNode *rule = static_cast<const LegacyRulePlanNode *>(node);
+		result.reset(new LegacyRulePlanNode(rule->getDatabase(), rule->getCube(), area, rule->getRule(), rule->getDefaultValue(), rule->getCache(), rule->useMarkers()));
+		break;
+	}
+	case CONSTANT: {
+		const ConstantPlanNode *constant = static_cast<const ConstantPlanNode *>(node);
+		result.reset(new ConstantPlanNode(area, constant->getDefaultValue() ? *constant->getDefaultValue() : CellValue()));
+		break;
+	}
+	case ADDITION:
+	case SUBTRACTION:
+	case MULTIPLICATION:
+	case DIVISION:
+		result.reset(new PlanNode(node->getType(), area, children, node->getCache(), node->getCacheCube(), node->getConstValue()));
+		break;
+	case TRANSFORMATION: {
+		const TransformationPlanNode *transformation = static_cast<const TransformationPlanNode *>(node);
+		result.reset(new TransformationPlanNode(area, children[0], SetMultimaps(), transformation->getFactor(), vector<uint32_t>()));
+		break;
+	}
+	default:
+		throw ErrorException(ErrorException::ERROR_INTERNAL, "PlanCache::rebind: unexpected plan node");
+	}
+	result->setExchange(node->isExchange());
+	return result;
+}
+
+bool PlanCache::isValid(const Dependences &dependences)
+{
+	CPServer server = Context::getContext()->getServer();
+	for (Dependences::const_iterator it = dependences.begin(); it != dependences.end(); ++it) {
+		CPDatabase db = server->lookupDatabase(it->id.first, false);
+		CPCube cube = db ? db->lookupCube(it->id.second, false) : CPCube();
+		if (cube != it->cube) {
+			// data or rules of the cube changed
+			return false;
+		}
+		PStorageCpu cacheStorage;
+		ValueCache::PCachedAreas cachedAreas;
+		cube->getCache()->getAreasAndStorage(cacheStorage, cachedAreas);
+		if (cacheStorage != it->cacheStorage) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void PlanCache::clear()
+{
+	WriteLocker wl(&lock);
+	entries.clear();
+}
+
+}
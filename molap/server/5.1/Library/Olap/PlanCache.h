@@ -0,0 +1,130 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef OLAP_PLAN_CACHE_H
+#define OLAP_PLAN_CACHE_H 1
+
+#include "palo.h"
+#include "Engine/Area.h"
+#include "Thread/Mutex.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cache of plans created by the Planner for one version of a cube
+///
+/// A plan is reused when the same area (including the database version) is
+/// requested with the same parameters, with the same rule list and while the
+/// value cache of the cube still holds the same storage snapshot. Every
+/// change of the cube data or rules creates a new version of the cube with
+/// an empty plan cache, plans made obsolete by a change of the value cache
+/// are dropped on the next lookup. Plans with sub-plans of other cubes
+/// (PALO.DATA) keep the version and the value cache snapshot of these cubes
+/// and are dropped as well when one of them changed. Plans are also dropped
+/// when the token of the cube or of one of its dimensions changed. The number
+/// of plans is bounded, the least recently used plan is dropped first.
+///
+/// Plans reading only base cells of the cube itself serve as templates: an
+/// area differing in dimensions with a single base element each is answered
+/// by a copy of the plan with these elements re-bound, if the old and the new
+/// element have the same type, every rule either contains both or none of
+/// them and the rules read the old element only as the element of the
+/// calculated cell.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS PlanCache {
+public:
+	static const size_t MAX_PLANS = 64;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief another cube read by a plan
+	////////////////////////////////////////////////////////////////////////////////
+
+	struct Dependence {
+		dbID_cubeID id;
+		CPCube cube;
+		PStorageCpu cacheStorage;
+	};
+
+	typedef vector<Dependence> Dependences;
+
+	PlanCache() : hits(0), misses(0), rebinds(0) {}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the cached plan, a re-bound template or an empty pointer
+	////////////////////////////////////////////////////////////////////////////////
+
+	PPlanNode find(CPCubeArea area, CubeArea::CellType type, RulesType rulesType, bool skipEmpty, uint64_t blockSize, CPRuleList rules, PStorageCpu cacheStorage);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief stores a new plan
+	////////////////////////////////////////////////////////////////////////////////
+
+	void insert(CPCubeArea area, CubeArea::CellType type, RulesType rulesType, bool skipEmpty, uint64_t blockSize, CPRuleList rules, PStorageCpu cacheStorage, const Dependences &dependences, PPlanNode plan);
+
+	void clear();
+
+private:
+	PlanCache(const PlanCache &);
+
+	struct Binding {
+		size_t dim;
+		IdentifierType from;
+		IdentifierType to;
+	};
+
+	typedef vector<Binding> Bindings;
+
+	static bool isValid(const Dependences &dependences);
+	static vector<uint32_t> getTokens(CPCubeArea area);
+	static bool isTemplate(const PlanNode *node);
+	static bool canRebind(const CubeArea &cached, const CubeArea &area, CPRuleList rules, Bindings &bindings);
+	static PPlanNode rebind(const PlanNode *node, const CubeArea &target, const Bindings &bindings);
+
+	struct Entry {
+		CPCubeArea area;
+		vector<uint32_t> tokens;
+		bool isTemplate;
+		CubeArea::CellType type;
+		RulesType rulesType;
+		bool skipEmpty;
+		uint64_t blockSize;
+		CPRuleList rules;
+		PStorageCpu cacheStorage;
+		Dependences dependences;
+		PPlanNode plan;
+	};
+
+	Mutex lock;
+	list<Entry> entries;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t rebinds;
+};
+
+}
+
+#endif
@@ -88,7 +88,7 @@ ResultStatus RightsCube::setCellValue(PServer server, PDatabase db, PCubeArea ce
 			   ) {
 
 				if (l > 1) {
-					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "value not allowed here", "value", value);
+					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "value not allowed here", "value", value.getString());
 				}
 
 				string okStrings = "NRWD";
@@ -106,7 +106,7 @@ ResultStatus RightsCube::setCellValue(PServer server, PDatabase db, PCubeArea ce
 				newValue = string(1, valueChar);
 
 				if (newValue.find_first_not_of(okStrings) != string::npos) {
-					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "value not allowed here", "value", value);
+					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "value not allowed here", "value", value.getString());
 				}
 			}
 		}
@@ -126,7 +126,7 @@ ResultStatus RightsCube::setCellValue(PServer server, PDatabase db, PCubeArea ce
 			cube = system->getUserUserPropertiesCube().get();
 			if (cube && cube->getId() == getId()) {
 				if (elem0->getName(dim0->getElemNamesVector()) == SystemDatabase::NAME_ADMIN && elem1->getName(dim1->getElemNamesVector()) == SystemDatabase::INACTIVE) {
-					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "Can't change inactive value for admin.", "value", value);
+					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "Can't change inactive value for admin.", "value", value.getString());
 				}
 				if (elem1->getName(dim1->getElemNamesVector()) == SystemDatabase::LICENSES) {
 					server->checkNamedLicense(elem0->getIdentifier(), value);
@@ -135,13 +135,13 @@ ResultStatus RightsCube::setCellValue(PServer server, PDatabase db, PCubeArea ce
 			cube = system->getGroupGroupPropertiesCube().get();
 			if (cube && cube->getId() == getId()) {
 				if (elem0->getName(dim0->getElemNamesVector()) == SystemDatabase::NAME_ADMIN && elem1->getName(dim1->getElemNamesVector()) == SystemDatabase::INACTIVE) {
-					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "Can't change inactive value for admin.", "value", value);
+					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "Can't change inactive value for admin.", "value", value.getString());
 				}
 			}
 			cube = system->getRoleRolePropertiesCube().get();
 			if (cube && cube->getId() == getId()) {
 				if (elem0->getName(dim0->getElemNamesVector()) == SystemDatabase::NAME_ADMIN && elem1->getName(dim1->getElemNamesVector()) == SystemDatabase::INACTIVE) {
-					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "Can't change inactive value for admin.", "value", value);
+					throw ParameterException(ErrorException::ERROR_INVALID_PERMISSION, "Can't change inactive value for admin.", "value", value.getString());
 				}
 			}
 			cube = system->getUserGroupCube().get();
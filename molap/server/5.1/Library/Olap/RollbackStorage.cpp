@@ -35,17 +35,26 @@
 #if defined(_MSC_VER)
 #include <float.h>
 #include <limits>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
+#include <boost/unordered_set.hpp>
+
 #include "Olap/RollbackStorage.h"
 #include "Olap/Rule.h"
 #include "Olap/Cube.h"
 #include "Engine/EngineBase.h"
 
+#include "Exceptions/FileOpenException.h"
 #include "Logger/Logger.h"
 #include "InputOutput/Statistics.h"
 #include "InputOutput/FileReader.h"
 #include "InputOutput/FileWriter.h"
+#include "InputOutput/FileWriterBF.h"
 
 #include "Thread/WriteLocker.h"
 
@@ -56,31 +65,214 @@ namespace palo {
 size_t RollbackStorage::maximumFileRollbackSize = 100 * 1024 * 1024;
 size_t RollbackStorage::maximumMemoryRollbackSize = 10 * 1024 * 1024;
 
-size_t RollbackStorage::getSize(const IdentifiersType &path, const CellValue &val)
-{
-	return (path.size() * sizeof(IdentifierType)) + sizeof(CellValue) + (val.isString() ? val.length() : 0);
-}
+////////////////////////////////////////////////////////////////////////////////
+/// @brief header of a binary rollback page
+///
+/// The header is followed by the numeric values, the keys, the string ends,
+/// the cell kinds and the string data, so every column is properly aligned.
+////////////////////////////////////////////////////////////////////////////////
+
+struct RollbackPageHeader {
+	static const uint32_t MAGIC = 0x50524c42;
+
+	uint32_t magic;
+	uint32_t dimCount;
+	uint64_t cells;
+	uint64_t strings;
+	uint64_t stringBytes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read only image of a binary rollback page file
+////////////////////////////////////////////////////////////////////////////////
+
+class RollbackPageFile {
+public:
+	RollbackPageFile(const FileName &pageFileName) : memory(0), length(0) {
+		string name = pageFileName.fullPath();
+#if defined(_MSC_VER)
+		FILE *file = fopen(name.c_str(), "rb");
+		if (file == 0) {
+			throw FileOpenException("could not open rollback page", name);
+		}
+		fseek(file, 0, SEEK_END);
+		buffer.resize(ftell(file));
+		fseek(file, 0, SEEK_SET);
+		bool ok = buffer.empty() || fread(&buffer[0], 1, buffer.size(), file) == buffer.size();
+		fclose(file);
+		if (!ok) {
+			throw FileOpenException("could not read rollback page", name);
+		}
+		memory = buffer.empty() ? 0 : &buffer[0];
+		length = buffer.size();
+#else
+		int fd = open(name.c_str(), O_RDONLY);
+		if (fd == -1) {
+			throw FileOpenException("could not open rollback page", name);
+		}
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+			length = (size_t)fileStat.st_size;
+			memory = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (memory == MAP_FAILED) {
+				memory = 0;
+			}
+		}
+		close(fd);
+		if (memory == 0) {
+			throw FileOpenException("could not map rollback page", name);
+		}
+#endif
+	}
+
+	~RollbackPageFile() {
+#if !defined(_MSC_VER)
+		if (memory) {
+			munmap(memory, length);
+		}
+#endif
+	}
+
+	const char *data() const {
+		return (const char *)memory;
+	}
+
+	size_t size() const {
+		return length;
+	}
+
+private:
+	void *memory;
+	size_t length;
+#if defined(_MSC_VER)
+	vector<char> buffer;
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash and equality of packed keys
+////////////////////////////////////////////////////////////////////////////////
+
+struct RollbackKeyHash {
+	RollbackKeyHash(size_t dimCount) : dimCount(dimCount) {}
+	size_t operator()(const IdentifierType *key) const {
+		size_t h = 0;
+		for (size_t i = 0; i < dimCount; i++) {
+			h = h * 31 + key[i];
+		}
+		return h;
+	}
+	size_t dimCount;
+};
+
+struct RollbackKeyEqual {
+	RollbackKeyEqual(size_t dimCount) : dimCount(dimCount) {}
+	bool operator()(const IdentifierType *a, const IdentifierType *b) const {
+		return memcmp(a, b, dimCount * sizeof(IdentifierType)) == 0;
+	}
+	size_t dimCount;
+};
+
+typedef boost::unordered_set<const IdentifierType *, RollbackKeyHash, RollbackKeyEqual> RollbackKeySet;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cells of a page from the first cell on
+///
+/// A cell already restored from an older page or an older position is
+/// skipped, so every cell is restored to its oldest value.
+////////////////////////////////////////////////////////////////////////////////
+
+class RollbackStorage::PageStream : public CellValueStream {
+public:
+	PageStream(const PageView &view, size_t first, size_t dimCount, RollbackKeySet &restored) :
+		view(view), position(first), dimCount(dimCount), restored(restored), key(dimCount) {
+		stringIndex = std::count(view.kinds, view.kinds + first, (uint8_t)STRING_CELL);
+	}
+
+	virtual bool next() {
+		while (position < view.cells) {
+			size_t i = position++;
+			const IdentifierType *cell = view.keys + i * dimCount;
+
+			if (view.kinds[i] == STRING_CELL) {
+				uint32_t stringBegin = stringIndex ? view.stringEnds[stringIndex - 1] : 0;
+				uint32_t stringEnd = view.stringEnds[stringIndex++];
+				if (!restored.insert(cell).second) {
+					continue;
+				}
+				value = string(view.stringData + stringBegin, view.stringData + stringEnd);
+			} else {
+				if (!restored.insert(cell).second) {
+					continue;
+				}
+				value = view.kinds[i] == NUMERIC_CELL ? CellValue(view.numerics[i]) : CellValue();
+			}
+			key.assign(cell, cell + dimCount);
+			return true;
+		}
+		return false;
+	}
+
+	virtual const CellValue &getValue() {
+		return value;
+	}
+
+	virtual double getDouble() {
+		return value.getNumeric();
+	}
+
+	virtual const IdentifiersType &getKey() const {
+		return key;
+	}
+
+	virtual void reset() {
+		throw ErrorException(ErrorException::ERROR_INTERNAL, "No reset for rollback page stream");
+	}
+
+private:
+	const PageView &view;
+	size_t position;
+	size_t stringIndex;
+	size_t dimCount;
+	RollbackKeySet &restored;
+	IdentifiersType key;
+	CellValue value;
+};
 
 RollbackStorage::RollbackStorage(size_t dimCount, PFileName cubeFileName, IdentifierType id) :
-	numPages(1), sizeSavedPages(0), currentPageSize(0)
+	dimCount(dimCount), textPages(bffilebuf::canCrypt()), numPages(1), sizeSavedPages(0), currentPageSize(0)
 {
 	fileName.reset(new FileName(cubeFileName->path, cubeFileName->name + "_lock_" + StringUtils::convertToString(id), cubeFileName->extension));
 }
 
 RollbackStorage::~RollbackStorage()
 {
-	for (size_t num = 0; num < numPages; num++) {
+	for (size_t num = 0; num + 1 < numPages; num++) {
 		FileName pageFileName = computePageFileName(num);
 		FileUtils::remove(pageFileName);
 	}
 }
 
+size_t RollbackStorage::getSize(const CellValue &val) const
+{
+	size_t size = dimCount * sizeof(IdentifierType) + sizeof(double) + sizeof(uint8_t);
+	if (val.isString()) {
+		size += sizeof(uint32_t) + val.length();
+	}
+	return size;
+}
+
+size_t RollbackStorage::getSize(const Page &page) const
+{
+	return page.keys.size() * sizeof(IdentifierType) + page.numerics.size() * sizeof(double) + page.kinds.size() + page.stringEnds.size() * sizeof(uint32_t) + page.strings.size();
+}
+
 void RollbackStorage::checkCurrentPage()
 {
 	if (currentPageSize >= maximumMemoryRollbackSize) {
 		// save curentPage to disk and delete it from memory
 		savePageToFile();
-		currentPage.clear();
+		currentPage = Page();
 		currentPageSize = 0;
 		numPages++;
 	}
@@ -94,8 +286,20 @@ void RollbackStorage::addCellValue(const vector<pair<IdentifiersType, CellValue>
 	}
 	for (vector<pair<IdentifiersType, CellValue> >::const_iterator it = cells.begin(); it != cells.end(); ++it) {
 		checkCurrentPage();
-		currentPage.push_back(make_pair(it->first, it->second));
-		currentPageSize += getSize(it->first, it->second);
+		currentPage.keys.insert(currentPage.keys.end(), it->first.begin(), it->first.end());
+		if (it->second.isString()) {
+			currentPage.numerics.push_back(0);
+			currentPage.kinds.push_back(STRING_CELL);
+			currentPage.strings.append(it->second);
+			currentPage.stringEnds.push_back((uint32_t)currentPage.strings.size());
+		} else if (it->second.isEmpty()) {
+			currentPage.numerics.push_back(0);
+			currentPage.kinds.push_back(EMPTY_CELL);
+		} else {
+			currentPage.numerics.push_back(it->second.getNumeric());
+			currentPage.kinds.push_back(NUMERIC_CELL);
+		}
+		currentPageSize += getSize(it->second);
 	}
 	steps.push(cells.size());
 }
@@ -107,136 +311,265 @@ void RollbackStorage::rollback(PServer server, PDatabase db, PCube cube, size_t
 		numSteps = steps.size();
 	}
 
-	vector<pair<IdentifiersType, CellValue> >::reverse_iterator rit = currentPage.rbegin();
-	set<PCube> changedCubes;
+	size_t count = 0;
 	for (size_t i = 0; i < numSteps; ++i) {
-		size_t subSteps = steps.top();
+		count += steps.top();
 		steps.pop();
-		for (size_t j = 0; j < subSteps; ++j) {
-			if (rit == currentPage.rend()) {
-				numPages--;
-				loadPageFromFile();
-				rit = currentPage.rbegin();
-			}
-			cube->setCellValue(server, db, PCubeArea(new CubeArea(db, cube, rit->first)), rit->second, PLockedCells(), PUser(), boost::shared_ptr<PaloSession>(), false, false, DEFAULT, true, 0, changedCubes, true, CubeArea::NONE);
-			currentPageSize -= getSize(rit->first, rit->second);
-			currentPage.pop_back();
-			rit = currentPage.rbegin();
+	}
+
+	// pages holding the last count cells, newest first
+	vector<boost::shared_ptr<void> > openedPages;
+	vector<PageView> views(1, getView(currentPage));
+	size_t remaining = count;
+	size_t page = numPages - 1;
+
+	while (remaining > views.back().cells && page > 0) {
+		remaining -= views.back().cells;
+		views.push_back(openPage(--page, openedPages));
+	}
+	size_t first = views.back().cells - min(remaining, views.back().cells);
+
+	// replay from the oldest value, every page is restored as one stream
+	set<PCube> changedCubes;
+	RollbackKeySet restored(count, RollbackKeyHash(dimCount), RollbackKeyEqual(dimCount));
+
+	for (vector<PageView>::reverse_iterator view = views.rbegin(); view != views.rend(); ++view) {
+		PCellStream values(new PageStream(*view, view == views.rbegin() ? first : 0, dimCount, restored));
+		if (cube->restoreCellValues(server, values, PUser())) {
+			continue;
+		}
+		while (values->next()) {
+			cube->setCellValue(server, db, PCubeArea(new CubeArea(db, cube, values->getKey())), values->getValue(), PLockedCells(), PUser(), boost::shared_ptr<PaloSession>(), false, false, DEFAULT, true, 0, changedCubes, true, CubeArea::NONE);
 		}
 	}
 	cube->commitChanges(false, user, changedCubes, false);
+
+	// the remaining cells of the oldest page become the current page
+	if (views.size() == 1) {
+		truncatePage(currentPage, first);
+	} else {
+		Page oldest;
+		appendCells(oldest, views.back(), first);
+		restored.clear();
+		views.clear();
+		openedPages.clear();
+		currentPage.keys.swap(oldest.keys);
+		currentPage.numerics.swap(oldest.numerics);
+		currentPage.kinds.swap(oldest.kinds);
+		currentPage.stringEnds.swap(oldest.stringEnds);
+		currentPage.strings.swap(oldest.strings);
+
+		while (numPages - 1 > page) {
+			numPages--;
+			FileUtils::remove(computePageFileName(numPages - 1));
+			sizeSavedPages -= pageSizes.back();
+			pageSizes.pop_back();
+		}
+	}
+	currentPageSize = getSize(currentPage);
+
+	Logger::debug << "rolled back " << count << " values (pages = " << numPages << ", sizeSavedPages = " << sizeSavedPages << ")" << endl;
+}
+
+RollbackStorage::PageView RollbackStorage::getView(const Page &page) const
+{
+	PageView view;
+	view.cells = page.kinds.size();
+	view.strings = page.stringEnds.size();
+	if (view.cells) {
+		view.keys = &page.keys[0];
+		view.numerics = &page.numerics[0];
+		view.kinds = &page.kinds[0];
+	}
+	if (view.strings) {
+		view.stringEnds = &page.stringEnds[0];
+		view.stringData = page.strings.data();
+	}
+	return view;
+}
+
+void RollbackStorage::appendCells(Page &page, const PageView &view, size_t count) const
+{
+	size_t strings = std::count(view.kinds, view.kinds + count, (uint8_t)STRING_CELL);
+
+	page.keys.insert(page.keys.end(), view.keys, view.keys + count * dimCount);
+	page.numerics.insert(page.numerics.end(), view.numerics, view.numerics + count);
+	page.kinds.insert(page.kinds.end(), view.kinds, view.kinds + count);
+	page.stringEnds.insert(page.stringEnds.end(), view.stringEnds, view.stringEnds + strings);
+	page.strings.append(view.stringData, strings ? view.stringEnds[strings - 1] : 0);
+}
+
+void RollbackStorage::truncatePage(Page &page, size_t cells) const
+{
+	size_t strings = std::count(page.kinds.begin(), page.kinds.begin() + cells, (uint8_t)STRING_CELL);
+
+	page.keys.resize(cells * dimCount);
+	page.numerics.resize(cells);
+	page.kinds.resize(cells);
+	page.stringEnds.resize(strings);
+	page.strings.resize(strings ? page.stringEnds[strings - 1] : 0);
 }
 
 FileName RollbackStorage::computePageFileName(size_t identifier)
 {
-	return FileName(fileName->path, fileName->name + "_" + StringUtils::convertToString((uint32_t)identifier), fileName->extension);
+	return FileName(fileName->path, fileName->name + "_" + StringUtils::convertToString((uint32_t)identifier), textPages ? fileName->extension : "undo");
 }
 
 void RollbackStorage::savePageToFile()
 {
 	FileName pageFileName = computePageFileName(numPages - 1);
 
-	// open a new temp-cube file
-	boost::shared_ptr<FileWriter> fw(FileWriter::getFileWriter(FileName(pageFileName, "csv")));
+	if (textPages) {
+		// encrypted data files, the page is written by an encrypting file writer
+		boost::shared_ptr<FileWriter> fw(FileWriter::getFileWriter(FileName(pageFileName, "csv")));
 
-	fw->openFile();
+		fw->openFile();
 
-	fw->appendComment("PALO ROLLBACK PAGE DATA");
-	fw->appendComment("");
+		fw->appendComment("PALO ROLLBACK PAGE DATA");
+		fw->appendComment("");
 
-	fw->appendComment("Description of data: ");
-	fw->appendComment("PATH;TYPE;VALUE ");
-	fw->appendSection("VALUES");
+		fw->appendComment("Description of data: ");
+		fw->appendComment("PATH;TYPE;VALUE ");
+		fw->appendSection("VALUES");
 
-	for (vector<pair<IdentifiersType, CellValue> >::iterator it = currentPage.begin(); it != currentPage.end(); ++it) {
-		fw->appendIdentifiers(it->first.begin(), it->first.end());
-		fw->appendInteger(it->second.isString() ? Element::STRING : Element::NUMERIC);
-		if (it->second.isString()) {
-			fw->appendEscapeString(it->second);
-		} else {
-			if (it->second.isEmpty()) {
-				fw->appendString("");
+		PageView view = getView(currentPage);
+		size_t stringIndex = 0;
+		for (size_t i = 0; i < view.cells; i++) {
+			fw->appendIdentifiers(view.keys + i * dimCount, view.keys + (i + 1) * dimCount);
+			if (view.kinds[i] == STRING_CELL) {
+				uint32_t stringBegin = stringIndex ? view.stringEnds[stringIndex - 1] : 0;
+				fw->appendInteger(Element::STRING);
+				fw->appendEscapeString(string(view.stringData + stringBegin, view.stringData + view.stringEnds[stringIndex]));
+				stringIndex++;
 			} else {
-				fw->appendDouble(it->second.getNumeric());
+				fw->appendInteger(Element::NUMERIC);
+				if (view.kinds[i] == EMPTY_CELL) {
+					fw->appendString("");
+				} else {
+					fw->appendDouble(view.numerics[i]);
+				}
 			}
+			fw->nextLine();
 		}
-		fw->nextLine();
-	}
 
-	// that's it
-	fw->appendComment("");
-	fw->appendComment("PALO CUBE DATA END");
+		// that's it
+		fw->appendComment("");
+		fw->appendComment("PALO CUBE DATA END");
 
-	fw->closeFile();
+		fw->closeFile();
+	} else {
+		RollbackPageHeader header;
+		header.magic = RollbackPageHeader::MAGIC;
+		header.dimCount = (uint32_t)dimCount;
+		header.cells = currentPage.kinds.size();
+		header.strings = currentPage.stringEnds.size();
+		header.stringBytes = currentPage.strings.size();
+
+		string name = pageFileName.fullPath();
+		FILE *file = fopen(name.c_str(), "wb");
+		if (file == 0) {
+			throw FileOpenException("could not write rollback page", name);
+		}
+		bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+		ok = ok && (currentPage.numerics.empty() || fwrite(&currentPage.numerics[0], sizeof(double), currentPage.numerics.size(), file) == currentPage.numerics.size());
+		ok = ok && (currentPage.keys.empty() || fwrite(&currentPage.keys[0], sizeof(IdentifierType), currentPage.keys.size(), file) == currentPage.keys.size());
+		ok = ok && (currentPage.stringEnds.empty() || fwrite(&currentPage.stringEnds[0], sizeof(uint32_t), currentPage.stringEnds.size(), file) == currentPage.stringEnds.size());
+		ok = ok && (currentPage.kinds.empty() || fwrite(&currentPage.kinds[0], 1, currentPage.kinds.size(), file) == currentPage.kinds.size());
+		ok = ok && (currentPage.strings.empty() || fwrite(currentPage.strings.data(), 1, currentPage.strings.size(), file) == currentPage.strings.size());
+		ok = fclose(file) == 0 && ok;
+		if (!ok) {
+			FileUtils::remove(pageFileName);
+			throw FileOpenException("could not write rollback page", name);
+		}
+	}
 
 	size_t pageSize = FileWriter::getFileSize(pageFileName);
 	sizeSavedPages += pageSize;
 	pageSizes.push_back(pageSize);
 
 	Logger::debug << "rollback page '" << numPages - 1 << "' saved (sizeSavedPages = " << sizeSavedPages << ")" << endl;
-
 }
 
-void RollbackStorage::loadPageFromFile()
+RollbackStorage::PageView RollbackStorage::openPage(size_t identifier, vector<boost::shared_ptr<void> > &openedPages)
 {
-	currentPage.clear();
-	currentPageSize = 0;
+	FileName pageFileName = computePageFileName(identifier);
 
-	FileName pageFileName = computePageFileName(numPages - 1);
-
-	sizeSavedPages -= FileWriter::getFileSize(pageFileName);
+	if (textPages) {
+		boost::shared_ptr<Page> page(new Page());
+		loadTextPage(pageFileName, *page);
+		openedPages.push_back(page);
+		return getView(*page);
+	}
 
-	{
-		boost::shared_ptr<FileReader> fr(FileReader::getFileReader(pageFileName));
-		fr->openFile(true, false);
+	boost::shared_ptr<RollbackPageFile> file(new RollbackPageFile(pageFileName));
+	openedPages.push_back(file);
 
-		if (fr->isSectionLine() && fr->getSection() == "VALUES") {
-			fr->nextLine();
+	const RollbackPageHeader *header = (const RollbackPageHeader *)file->data();
+	if (file->size() < sizeof(RollbackPageHeader) || header->magic != RollbackPageHeader::MAGIC || header->dimCount != dimCount ||
+		file->size() != sizeof(RollbackPageHeader) + header->cells * (sizeof(double) + dimCount * sizeof(IdentifierType) + 1) + header->strings * sizeof(uint32_t) + header->stringBytes) {
+		throw ErrorException(ErrorException::ERROR_CORRUPT_FILE, "corrupted rollback page " + pageFileName.fullPath());
+	}
 
-			while (fr->isDataLine()) {
-				IdentifiersType path = fr->getDataIdentifiers(0);
-				int type = fr->getDataInteger(1);
-				string value = fr->getDataString(2);
+	PageView view;
+	view.cells = (size_t)header->cells;
+	view.strings = (size_t)header->strings;
+	view.numerics = (const double *)(file->data() + sizeof(RollbackPageHeader));
+	view.keys = (const IdentifierType *)(view.numerics + view.cells);
+	view.stringEnds = (const uint32_t *)(view.keys + view.cells * dimCount);
+	view.kinds = (const uint8_t *)(view.stringEnds + view.strings);
+	view.stringData = (const char *)(view.kinds + view.cells);
+
+	Logger::debug << "rollback page '" << identifier << "' mapped" << endl;
+	return view;
+}
 
-				CellValue val;
-				if (type == 1) {
-					// integer
-					char *p;
-					double d = strtod(value.c_str(), &p);
+void RollbackStorage::loadTextPage(const FileName &pageFileName, Page &page)
+{
+	boost::shared_ptr<FileReader> fr(FileReader::getFileReader(pageFileName));
+	fr->openFile(true, false);
+
+	if (fr->isSectionLine() && fr->getSection() == "VALUES") {
+		fr->nextLine();
+
+		while (fr->isDataLine()) {
+			IdentifiersType path = fr->getDataIdentifiers(0);
+			int type = fr->getDataInteger(1);
+			string value = fr->getDataString(2);
+
+			page.keys.insert(page.keys.end(), path.begin(), path.end());
+			if (type == Element::STRING) {
+				page.numerics.push_back(0);
+				page.kinds.push_back(STRING_CELL);
+				page.strings.append(value);
+				page.stringEnds.push_back((uint32_t)page.strings.size());
+			} else {
+				char *p;
+				double d = strtod(value.c_str(), &p);
 
-					if (*p == '\0') {
-						val = d;
-					}
+				if (!value.empty() && *p == '\0') {
+					page.numerics.push_back(d);
+					page.kinds.push_back(NUMERIC_CELL);
 				} else {
-					// string
-					val = value;
+					page.numerics.push_back(0);
+					page.kinds.push_back(EMPTY_CELL);
 				}
-
-				currentPage.push_back(make_pair(path, val));
-				currentPageSize += getSize(path, val);
-				// get next line of saved data
-				fr->nextLine();
 			}
+			// get next line of saved data
+			fr->nextLine();
 		}
 	}
-
-	FileUtils::remove(pageFileName);
-	pageSizes.pop_back();
-
-	Logger::debug << "rollback page '" << numPages - 1 << "' loaded (sizeSavedPages = " << sizeSavedPages << ")" << endl;
 }
 
 bool RollbackStorage::hasCapacity(double num)
 {
-	if (currentPage.empty()) {
+	if (currentPage.kinds.empty()) {
 		return true;
-	} else {
-		size_t rowSize = currentPage[0].first.size() * sizeof(IdentifierType) + sizeof(CellValue);
-		double max = (maximumFileRollbackSize + maximumMemoryRollbackSize) * 1.0;
-		double used = (sizeSavedPages + currentPageSize) * 1.0;
-		double needed = num * rowSize;
-		return max > used + needed;
 	}
+	size_t rowSize = dimCount * sizeof(IdentifierType) + sizeof(double) + sizeof(uint8_t);
+	double max = (maximumFileRollbackSize + maximumMemoryRollbackSize) * 1.0;
+	double used = (sizeSavedPages + currentPageSize) * 1.0;
+	double needed = num * rowSize;
+	return max > used + needed;
 }
 
 }
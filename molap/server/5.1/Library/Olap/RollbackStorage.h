@@ -47,7 +47,11 @@ namespace palo {
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief palo rollback storage
 ///
-/// A rollback storage uses a rollback page
+/// A rollback storage keeps the old values of the cells changed in a locked
+/// area. The values are stored in columnar pages: the keys of all cells are
+/// packed into one vector, numeric values and strings are kept apart. Full
+/// pages are written to files, binary pages are mapped into memory again
+/// when they are needed for a rollback.
 ////////////////////////////////////////////////////////////////////////////////
 
 class SERVER_CLASS RollbackStorage {
@@ -94,7 +98,8 @@ public:
 
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief rollback steps
-	/// this removes the related values from the storage
+	/// this removes the related values from the storage, a cell changed in
+	/// several of the steps is restored only once
 	////////////////////////////////////////////////////////////////////////////////
 	void rollback(PServer server, PDatabase db, PCube cube, size_t numSteps, PUser user);
 
@@ -104,6 +109,39 @@ public:
 	void addCellValue(const vector<pair<IdentifiersType, CellValue> > &cells);
 
 private:
+	enum CellKind {
+		EMPTY_CELL = 0, NUMERIC_CELL = 1, STRING_CELL = 2
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief rollback page held in memory
+	////////////////////////////////////////////////////////////////////////////////
+
+	struct Page {
+		vector<IdentifierType> keys; // dimCount identifiers per cell
+		vector<double> numerics; // one value per cell, 0 for empty and string cells
+		vector<uint8_t> kinds; // one CellKind per cell
+		vector<uint32_t> stringEnds; // end of each string cell in strings
+		string strings;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief columns of a page in memory or of a mapped page file
+	////////////////////////////////////////////////////////////////////////////////
+
+	struct PageView {
+		PageView() : cells(0), strings(0), keys(0), numerics(0), kinds(0), stringEnds(0), stringData(0) {}
+		size_t cells;
+		size_t strings;
+		const IdentifierType *keys;
+		const double *numerics;
+		const uint8_t *kinds;
+		const uint32_t *stringEnds;
+		const char *stringData;
+	};
+
+	class PageStream;
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief checks if the rollback storage can hold num more values
 	////////////////////////////////////////////////////////////////////////////////
@@ -130,21 +168,33 @@ private:
 	void savePageToFile();
 
 	////////////////////////////////////////////////////////////////////////////////
-	/// @brief create a new rollback page and fill the page from file
+	/// @brief opens a saved page, the memory of the page is kept in openedPages
+	////////////////////////////////////////////////////////////////////////////////
+
+	PageView openPage(size_t identifier, vector<boost::shared_ptr<void> > &openedPages);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief reads a text page written if the data files are encrypted
 	////////////////////////////////////////////////////////////////////////////////
 
-	void loadPageFromFile();
+	void loadTextPage(const FileName &pageFileName, Page &page);
 
-	static size_t getSize(const IdentifiersType &path, const CellValue &val);
+	PageView getView(const Page &page) const;
+	void appendCells(Page &page, const PageView &view, size_t count) const;
+	void truncatePage(Page &page, size_t cells) const;
+	size_t getSize(const Page &page) const;
+	size_t getSize(const CellValue &val) const;
 
 private:
+	size_t dimCount;
+	bool textPages;
 	size_t numPages;
 	PFileName fileName;
 	size_t sizeSavedPages;
 	vector<size_t> pageSizes;
 	size_t currentPageSize;
 	stack<size_t> steps;
-	vector<pair<IdentifiersType, CellValue> > currentPage;
+	Page currentPage;
 	Mutex lock;
 
 private:
@@ -32,6 +32,7 @@
 #include "Olap/RuleMarker.h"
 #include "Engine/EngineBase.h"
 
+#include "Engine/Legacy/NativeCode.h"
 #include "Exceptions/ParameterException.h"
 #include "Exceptions/DefragmentationException.h"
 
@@ -175,6 +176,18 @@ bool Rule::isRestrictedRule() const
 	return isOptimized;
 }
 
+const Area *Rule::getRestrictedArea(CPDatabase db) const
+{
+	if (!isOptimized || !restrictedRule || !restrictedArea) {
+		return 0;
+	}
+	CPDimension dimension = db->lookupDimension(restrictedDimension, false);
+	if (!dimension || dimension->getToken() != restrictedToken) {
+		return 0;
+	}
+	return restrictedArea.get();
+}
+
 void Rule::optimizeRule(CPDatabase db, CPCube cube)
 {
 	// reset optimization
@@ -204,6 +217,9 @@ void Rule::optimizeRule(CPDatabase db, CPCube cube)
 		restrictedDimension = ruleOptimizer.getRestrictedDimension();
 		restrictedIdentifiers = ruleOptimizer.getRestrictedIdentifiers();
 
+		CPDimension dimension = db->lookupDimension(restrictedDimension, false);
+		restrictedToken = dimension ? dimension->getToken() : 0;
+
 		restrictedArea.reset(new Area(*rule->getDestinationArea()));
 
 		int pos = 0;
@@ -488,6 +504,7 @@ Rule::Rule(const Rule &other) : Commitable(other)
 	restrictedRule = other.restrictedRule;
 	restrictedDimension = other.restrictedDimension;
 	restrictedIdentifiers = other.restrictedIdentifiers;
+	restrictedToken = other.restrictedToken;
 	linearRule = other.linearRule;
 	restrictedArea = other.restrictedArea;
 	containsArea = other.containsArea;
@@ -497,6 +514,21 @@ Rule::Rule(const Rule &other) : Commitable(other)
 	evalNullCounter = other.evalNullCounter;
 	position = other.position;
 	custom = other.custom;
+	nativeCode = boost::atomic_load(&other.nativeCode);
+}
+
+paloLegacy::PNativeCode Rule::getNativeCode() const
+{
+	boost::shared_ptr<const NativeCodeEntry> entry = boost::atomic_load(&nativeCode);
+	if (!rule || !entry || entry->node != rule) {
+		return paloLegacy::PNativeCode();
+	}
+	return entry->code;
+}
+
+void Rule::setNativeCode(paloLegacy::PNativeCode code) const
+{
+	boost::atomic_store(&nativeCode, boost::shared_ptr<const NativeCodeEntry>(new NativeCodeEntry(rule, code)));
 }
 
 PCommitable Rule::copy() const
@@ -37,6 +37,11 @@
 
 #define SORT_RULES_BY_POSITION
 
+namespace paloLegacy {
+class native_code;
+typedef boost::shared_ptr<native_code> PNativeCode;
+}
+
 namespace palo {
 class ExprNode;
 typedef boost::shared_ptr<ExprNode> PExprNode;
@@ -53,7 +58,7 @@ public:
 
 	Rule(PRuleNode ruleNode, PDatabase db, PCube cube, const string& definition, const string& external, const string& comment, time_t timestamp, bool activeRule) :
 		Commitable(""), rule(ruleNode), comment(comment), external(external), timestamp(timestamp), activeRule(activeRule), isOptimized(false),
-		restrictedRule(PExprNode()), restrictedDimension(0), evalCounter(0), evalNullCounter(0), position(0), custom(false)
+		restrictedRule(PExprNode()), restrictedDimension(0), restrictedToken(0), evalCounter(0), evalNullCounter(0), position(0), custom(false)
 
 	{
 		this->rule = ruleNode; // rule can be compilable but not active, ruleNode used for definition generation
@@ -192,6 +197,15 @@ public:
 
 	bool isRestrictedRule() const;
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief area of an optimized rule where the non STET expression applies
+	///
+	/// Returns 0 if the rule is not optimized or if the restricted dimension
+	/// changed since the optimization.
+	////////////////////////////////////////////////////////////////////////////////
+
+	const Area *getRestrictedArea(CPDatabase db) const;
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @}
 	////////////////////////////////////////////////////////////////////////////////
@@ -325,6 +339,16 @@ public:
 	bool isCustom() const {return custom;}
 	void setCustom() {checkCheckedOut(); custom = true;}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief gets native code compiled from the current rule definition
+	////////////////////////////////////////////////////////////////////////////////
+	paloLegacy::PNativeCode getNativeCode() const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief stores native code compiled from the current rule definition
+	////////////////////////////////////////////////////////////////////////////////
+	void setNativeCode(paloLegacy::PNativeCode code) const;
+
 	void onCubeChange(CPDatabase db, CPCube cube);
 
 	virtual bool merge(const CPCommitable &o, const PCommitable &p);
@@ -357,6 +381,7 @@ private:
 	PExprNode restrictedRule;
 	IdentifierType restrictedDimension;
 	set<IdentifierType> restrictedIdentifiers;
+	uint32_t restrictedToken;
 	bool linearRule;
 
 	PArea restrictedArea;
@@ -371,7 +396,17 @@ private:
 	double position;
 	bool custom;
 
+	// native code together with the rule node it was compiled from, the node
+	// is held so that its address cannot be reused by a new definition
+	struct NativeCodeEntry {
+		NativeCodeEntry(PRuleNode node, paloLegacy::PNativeCode code) : node(node), code(code) {}
+		PRuleNode node;
+		paloLegacy::PNativeCode code;
+	};
+	mutable boost::shared_ptr<const NativeCodeEntry> nativeCode;
+
 	friend class Planner;
+	friend class RuleDependencies;
 };
 
 bool rulePositionCompare(PRule i,PRule j);
@@ -0,0 +1,381 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "Olap/RuleDependencies.h"
+#include "Olap/Rule.h"
+#include "Olap/RulesList.h"
+#include "Olap/Cube.h"
+#include "Olap/Database.h"
+#include "Olap/Dimension.h"
+#include "Parser/RuleNode.h"
+#include "Parser/SourceNode.h"
+#include "Parser/FunctionNode.h"
+#include "Parser/StringNode.h"
+#include "Parser/VariableNode.h"
+#include "Olap/Server.h"
+
+namespace palo {
+
+RuleDependencies::RuleDependencies(CPRuleList rules, size_t dimCount) : rules(rules), dimCount(dimCount)
+{
+	if (!rules) {
+		return;
+	}
+	for (RuleList::ConstIterator it = rules->const_begin(); it != rules->const_end(); ++it) {
+		CPRule rule = CONST_COMMITABLE_CAST(Rule, *it);
+		const Area *destination = rule->getDestinationArea();
+		if (!rule->isActive() || !rule->rule || !destination) {
+			continue;
+		}
+		vector<Node *> sources;
+		rule->rule->getExprNode()->collectSources(sources);
+
+		for (vector<Node *>::const_iterator sit = sources.begin(); sit != sources.end(); ++sit) {
+			Edge edge;
+			edge.ruleId = rule->getId();
+			edge.destination.reset(new Area(*destination));
+			if ((*sit)->getNodeType() == Node::NODE_SOURCE_NODE) {
+				const SourceNode *source = dynamic_cast<const SourceNode *>(*sit);
+				edge.restriction = *source->getRestriction();
+				edge.elements = *source->getElementIDs();
+			} else {
+				// STET and CONTINUE depend on the same cell
+				edge.restriction.resize(dimCount, uint8_t(AreaNode::NO_RESTRICTION));
+				edge.elements.resize(dimCount, NO_IDENTIFIER);
+			}
+			if (edge.restriction.size() == dimCount && edge.elements.size() == dimCount) {
+				edges.push_back(edge);
+			}
+		}
+
+		vector<Node *> reads;
+		rule->rule->getExprNode()->collectCubeReads(reads);
+
+		for (vector<Node *>::const_iterator rit = reads.begin(); rit != reads.end(); ++rit) {
+			vector<Node *> *params = dynamic_cast<FunctionNode *>(*rit)->getParameters();
+			CubeEdge edge;
+			edge.destination.reset(new Area(*destination));
+			if (params && params->size() > 2 && params->at(0)->getNodeType() == Node::NODE_STRING_NODE && params->at(1)->getNodeType() == Node::NODE_STRING_NODE) {
+				edge.constant = true;
+				edge.databaseName = dynamic_cast<StringNode *>(params->at(0))->getStringValue();
+				edge.cubeName = dynamic_cast<StringNode *>(params->at(1))->getStringValue();
+				for (size_t i = 2; i < params->size(); i++) {
+					Node *param = params->at(i);
+					int ordinal = -1;
+					IdentifierType dimensionId = NO_IDENTIFIER;
+					string elementName;
+					if (param->getNodeType() == Node::NODE_VARIABLE_NODE) {
+						VariableNode *variable = dynamic_cast<VariableNode *>(param);
+						ordinal = variable->getDimensionOrdinal();
+						dimensionId = variable->getDimensionId();
+					} else if (param->getNodeType() == Node::NODE_STRING_NODE) {
+						elementName = dynamic_cast<StringNode *>(param)->getStringValue();
+					}
+					edge.ordinals.push_back(ordinal < (int)dimCount ? ordinal : -1);
+					edge.dimensionIds.push_back(dimensionId);
+					edge.elementNames.push_back(elementName);
+				}
+			}
+			cubeEdges.push_back(edge);
+		}
+	}
+}
+
+bool RuleDependencies::passesThrough(size_t dim, IdentifierType id) const
+{
+	for (vector<Edge>::const_iterator edge = edges.begin(); edge != edges.end(); ++edge) {
+		uint8_t restriction = edge->restriction[dim];
+		if (restriction == AreaNode::OFFSET_RESTRICTION || (restriction == AreaNode::ABS_RESTRICTION && edge->elements[dim] == id)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool RuleDependencies::lookupDimensions(CPDatabase db, CPCube cube, vector<CPDimension> &dimensions) const
+{
+	const IdentifiersType *dimensionIds = cube->getDimensions();
+	if (dimensionIds->size() != dimCount) {
+		return false;
+	}
+	dimensions.resize(dimCount);
+	for (size_t dim = 0; dim < dimCount; dim++) {
+		dimensions[dim] = db->lookupDimension(dimensionIds->at(dim), false);
+		if (!dimensions[dim]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void RuleDependencies::addDestination(ElementSet &target, const Area &destination, size_t dim, CPDimension dimension) const
+{
+	CPSet elements = destination.getDim(dim);
+	if (!elements || !elements->size() || elements->size() >= dimension->sizeElements()) {
+		target.all = true;
+	} else {
+		target.elements.insert(elements->begin(), elements->end());
+	}
+}
+
+bool RuleDependencies::addElements(ElementSet &target, const ElementSet &source) const
+{
+	if (target.all) {
+		return false;
+	}
+	if (source.all) {
+		target.all = true;
+		target.elements.clear();
+		return true;
+	}
+	size_t size = target.elements.size();
+	target.elements.insert(source.elements.begin(), source.elements.end());
+	return size != target.elements.size();
+}
+
+bool RuleDependencies::addAncestors(CPDimension dimension, ElementSet &elements, set<IdentifierType> &expanded) const
+{
+	if (elements.all) {
+		return false;
+	}
+	size_t size = elements.elements.size();
+	vector<IdentifierType> toExpand;
+	for (set<IdentifierType>::const_iterator it = elements.elements.begin(); it != elements.elements.end(); ++it) {
+		if (expanded.insert(*it).second) {
+			toExpand.push_back(*it);
+		}
+	}
+	for (vector<IdentifierType>::const_iterator it = toExpand.begin(); it != toExpand.end(); ++it) {
+		Element *element = dimension->lookupElement(*it, false);
+		if (element) {
+			set<Element *> ancestors = dimension->ancestors(element);
+			for (set<Element *>::const_iterator ait = ancestors.begin(); ait != ancestors.end(); ++ait) {
+				elements.elements.insert((*ait)->getIdentifier());
+				expanded.insert((*ait)->getIdentifier());
+			}
+		}
+	}
+	return size != elements.elements.size();
+}
+
+PArea RuleDependencies::getAffectedArea(CPDatabase db, CPCube cube, const Area &changedArea) const
+{
+	vector<CPDimension> dimensions;
+	if (changedArea.dimCount() != dimCount || !lookupDimensions(db, cube, dimensions)) {
+		return PArea();
+	}
+	vector<ElementSet> affected(dimCount);
+
+	for (size_t dim = 0; dim < dimCount; dim++) {
+		CPSet changedSet = changedArea.getDim(dim);
+		if (!changedSet || changedSet->size() >= dimensions[dim]->sizeElements()) {
+			affected[dim].all = true;
+			continue;
+		}
+		for (Area::ConstElemIter it = changedArea.elemBegin(dim); it != changedArea.elemEnd(dim); ++it) {
+			affected[dim].elements.insert(*it);
+			// splashing to consolidated cells changes the base cells below
+			Element *element = dimensions[dim]->lookupElement(*it, false);
+			if (element && element->getElementType() == Element::CONSOLIDATED) {
+				set<Element *> baseElements = dimensions[dim]->getBaseElements(element, 0);
+				for (set<Element *>::const_iterator bit = baseElements.begin(); bit != baseElements.end(); ++bit) {
+					affected[dim].elements.insert((*bit)->getIdentifier());
+				}
+			}
+		}
+	}
+	return getClosure(dimensions, affected);
+}
+
+bool RuleDependencies::getDependentArea(CPServer server, CPDatabase db, CPCube cube, CPDatabase sourceDb, CPCube sourceCube, const Area *sourceArea, PArea &affected) const
+{
+	affected.reset();
+	const IdentifiersType *sourceDimensions = sourceCube->getDimensions();
+	vector<CPDimension> dimensions;
+	vector<ElementSet> seeds(dimCount);
+	bool found = false;
+
+	for (vector<CubeEdge>::const_iterator edge = cubeEdges.begin(); edge != cubeEdges.end(); ++edge) {
+		if (!edge->constant) {
+			// the cube read is only known when the rule is evaluated
+			return true;
+		}
+		CPDatabase edgeDb = edge->databaseName.empty() ? db : server->lookupDatabaseByName(edge->databaseName, false);
+		if (!edgeDb || edgeDb->getId() != sourceDb->getId()) {
+			continue;
+		}
+		CPCube edgeCube = edge->cubeName.empty() ? cube : edgeDb->lookupCubeByName(edge->cubeName, false);
+		if (!edgeCube || edgeCube->getId() != sourceCube->getId()) {
+			continue;
+		}
+		if (dimensions.empty() && !lookupDimensions(db, cube, dimensions)) {
+			return true;
+		}
+		if (edge->elementNames.size() != sourceDimensions->size() || (sourceArea && sourceArea->dimCount() != sourceDimensions->size())) {
+			return true;
+		}
+
+		vector<ElementSet> targets(dimCount);
+		for (size_t dim = 0; dim < dimCount; dim++) {
+			addDestination(targets[dim], *edge->destination, dim, dimensions[dim]);
+		}
+		bool overlapping = true;
+		for (size_t i = 0; sourceArea && i < sourceDimensions->size() && overlapping; i++) {
+			CPDimension sourceDimension = sourceDb->lookupDimension(sourceDimensions->at(i), false);
+			CPSet changed = sourceArea->getDim(i);
+			if (!sourceDimension || !changed || changed->size() >= sourceDimension->sizeElements()) {
+				continue;
+			}
+			int ordinal = edge->ordinals[i];
+			if (ordinal >= 0 && edge->dimensionIds[i] == sourceDimensions->at(i)) {
+				// the element of the own cell is read
+				ElementSet &target = targets[ordinal];
+				ElementSet read;
+				for (Set::Iterator it = changed->begin(); it != changed->end(); ++it) {
+					if (target.all || target.elements.find(*it) != target.elements.end()) {
+						read.elements.insert(*it);
+					}
+				}
+				target = read;
+				overlapping = !target.elements.empty();
+			} else if (!edge->elementNames[i].empty()) {
+				Element *element = sourceDimension->lookupElementByName(edge->elementNames[i], false);
+				overlapping = element && changed->find(element->getIdentifier()) != changed->end();
+			}
+		}
+		if (overlapping) {
+			found = true;
+			for (size_t dim = 0; dim < dimCount; dim++) {
+				addElements(seeds[dim], targets[dim]);
+			}
+		}
+	}
+
+	if (found) {
+		// the rule targets change, their consolidations and readers as well
+		affected = getClosure(dimensions, seeds);
+	}
+	return found;
+}
+
+PArea RuleDependencies::getClosure(const vector<CPDimension> &dimensions, vector<ElementSet> &affected) const
+{
+	vector<set<IdentifierType> > expanded(dimCount);
+
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		// consolidations of the affected cells
+		for (size_t dim = 0; dim < dimCount; dim++) {
+			changed |= addAncestors(dimensions[dim], affected[dim], expanded[dim]);
+		}
+		// rule targets reading the affected cells
+		for (vector<Edge>::const_iterator edge = edges.begin(); edge != edges.end(); ++edge) {
+			bool overlapping = true;
+			for (size_t dim = 0; dim < dimCount && overlapping; dim++) {
+				if (edge->restriction[dim] == AreaNode::ABS_RESTRICTION && !affected[dim].all) {
+					overlapping = affected[dim].elements.find(edge->elements[dim]) != affected[dim].elements.end();
+				}
+			}
+			if (!overlapping) {
+				continue;
+			}
+			vector<ElementSet> targets(dimCount);
+			for (size_t dim = 0; dim < dimCount && overlapping; dim++) {
+				CPSet destination = edge->destination->getDim(dim);
+				bool allDestination = !destination || !destination->size() || destination->size() >= dimensions[dim]->sizeElements();
+				if (edge->restriction[dim] == AreaNode::NO_RESTRICTION && !affected[dim].all) {
+					// target element equals source element
+					for (set<IdentifierType>::const_iterator it = affected[dim].elements.begin(); it != affected[dim].elements.end(); ++it) {
+						if (allDestination || destination->find(*it) != destination->end()) {
+							targets[dim].elements.insert(*it);
+						}
+					}
+					overlapping = !targets[dim].elements.empty();
+				} else if (allDestination) {
+					targets[dim].all = true;
+				} else {
+					targets[dim].elements.insert(destination->begin(), destination->end());
+				}
+			}
+			if (overlapping) {
+				for (size_t dim = 0; dim < dimCount; dim++) {
+					changed |= addElements(affected[dim], targets[dim]);
+				}
+			}
+		}
+	}
+
+	vector<IdentifiersType> ids(dimCount);
+	bool wholeCube = true;
+	for (size_t dim = 0; dim < dimCount; dim++) {
+		if (affected[dim].all) {
+			ids[dim].push_back(ALL_IDENTIFIERS);
+		} else {
+			ids[dim].assign(affected[dim].elements.begin(), affected[dim].elements.end());
+			wholeCube = false;
+		}
+	}
+	if (wholeCube) {
+		return PArea();
+	}
+	return PArea(new Area(ids));
+}
+
+bool RuleDependencies::extendArea(PArea &area, const Area *other)
+{
+	if (!area) {
+		return false;
+	}
+	if (!other || other->dimCount() != area->dimCount()) {
+		area.reset();
+		return true;
+	}
+	bool grown = false;
+	PArea result(new Area(area->dimCount()));
+	for (size_t dim = 0; dim < area->dimCount(); dim++) {
+		CPSet elements = area->getDim(dim);
+		CPSet otherElements = other->getDim(dim);
+		PSet s(new Set(*elements));
+		if (elements->size() == (size_t)-1) {
+			// already all elements
+		} else if (otherElements->size() == (size_t)-1) {
+			s.reset(new Set(true));
+			grown = true;
+		} else {
+			for (Set::Iterator it = otherElements->begin(); it != otherElements->end(); ++it) {
+				grown |= s->insert(*it);
+			}
+		}
+		result->insert(dim, s, dim + 1 == area->dimCount());
+	}
+	if (grown) {
+		area = result;
+	}
+	return grown;
+}
+
+}
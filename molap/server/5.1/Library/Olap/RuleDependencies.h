@@ -0,0 +1,135 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef OLAP_RULE_DEPENDENCIES_H
+#define OLAP_RULE_DEPENDENCIES_H 1
+
+#include "palo.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dependency graph between rule targets and rule sources of a cube
+///
+/// Every source area of an active rule (and every STET or CONTINUE) is an
+/// edge from the source cells to the destination area of the rule. Starting
+/// with the changed cells, the edges and the consolidation hierarchies are
+/// followed until no new cells are reached. The result is a conservative
+/// hull (one element set per dimension) of all cells whose values can be
+/// changed by the write. Reads of other cubes (PALO.DATA, PALO.MARKER) are
+/// edges from the cells of the other cube to the destination of the rule,
+/// they map a hull of the other cube into a hull of this cube.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS RuleDependencies {
+public:
+	RuleDependencies(CPRuleList rules, size_t dimCount);
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief true if the graph was built from this list of rules
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool isBuiltFrom(CPRuleList rules) const {
+		return this->rules == rules;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the cells depending on changedArea or 0 for the whole cube
+	////////////////////////////////////////////////////////////////////////////////
+
+	PArea getAffectedArea(CPDatabase db, CPCube cube, const Area &changedArea) const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns the cells depending on sourceArea of another cube
+	///
+	/// Returns false if no rule reads the cells of sourceArea. Otherwise
+	/// affected holds the depending cells or is 0 for the whole cube, also if
+	/// the cube read by a rule is not known before the rule is evaluated. A
+	/// sourceArea of 0 stands for the whole source cube.
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool getDependentArea(CPServer server, CPDatabase db, CPCube cube, CPDatabase sourceDb, CPCube sourceCube, const Area *sourceArea, PArea &affected) const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief true if the rules read the element of the dimension only as the
+	/// element of the calculated cell, no source names it or is shifted in
+	/// the dimension
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool passesThrough(size_t dim, IdentifierType id) const;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief extends the hull area by other, 0 stands for the whole cube
+	///
+	/// Returns true if area grew.
+	////////////////////////////////////////////////////////////////////////////////
+
+	static bool extendArea(PArea &area, const Area *other);
+
+private:
+	struct Edge {
+		IdentifierType ruleId;
+		CPArea destination;
+		vector<uint8_t> restriction;
+		IdentifiersType elements;
+	};
+
+	struct CubeEdge {
+		CubeEdge() : constant(false) {}
+		CPArea destination;
+		bool constant;
+		string databaseName;
+		string cubeName;
+		// per dimension of the read cube the dimension ordinal of the own
+		// cube (!dim) or -1 and the name of the constant element or ""
+		vector<int> ordinals;
+		vector<IdentifierType> dimensionIds;
+		vector<string> elementNames;
+	};
+
+	struct ElementSet {
+		ElementSet() : all(false) {}
+		bool all;
+		set<IdentifierType> elements;
+	};
+
+	bool lookupDimensions(CPDatabase db, CPCube cube, vector<CPDimension> &dimensions) const;
+	void addDestination(ElementSet &target, const Area &destination, size_t dim, CPDimension dimension) const;
+	bool addElements(ElementSet &target, const ElementSet &source) const;
+	bool addAncestors(CPDimension dimension, ElementSet &elements, set<IdentifierType> &expanded) const;
+	PArea getClosure(const vector<CPDimension> &dimensions, vector<ElementSet> &affected) const;
+
+	CPRuleList rules;
+	size_t dimCount;
+	vector<Edge> edges;
+	vector<CubeEdge> cubeEdges;
+};
+
+typedef boost::shared_ptr<const RuleDependencies> CPRuleDependencies;
+
+}
+
+#endif
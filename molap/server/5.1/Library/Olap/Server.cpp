@@ -47,6 +47,7 @@
 #include "InputOutput/FileReaderTXT.h"
 #include "InputOutput/FileWriter.h"
 #include "InputOutput/ProgressCallback.h"
+#include "InputOutput/Metrics.h"
 #include "InputOutput/Statistics.h"
 #include "InputOutput/ZipUtils.h"
 
@@ -61,6 +62,7 @@
 #include "Olap/Rule.h"
 
 #include "Engine/EngineCpu.h"
+#include "Engine/EngineColumnar.h"
 #include "Engine/EngineCpuMT.h"
 
 #include "Worker/LoginWorker.h"
@@ -82,7 +84,7 @@ const string Server::VALID_DATABASE_CHARACTERS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcd
 bool Server::ignoreJournal = false;
 
 PServer Server::readersserver;
-Mutex Server::readerslock;
+std::atomic<uint64_t> Server::readersepoch(0);
 PServer Server::writersserver;
 Mutex Server::writerslock;
 
@@ -154,10 +156,13 @@ string LicIter::validateLics(string value)
 	return "";
 }
 
-void Server::invalidateCache(IdentifierType dbId, IdentifierType cubeId)
+void Server::invalidateCache(IdentifierType dbId, IdentifierType cubeId, CPCube changedCube, CPArea changedArea)
 {
-	dbID_cubeID dbCubeId(dbId, cubeId);
 	Context::getContext()->clearQueryCache();
+	map<dbID_cubeID, PArea> affectedAreas;
+	if (dbId != NO_IDENTIFIER && cubeId != NO_IDENTIFIER) {
+		affectedAreas = getAffectedAreas(dbId, cubeId, changedArea);
+	}
 	for (DatabaseList::Iterator dbit = dbs->begin(); dbit != dbs->end(); ++dbit) {
 		if (NULL == (*dbit)) {
 			continue;
@@ -167,16 +172,29 @@ void Server::invalidateCache(IdentifierType dbId, IdentifierType cubeId)
 			if (NULL != (*cbit)) {
 				PCube cube = COMMITABLE_CAST(Cube, *cbit);
 				if (dbId != NO_IDENTIFIER && cubeId != NO_IDENTIFIER) {
-					// check if cube depends on specified cube
+					map<dbID_cubeID, PArea>::const_iterator affected = affectedAreas.find(dbID_cubeID(db->getId(), cube->getId()));
 					ValueCache *cache = cube->getCache();
 					if (cube->getId() == cubeId && (*dbit)->getId() == dbId) {
 						// invalidate cache exactly of this cube
-					} else if (!cache || !cache->isDepending(dbCubeId)) {
-						// this cube doesn't depend on specified cube
+						if (changedArea && cube == changedCube && affected != affectedAreas.end() && affected->second && cube->updateCache(db, *affected->second)) {
+							// only the values depending on the changed cells were removed
+							continue;
+						}
+					} else if (!cache) {
 						continue;
 					} else {
-						// invalidate cache of this depending cube
-//						int breakHere = 1;
+						bool depending = false;
+						for (map<dbID_cubeID, PArea>::const_iterator it = affectedAreas.begin(); it != affectedAreas.end() && !depending; ++it) {
+							depending = cache->isDepending(it->first);
+						}
+						if (!depending || affected == affectedAreas.end()) {
+							// this cube doesn't depend on the changed cells
+							continue;
+						}
+						if (affected->second && cube->invalidateCachedArea(db, *affected->second)) {
+							// only the values depending on the changed cells of the other cubes were removed
+							continue;
+						}
 					}
 				}
 				cube->invalidateCache();
@@ -185,6 +203,57 @@ void Server::invalidateCache(IdentifierType dbId, IdentifierType cubeId)
 	}
 }
 
+map<dbID_cubeID, PArea> Server::getAffectedAreas(IdentifierType dbId, IdentifierType cubeId, CPArea changedArea)
+{
+	map<dbID_cubeID, PArea> result;
+	CPServer server = COMMITABLE_CAST(Server, shared_from_this());
+	CPDatabase changedDb = lookupDatabase(dbId, false);
+	CPCube changedCube = changedDb ? changedDb->lookupCube(cubeId, false) : CPCube();
+	if (!changedCube) {
+		return result;
+	}
+	dbID_cubeID changedId(dbId, cubeId);
+	result[changedId] = changedArea ? changedCube->getRuleDependencies()->getAffectedArea(changedDb, changedCube, *changedArea) : PArea();
+
+	// cubes reading the cells of a changed cube, until no area grows anymore
+	list<dbID_cubeID> changedIds(1, changedId);
+	while (!changedIds.empty()) {
+		dbID_cubeID sourceId = changedIds.front();
+		changedIds.pop_front();
+		CPDatabase sourceDb = lookupDatabase(sourceId.first, false);
+		CPCube sourceCube = sourceDb->lookupCube(sourceId.second, false);
+		PArea sourceArea = result[sourceId];
+
+		for (DatabaseList::Iterator dbit = dbs->begin(); dbit != dbs->end(); ++dbit) {
+			if (NULL == (*dbit)) {
+				continue;
+			}
+			CPDatabase db = CONST_COMMITABLE_CAST(Database, *dbit);
+			for (CubeList::Iterator cbit = db->cubes->begin(); cbit != db->cubes->end(); ++cbit) {
+				if (NULL == (*cbit)) {
+					continue;
+				}
+				CPCube cube = CONST_COMMITABLE_CAST(Cube, *cbit);
+				PArea affected;
+				if (!cube->getRuleDependencies()->getDependentArea(server, db, cube, sourceDb, sourceCube, sourceArea.get(), affected)) {
+					continue;
+				}
+				dbID_cubeID id(db->getId(), cube->getId());
+				map<dbID_cubeID, PArea>::iterator it = result.find(id);
+				if (it == result.end()) {
+					result[id] = affected;
+				} else if (!RuleDependencies::extendArea(it->second, affected.get())) {
+					continue;
+				}
+				if (find(changedIds.begin(), changedIds.end(), id) == changedIds.end()) {
+					changedIds.push_back(id);
+				}
+			}
+		}
+	}
+	return result;
+}
+
 void Server::updateDatabaseDim(bool useDimWorker)
 {
 	systemDatabase->updateDatabaseDim(COMMITABLE_CAST(Server, shared_from_this()), useDimWorker);
@@ -275,14 +344,18 @@ void Server::triggerMarkerCalculation()
 	}
 	PDatabaseList dbs = getDatabaseList(true);
 	setDatabaseList(dbs);
-	// first clear all markers
+	// first clear all markers, markers of a few deleted cells are updated in place
 	for (CubesWithDBs::iterator i = changedMarkerCubes.begin(); i != changedMarkerCubes.end(); ++i) {
 		PDatabase database = lookupDatabase(i->first, true);
 		if (database) {
 			PCube cube = database->lookupCube(i->second, true);
-			if (cube && cube->getStatus() > Cube::UNLOADED && cube->hitMarkerRebuildLimit()) {
-				cube->clearAllMarkers();
-				addCubeToList(database, cube);
+			if (cube && cube->getStatus() > Cube::UNLOADED) {
+				if (cube->hitMarkerRebuildLimit()) {
+					cube->clearAllMarkers();
+					addCubeToList(database, cube);
+				} else if (!cube->isLocked() && cube->updateDeletedMarkers()) {
+					addCubeToList(database, cube);
+				}
 			}
 		}
 	}
@@ -328,6 +401,15 @@ void Server::triggerMarkerCalculation()
 	buildMarkers = false;
 }
 
+// snapshot a reader thread took last, weak so that it doesn't keep old servers
+struct ReaderPin {
+	ReaderPin() : epoch(~(uint64_t)0) {}
+	uint64_t epoch;
+	boost::weak_ptr<Server> server;
+};
+
+static boost::thread_specific_ptr<ReaderPin> readerPin;
+
 PServer Server::getInstance(bool write)
 {
 	PServer ret;
@@ -335,8 +417,21 @@ PServer Server::getInstance(bool write)
 		WriteLocker wl(&writerslock);
 		ret = COMMITABLE_CAST(Server, writersserver->copy());
 	} else {
-		WriteLocker wl(&readerslock);
-		ret = readersserver;
+		// commit publishes the snapshot before it starts the new epoch
+		uint64_t epoch = readersepoch.load(std::memory_order_acquire);
+		ReaderPin *pin = readerPin.get();
+		if (pin == 0) {
+			pin = new ReaderPin();
+			readerPin.reset(pin);
+		} else if (pin->epoch == epoch) {
+			ret = pin->server.lock();
+			if (ret) {
+				return ret;
+			}
+		}
+		ret = boost::atomic_load(&readersserver);
+		pin->epoch = epoch;
+		pin->server = ret;
 	}
 	return ret;
 }
@@ -362,6 +457,9 @@ Server::Server(const FileName & fileName) :
 	PEngineBase cpuEngine(new EngineCpuMT());
 	engines->add(PEngineBase(cpuEngine), true);
 	Logger::debug << "CPU Engine created with Id " << cpuEngine->getId() << endl;
+	PEngineBase columnarEngine(new EngineColumnar());
+	engines->add(columnarEngine, false);
+	Logger::debug << "Columnar Engine created with Id " << columnarEngine->getId() << endl;
 }
 
 Server::Server(const Server & s) :
@@ -1470,17 +1568,22 @@ void Server::setDatabaseList(PDatabaseList l)
 
 bool Server::commit()
 {
+	Metrics::ScopedTimer timer(Metrics::COMMIT);
 	bool ret = true;
 	checkCheckedOut();
 	ret = Context::getContext()->makeCubeChanges(false, PServer());
 	if (!Context::getContext()->isWorker()) {
 		if (ret) {
 			WriteLocker wl(&writerslock);
+			Metrics::ScopedTimer mergeTimer(Metrics::MERGE);
 			ret = merge(writersserver, PCommitable());
 			if (ret) {
 				writersserver = COMMITABLE_CAST(Server, shared_from_this());
-				WriteLocker wl(&readerslock);
-				readersserver = writersserver;
+				boost::atomic_store(&readersserver, writersserver);
+				readersepoch.fetch_add(1, std::memory_order_release);
+			} else {
+				// the job repeats its changes on a new copy of the server
+				Metrics::count(Metrics::COMMIT_CONFLICT);
 			}
 		}
 	}
@@ -1767,7 +1870,7 @@ bool Server::activateGpuEngine(vector<string> gpuDeviceIdsOptions)
 		gpuDeviceOrdinals = getGpuDeviceOrdinals(gpuDeviceIdsSystem, numGpusLicense);
 
 		if (gpuDeviceOrdinals.size() > 0) {
-			if (engines->size() == 1) {
+			if (!engines->get(EngineBase::GPU, false)) {
 				// add EngineGpu
 				PEngineBase gpuEngine(new EngineGpu(gpuDeviceOrdinals));
 				if (gpuEngine != NULL) {
@@ -216,9 +216,17 @@ public:
 	virtual bool optimizeGpuEngine();
 	virtual bool needGpuOptimization();
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief returns a copy of the server for a writer or the current snapshot
+	///
+	/// Readers keep the snapshot of their thread with the epoch it was published
+	/// in and take it again as long as no commit started a new epoch. This
+	/// avoids the spinlock of boost::atomic_load on the shared snapshot, the
+	/// reference count of the returned server is still shared by all threads.
+	////////////////////////////////////////////////////////////////////////////////
 	static PServer getInstance(bool write);
 	static void create(const FileName & fileName);
-	static void destroy() {writersserver.reset(); readersserver.reset();}
+	static void destroy() {writersserver.reset(); boost::atomic_store(&readersserver, PServer()); readersepoch++;}
 	static Mutex &getSaveLock() {return writerslock;}
 	virtual ~Server();
 public:
@@ -387,7 +395,7 @@ public:
 	void ShutdownLoginWorker();
 	void ShutdownDimensionWorker();
 	void ShutdownGpuEngine(PUser user);
-	void invalidateCache(IdentifierType dbId = NO_IDENTIFIER, IdentifierType cubeId = NO_IDENTIFIER);
+	void invalidateCache(IdentifierType dbId = NO_IDENTIFIER, IdentifierType cubeId = NO_IDENTIFIER, CPCube changedCube = CPCube(), CPArea changedArea = CPArea());
 	void updateDatabaseDim(bool useDimWorker);
 	void updateDatabaseDim(SystemDatabase::UpdateType type, const string &dbName, const string &dbOldName, PUser user, bool useDimWorker);
 	void checkOldCubes();
@@ -395,6 +403,15 @@ public:
 	bool isBigEndian() const {return bigEndian;}
 	bool enforceBuildMarkers() const {return buildMarkers;}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief merges the changes of this copy into the server of the writers
+	///
+	/// The merge runs under one lock for the whole server, but it only
+	/// compares the checked out objects. Changes of different databases or
+	/// cubes therefore never conflict. A failed merge is counted as commit
+	/// conflict, the job has to repeat its changes on a new copy.
+	////////////////////////////////////////////////////////////////////////////////
+
 	virtual bool commit();
 	virtual bool merge(const CPCommitable & o, const PCommitable & p);
 	virtual PCommitable copy() const;
@@ -454,6 +471,17 @@ private:
 	}
 	void addSystemDatabaseIntern(bool sys);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief cells of all cubes whose values depend on the changed cells
+	///
+	/// Follows the rule dependency graph of the changed cube and the reads of
+	/// other cubes (PALO.DATA, PALO.MARKER) from cube to cube. An area of 0
+	/// stands for the whole cube, cubes not depending on the changed cells
+	/// are missing.
+	////////////////////////////////////////////////////////////////////////////////
+
+	map<dbID_cubeID, PArea> getAffectedAreas(IdentifierType dbId, IdentifierType cubeId, CPArea changedArea);
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief get vector with all usable gpu device (Compute Capability >= 1.3)
 	////////////////////////////////////////////////////////////////////////////////
@@ -479,8 +507,8 @@ private:
 	PDimensionWorker dimensionWorker;
 	bool dimensionWorkerConfigured;
 	static PServer readersserver;
+	static std::atomic<uint64_t> readersepoch;
 	static PServer writersserver;
-	static Mutex readerslock;
 	static Mutex writerslock;
 
 	PSharedMutex filelock;
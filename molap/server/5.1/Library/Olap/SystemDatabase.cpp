@@ -750,9 +750,9 @@ bool SystemDatabase::groupsUpdateRequired(PServer server, const string& name, ve
 			}
 		}
 
-		if (found && (cv.isEmpty() || cv.compare("1") != 0)) {
+		if (found && (cv.isEmpty() || cv.getString().compare("1") != 0)) {
 			return true; // "1" has to be written
-		} else if (!found && cv.compare("1") == 0) {
+		} else if (!found && cv.getString().compare("1") == 0) {
 			return true; // value has to be deleted
 		}
 	}
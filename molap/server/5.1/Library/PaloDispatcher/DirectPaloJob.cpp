@@ -35,6 +35,7 @@
 #include "Exceptions/ErrorException.h"
 #include "Exceptions/WorkerException.h"
 #include "HttpServer/HttpResponse.h"
+#include "InputOutput/Metrics.h"
 #include "InputOutput/Statistics.h"
 #include "Olap/Context.h"
 #include "Olap/Server.h"
@@ -105,11 +106,12 @@ void DirectPaloJob::work()
 		} catch (const bad_alloc&) {
 			handleException(ErrorException::ERROR_OUT_OF_MEMORY, "Not enough memory", "");
 		}
+		ptime currentTime(microsec_clock::universal_time());
+		uint64_t liveTime = (uint64_t)(currentTime - startTime).total_microseconds();
 		if (session) {
-			ptime currentTime(microsec_clock::universal_time());
-			uint64_t liveTime = (uint64_t)(currentTime - startTime).total_microseconds();
 			session->increaseTime(liveTime, this);
 		}
+		Metrics::recordRequest(Metrics::lookupRequest(getName()), liveTime);
 		return;
 	}
 }
@@ -117,6 +119,7 @@ void DirectPaloJob::work()
 void DirectPaloJob::handleException(ErrorException::ErrorType type, const string& message, const string& details)
 {
 	Context::getContext(0, false)->setSaveToCache(false);
+	Metrics::count(Metrics::REQUEST_ERROR);
 	if (ErrorException::ERROR_OUT_OF_MEMORY == type) {
 		Context::getContext(0, false)->freeEngineCube();
 	}
@@ -152,6 +152,13 @@ bool PaloJob::initialize()
 	return true;
 }
 
+void PaloJob::attachThread()
+{
+	context = Context::getContext();
+	context->setSession(session);
+	context->setTask(ioTask);
+}
+
 // /////////////////////////////////////////////////////////////////////////////
 // check token methods
 // /////////////////////////////////////////////////////////////////////////////
@@ -579,6 +586,30 @@ void PaloJob::findCube(bool requireLoad, bool write)
 	checkToken(cube);
 }
 
+PSharedMutex PaloJob::findCommitLock()
+{
+	if (session && session->isWorker()) {
+		return PSharedMutex(new PaloSharedMutex());
+	}
+	PServer readers = Server::getInstance(false);
+	PDatabase db;
+	if (jobRequest->database != NO_IDENTIFIER) {
+		db = readers->lookupDatabase(jobRequest->database, false);
+	} else if (jobRequest->databaseName) {
+		db = readers->lookupDatabaseByName(*(jobRequest->databaseName), false);
+	}
+	PCube c;
+	if (db) {
+		if (jobRequest->cube != NO_IDENTIFIER) {
+			c = db->lookupCube(jobRequest->cube, false);
+		} else if (jobRequest->cubeName) {
+			c = db->lookupCubeByName(*(jobRequest->cubeName), false);
+		}
+	}
+	// unknown cube is reported later by findCube
+	return c ? c->getCommitLock() : PSharedMutex(new PaloSharedMutex());
+}
+
 void PaloJob::findPath()
 {
 	findCube(true, false);
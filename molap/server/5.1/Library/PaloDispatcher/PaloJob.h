@@ -82,6 +82,12 @@ public:
 	/// {@inheritDoc}
 	////////////////////////////////////////////////////////////////////////////////
 
+	void attachThread();
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// {@inheritDoc}
+	////////////////////////////////////////////////////////////////////////////////
+
 	IdentifierType getSessionInternalId() {
 		if (session) {
 			return session->getInternalId();
@@ -226,6 +232,15 @@ protected:
 
 	void findCube(bool requireLoad, bool write);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief finds commit lock of the requested cube
+	///
+	/// Worker sessions get a private lock, they are writing on behalf of a job
+	/// which already holds the lock of the cube.
+	////////////////////////////////////////////////////////////////////////////////
+
+	PSharedMutex findCommitLock();
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief finds path
 	////////////////////////////////////////////////////////////////////////////////
@@ -31,6 +31,8 @@
 
 #include "PaloDispatcher/PaloJobAnalyser.h"
 
+#include "InputOutput/Metrics.h"
+
 #include "PaloDispatcher/PaloJobRequest.h"
 #include "PaloDispatcher/UnknownRequestJob.h"
 
@@ -52,6 +54,7 @@
 #include "PaloJobs/CellDrillThroughJob.h"
 #include "PaloJobs/CellExportJob.h"
 #include "PaloJobs/CellGoalSeekJob.h"
+#include "PaloJobs/CellImportJob.h"
 #include "PaloJobs/CellReplaceBulkJob.h"
 #include "PaloJobs/CellReplaceJob.h"
 #include "PaloJobs/CellValueJob.h"
@@ -116,12 +119,14 @@
 #include "PaloJobs/RuleModifyJob.h"
 #include "PaloJobs/RuleParseJob.h"
 
+#include "PaloJobs/ServerBatchJob.h"
 #include "PaloJobs/ServerDatabasesJob.h"
 #include "PaloJobs/ServerInfoJob.h"
 #include "PaloJobs/ServerLicenseJob.h"
 #include "PaloJobs/ServerLicensesJob.h"
 #include "PaloJobs/ServerLoadJob.h"
 #include "PaloJobs/ServerMarkersJob.h"
+#include "PaloJobs/ServerMetricsJob.h"
 #include "PaloJobs/ServerLoginJob.h"
 #include "PaloJobs/ServerLogoutJob.h"
 #include "PaloJobs/ServerSaveJob.h"
@@ -166,6 +171,7 @@ PaloJobAnalyser::PaloJobAnalyser()
 	creators["/cell/drillthrough"] = CellDrillThroughJob::create;
 	creators["/cell/export"] = CellExportJob::create;
 	creators["/cell/goalseek"] = CellGoalSeekJob::create;
+	creators["/cell/import"] = CellImportJob::create;
 	creators["/cell/replace_bulk"] = CellReplaceBulkJob::create;
 	creators["/cell/replace"] = CellReplaceJob::create;
 	creators["/cell/value"] = CellValueJob::create;
@@ -229,6 +235,7 @@ PaloJobAnalyser::PaloJobAnalyser()
 	creators["/rule/modify"] = RuleModifyJob::create;
 	creators["/rule/parse"] = RuleParseJob::create;
 
+	creators["/server/batch"] = ServerBatchJob::create;
 	creators["/server/info"] = ServerInfoJob::create;
 	creators["/server/login"] = ServerLoginJob::create;
 	creators["/server/databases"] = ServerDatabasesJob::create;
@@ -237,6 +244,7 @@ PaloJobAnalyser::PaloJobAnalyser()
 	creators["/server/save"] = ServerSaveJob::create;
 	creators["/server/shutdown"] = ServerShutdownJob::create;
 	creators["/server/markers"] = ServerMarkersJob::create;
+	creators["/server/metrics"] = ServerMetricsJob::create;
 	creators["/server/license"] = ServerLicenseJob::create;
 	creators["/server/licenses"] = ServerLicensesJob::create;
 	creators["/server/change_password"] = ServerChangePasswordJob::create;
@@ -249,6 +257,10 @@ PaloJobAnalyser::PaloJobAnalyser()
 	creators["/svs/restart"] = SvsRestartJob::create;
 
 	creators["/view/calculate"] = ViewCalculateJob::create;
+
+	for (map<string, create_fptr>::const_iterator i = creators.begin(); i != creators.end(); ++i) {
+		Metrics::registerRequest(i->first);
+	}
 }
 
 // /////////////////////////////////////////////////////////////////////////////
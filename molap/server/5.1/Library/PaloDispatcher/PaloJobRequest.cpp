@@ -83,6 +83,9 @@ PaloJobRequest::~PaloJobRequest()
 	if (cubeName) {
 		delete cubeName;
 	}
+	if (data) {
+		delete data;
+	}
 	if (databaseName) {
 		delete databaseName;
 	}
@@ -280,6 +283,7 @@ void PaloJobRequest::initialize()
 	comment = 0;
 	condition = 0;
 	cubeName = 0;
+	data = 0;
 	databaseName = 0;
 	definition = 0;
 	dimensionName = 0;
@@ -420,6 +420,7 @@ public:
 	string * comment;
 	string * condition;
 	string * cubeName;
+	string * data; // raw request body of cell/import and server/batch
 	string * databaseName;
 	string * definition;
 	string * dimensionName;
@@ -73,7 +73,7 @@ public:
 //				logfile_level.push_back("");
 //				logfile_message.push_back("");
 			}
-			columns[key[1]]->back() = logData->getValue();
+			columns[key[1]]->back() = logData->getValue().getString();
 			// ordered like in const string SystemDatabase::MESSAGE_ITEMS
 			// "date", "time", "level", "message"
 			//logfile_date[key-startLine] =
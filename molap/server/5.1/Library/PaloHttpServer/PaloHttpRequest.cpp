@@ -51,6 +51,7 @@ PaloHttpRequest::PaloHttpRequest(const string& path, HttpRequestHandler* httpReq
 {
 	paloJobRequest = new PaloJobRequest(path);
 	loginRequest = (path == "/server/login");
+	rawBodyRequest = (path == "/cell/import" || path == "/server/batch");
 }
 
 PaloHttpRequest::~PaloHttpRequest()
@@ -226,6 +227,12 @@ void PaloHttpRequest::extractBody(char* begin, char* end)
 	}
 #endif
 
+	if (rawBodyRequest) {
+		// the body of cell/import and server/batch is the data itself, parameters are passed in the url
+		paloJobRequest->data = new string(begin, end);
+		return;
+	}
+
 	setKeyValues(begin, end);
 }
 
@@ -790,32 +797,36 @@ void PaloHttpRequest::fillVectorUint(vector<uint32_t>*& ints, char* valueStart,
 	ints->push_back(id);
 }
 
+// the fill methods below work on slices of the request buffer, values are
+// converted in place without copying the parameter into temporary strings
+
+static inline const char *findSeparator(const char* p, const char* e, char separator)
+{
+	const char* f = (const char*)memchr(p, separator, e - p);
+	return f ? f : e;
+}
+
 void PaloHttpRequest::fillVectorDouble(vector<double>*& doubles, char* valueStart, char* valueEnd)
 {
 	doubles = new vector<double> ();
-	string buffer = valueStart;
-	size_t size = valueEnd - valueStart;
-	size_t pos = 0;
-	boost::scoped_array<char> dummyBuffer;
-
-	while (pos < size) {
-		string s = StringUtils::getNextElement(buffer, pos, ',', false, dummyBuffer);
-		double v = StringUtils::stringToDouble(s);
-		doubles->push_back(v);
+	const char* p = valueStart;
+
+	while (p < valueEnd) {
+		const char* e = findSeparator(p, valueEnd, ',');
+		doubles->push_back(StringUtils::stringToDouble(p, e));
+		p = e + 1;
 	}
 }
 
 void PaloHttpRequest::fillVectorString(vector<string>*& strings, char* valueStart, char* valueEnd, char separator)
 {
 	strings = new vector<string> ();
-	string buffer = valueStart;
-	size_t size = valueEnd - valueStart;
-	size_t pos = 0;
-	boost::scoped_array<char> dummyBuffer;
-
-	while (pos < size) {
-		string s = StringUtils::getNextElement(buffer, pos, separator, false, dummyBuffer);
-		strings->push_back(s);
+	const char* p = valueStart;
+
+	while (p < valueEnd) {
+		const char* e = findSeparator(p, valueEnd, separator);
+		strings->push_back(string(p, e));
+		p = e + 1;
 	}
 }
 
@@ -827,13 +838,11 @@ void PaloHttpRequest::fillVectorStringQuote(vector<string>*& strings, char* valu
 
 void PaloHttpRequest::fillVectorStringQuote(vector<string>& strings, const char* valueStart, const char* valueEnd, char separator)
 {
-	string buffer = valueStart;
-	size_t size = valueEnd - valueStart;
-	size_t pos = 0;
-	boost::scoped_array<char> quoteBuffer;
+	const char* p = valueStart;
+	string s;
 
-	while (pos < size) {
-		string s = StringUtils::getNextElement(buffer, pos, separator, true, quoteBuffer);
+	while (p < valueEnd) {
+		p = StringUtils::getNextElement(p, valueEnd, separator, true, s);
 		strings.push_back(s);
 	}
 }
@@ -888,28 +897,23 @@ void PaloHttpRequest::fillVectorVectorIdentifier(vector<IdentifiersType>*& ident
 void PaloHttpRequest::fillVectorVectorString(vector<vector<string> >*& strings, char* valueStart, char* valueEnd, char first, char second)
 {
 	strings = new vector<vector<string> > ;
-	string buffer = valueStart;
-	size_t size = valueEnd - valueStart;
-	size_t pos = 0;
-	boost::scoped_array<char> dummyBuffer;
+	const char* p = valueStart;
 
-	while (pos < size) {
-		string s = StringUtils::getNextElement(buffer, pos, first, false, dummyBuffer);
+	while (p < valueEnd) {
+		const char* e = findSeparator(p, valueEnd, first);
+		strings->push_back(vector<string> ());
 
-		if (s.size() == 0 || s == "*") {
-			vector<string> v = vector<string> ();
-			strings->push_back(v);
-		} else {
-			vector<string> v = vector<string> ();
-			size_t pos2 = 0;
+		if (e != p && !(e == p + 1 && *p == '*')) {
+			vector<string>& v = strings->back();
 
-			while (pos2 < s.size()) {
-				string s2 = StringUtils::getNextElement(s, pos2, second, false, dummyBuffer);
-				v.push_back(s2);
+			for (const char* q = p; q < e;) {
+				const char* f = findSeparator(q, e, second);
+				v.push_back(string(q, f));
+				q = f + 1;
 			}
-
-			strings->push_back(v);
 		}
+
+		p = e + 1;
 	}
 }
 
@@ -930,29 +934,23 @@ void PaloHttpRequest::fillVectorVectorStringQuote(vector<vector<string> >& strin
 void PaloHttpRequest::fillVectorVectorDouble(vector<vector<double> >*& doubles, char* valueStart, char* valueEnd, char first, char second)
 {
 	doubles = new vector<vector<double> > ;
-	string buffer = valueStart;
-	size_t size = valueEnd - valueStart;
-	size_t pos = 0;
-	boost::scoped_array<char> dummyBuffer;
+	const char* p = valueStart;
 
-	while (pos < size) {
-		string s = StringUtils::getNextElement(buffer, pos, first, false, dummyBuffer);
+	while (p < valueEnd) {
+		const char* e = findSeparator(p, valueEnd, first);
+		doubles->push_back(vector<double> ());
 
-		if (s.size() == 0 || s == "*") {
-			vector<double> v = vector<double> ();
-			doubles->push_back(v);
-		} else {
-			vector<double> v = vector<double> ();
-			size_t pos2 = 0;
+		if (e != p && !(e == p + 1 && *p == '*')) {
+			vector<double>& v = doubles->back();
 
-			while (pos2 < s.size()) {
-				string s2 = StringUtils::getNextElement(s, pos2, second, false, dummyBuffer);
-				double d = StringUtils::stringToDouble(s2);
-				v.push_back(d);
+			for (const char* q = p; q < e;) {
+				const char* f = findSeparator(q, e, second);
+				v.push_back(StringUtils::stringToDouble(q, f));
+				q = f + 1;
 			}
-
-			doubles->push_back(v);
 		}
+
+		p = e + 1;
 	}
 }
 
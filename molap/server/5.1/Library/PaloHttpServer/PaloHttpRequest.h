@@ -148,6 +148,7 @@ protected:
 
 private:
 	bool loginRequest;
+	bool rawBodyRequest;
 };
 
 }
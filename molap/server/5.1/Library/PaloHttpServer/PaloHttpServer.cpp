@@ -116,6 +116,7 @@ void PaloHttpServer::addCommandHandlers(bool enabled, const HandleCreator &handl
 	addHandler("/server/license", new PaloRequestHandler(enabled));
 	addHandler("/server/licenses", new PaloRequestHandler(enabled));
 	addHandler("/server/login", new PaloSSORequestHandler(false));
+	addHandler("/server/metrics", new PaloRequestHandler(enabled));
 
 	// sid-full
 	addHandler("/cell/area_counter", handleCreator.create(enabled, false));
@@ -124,6 +125,7 @@ void PaloHttpServer::addCommandHandlers(bool enabled, const HandleCreator &handl
 	addHandler("/cell/drillthrough", handleCreator.create(enabled, false));
 	addHandler("/cell/export", handleCreator.create(enabled, false));
 	addHandler("/cell/goalseek", handleCreator.create(enabled, true));
+	addHandler("/cell/import", handleCreator.create(enabled, true));
 	addHandler("/cell/replace_bulk", handleCreator.create(enabled, true));
 	addHandler("/cell/replace", handleCreator.create(enabled, true));
 	addHandler("/cell/value", handleCreator.create(enabled, false));
@@ -187,6 +189,7 @@ void PaloHttpServer::addCommandHandlers(bool enabled, const HandleCreator &handl
 	addHandler("/rule/modify", handleCreator.create(enabled, true));
 	addHandler("/rule/parse", handleCreator.create(enabled, false));
 
+	addHandler("/server/batch", handleCreator.create(enabled, true));
 	addHandler("/server/databases", handleCreator.create(enabled, false));
 	addHandler("/server/load", handleCreator.create(enabled, false));
 	addHandler("/server/logout", handleCreator.create(enabled, false));
@@ -229,12 +232,14 @@ void PaloHttpServer::addDocumentationHandlers(const string& tmpl)
 	const string d1 = tmpl + ".tmpl";
 	const string d2 = tmpl + "2.tmpl";
 
+	addHandler("/api/server/batch", new DocumentationHandler(d1, templateDirectory + "/server_batch.api"));
 	addHandler("/api/server/databases", new DocumentationHandler(d1, templateDirectory + "/server_databases.api"));
 	addHandler("/api/server/info", new DocumentationHandler(d1, templateDirectory + "/server_info.api"));
 	addHandler("/api/server/licenses", new DocumentationHandler(d1, templateDirectory + "/server_licenses.api"));
 	addHandler("/api/server/load", new DocumentationHandler(d1, templateDirectory + "/server_load.api"));
 	addHandler("/api/server/login", new DocumentationHandler(d2, templateDirectory + "/server_login.api"));
 	addHandler("/api/server/logout", new DocumentationHandler(d1, templateDirectory + "/server_logout.api"));
+	addHandler("/api/server/metrics", new DocumentationHandler(d1, templateDirectory + "/server_metrics.api"));
 	addHandler("/api/server/save", new DocumentationHandler(d1, templateDirectory + "/server_save.api"));
 	addHandler("/api/server/shutdown", new DocumentationHandler(d1, templateDirectory + "/server_shutdown.api"));
 	addHandler("/api/server/change_password", new DocumentationHandler(d1, templateDirectory + "/server_change_password.api"));
@@ -294,6 +299,7 @@ void PaloHttpServer::addDocumentationHandlers(const string& tmpl)
 	addHandler("/api/cell/drillthrough", new DocumentationHandler(d1, templateDirectory + "/cell_drillthrough.api"));
 	addHandler("/api/cell/export", new DocumentationHandler(d1, templateDirectory + "/cell_export.api"));
 	addHandler("/api/cell/goalseek", new DocumentationHandler(d1, templateDirectory + "/cell_goalseek.api"));
+	addHandler("/api/cell/import", new DocumentationHandler(d1, templateDirectory + "/cell_import.api"));
 	addHandler("/api/cell/replace", new DocumentationHandler(d1, templateDirectory + "/cell_replace.api"));
 	addHandler("/api/cell/replace_bulk", new DocumentationHandler(d1, templateDirectory + "/cell_replace_bulk.api"));
 	addHandler("/api/cell/value", new DocumentationHandler(d1, templateDirectory + "/cell_value.api"));
@@ -79,6 +79,8 @@ public:
 	////////////////////////////////////////////////////////////////////////////////
 
 	void compute() {
+		PSharedMutex commitLock = findCommitLock();
+		WriteLocker cl(commitLock->getLock());
 		bool ret = false;
 		for (int commitTry = 0; commitTry < Commitable::COMMIT_REPEATS_CELL_REPLACE; commitTry++) {
 			Context *context = Context::getContext();
@@ -145,7 +147,7 @@ public:
 			throw CommitException(ErrorException::ERROR_COMMIT_CANTCOMMIT, "CellCopyJob failed. Internal error occured.");
 		}
 
-		server->invalidateCache();
+		server->invalidateCache(database ? database->getId() : NO_IDENTIFIER, cube ? cube->getId() : NO_IDENTIFIER, cube, cellPathTo);
 
 		generateOkResponse(cube);
 	}
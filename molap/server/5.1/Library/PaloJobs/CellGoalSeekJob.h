@@ -79,6 +79,8 @@ public:
 	////////////////////////////////////////////////////////////////////////////////
 
 	void compute() {
+		PSharedMutex commitLock = findCommitLock();
+		WriteLocker cl(commitLock->getLock());
 		bool ret = false;
 		for (int commitTry = 0; commitTry < Commitable::COMMIT_REPEATS_CELL_REPLACE; commitTry++) {
 			Context *context = Context::getContext();
@@ -141,7 +143,21 @@ public:
 			throw CommitException(ErrorException::ERROR_COMMIT_CANTCOMMIT, "CellGoalSeekJob failed. Internal error occured.");
 		}
 
-		server->invalidateCache();
+		// the goal seek changes the base cells of the path and of the area
+		PArea changedArea = cellPath;
+		if (jobRequest->area && jobRequest->type != 0) {
+			vector<IdentifiersType> changedIds(*jobRequest->area);
+			for (size_t dim = 0; dim < changedIds.size(); dim++) {
+				if (changedIds[dim].size() == 1 && changedIds[dim][0] == ALL_IDENTIFIERS) {
+					continue;
+				}
+				for (Area::ConstElemIter it = cellPath->elemBegin(dim); it != cellPath->elemEnd(dim); ++it) {
+					changedIds[dim].push_back(*it);
+				}
+			}
+			changedArea.reset(new Area(changedIds));
+		}
+		server->invalidateCache(database ? database->getId() : NO_IDENTIFIER, cube ? cube->getId() : NO_IDENTIFIER, cube, changedArea);
 
 		generateOkResponse(cube);
 	}
@@ -0,0 +1,494 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ *
+ */
+
+#ifndef PALO_JOBS_CELL_IMPORT_JOB_H
+#define PALO_JOBS_CELL_IMPORT_JOB_H 1
+
+#include "palo.h"
+
+#include <iostream>
+
+#include "Exceptions/ParameterException.h"
+#include "Olap/Dimension.h"
+#include "Olap/Lock.h"
+#include "Olap/PaloSession.h"
+#include "Olap/Server.h"
+#include "PaloDispatcher/DirectPaloJob.h"
+#include "Thread/ThreadPool.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parses a chunk of lines of a cell/import body
+///
+/// Every line consists of one element per dimension of the cube followed by
+/// the value, separated by commas. Fields may be enclosed in double quotes,
+/// a double quote inside a quoted field is written twice. Lines which cannot
+/// be imported are reported as errors and skipped.
+////////////////////////////////////////////////////////////////////////////////
+
+class CellImportParser : public ThreadPoolJob {
+public:
+	struct Row {
+		IdentifiersType path;
+		string value;
+		double number;
+		CubeArea::CellType cellType;
+		vector<char> elemTypes;
+		size_t line;
+	};
+
+	struct Error {
+		Error(size_t line, ErrorException::ErrorType type, const string &message) : line(line), type(type), message(message) {}
+		size_t line;
+		ErrorException::ErrorType type;
+		string message;
+	};
+
+	CellImportParser(ThreadPool::ThreadGroup &tg, const char *begin, const char *end, const vector<Dimension *> &dims, bool useIdentifier, bool aggregations) :
+		ThreadPoolJob(tg), lineCount(0), begin(begin), end(end), dims(dims), useIdentifier(useIdentifier), aggregations(aggregations) {
+	}
+
+	virtual void operator()() {
+		const char *p = begin;
+		vector<string> fields;
+		while (p < end) {
+			const char *eol = p;
+			while (eol < end && *eol != '\n') {
+				eol++;
+			}
+			const char *last = eol;
+			if (last > p && *(last - 1) == '\r') {
+				last--;
+			}
+			if (last > p) {
+				try {
+					split(p, last, fields);
+					parseLine(fields, lineCount);
+				} catch (ErrorException &e) {
+					errors.push_back(Error(lineCount, e.getErrorType(), e.getMessage()));
+				}
+			}
+			lineCount++;
+			p = eol + 1;
+		}
+	}
+
+	size_t lineCount;
+	vector<Row> rows;
+	vector<Error> errors;
+
+private:
+	void split(const char *p, const char *last, vector<string> &fields) {
+		fields.clear();
+		while (true) {
+			string field;
+			if (p < last && *p == '"') {
+				for (p++; p < last; p++) {
+					if (*p == '"') {
+						if (p + 1 < last && *(p + 1) == '"') {
+							p++;
+						} else {
+							p++;
+							break;
+						}
+					}
+					field += *p;
+				}
+			} else {
+				const char *s = p;
+				while (p < last && *p != ',') {
+					p++;
+				}
+				field.assign(s, p);
+			}
+			fields.push_back(field);
+			if (p >= last) {
+				break;
+			}
+			if (*p != ',') {
+				throw ParameterException(ErrorException::ERROR_INVALID_STRING, "separator expected after quoted field", "field", (int)fields.size());
+			}
+			p++;
+			if (p == last) {
+				fields.push_back(string());
+				break;
+			}
+		}
+	}
+
+	void parseLine(const vector<string> &fields, size_t line) {
+		size_t dimCount = dims.size();
+		if (fields.size() != dimCount + 1) {
+			throw ParameterException(ErrorException::ERROR_INVALID_COORDINATES, "expected " + StringUtils::convertToString((uint32_t)dimCount) + " elements and a value", "fields", (int)fields.size());
+		}
+
+		Row row;
+		row.line = line;
+		row.path.resize(dimCount);
+		row.elemTypes.resize(dimCount);
+		row.number = 0;
+		row.cellType = CubeArea::BASE_NUMERIC;
+
+		for (size_t j = 0; j < dimCount; j++) {
+			Element *element = 0;
+			if (useIdentifier) {
+				char *q;
+				const char *s = fields[j].c_str();
+				unsigned long id = strtoul(s, &q, 10);
+				if (!*s || *q) {
+					throw ParameterException(ErrorException::ERROR_CONVERSION_FAILED, "invalid element identifier '" + fields[j] + "'", "id", fields[j]);
+				}
+				row.path[j] = (IdentifierType)id;
+				if (dims[j]->getDimensionType() == Dimension::VIRTUAL) {
+					row.elemTypes[j] = (char)Element::NUMERIC;
+					continue;
+				}
+				element = dims[j]->lookupElement(row.path[j], false);
+				if (!element) {
+					throw ParameterException(ErrorException::ERROR_ELEMENT_NOT_FOUND, "element with id '" + fields[j] + "' not found in dimension '" + dims[j]->getName() + "'", "id", fields[j]);
+				}
+			} else {
+				element = dims[j]->lookupElementByName(fields[j], false);
+				if (!element) {
+					throw ParameterException(ErrorException::ERROR_ELEMENT_NOT_FOUND, "element '" + fields[j] + "' not found in dimension '" + dims[j]->getName() + "'", "name", fields[j]);
+				}
+				row.path[j] = element->getIdentifier();
+			}
+
+			if (element->isStringConsolidation()) {
+				row.elemTypes[j] = (char)Element::STRING;
+			} else {
+				row.elemTypes[j] = (char)element->getElementType();
+			}
+			if (row.elemTypes[j] == (char)Element::STRING) {
+				row.cellType = CubeArea::BASE_STRING;
+			} else if (aggregations && row.elemTypes[j] == (char)Element::CONSOLIDATED && row.cellType != CubeArea::BASE_STRING) {
+				row.cellType = CubeArea::CONSOLIDATED;
+			}
+		}
+
+		if (row.cellType == CubeArea::BASE_STRING) {
+			row.value = fields[dimCount];
+		} else if (!fields[dimCount].empty()) {
+			row.number = StringUtils::stringToDouble(fields[dimCount]);
+		}
+		rows.push_back(row);
+	}
+
+	const char *begin;
+	const char *end;
+	const vector<Dimension *> &dims;
+	bool useIdentifier;
+	bool aggregations;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cell import
+///
+/// Loads the body of the request (one cell per line) into a cube through a
+/// single commit. The body is split into chunks of lines which are parsed
+/// and resolved in parallel on the thread pool of the server. The response
+/// contains the number of imported, rejected and read lines followed by one
+/// line per rejected line (line number, error code and message).
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS CellImportJob : public DirectPaloJob {
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief factory method
+	////////////////////////////////////////////////////////////////////////////////
+
+	static PaloJob* create(PaloJobRequest* jobRequest) {
+		return new CellImportJob(jobRequest);
+	}
+
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief constructor
+	////////////////////////////////////////////////////////////////////////////////
+
+	CellImportJob(PaloJobRequest* jobRequest) :
+		DirectPaloJob(jobRequest), lineCount(0) {
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// {@inheritDoc}
+	////////////////////////////////////////////////////////////////////////////////
+
+	JobType getType() {
+		return WRITE_JOB;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// {@inheritDoc}
+	////////////////////////////////////////////////////////////////////////////////
+
+	void compute() {
+		PSharedMutex commitLock = findCommitLock();
+		WriteLocker cl(commitLock->getLock());
+		bool ret = false;
+		assertParameter("data", jobRequest->data);
+
+		// the lines are parsed and resolved once, the commit tries reuse the rows
+		findDatabase(true, false);
+		findCube(true, false);
+		vector<boost::shared_ptr<CellImportParser> > parsers;
+		vector<PDimension> parsedDims = lookupDimensions();
+		parse(parsedDims, parsers);
+		clear();
+
+		size_t imported = 0;
+		for (int commitTry = 0; commitTry < Commitable::COMMIT_REPEATS_CELL_REPLACE; commitTry++) {
+			Context *context = Context::getContext();
+
+			bool optimistic = commitTry == 0;
+			server = context->getServerCopy();
+			findDatabase(true, true);
+			findCube(true, true);
+			findLockedPaths(0);
+
+			cube->disableTokenUpdate();
+
+			// get splash mode
+			SplashMode mode = splashMode(jobRequest->splash);
+
+			// true means add value instead of set
+			if (jobRequest->add) {
+				if (mode != DISABLED && mode != DEFAULT) {
+					throw ParameterException(ErrorException::ERROR_INVALID_SPLASH_MODE, "add=1 requires splash mode DEFAULT or DISABLED", PaloRequestHandler::SPLASH, (int)mode);
+				}
+			}
+
+			bool withinEvent = server->isBlocking();
+
+			if (session->isWorker()) {
+				if (!withinEvent || getSid() != server->getActiveSession()) {
+					throw ParameterException(ErrorException::ERROR_NOT_WITHIN_EVENT, "worker cell/import requires an event/begin", "session", getSid());
+				}
+			}
+
+			// get event-process flag, false means to circumvent the processor (right will be checked by cube)
+			bool eventProcessor = jobRequest->eventProcess;
+			bool checkArea = eventProcessor && !withinEvent;
+
+			// a dimension changed by a concurrent commit invalidates the resolved paths
+			vector<PDimension> dims = lookupDimensions();
+			if (dims != parsedDims) {
+				parse(dims, parsers);
+				parsedDims = dims;
+			}
+			size_t dimCount = dims.size();
+
+			size_t rowCount = 0;
+			for (size_t i = 0; i < parsers.size(); i++) {
+				rowCount += parsers[i]->rows.size();
+			}
+
+			bool unused = false; //NULL is also an unused value
+			PCellValueContext cvc = PCellValueContext(new CellValueContext(cube, CellValueContext::CELL_REPLACE_BULK_JOB, database, user, session, checkArea, jobRequest->add, mode, lockedPaths, PCubeArea(), unused, NULL));
+			context->setCellValueContext(cvc);
+
+			cvc->pathVectorAndValue.reserve(rowCount);
+
+			vector<vector<char> > vElemTypes(dimCount);
+			bool hasCons = false;
+			for (size_t i = 0; i < parsers.size(); i++) {
+				vector<CellImportParser::Row> &rows = parsers[i]->rows;
+				for (vector<CellImportParser::Row>::iterator row = rows.begin(); row != rows.end(); ++row) {
+					for (size_t j = 0; j < dimCount; j++) {
+						vElemTypes[j].push_back(row->elemTypes[j]);
+					}
+					if (row->cellType == CubeArea::BASE_STRING) {
+						cvc->addPathAndValue(row->path, row->value.empty() ? CellValue::NullString : CellValue(row->value), !eventProcessor, row->cellType);
+					} else {
+						if (row->cellType == CubeArea::CONSOLIDATED) {
+							hasCons = true;
+						}
+						cvc->addPathAndValue(row->path, row->number == 0 ? CellValue::NullNumeric : CellValue(row->number), !eventProcessor, row->cellType);
+					}
+				}
+			}
+			if (hasCons) {
+				cvc->vElemTypes = &vElemTypes;
+			}
+			imported = rowCount;
+
+			if (!optimistic) {
+				context->setPesimistic();
+			}
+
+			updateLics = true;
+			ret = server->commit();
+			if (ret) {
+				updateLics = false;
+				break;
+			}
+			clear();
+		}
+		if (!ret) {
+			throw CommitException(ErrorException::ERROR_COMMIT_CANTCOMMIT, "CellImportJob failed. Internal error occurred.");
+		}
+
+		PArea changedArea;
+		if (cube && imported) {
+			vector<IdentifiersType> changedIds(cube->getDimensions()->size());
+			for (size_t i = 0; i < parsers.size(); i++) {
+				const vector<CellImportParser::Row> &rows = parsers[i]->rows;
+				for (vector<CellImportParser::Row>::const_iterator row = rows.begin(); row != rows.end(); ++row) {
+					for (size_t j = 0; j < changedIds.size(); j++) {
+						changedIds[j].push_back(row->path[j]);
+					}
+				}
+			}
+			for (size_t j = 0; j < changedIds.size(); j++) {
+				sort(changedIds[j].begin(), changedIds[j].end());
+				changedIds[j].erase(unique(changedIds[j].begin(), changedIds[j].end()), changedIds[j].end());
+			}
+			changedArea.reset(new Area(changedIds));
+		}
+		server->invalidateCache(database ? database->getId() : NO_IDENTIFIER, cube ? cube->getId() : NO_IDENTIFIER, cube, changedArea);
+
+		generateImportResponse(parsers, imported);
+	}
+
+private:
+	static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+	static const size_t MAX_REPORTED_ERRORS = 1000;
+
+	vector<Dimension *> vDims;
+	size_t lineCount;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief dimensions of the cube
+	////////////////////////////////////////////////////////////////////////////////
+
+	vector<PDimension> lookupDimensions() {
+		const IdentifiersType *dims = cube->getDimensions();
+		vector<PDimension> result(dims->size());
+		for (size_t i = 0; i < dims->size(); i++) {
+			result[i] = database->lookupDimension(dims->at(i), false);
+		}
+		return result;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief splits the body at line ends and parses the chunks in parallel
+	////////////////////////////////////////////////////////////////////////////////
+
+	void parse(const vector<PDimension> &dims, vector<boost::shared_ptr<CellImportParser> > &parsers) {
+		parsers.clear();
+		vDims.resize(dims.size());
+		for (size_t i = 0; i < dims.size(); i++) {
+			vDims[i] = dims[i].get();
+		}
+
+		const char *begin = jobRequest->data->data();
+		const char *end = begin + jobRequest->data->size();
+
+		PThreadPool tp = server->getThreadPool();
+		ThreadPool::ThreadGroup tg = tp->createThreadGroup();
+
+		size_t chunks = max((size_t)1, min(tp->getCoreCount(), (size_t)(end - begin) / MIN_CHUNK_SIZE));
+		size_t chunkSize = (end - begin) / chunks + 1;
+
+		while (begin < end) {
+			const char *next = begin + min(chunkSize, (size_t)(end - begin));
+			while (next < end && *(next - 1) != '\n') {
+				next++;
+			}
+			CellImportParser *parser = new CellImportParser(tg, begin, next, vDims, jobRequest->useIdentifier, cube->supportsAggregations());
+			parsers.push_back(boost::shared_ptr<CellImportParser>(parser));
+			begin = next;
+		}
+
+		for (size_t i = 0; i < parsers.size(); i++) {
+			if (i + 1 < parsers.size() && tp->hasFreeCore(false)) {
+				tp->addJob(parsers[i]);
+			} else {
+				(*parsers[i])();
+			}
+		}
+		tp->join(tg);
+
+		// convert the chunk relative line numbers
+		size_t lines = 0;
+		size_t errors = 0;
+		for (size_t i = 0; i < parsers.size(); i++) {
+			vector<CellImportParser::Row> &rows = parsers[i]->rows;
+			for (vector<CellImportParser::Row>::iterator row = rows.begin(); row != rows.end(); ++row) {
+				row->line += lines;
+			}
+			vector<CellImportParser::Error> &errs = parsers[i]->errors;
+			for (vector<CellImportParser::Error>::iterator err = errs.begin(); err != errs.end(); ++err) {
+				err->line += lines;
+			}
+			lines += parsers[i]->lineCount;
+			errors += errs.size();
+		}
+
+		lineCount = lines;
+		Logger::info << "cell/import parsed " << lines << " lines in " << parsers.size() << " chunks, " << errors << " lines rejected" << endl;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief generates the summary and the rejected lines
+	////////////////////////////////////////////////////////////////////////////////
+
+	void generateImportResponse(const vector<boost::shared_ptr<CellImportParser> > &parsers, size_t imported) {
+		response = new HttpResponse(HttpResponse::OK);
+		setToken(cube);
+		StringBuffer& body = response->getBody();
+
+		size_t failed = 0;
+		for (size_t i = 0; i < parsers.size(); i++) {
+			failed += parsers[i]->errors.size();
+		}
+
+		body.appendCsvInteger((uint64_t)imported);
+		body.appendCsvInteger((uint64_t)failed);
+		body.appendCsvInteger((uint64_t)lineCount);
+		body.appendEol();
+
+		size_t reported = 0;
+		for (size_t i = 0; i < parsers.size() && reported < MAX_REPORTED_ERRORS; i++) {
+			const vector<CellImportParser::Error> &errs = parsers[i]->errors;
+			for (vector<CellImportParser::Error>::const_iterator err = errs.begin(); err != errs.end() && reported < MAX_REPORTED_ERRORS; ++err, reported++) {
+				body.appendCsvInteger((uint64_t)(err->line + 1));
+				body.appendCsvInteger((uint32_t)err->type);
+				body.appendCsvString(StringUtils::escapeString(err->message));
+				body.appendEol();
+			}
+		}
+	}
+};
+
+}
+
+#endif
@@ -84,6 +84,8 @@ public:
 	////////////////////////////////////////////////////////////////////////////////
 
 	void compute() {
+		PSharedMutex commitLock = findCommitLock();
+		WriteLocker cl(commitLock->getLock());
 		bool ret = false;
 		for (int commitTry = 0; commitTry < Commitable::COMMIT_REPEATS_CELL_REPLACE; commitTry++) {
 //			ptime parsingStart(microsec_clock::local_time());
@@ -214,7 +216,17 @@ public:
 			throw CommitException(ErrorException::ERROR_COMMIT_CANTCOMMIT, "CellReplaceBulkJob failed. Internal error occurred.");
 		}
 
-		server->invalidateCache(database ? database->getId() : NO_IDENTIFIER, cube ? cube->getId() : NO_IDENTIFIER);
+		PArea changedArea;
+		if (cube && cellPaths && !cellPaths->empty()) {
+			vector<IdentifiersType> changedIds(cube->getDimensions()->size());
+			for (vector<IdentifiersType>::const_iterator it = cellPaths->begin(); it != cellPaths->end(); ++it) {
+				for (size_t i = 0; i < it->size() && i < changedIds.size(); i++) {
+					changedIds[i].push_back(it->at(i));
+				}
+			}
+			changedArea.reset(new Area(changedIds));
+		}
+		server->invalidateCache(database ? database->getId() : NO_IDENTIFIER, cube ? cube->getId() : NO_IDENTIFIER, cube, changedArea);
 
 		generateOkResponse(cube);
 	}
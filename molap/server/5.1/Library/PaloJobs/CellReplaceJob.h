@@ -83,6 +83,8 @@ public:
 	////////////////////////////////////////////////////////////////////////////////
 
 	void compute() {
+		PSharedMutex commitLock = findCommitLock();
+		WriteLocker cl(commitLock->getLock());
 		bool ret = false;
 		for (int commitTry = 0; commitTry < Commitable::COMMIT_REPEATS_CELL_REPLACE; commitTry++) {
 			Context *context = Context::getContext();
@@ -136,7 +138,7 @@ public:
 				for (size_t i = 0; i < value.length(); i++) {
 					if (value[i] >= 0 && value[i] < 32 && value[i] != 9 && value[i] != 10 && value[i] != 13) {
 						// only \n \r \t are allowed from special characters
-						throw ParameterException(ErrorException::ERROR_INVALID_STRING, "string value contains an illegal character", "value", value);
+						throw ParameterException(ErrorException::ERROR_INVALID_STRING, "string value contains an illegal character", "value", value.getString());
 					}
 				}
 
@@ -168,7 +170,7 @@ public:
 			throw CommitException(ErrorException::ERROR_COMMIT_CANTCOMMIT, "CellReplaceJob failed. Internal error occured.");
 		}
 
-		server->invalidateCache(database ? database->getId() : NO_IDENTIFIER, cube ? cube->getId() : NO_IDENTIFIER);
+		server->invalidateCache(database ? database->getId() : NO_IDENTIFIER, cube ? cube->getId() : NO_IDENTIFIER, cube, cellPath);
 
 		generateOkResponse(cube);
 	}
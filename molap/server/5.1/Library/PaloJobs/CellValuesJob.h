@@ -106,6 +106,9 @@ public:
 		}
 		bool checkPermissions = cube->getMinimumAccessRight(user) == RIGHT_NONE;
 
+		// the client cache token has to be taken before the values are calculated
+		uint32_t clientCacheToken = cube->getClientCacheToken();
+
 		boost::scoped_ptr<SubCubeList> subCubes(new SubCubeList());
 		buildSubCubes(subCubes.get(), invalidPaths);
 
@@ -127,6 +130,7 @@ public:
 
 		response = new HttpResponse(HttpResponse::OK);
 		setToken(cube);
+		response->setSecondToken(PaloRequestHandler::X_PALO_CUBE_CLIENT_CACHE, clientCacheToken);
 
 		size_t i = 0;
 		set<size_t>::iterator endip = invalidPaths.end();
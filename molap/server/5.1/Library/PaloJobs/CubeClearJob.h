@@ -75,13 +75,17 @@ public:
 	////////////////////////////////////////////////////////////////////////////////
 
 	void compute() {
+		PSharedMutex commitLock = findCommitLock();
+		WriteLocker cl(commitLock->getLock());
 		bool ret = false;
+		PCubeArea changedArea;
 		for (int commitTry = 0; commitTry < Commitable::COMMIT_REPEATS; commitTry++) {
 			Context *context = Context::getContext();
 
 			server = context->getServerCopy();
 			findDatabase(true, true);
 			findCube(true, true);
+			changedArea.reset();
 
 			cube->disableTokenUpdate();
 
@@ -113,6 +117,7 @@ public:
 						Logger::trace << "clear cube area of " << numResult << " cells" << endl;
 
 					cube->clearCells(server, database, paths, user, true);
+					changedArea = paths;
 				}
 			}
 			ret = server->commit();
@@ -125,7 +130,7 @@ public:
 		if (!ret) {
 			throw CommitException(ErrorException::ERROR_COMMIT_CANTCOMMIT, "Couldn't clear cells in cube. Somebody else is to the changes in same area.");
 		}
-		server->invalidateCache();
+		server->invalidateCache(database ? database->getId() : NO_IDENTIFIER, cube ? cube->getId() : NO_IDENTIFIER, cube, changedArea);
 
 		generateCubeResponse(cube);
 	}
@@ -106,9 +106,7 @@ public:
 			}
 
 			if (!session->isWorker()) {
-				for (ElementsType::iterator it = createdElems.begin(); it != createdElems.end(); ++it) {
-					dimension->addElementEvent(server, database, *it);
-				}
+				dimension->addElementsEvent(server, database, createdElems);
 			}
 
 			server->updateGpuBins(dimension, server, jobRequest, database, Context::getContext(), user);
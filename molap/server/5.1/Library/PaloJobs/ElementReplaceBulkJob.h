@@ -218,11 +218,13 @@ public:
 			}
 
 			if (!session->isWorker()) {
+				ElementsType createdElems;
 				for (vector<pair<Element *, bool> >::iterator it = elemsToReplace.begin(); it != elemsToReplace.end(); ++it) {
 					if (it->second) {
-						dimension->addElementEvent(server, database, it->first);
+						createdElems.push_back(it->first);
 					}
 				}
+				dimension->addElementsEvent(server, database, createdElems);
 			}
 
 			server->updateGpuBins(dimension, server, jobRequest, database, Context::getContext(), user);
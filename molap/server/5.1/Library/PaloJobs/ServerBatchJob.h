@@ -0,0 +1,187 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef PALO_JOBS_SERVER_BATCH_JOB_H
+#define PALO_JOBS_SERVER_BATCH_JOB_H 1
+
+#include "palo.h"
+
+#include "Exceptions/ParameterException.h"
+#include "HttpServer/HttpRequest.h"
+#include "HttpServer/HttpServer.h"
+#include "HttpServer/HttpServerTask.h"
+#include "Olap/Context.h"
+#include "PaloDispatcher/DirectPaloJob.h"
+#include "PaloDispatcher/PaloJobRequest.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief server batch
+///
+/// Executes the requests in the body (one request path with parameters per
+/// line) like pipelined requests of the connection and returns all responses
+/// in one body. Each response is preceded by a line with its index, http
+/// status and length.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS ServerBatchJob : public DirectPaloJob {
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief factory method
+	////////////////////////////////////////////////////////////////////////////////
+
+	static PaloJob* create(PaloJobRequest* jobRequest) {
+		return new ServerBatchJob(jobRequest);
+	}
+
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief constructor
+	////////////////////////////////////////////////////////////////////////////////
+
+	ServerBatchJob(PaloJobRequest* jobRequest) :
+		DirectPaloJob(jobRequest) {
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief gets job type
+	////////////////////////////////////////////////////////////////////////////////
+
+	JobType getType() {
+		return SPECIAL_JOB;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief start working
+	////////////////////////////////////////////////////////////////////////////////
+
+	void compute() {
+		HttpServerTask *task = dynamic_cast<HttpServerTask *>(ioTask);
+
+		if (task == 0) {
+			throw ErrorException(ErrorException::ERROR_INTERNAL, "server/batch needs a http connection");
+		}
+
+		if (jobRequest->data == 0 || jobRequest->data->empty()) {
+			throw ParameterException(ErrorException::ERROR_PARAMETER_MISSING, "missing batch requests", "body", "");
+		}
+
+		// build a GET header for every line, the headers must not move while the requests exist
+		vector<string> headers;
+		headers.reserve(count(jobRequest->data->begin(), jobRequest->data->end(), '\n') + 1);
+
+		const char *p = jobRequest->data->c_str();
+		const char *end = p + jobRequest->data->size();
+
+		while (p < end) {
+			const char *eol = (const char *)memchr(p, '\n', end - p);
+			if (eol == 0) {
+				eol = end;
+			}
+
+			string line(p, (eol > p && eol[-1] == '\r') ? eol - 1 : eol);
+			p = eol + 1;
+
+			if (line.empty()) {
+				continue;
+			}
+
+			// requests without session identifier use the session of the batch
+			if (line.find("?sid=") == string::npos && line.find("&sid=") == string::npos) {
+				line += (line.find('?') == string::npos ? "?sid=" : "&sid=") + jobRequest->sid;
+			}
+
+			headers.push_back("GET " + line + " HTTP/1.1\r\n\r\n");
+		}
+
+		HttpServer *httpServer = task->getHttpServer();
+		vector<HttpRequest*> requests;
+		vector<HttpJobRequest*> jobRequests;
+
+		for (vector<string>::iterator i = headers.begin(); i != headers.end(); ++i) {
+			size_t pathEnd = i->find_first_of("? ", 4);
+			HttpRequest *request = httpServer->createHttpRequest(i->substr(4, pathEnd - 4));
+
+			requests.push_back(request);
+
+			try {
+				if (request->getRequestPath() == jobRequest->getName()) {
+					throw ParameterException(ErrorException::ERROR_INVALID_COMMAND, "server/batch cannot be nested", "path", request->getRequestPath());
+				}
+
+				request->extractHeader(&(*i)[0], &(*i)[0] + i->size());
+				jobRequests.push_back(httpServer->createJobRequest(task, request));
+			} catch (const ErrorException& e) {
+				jobRequests.push_back(httpServer->handleException(e, request));
+			}
+		}
+
+		vector<HttpResponse*> responses;
+		{
+			// every nested job resets the context of the thread when it is
+			// finished, run them in their own context and keep ours
+			BatchContextGuard guard;
+			task->executeRequests(jobRequests, responses);
+		}
+
+		response = new HttpResponse(HttpResponse::OK);
+
+		StringBuffer& body = response->getBody();
+
+		for (size_t i = 0; i < responses.size(); i++) {
+			StringBuffer& result = responses[i]->getBody();
+
+			body.appendCsvInteger((uint64_t)i);
+			body.appendCsvInteger((int32_t)responses[i]->getResponseCode());
+			body.appendCsvInteger((uint64_t)result.length());
+			body.appendEol();
+			body.appendText(result);
+
+			delete responses[i];
+
+			requests[i]->releaseBuffers();
+			delete requests[i];
+		}
+	}
+
+private:
+	struct BatchContextGuard {
+		BatchContextGuard() : saved(Context::detachContext()) {
+		}
+		~BatchContextGuard() {
+			Context::reset();
+			Context::attachContext(saved);
+		}
+		Context *saved;
+	};
+};
+
+}
+
+#endif
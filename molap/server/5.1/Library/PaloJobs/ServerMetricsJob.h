@@ -0,0 +1,88 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef PALO_JOBS_SERVER_METRICS_JOB_H
+#define PALO_JOBS_SERVER_METRICS_JOB_H 1
+
+#include "palo.h"
+
+#include "InputOutput/Metrics.h"
+#include "PaloDispatcher/DirectPaloJob.h"
+#include "PaloDispatcher/PaloJobRequest.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief server metrics
+///
+/// Returns the merged request, engine and cache metrics of all threads as
+/// plain text, one sample per line.
+////////////////////////////////////////////////////////////////////////////////
+
+class SERVER_CLASS ServerMetricsJob : public DirectPaloJob {
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief factory method
+	////////////////////////////////////////////////////////////////////////////////
+
+	static PaloJob* create(PaloJobRequest* jobRequest) {
+		return new ServerMetricsJob(jobRequest);
+	}
+
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief constructor
+	////////////////////////////////////////////////////////////////////////////////
+
+	ServerMetricsJob(PaloJobRequest* jobRequest) :
+		DirectPaloJob(jobRequest) {
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief gets job type
+	////////////////////////////////////////////////////////////////////////////////
+
+	JobType getType() {
+		return READ_JOB;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief start working
+	////////////////////////////////////////////////////////////////////////////////
+
+	void compute() {
+		response = new HttpResponse(HttpResponse::OK);
+		response->setContentType("text/plain; version=0.0.4");
+
+		Metrics::appendText(response->getBody());
+	}
+};
+
+}
+
+#endif
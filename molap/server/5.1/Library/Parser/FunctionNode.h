@@ -84,6 +84,18 @@ public:
 		}
 	}
 
+	void collectSources(vector<Node*>& sources) {
+		for (vector<Node*>::iterator i = params->begin(); i != params->end(); i++) {
+			(*i)->collectSources(sources);
+		}
+	}
+
+	void collectCubeReads(vector<Node*>& reads) {
+		for (vector<Node*>::iterator i = params->begin(); i != params->end(); i++) {
+			(*i)->collectCubeReads(reads);
+		}
+	}
+
 protected:
 	vector<Node*> * cloneParameters();
 
@@ -83,6 +83,10 @@ public:
 		return result;
 	}
 
+	void collectSources(vector<Node*>& sources) {
+		sources.push_back(this);
+	}
+
 	bool genCode(bytecode_generator& generator, uint8_t want) const {
 		return generator.EmitContinue();
 	}
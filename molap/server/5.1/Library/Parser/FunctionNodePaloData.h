@@ -79,6 +79,11 @@ public:
 		return Node::NODE_UNKNOWN_VALUE;
 	}
 
+	void collectCubeReads(vector<Node*>& reads) {
+		reads.push_back(this);
+		FunctionNodePalo::collectCubeReads(reads);
+	}
+
 #ifdef ENABLE_PLAN_FOR_PALO_DATA
 	virtual bool isPlanCompatible(CPCubeArea area, Variability &varDimensions) const
 	{
@@ -426,7 +431,7 @@ public:
 			if (!value.isEmpty()) {
 				if (value.isString()) {
 					result.type = Node::NODE_STRING;
-					result.stringValue = value;
+					result.stringValue = value.getString();
 				} else {
 					result.type = Node::NODE_NUMERIC;
 					result.doubleValue = value.getNumeric();
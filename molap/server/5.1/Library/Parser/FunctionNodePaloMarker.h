@@ -79,6 +79,11 @@ public:
 		return Node::NODE_UNKNOWN_VALUE;
 	}
 
+	void collectCubeReads(vector<Node*>& reads) {
+		reads.push_back(this);
+		FunctionNodePalo::collectCubeReads(reads);
+	}
+
 	const string& getDatabaseName() const {
 		return databaseName;
 	}
@@ -194,7 +199,7 @@ public:
 			if (!value.isEmpty()) {
 				if (value.isString()) {
 					result.type = Node::NODE_STRING;
-					result.stringValue = value;
+					result.stringValue = value.getString();
 				} else {
 					result.type = Node::NODE_NUMERIC;
 					result.doubleValue = value.getNumeric();
@@ -218,6 +218,20 @@ public:
 	virtual void collectMarkers(vector<Node*>& markers) {
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief collects nodes reading cells of the own cube (sources, STET, CONTINUE)
+	////////////////////////////////////////////////////////////////////////////////
+
+	virtual void collectSources(vector<Node*>& sources) {
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief collects nodes reading cells of other cubes (PALO.DATA, PALO.MARKER)
+	////////////////////////////////////////////////////////////////////////////////
+
+	virtual void collectCubeReads(vector<Node*>& reads) {
+	}
+
 	virtual uint32_t guessType(uint32_t level) {
 		Logger::trace << "guessType " << "level " << level << "node " << "unknown" << " type " << "unknown" << endl;
 		return Node::NODE_UNKNOWN_VALUE;
@@ -190,7 +190,7 @@ Node::RuleValueType SourceNode::getValue(const CubeArea* cellPath, bool* isCacha
 	if (!value.isEmpty()) {
 		if (value.isString()) {
 			result.type = Node::NODE_STRING;
-			result.stringValue = value;
+			result.stringValue = value.getString();
 		} else {
 			result.type = Node::NODE_NUMERIC;
 			result.doubleValue = value.getNumeric();
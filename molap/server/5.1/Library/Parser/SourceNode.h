@@ -202,6 +202,10 @@ public:
 		}
 	}
 
+	void collectSources(vector<Node*>& sources) {
+		sources.push_back(this);
+	}
+
 protected:
 	bool validateNames(PServer, PDatabase, PCube, Node*, string&);
 
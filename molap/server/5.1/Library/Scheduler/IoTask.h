@@ -178,6 +178,11 @@ public:
 			FD_ZERO(&fd);
 			FD_SET(readSocket, &fd);
 			int ret = select((int)readSocket + 1, &fd, NULL, NULL, &tv);
+			if (ret > 0) {
+				// a readable socket is either closed or has a pipelined request waiting
+				char c;
+				return recv(readSocket, &c, 1, MSG_PEEK) <= 0;
+			}
 			return ret != 0;
 		}
 		return false;
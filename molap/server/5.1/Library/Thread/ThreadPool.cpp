@@ -28,6 +28,7 @@
  */
 
 #include "Thread/ThreadPool.h"
+#include "InputOutput/Metrics.h"
 #include "Logger/Logger.h"
 
 #if defined(_MSC_VER)
@@ -74,6 +75,7 @@ void ThreadPool::destroy()
 void ThreadPool::addJob(PThreadPoolJob job, unsigned int priority)
 {
 	bool useHP = false;
+	job->queued = Metrics::now();
 	{
 		boost::unique_lock<boost::mutex> lock(m);
 		switch (priority) {
@@ -187,6 +189,7 @@ void ThreadPool::operator()(bool hpOnly)
 			err = !job->tg->errors.empty();
 			notthrow = job->tg->notthrow;
 		}
+		Metrics::record(Metrics::POOL_QUEUE_WAIT, Metrics::now() - job->queued);
 		TGReleaser fin(job->tg, this, hpOnly);
 		if (!err) {
 			try {
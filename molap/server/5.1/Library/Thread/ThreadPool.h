@@ -136,12 +136,13 @@ typedef boost::shared_ptr<ThreadPool> PThreadPool;
 class ThreadPoolJob {
 	friend class ThreadPool;
 public:
-	ThreadPoolJob(ThreadPool::ThreadGroup &tg) : tg(tg) {}
+	ThreadPoolJob(ThreadPool::ThreadGroup &tg) : tg(tg), queued(0) {}
 	virtual ~ThreadPoolJob();
 	ThreadPool::ThreadGroup &getThreadGroup() {return tg;}
 private:
 	virtual void operator()() = 0;
 	ThreadPool::ThreadGroup &tg;
+	uint64_t queued;
 };
 
 class TGReleaser {
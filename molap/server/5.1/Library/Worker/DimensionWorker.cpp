@@ -30,9 +30,14 @@
 #include "Collections/StringUtils.h"
 #include "Logger/Logger.h"
 #include "Exceptions/WorkerException.h"
+#include "Olap/PaloSession.h"
+#include "Olap/Server.h"
+#include "Thread/WriteLocker.h"
 
 namespace palo {
 
+size_t DimensionWorker::poolSize = 1;
+
 // /////////////////////////////////////////////////////////////////////////////
 // Worker methods
 // /////////////////////////////////////////////////////////////////////////////
@@ -50,7 +55,71 @@ bool DimensionWorker::start()
 
 	Logger::trace << "starting dimension worker" << endl;
 
-	return Worker::startint();
+	bool ok = Worker::startint();
+
+	if (ok && !helper && !poolStarted) {
+		ok = startPool();
+	}
+
+	return ok;
+}
+
+
+bool DimensionWorker::startPool()
+{
+	WriteLocker locker(&poolMutex);
+
+	if (poolStarted) {
+		return true;
+	}
+
+	for (vector<boost::shared_ptr<DimensionWorker> >::iterator it = pool.begin(); it != pool.end(); ++it) {
+		if (!(*it)->start()) {
+			Logger::warning << "cannot restart dimension worker of the pool" << endl;
+		}
+	}
+
+	while (pool.size() + 1 < poolSize) {
+		boost::shared_ptr<PaloSession> session = PaloSession::createSession(PUser(), true, 0, Server::getInstance(false)->useShortSid(), false, "worker", 0, 0, 0, "worker", "");
+		boost::shared_ptr<DimensionWorker> worker(new DimensionWorker(session->getSid(), true));
+
+		if (!worker->start()) {
+			Logger::warning << "cannot start dimension worker of the pool, using " << pool.size() + 1 << " processes until the next start" << endl;
+			worker->releaseSession();
+			break;
+		}
+
+		pool.push_back(worker);
+	}
+
+	// an incomplete pool keeps the configured size and is completed by the next start
+	poolCalls.resize(pool.size() + 1);
+	poolStarted = pool.size() + 1 >= poolSize;
+
+	return true;
+}
+
+
+void DimensionWorker::terminate(bool restart)
+{
+	Worker::terminate(restart);
+
+	WriteLocker locker(&poolMutex);
+
+	// the next start brings the processes of the pool up again
+	poolStarted = false;
+
+	for (vector<boost::shared_ptr<DimensionWorker> >::iterator it = pool.begin(); it != pool.end(); ++it) {
+		(*it)->terminate(restart);
+		if (!restart) {
+			(*it)->releaseSession();
+		}
+	}
+
+	if (!restart) {
+		pool.clear();
+		poolCalls.resize(1);
+	}
 }
 
 
@@ -191,48 +260,98 @@ ResultStatus DimensionWorker::readDimensionLines(const vector<string> &result, M
 }
 
 
-ResultStatus DimensionWorker::notifyElementDestroyed(IdentifierType database, IdentifierType dimension, const string &elementName, long function, string session)
+ResultStatus DimensionWorker::notify(const vector<string> &lines, const string &trigger)
 {
-	vector<string> result;
-	ResultStatus status = execute("ELEMENT DESTROYED;" + StringUtils::convertToString(database) + ";" + StringUtils::convertToString(dimension) + ";" + StringUtils::escapeString(elementName) + ";" + StringUtils::convertToString((uint32_t)function) + ";" + session + ";", result, WORKER_TIMEOUT_MSEC);
+	boost::shared_ptr<DimensionWorker> worker;
+	size_t index = 0;
 
-	if (isErrorStatus(result)) {
-		throw WorkerException(result[0].substr(6), true);
-	} else if (isExceptionStatus(result)) {
-		throw WorkerException("SVS ElementDestroy trigger function failed", false);
+	{
+		WriteLocker locker(&poolMutex);
+
+		poolCalls.resize(pool.size() + 1);
+		for (size_t i = 1; i < poolCalls.size(); i++) {
+			if (poolCalls[i] < poolCalls[index]) {
+				index = i;
+			}
+		}
+		poolCalls[index]++;
+
+		if (index) {
+			worker = pool[index - 1];
+		}
+	}
+
+	vector<vector<string> > results;
+	ResultStatus status;
+
+	try {
+		status = (index ? worker.get() : this)->execute(lines, results, WORKER_TIMEOUT_MSEC);
+	} catch (...) {
+		WriteLocker locker(&poolMutex);
+		if (index < poolCalls.size()) {
+			poolCalls[index]--;
+		}
+		throw;
+	}
+
+	{
+		WriteLocker locker(&poolMutex);
+		if (index < poolCalls.size()) {
+			poolCalls[index]--;
+		}
+	}
+
+	for (vector<vector<string> >::const_iterator it = results.begin(); it != results.end(); ++it) {
+		if (isErrorStatus(*it)) {
+			throw WorkerException((*it)[0].substr(6), true);
+		} else if (isExceptionStatus(*it)) {
+			throw WorkerException("SVS " + trigger + " trigger function failed", false);
+		}
 	}
 
 	return status;
 }
 
 
-ResultStatus DimensionWorker::notifyElementRenamed(IdentifierType database, IdentifierType dimension, const string &oldName, const string &newName, long function, string session)
+ResultStatus DimensionWorker::notifyElementDestroyed(IdentifierType database, IdentifierType dimension, const string &elementName, long function, string session)
 {
-	vector<string> result;
-	ResultStatus status = execute("ELEMENT RENAMED;" + StringUtils::convertToString(database) + ";" + StringUtils::convertToString(dimension) + ";" + oldName + ";" + newName + ";" + StringUtils::convertToString((uint32_t)function) + ";" + session + ";", result, WORKER_TIMEOUT_MSEC);
+	return notifyElementsDestroyed(database, dimension, vector<string>(1, elementName), function, session);
+}
 
-	if (isErrorStatus(result)) {
-		throw WorkerException(result[0].substr(6), true);
-	} else if (isExceptionStatus(result)) {
-		throw WorkerException("SVS ElementRename trigger function failed", false);
+
+ResultStatus DimensionWorker::notifyElementsDestroyed(IdentifierType database, IdentifierType dimension, const vector<string> &elementNames, long function, string session)
+{
+	vector<string> lines;
+	for (vector<string>::const_iterator it = elementNames.begin(); it != elementNames.end(); ++it) {
+		lines.push_back("ELEMENT DESTROYED;" + StringUtils::convertToString(database) + ";" + StringUtils::convertToString(dimension) + ";" + StringUtils::escapeString(*it) + ";" + StringUtils::convertToString((uint32_t)function) + ";" + session + ";");
 	}
 
-	return status;
+	return notify(lines, "ElementDestroy");
+}
+
+
+ResultStatus DimensionWorker::notifyElementRenamed(IdentifierType database, IdentifierType dimension, const string &oldName, const string &newName, long function, string session)
+{
+	vector<string> lines(1, "ELEMENT RENAMED;" + StringUtils::convertToString(database) + ";" + StringUtils::convertToString(dimension) + ";" + oldName + ";" + newName + ";" + StringUtils::convertToString((uint32_t)function) + ";" + session + ";");
+
+	return notify(lines, "ElementRename");
 }
 
 
 ResultStatus DimensionWorker::notifyElementCreated(IdentifierType database, IdentifierType dimension, IdentifierType element, long function, string session)
 {
-	vector<string> result;
-	ResultStatus status = execute("ELEMENT CREATED;" + StringUtils::convertToString(database) + ";" + StringUtils::convertToString(dimension) + ";" + StringUtils::convertToString(element) + ";" + StringUtils::convertToString((uint32_t)function) + ";" + session + ";", result, WORKER_TIMEOUT_MSEC);
+	return notifyElementsCreated(database, dimension, IdentifiersType(1, element), function, session);
+}
+
 
-	if (isErrorStatus(result)) {
-		throw WorkerException(result[0].substr(6), true);
-	} else if (isExceptionStatus(result)) {
-		throw WorkerException("SVS ElementCreate trigger function failed", false);
+ResultStatus DimensionWorker::notifyElementsCreated(IdentifierType database, IdentifierType dimension, const IdentifiersType &elements, long function, string session)
+{
+	vector<string> lines;
+	for (IdentifiersType::const_iterator it = elements.begin(); it != elements.end(); ++it) {
+		lines.push_back("ELEMENT CREATED;" + StringUtils::convertToString(database) + ";" + StringUtils::convertToString(dimension) + ";" + StringUtils::convertToString(*it) + ";" + StringUtils::convertToString((uint32_t)function) + ";" + session + ";");
 	}
 
-	return status;
+	return notify(lines, "ElementCreate");
 }
 
 
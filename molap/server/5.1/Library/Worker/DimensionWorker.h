@@ -47,11 +47,19 @@ public:
 	////////////////////////////////////////////////////////////////////////////////
 
 	DimensionWorker(const string& session) :
-		Worker(session), shutdownInProgress(false) {
+		Worker(session), shutdownInProgress(false), helper(false), poolStarted(false) {
 	}
 
 	virtual ~DimensionWorker();
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sets number of worker processes receiving notifications
+	////////////////////////////////////////////////////////////////////////////////
+
+	static void setPoolSize(size_t size) {
+		poolSize = size ? size : 1;
+	}
+
 public:
 
 	typedef map<IdentifierType, long> MapDimension2FunctionId;
@@ -63,6 +71,13 @@ public:
 
 	bool start();
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief terminates the worker and all processes of the pool
+	////////////////////////////////////////////////////////////////////////////////
+
+	virtual void terminate(bool restart);
+	using Worker::terminate;
+
 public:
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -89,8 +104,29 @@ public:
 	ResultStatus notifyElementRenamed(IdentifierType database, IdentifierType dimension, const string &oldName, const string &newName, long function, string session);
 	ResultStatus notifyElementCreated(IdentifierType database, IdentifierType dimension, IdentifierType element, long function, string session);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief informs worker about elements created by one request
+	///
+	/// The notifications are sent to one process of the pool without waiting
+	/// for the result of each notification.
+	////////////////////////////////////////////////////////////////////////////////
+
+	ResultStatus notifyElementsCreated(IdentifierType database, IdentifierType dimension, const IdentifiersType &elements, long function, string session);
+	ResultStatus notifyElementsDestroyed(IdentifierType database, IdentifierType dimension, const vector<string> &elementNames, long function, string session);
+
 
 private:
+	DimensionWorker(const string& session, bool helper) :
+		Worker(session), shutdownInProgress(false), helper(helper), poolStarted(false) {
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sends notifications to the least busy process of the pool
+	////////////////////////////////////////////////////////////////////////////////
+
+	ResultStatus notify(const vector<string> &lines, const string &trigger);
+
+	bool startPool();
 
 	ResultStatus getDimensionsToWatch(MapDatabase2WatchDef &mDims, string command);
 	ResultStatus readDimensionLines(const vector<string> &result, MapDatabase2WatchDef &mDims);
@@ -102,6 +138,14 @@ private:
 	MapDatabase2WatchDef mapElementDestroy;
 	MapDatabase2WatchDef mapElementRename;
 	MapDatabase2WatchDef mapElementCreate;
+
+	bool helper;
+	bool poolStarted;
+	Mutex poolMutex;
+	vector<boost::shared_ptr<DimensionWorker> > pool; // other processes, this worker is not included
+	vector<size_t> poolCalls; // running calls of this worker followed by the pool
+
+	static size_t poolSize;
 };
 
 }
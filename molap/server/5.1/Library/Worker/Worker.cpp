@@ -235,6 +235,67 @@ ResultStatus Worker::execute(const string& line, vector<string>& result, time_t
 	}
 }
 
+ResultStatus Worker::execute(const vector<string>& lines, vector<vector<string> >& results, time_t timeout)
+{
+	WriteLocker locker(&mutex);
+
+	results.clear();
+
+	if (status != WORKER_RUNNING) {
+		return RESULT_FAILED;
+	}
+
+	Context::getContext()->check();
+
+	if (numFailures >= maxFailures) {
+		// SVS failed to execute the required command, has to be recovered manually by administrator
+		throw WorkerException("SVS script error, can't recover, contact administrator.", false);
+	}
+
+	boost::shared_ptr<PaloSession> s = PaloSession::findSession(session, false);
+	s->setWorkerContext(Context::getContext());
+
+	size_t sent = 0;
+
+	while (results.size() < lines.size()) {
+		bool ok = true;
+
+		// the pipes have limited buffers, the worker could block writing results
+		while (ok && sent < lines.size() && sent - results.size() < PIPELINE_DEPTH) {
+			ok = sendLine(lines[sent], timeout);
+			sent++;
+		}
+
+		if (ok) {
+			result.clear();
+			ok = readResult(timeout);
+		}
+
+		if (!ok) {
+			if (timeout == 0) {
+				ok = restart();
+			} else {
+				// results of the unanswered requests must not be read by the next call
+				restartProcess();
+			}
+
+			if (!ok || timeout != 0) {
+				s->setWorkerContext(0);
+				return RESULT_FAILED;
+			}
+
+			// send all unanswered requests again
+			sent = results.size();
+			continue;
+		}
+
+		results.push_back(this->result);
+	}
+
+	s->setWorkerContext(0);
+	return RESULT_OK;
+}
+
 void Worker::terminate(const string& line, time_t timeout)
 {
 	WriteLocker locker(&mutex);
@@ -616,6 +677,11 @@ bool Worker::restart()
 
 	Logger::warning << "trying to restart worker" << endl;
 
+	return restartProcess();
+}
+
+bool Worker::restartProcess()
+{
 	terminateProcess();
 
 	bool ok = startProcess();
@@ -47,6 +47,12 @@ class SERVER_CLASS Worker {
 public:
 	static const int WORKER_TIMEOUT_MSEC = 2000;
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief maximal number of requests sent before the first result is read
+	////////////////////////////////////////////////////////////////////////////////
+
+	static const size_t PIPELINE_DEPTH = 16;
+
 public:
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -102,6 +108,15 @@ public:
 
 	virtual ResultStatus execute(const string& line, vector<string>& result, time_t timeout);
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sends requests to the worker without waiting for each result
+	///
+	/// The worker answers the requests in order, the results are returned in
+	/// the order of the lines.
+	////////////////////////////////////////////////////////////////////////////////
+
+	virtual ResultStatus execute(const vector<string>& lines, vector<vector<string> >& results, time_t timeout);
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief sends a terminate request to the worker and kills the process
 	////////////////////////////////////////////////////////////////////////////////
@@ -168,6 +183,8 @@ private:
 
 	bool restart();
 
+	bool restartProcess();
+
 	bool readLine(string& line, time_t timeout);
 
 	bool fillReadBuffer(time_t timeout);
@@ -43,6 +43,8 @@
 #include "Worker/DimensionWorker.h"
 #include "PaloJobs/AreaJob.h"
 #include "InputOutput/FileReaderBF.h"
+#include "Engine/Legacy/NativeCode.h"
+#include "Engine/EngineColumnar.h"
 
 namespace palo {
 using namespace std;
@@ -53,6 +55,7 @@ using namespace std;
 
 // build options parser
 static const char * AllowedOptions[] = {"?|help",
+        "\x01:dimension-workers     <number_of_processes>",
         "a+admin                 <address> <port>",
         "A|auto-load",
         "b:cache-barrier         <maximum of number_of_cells to store in each Cube cache>",
@@ -68,6 +71,7 @@ static const char * AllowedOptions[] = {"?|help",
         "F:friendly-service-name <service-name>",
 #endif
         "g:cross-origin          <domain_name>",
+        "G|no-rule-jit",
         "h+http                  <address> <port>",
 #if defined(ENABLE_HTTPS)
         "H+https                 <port>",
@@ -83,6 +87,8 @@ static const char * AllowedOptions[] = {"?|help",
         "M:session-timeout       <seconds>",
         "m:undo-memory-size      <undo_memory_size_in_bytes_per_lock>",
         "n|load-init-file",
+        "N:columnar-min-cells    <number_of_cells>",
+        "\x02+columnar-cube         <database> <cube>",
         "o:log                   <logfile>",
         "O|amazon-id",
         "p:password              <private-password>",
@@ -150,6 +156,7 @@ PaloOptions::PaloOptions(int argc, char** argv) :
 	extensionsDirectory = "usr/lib"+suffix;
 #endif
 	friendlyServiceName = "PALO Server Service";
+	columnarMinCells = 1000000;
 	goalseekCellLimit = 1000;
 	goalseekTimeout = 10000;
 	ignoreCellData = false;
@@ -169,6 +176,8 @@ PaloOptions::PaloOptions(int argc, char** argv) :
 	undoMemorySize = 10 * 1024 * 1024;
 	useCubeWorkers = false;
 	useDimensionWorker = false;
+	dimensionWorkers = 1;
+	useRuleJit = true;
 	useFakeSession = false;
 	useInitFile = true;
 
@@ -247,6 +256,12 @@ void PaloOptions::checkOptions()
 		}
 	}
 
+	// check columnar database/cube pairs
+	if (columnarCubes.size() % 2 == 1) {
+		cout << "not enough arguments to --columnar-cube\n" << endl;
+		usage();
+	}
+
 	// check admin host/port pairs
 	if (adminPorts.size() % 2 == 1) {
 		cout << "not enough arguments to --admin\n" << endl;
@@ -297,6 +312,10 @@ void PaloOptions::updateGlobals()
 	Server::setCrossOrigin(crossOrigin);
 	Cube::setCacheBarrier(cacheBarrier);
 	Cube::setGoalseekCellLimit(goalseekCellLimit);
+	EngineColumnar::setMinCells(columnarMinCells);
+	for (size_t i = 0; i + 1 < columnarCubes.size(); i += 2) {
+		EngineColumnar::addCube(columnarCubes[i], columnarCubes[i + 1]);
+	}
 	Cube::setGoalseekTimeout(goalseekTimeout);
 	Cube::setIgnoreCellData(ignoreCellData);
 	Cube::setSaveCSV(saveCSV);
@@ -306,6 +325,8 @@ void PaloOptions::updateGlobals()
 
 	CubeWorker::setUseCubeWorker(useCubeWorkers);
 
+	paloLegacy::native_code::setEnabled(useRuleJit);
+
 	RollbackStorage::setMaximumMemoryRollbackSize(undoMemorySize);
 	RollbackStorage::setMaximumFileRollbackSize(undoFileSize);
 
@@ -331,6 +352,7 @@ void PaloOptions::updateGlobals()
 			server->setLoginWorker(worker);
 		}
 		if (useDimensionWorker) {
+			DimensionWorker::setPoolSize(dimensionWorkers > 0 ? dimensionWorkers : 1);
 			boost::shared_ptr<PaloSession> session = PaloSession::createSession(PUser(), true, 0, shortSid, false, "worker", 0, 0, 0, "worker", "");
 			PDimensionWorker worker(new DimensionWorker(session->getSid()));
 			server->setDimensionWorker(worker);
@@ -376,8 +398,11 @@ void PaloOptions::usage()
 		     << "auto-commit on exit:   " << (autoCommit ? "true" : "false") << "\n"
 		     << "use cube workers:      " << (useCubeWorkers ? "true" : "false") << "\n"
 		     << "use dimension worker:  " << (useDimensionWorker ? "true" : "false") << "\n"
+		     << "dimension workers:     " << dimensionWorkers << "\n"
+		     << "use rule jit:          " << (useRuleJit ? "true" : "false") << "\n"
 		     << "drillthrough enabled:  " << (drillThroughEnabled ? "true" : "false") << "\n"
 		     << "cache-barrier:         " << cacheBarrier << "\n"
+		     << "columnar-min-cells:    " << columnarMinCells << "\n"
 		     << "gpu server enabled:    " << (enableGpu ? "true" : "false") << "\n"
 		     << "gpu device ids:              list of gpu device ids\n"
 		     ;
@@ -438,6 +463,11 @@ void PaloOptions::parseOptions(OptionsIterator& iter, bool commandLine)
 			int i;
 			double d;
 			switch (optchar) {
+			case '\x01':
+				i = StringUtils::stringToInteger(optarg);
+				dimensionWorkers = i;
+				break;
+
 			case 'a':
 				if (adminPorts.size() % 2 == 1) {
 					i = StringUtils::stringToInteger(optarg);
@@ -504,6 +534,10 @@ void PaloOptions::parseOptions(OptionsIterator& iter, bool commandLine)
 				crossOrigin = optarg;
 				break;
 
+			case 'G':
+				useRuleJit = !useRuleJit;
+				break;
+
 			case 'h':
 				if (httpPorts.size() % 2 == 1) {
 					i = StringUtils::stringToInteger(optarg);
@@ -566,6 +600,15 @@ void PaloOptions::parseOptions(OptionsIterator& iter, bool commandLine)
 				defaultTtl = i;
 				break;
 
+			case 'N':
+				i = StringUtils::stringToInteger(optarg);
+				columnarMinCells = i;
+				break;
+
+			case '\x02':
+				columnarCubes.push_back(optarg);
+				break;
+
 			case 'n':
 				if (commandLine) {
 					useInitFile = !useInitFile;
@@ -715,6 +758,7 @@ void PaloOptions::parseOptions(OptionsIterator& iter, bool commandLine)
 			}
 		} catch (const ErrorException &e) {
 			switch (optchar) {
+			case '\x01':
 			case 'a':
 			case 'b':
 			case 'h':
@@ -725,6 +769,7 @@ void PaloOptions::parseOptions(OptionsIterator& iter, bool commandLine)
 			case 'L':
 			case 'm':
 			case 'M':
+			case 'N':
 			case 'u':
 			case 'z':
 			case 'Z':
@@ -175,6 +175,18 @@ public:
 
 	string friendlyServiceName;
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief minimal number of cells aggregated by the columnar engine (-N)
+	////////////////////////////////////////////////////////////////////////////////
+
+	int columnarMinCells;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief database and cube pairs calculated by the columnar engine (--columnar-cube)
+	////////////////////////////////////////////////////////////////////////////////
+
+	vector<string> columnarCubes;
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief goalseek cell limit (-J)
 	////////////////////////////////////////////////////////////////////////////////
@@ -326,6 +338,18 @@ public:
 
 	bool useDimensionWorker;
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief number of dimension worker processes (-1)
+	////////////////////////////////////////////////////////////////////////////////
+
+	int dimensionWorkers;
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief compile numeric rules to native code (-G)
+	////////////////////////////////////////////////////////////////////////////////
+
+	bool useRuleJit;
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// @brief use a fake session id for debugging (-f)
 	////////////////////////////////////////////////////////////////////////////////
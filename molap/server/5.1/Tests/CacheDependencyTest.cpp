@@ -0,0 +1,191 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include "Olap/Cube.h"
+#include "Olap/Database.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t ITEMS = 4;
+
+static string itemName(size_t i)
+{
+	return "item" + StringUtils::convertToString((uint64_t)i);
+}
+
+static string encode(const string &text)
+{
+	string result;
+	for (size_t i = 0; i < text.size(); i++) {
+		unsigned char c = text[i];
+		if (isalnum(c)) {
+			result += c;
+		} else {
+			char buffer[4];
+			snprintf(buffer, sizeof(buffer), "%%%02X", c);
+			result += buffer;
+		}
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cube dep reads the measure a of the cube src by PALO.DATA into
+/// its measure b, item1 to item4 are consolidated by total. ROUND keeps the
+/// rule from being planned as a plain source, its values are cached.
+////////////////////////////////////////////////////////////////////////////////
+
+static void createCubes(TestServer &server)
+{
+	server.request("/database/create?new_name=test");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/dimension/create?name_database=test&new_name=items");
+	server.request("/dimension/create?name_database=test&new_name=measure");
+
+	string names;
+	for (size_t i = 1; i <= ITEMS; i++) {
+		names += (i > 1 ? "," : "") + itemName(i);
+	}
+	server.request("/element/create_bulk?name_database=test&name_dimension=items&type=1&name_elements=" + names);
+	server.request("/element/create?name_database=test&name_dimension=items&type=4&new_name=total&name_children=" + names);
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/element/create_bulk?name_database=test&name_dimension=measure&type=1&name_elements=a,b");
+	TEST_CHECK(server.lastStatus == 200);
+
+	server.request("/cube/create?name_database=test&new_name=src&name_dimensions=items,measure");
+	server.request("/cube/create?name_database=test&new_name=dep&name_dimensions=items,measure");
+	TEST_CHECK(server.lastStatus == 200);
+
+	server.request("/rule/create?name_database=test&name_cube=dep&definition=" + encode("['b'] = ROUND(PALO.DATA(\"test\",\"src\",!'items',\"a\") * 2, 0)"));
+	TEST_CHECK(server.lastStatus == 200);
+
+	for (size_t i = 1; i <= ITEMS; i++) {
+		server.request("/cell/replace?name_database=test&name_cube=src&name_path=" + itemName(i) + ",a&value=" + StringUtils::convertToString((uint64_t)i));
+		TEST_CHECK(server.lastStatus == 200);
+	}
+}
+
+static double value(TestServer &server, const string &cube, const string &path)
+{
+	string body = server.request("/cell/value?name_database=test&name_cube=" + cube + "&name_path=" + path);
+	TEST_CHECK(server.lastStatus == 200);
+	// type;exists;value;
+	size_t start = body.find(';', body.find(';') + 1);
+	size_t end = body.find(';', start + 1);
+	return end == string::npos ? 0 : StringUtils::stringToDouble(body.substr(start + 1, end - start - 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief true if the value of the cell of the cube dep is cached
+////////////////////////////////////////////////////////////////////////////////
+
+static bool isCached(const string &item, const string &measure)
+{
+	// the values of a request reach the cache of the cube with the end of its
+	// context, the next job would end it the same way
+	Context::reset();
+
+	CPServer server = Server::getInstance(false);
+	CPDatabase db = server->lookupDatabaseByName("test", false);
+	CPCube cube = db->lookupCubeByName("dep", false);
+	IdentifiersType key;
+	key.push_back(db->findDimensionByName("items", PUser(), false)->findElementByName(item, 0, false)->getIdentifier());
+	key.push_back(db->findDimensionByName("measure", PUser(), false)->findElementByName(measure, 0, false)->getIdentifier());
+
+	PStorageCpu storage;
+	ValueCache::PCachedAreas areas;
+	cube->getCache()->getAreasAndStorage(storage, areas);
+	for (ValueCache::CachedAreas::const_iterator ruleAreas = areas->begin(); ruleAreas != areas->end(); ++ruleAreas) {
+		for (SubCubeList::const_iterator it = ruleAreas->second->begin(); it != ruleAreas->second->end(); ++it) {
+			if (it->second->find(key) != it->second->pathEnd()) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a write to src drops the rule values of dep reading the written
+/// cell and their consolidations, the other values stay cached
+////////////////////////////////////////////////////////////////////////////////
+
+static void testDependentCube(TestServer &server)
+{
+	server.request("/cell/area?name_database=test&name_cube=dep&area=0:1:2:3:4,1");
+	TEST_CHECK(server.lastStatus == 200);
+	for (size_t i = 1; i <= ITEMS; i++) {
+		TEST_CHECK(isCached(itemName(i), "b"));
+	}
+
+	server.request("/cell/replace?name_database=test&name_cube=src&name_path=item1,a&value=10");
+	TEST_CHECK(server.lastStatus == 200);
+
+	TEST_CHECK(!isCached("item1", "b"));
+	TEST_CHECK(!isCached("total", "b"));
+	for (size_t i = 2; i <= ITEMS; i++) {
+		TEST_CHECK(isCached(itemName(i), "b"));
+	}
+
+	TEST_CHECK(value(server, "dep", "item1,b") == 20);
+	TEST_CHECK(value(server, "dep", "item2,b") == 4);
+	TEST_CHECK(value(server, "dep", "total,b") == 38);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a write to a cell no rule reads keeps the values of dep cached
+////////////////////////////////////////////////////////////////////////////////
+
+static void testIndependentCell(TestServer &server)
+{
+	server.request("/cell/area?name_database=test&name_cube=dep&area=0:1:2:3:4,1");
+	TEST_CHECK(isCached("item1", "b"));
+
+	server.request("/cell/replace?name_database=test&name_cube=src&name_path=item1,b&value=7");
+	TEST_CHECK(server.lastStatus == 200);
+
+	for (size_t i = 1; i <= ITEMS; i++) {
+		TEST_CHECK(isCached(itemName(i), "b"));
+	}
+	TEST_CHECK(value(server, "dep", "item1,b") == 20);
+}
+
+int main(int argc, char * argv[])
+{
+	{
+		TestServer server;
+
+		createCubes(server);
+		testDependentCube(server);
+		testIndependentCell(server);
+	}
+
+	return TEST_RESULT();
+}
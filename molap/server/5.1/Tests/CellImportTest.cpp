@@ -0,0 +1,189 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static string encode(const string &text)
+{
+	string result;
+	for (size_t i = 0; i < text.size(); i++) {
+		unsigned char c = text[i];
+		if (isalnum(c)) {
+			result += c;
+		} else {
+			char buffer[4];
+			snprintf(buffer, sizeof(buffer), "%%%02X", c);
+			result += buffer;
+		}
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the regions 0 to 2 are Germany and two names with a comma and with
+/// double quotes, the measures 0 to 2 are a, b and the string element text
+////////////////////////////////////////////////////////////////////////////////
+
+static void createCube(TestServer &server)
+{
+	server.request("/database/create?new_name=test");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/dimension/create?name_database=test&new_name=regions");
+	server.request("/dimension/create?name_database=test&new_name=measure");
+	server.request("/element/create?name_database=test&name_dimension=regions&type=1&new_name=Germany");
+	server.request("/element/create?name_database=test&name_dimension=regions&type=1&new_name=" + encode("Ile, de France"));
+	server.request("/element/create?name_database=test&name_dimension=regions&type=1&new_name=" + encode("say \"hi\""));
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/element/create_bulk?name_database=test&name_dimension=measure&type=1&name_elements=a,b");
+	server.request("/element/create?name_database=test&name_dimension=measure&type=2&new_name=text");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/cube/create?name_database=test&new_name=data&name_dimensions=regions,measure");
+	TEST_CHECK(server.lastStatus == 200);
+}
+
+struct Result {
+	size_t imported;
+	size_t rejected;
+	size_t lines;
+
+	// line number and error code of the rejected lines
+	vector<pair<size_t, uint32_t> > errors;
+};
+
+static Result import(TestServer &server, const string &parameters, const string &body)
+{
+	string response = server.request("/cell/import?name_database=test&name_cube=data" + parameters, body);
+	TEST_CHECK(server.lastStatus == 200);
+
+	Result result = {0, 0, 0};
+	vector<string> lines;
+	StringUtils::splitString(response, &lines, '\n');
+	for (size_t i = 0; i < lines.size(); i++) {
+		vector<string> fields;
+		StringUtils::splitString(lines[i], &fields, ';');
+		if (i == 0) {
+			TEST_CHECK(fields.size() >= 3);
+			if (fields.size() >= 3) {
+				result.imported = StringUtils::stringToUnsignedInteger(fields[0]);
+				result.rejected = StringUtils::stringToUnsignedInteger(fields[1]);
+				result.lines = StringUtils::stringToUnsignedInteger(fields[2]);
+			}
+		} else if (fields.size() >= 2) {
+			result.errors.push_back(make_pair((size_t)StringUtils::stringToUnsignedInteger(fields[0]), StringUtils::stringToUnsignedInteger(fields[1])));
+		}
+	}
+	return result;
+}
+
+static string value(TestServer &server, const string &path)
+{
+	string body = server.request("/cell/value?name_database=test&name_cube=data&path=" + path);
+	TEST_CHECK(server.lastStatus == 200);
+	// type;exists;value;
+	size_t start = body.find(';', body.find(';') + 1);
+	size_t end = body.rfind(';');
+	return start == string::npos || end <= start ? "" : body.substr(start + 1, end - start - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief quoted names are resolved, malformed lines are reported and skipped
+////////////////////////////////////////////////////////////////////////////////
+
+static void testNames(TestServer &server)
+{
+	string body =
+		"Germany,a,1.5\n"
+		"\"Ile, de France\",a,2\r\n"
+		"\"say \"\"hi\"\"\",b,3\n"
+		"Unknown,a,4\n"
+		"Germany,a\n"
+		"Germany,b,abc\n"
+		"\n"
+		"Germany,text,\"hello, world\"\n"
+		"\"Germany\"x,a,1\n"
+		"Germany,b,\n";
+
+	Result result = import(server, "", body);
+	TEST_CHECK(result.imported == 5);
+	TEST_CHECK(result.rejected == 4);
+	TEST_CHECK(result.lines == 10);
+	TEST_CHECK(result.errors.size() == 4);
+	if (result.errors.size() == 4) {
+		TEST_CHECK(result.errors[0] == make_pair((size_t)4, (uint32_t)ErrorException::ERROR_ELEMENT_NOT_FOUND));
+		TEST_CHECK(result.errors[1] == make_pair((size_t)5, (uint32_t)ErrorException::ERROR_INVALID_COORDINATES));
+		TEST_CHECK(result.errors[2] == make_pair((size_t)6, (uint32_t)ErrorException::ERROR_CONVERSION_FAILED));
+		TEST_CHECK(result.errors[3] == make_pair((size_t)9, (uint32_t)ErrorException::ERROR_INVALID_STRING));
+	}
+
+	TEST_CHECK(value(server, "0,0") == "1.5");
+	TEST_CHECK(value(server, "1,0") == "2");
+	TEST_CHECK(value(server, "2,1") == "3");
+	TEST_CHECK(value(server, "0,2").find("hello, world") != string::npos);
+	TEST_CHECK(value(server, "0,1") == "");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief identifiers are checked against the dimensions
+////////////////////////////////////////////////////////////////////////////////
+
+static void testIdentifiers(TestServer &server)
+{
+	string body =
+		"1,1,7\n"
+		"99,0,1\n"
+		"x,0,1\n"
+		"2,0,\"8\"\n";
+
+	Result result = import(server, "&use_identifier=1", body);
+	TEST_CHECK(result.imported == 2);
+	TEST_CHECK(result.rejected == 2);
+	TEST_CHECK(result.lines == 4);
+	TEST_CHECK(result.errors.size() == 2);
+	if (result.errors.size() == 2) {
+		TEST_CHECK(result.errors[0] == make_pair((size_t)2, (uint32_t)ErrorException::ERROR_ELEMENT_NOT_FOUND));
+		TEST_CHECK(result.errors[1] == make_pair((size_t)3, (uint32_t)ErrorException::ERROR_CONVERSION_FAILED));
+	}
+
+	TEST_CHECK(value(server, "1,1") == "7");
+	TEST_CHECK(value(server, "2,0") == "8");
+}
+
+int main(int argc, char * argv[])
+{
+	{
+		TestServer server;
+
+		createCube(server);
+		testNames(server);
+		testIdentifiers(server);
+	}
+
+	return TEST_RESULT();
+}
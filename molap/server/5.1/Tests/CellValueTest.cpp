@@ -0,0 +1,143 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <new>
+#include <stdlib.h>
+
+#include "Engine/EngineBase.h"
+
+#include "Tests/TestUtils.h"
+
+using namespace palo;
+
+// the shared strings of the values are counted by the allocations
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+	void *p = malloc(size ? size : 1);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	allocations++;
+	return p;
+}
+
+void operator delete(void *p) throw()
+{
+	if (p) {
+		allocations--;
+		free(p);
+	}
+}
+
+static bool sameValue(const CellValue &a, const CellValue &b)
+{
+	return a.isNumeric() == b.isNumeric() && a.isString() == b.isString() && a.isError() == b.isError() && a.getNumeric() == b.getNumeric() && a.getString() == b.getString() && a.getError() == b.getError() && a.isEmpty() == b.isEmpty() && a.getRuleId() == b.getRuleId();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief numeric, string and error values survive copies and assignments
+////////////////////////////////////////////////////////////////////////////////
+
+static void testRoundTrip()
+{
+	vector<CellValue> values;
+	values.push_back(CellValue(1.5));
+	values.push_back(CellValue(0.0));
+	values.push_back(CellValue(-2.25e300));
+	values.push_back(CellValue(string("a text longer than the small string buffer of std::string")));
+	values.push_back(CellValue(3.5, "text with value"));
+	values.push_back(CellValue(string()));
+	values.push_back(CellValue(ErrorException::ERROR_INVALID_TYPE));
+	values.push_back(CellValue(ErrorException::ERROR_OUT_OF_MEMORY));
+	values[0].setRuleId(7);
+	values[3].setRuleId(8);
+	values[6].setRuleId(9);
+
+	for (size_t i = 0; i < values.size(); i++) {
+		CellValue copy(values[i]);
+		TEST_CHECK(sameValue(copy, values[i]));
+
+		// assignment over every kind of value
+		for (size_t j = 0; j < values.size(); j++) {
+			CellValue target(values[j]);
+			target = values[i];
+			TEST_CHECK(sameValue(target, values[i]));
+			target = target;
+			TEST_CHECK(sameValue(target, values[i]));
+		}
+	}
+
+	TEST_CHECK(values[6].getError() == ErrorException::ERROR_INVALID_TYPE);
+	TEST_CHECK(values[6].getNumeric() == 0.0);
+	TEST_CHECK(values[4].getNumeric() == 3.5);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the last value of a shared string releases it
+////////////////////////////////////////////////////////////////////////////////
+
+static void testRelease()
+{
+	size_t before = allocations;
+	{
+		CellValue *text = new CellValue(string("a text longer than the small string buffer of std::string"));
+		size_t shared = allocations;
+
+		CellValue copy(*text);
+		CellValue assigned(1.0);
+		assigned = *text;
+		CellValue error(ErrorException::ERROR_INVALID_TYPE);
+		error = copy;
+		TEST_CHECK(allocations == shared);
+
+		delete text;
+		TEST_CHECK(copy.getString() == assigned.getString());
+		TEST_CHECK(error.getString() == copy.getString());
+
+		copy = 2.0;
+		assigned = CellValue(ErrorException::ERROR_INVALID_TYPE);
+		TEST_CHECK(allocations > before);
+		error = CellValue(3.0);
+		TEST_CHECK(allocations == before);
+		TEST_CHECK(error.getNumeric() == 3.0);
+		TEST_CHECK(assigned.isError());
+	}
+	TEST_CHECK(allocations == before);
+}
+
+int main(int argc, char * argv[])
+{
+	TEST_CHECK(sizeof(CellValue) == 16);
+
+	testRoundTrip();
+	testRelease();
+
+	return TEST_RESULT();
+}
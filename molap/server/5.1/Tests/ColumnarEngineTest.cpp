@@ -0,0 +1,243 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <boost/thread.hpp>
+
+#include "Engine/EngineColumnar.h"
+#include "Olap/Cube.h"
+#include "Olap/Database.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+// base elements of the dimensions, the codes of rows and columns are 3 and 6
+// bits wide and therefore cross the words of the packed columns
+static const size_t ROWS = 5;
+static const size_t COLS = 37;
+static const size_t MEASURES = 3;
+
+// filled cells of the cube
+static size_t cells = 0;
+
+static string names(const string &prefix, size_t count, size_t step = 1, size_t first = 0)
+{
+	string result;
+	for (size_t i = first; i < count; i += step) {
+		result += (result.empty() ? "" : ",") + prefix + StringUtils::convertToString((uint64_t)i);
+	}
+	return result;
+}
+
+static string ids(size_t count)
+{
+	string result;
+	for (size_t i = 0; i < count; i++) {
+		result += (i ? ":" : "") + StringUtils::convertToString((uint64_t)i);
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief rows have weighted and zero weighted children, the odd columns are
+/// consolidated twice and the nested consolidation CC reaches them three times
+////////////////////////////////////////////////////////////////////////////////
+
+static void createCube(TestServer &server)
+{
+	server.request("/database/create?new_name=test");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/dimension/create?name_database=test&new_name=rows");
+	server.request("/dimension/create?name_database=test&new_name=cols");
+	server.request("/dimension/create?name_database=test&new_name=measure");
+
+	server.request("/element/create_bulk?name_database=test&name_dimension=rows&type=1&name_elements=" + names("r", ROWS));
+	server.request("/element/create?name_database=test&name_dimension=rows&type=4&new_name=R&name_children=" + names("r", ROWS));
+	server.request("/element/create?name_database=test&name_dimension=rows&type=4&new_name=Rw&name_children=r1,r3,r4&weights=0.5,-1,0");
+	TEST_CHECK(server.lastStatus == 200);
+
+	server.request("/element/create_bulk?name_database=test&name_dimension=cols&type=1&name_elements=" + names("c", COLS));
+	server.request("/element/create?name_database=test&name_dimension=cols&type=4&new_name=C&name_children=" + names("c", COLS));
+	server.request("/element/create?name_database=test&name_dimension=cols&type=4&new_name=Codd&name_children=" + names("c", COLS, 2, 1));
+	server.request("/element/create?name_database=test&name_dimension=cols&type=4&new_name=CC&name_children=C,Codd&weights=1,2");
+	TEST_CHECK(server.lastStatus == 200);
+
+	server.request("/element/create_bulk?name_database=test&name_dimension=measure&type=1&name_elements=" + names("m", MEASURES));
+	server.request("/element/create?name_database=test&name_dimension=measure&type=4&new_name=M&name_children=m0,m1");
+	TEST_CHECK(server.lastStatus == 200);
+
+	server.request("/cube/create?name_database=test&new_name=data&name_dimensions=rows,cols,measure");
+	TEST_CHECK(server.lastStatus == 200);
+
+	// every seventh cell and the zeros stay empty, the values are integers and
+	// sum up exactly
+	size_t cell = 0;
+	for (size_t r = 0; r < ROWS; r++) {
+		for (size_t c = 0; c < COLS; c++) {
+			for (size_t m = 0; m < MEASURES; m++, cell++) {
+				int32_t value = (int32_t)(cell % 17) - 5;
+				if (cell % 7 == 0 || value == 0) {
+					continue;
+				}
+				string path = StringUtils::convertToString((uint64_t)r) + "," + StringUtils::convertToString((uint64_t)c) + "," + StringUtils::convertToString((uint64_t)m);
+				server.request("/cell/replace?name_database=test&name_cube=data&path=" + path + "&value=" + StringUtils::convertToString(value));
+				TEST_CHECK(server.lastStatus == 200);
+				cells++;
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief all base and consolidated cells of the cube
+////////////////////////////////////////////////////////////////////////////////
+
+static string readArea(TestServer &server)
+{
+	server.request("/cube/clear_cache?name_database=test&name_cube=data");
+	string area = ids(ROWS + 2) + "," + ids(COLS + 3) + "," + ids(MEASURES + 1);
+	string body = server.request("/cell/area?name_database=test&name_cube=data&area=" + area);
+	TEST_CHECK(server.lastStatus == 200);
+	return body;
+}
+
+static string readAreaCpu(TestServer &server)
+{
+	EngineColumnar::setMinCells(0);
+	string body = readArea(server);
+	EngineColumnar::setMinCells(1);
+	return body;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief waits for the columnar copy of the current storage of the cube
+////////////////////////////////////////////////////////////////////////////////
+
+static CPColumnarStorage waitForColumns()
+{
+	PServer server = Server::getInstance(false);
+	CPCube cube = server->lookupDatabaseByName("test", false)->lookupCubeByName("data", false);
+	EngineColumnar *engine = dynamic_cast<EngineColumnar *>(server->getEngine(EngineBase::COLUMNAR).get());
+	PStorageBase storage = server->getEngine(EngineBase::CPU)->getStorage(cube->getNumericStorageId());
+
+	CPColumnarStorage columns;
+	for (int i = 0; i < 1000 && !columns; i++) {
+		columns = engine->getColumns(cube->getNumericStorageId(), storage);
+		if (!columns) {
+			boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+		}
+	}
+	TEST_CHECK(columns);
+	return columns;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the copy holds every filled cell in bit-packed columns
+////////////////////////////////////////////////////////////////////////////////
+
+static void testColumns(TestServer &server)
+{
+	readArea(server);
+	CPColumnarStorage columns = waitForColumns();
+	if (!columns) {
+		return;
+	}
+	TEST_CHECK(columns->dimCount() == 3);
+	TEST_CHECK(columns->rowCount() == cells);
+	TEST_CHECK(columns->getColumn(0).bits == 3);
+	TEST_CHECK(columns->getColumn(1).bits == 6);
+	TEST_CHECK(columns->getColumn(2).bits == 2);
+
+	// the codes crossing word boundaries decode to the keys of the storage
+	IdentifiersType key(3);
+	size_t checked = 0;
+	PServer srv = Server::getInstance(false);
+	CPCube cube = srv->lookupDatabaseByName("test", false)->lookupCubeByName("data", false);
+	PStorageBase storage = srv->getEngine(EngineBase::CPU)->getStorage(cube->getNumericStorageId());
+	PProcessorBase reader = storage->getCellValues(CPArea());
+	for (size_t row = 0; reader->next(); row++) {
+		for (size_t dim = 0; dim < 3; dim++) {
+			const ColumnarStorage::Column &column = columns->getColumn(dim);
+			key[dim] = column.dictionary[column.code(row)];
+		}
+		TEST_CHECK(key == reader->getKey());
+		TEST_CHECK(columns->getValues()[row] == reader->getDouble());
+		checked++;
+	}
+	TEST_CHECK(checked == columns->rowCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the dense and the sparse path calculate the values of the cpu engine
+////////////////////////////////////////////////////////////////////////////////
+
+static void testAggregation(TestServer &server)
+{
+	string expected = readAreaCpu(server);
+	waitForColumns();
+
+	TEST_CHECK(readArea(server) == expected);
+
+	EngineColumnar::setDenseCells(0);
+	TEST_CHECK(readArea(server) == expected);
+	EngineColumnar::setDenseCells(1 << 20);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a changed cube is calculated by the cpu engine until the new copy
+/// is ready
+////////////////////////////////////////////////////////////////////////////////
+
+static void testChange(TestServer &server)
+{
+	waitForColumns();
+	server.request("/cell/replace?name_database=test&name_cube=data&path=2,5,1&value=1000");
+	TEST_CHECK(server.lastStatus == 200);
+
+	string expected = readAreaCpu(server);
+	TEST_CHECK(readArea(server) == expected);
+	TEST_CHECK(waitForColumns());
+	TEST_CHECK(readArea(server) == expected);
+}
+
+int main(int argc, char * argv[])
+{
+	{
+		TestServer server;
+
+		EngineColumnar::setMinCells(1);
+		EngineColumnar::addCube("test", "data");
+
+		createCube(server);
+		testColumns(server);
+		testAggregation(server);
+		testChange(server);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,123 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <boost/thread.hpp>
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t WRITES = 100;
+
+static string databaseName(int db)
+{
+	return "db" + StringUtils::convertToString((int32_t)db);
+}
+
+static void createDatabase(TestServer &server, int db)
+{
+	string name = databaseName(db);
+	server.request("/database/create?new_name=" + name);
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/dimension/create?name_database=" + name + "&new_name=items");
+
+	string names;
+	for (size_t i = 0; i < WRITES; i++) {
+		names += (i ? "," : "") + string("item") + StringUtils::convertToString((uint64_t)i);
+	}
+	server.request("/element/create_bulk?name_database=" + name + "&name_dimension=items&type=1&name_elements=" + names);
+	server.request("/cube/create?name_database=" + name + "&new_name=data&name_dimensions=items");
+	TEST_CHECK(server.lastStatus == 200);
+}
+
+static uint64_t commitConflicts(TestServer &server)
+{
+	string body = server.request("/server/metrics");
+	TEST_CHECK(server.lastStatus == 200);
+	const string name = "\npalo_commit_conflicts_total ";
+	size_t pos = body.find(name);
+	TEST_CHECK(pos != string::npos);
+	return pos == string::npos ? 0 : StringUtils::stringToUnsignedInteger(body.substr(pos + name.size(), body.find('\n', pos + 1) - pos - name.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes every cell of the cube of one database
+////////////////////////////////////////////////////////////////////////////////
+
+static void writeCells(TestConnection *connection, int db, int *failures)
+{
+	for (size_t i = 0; i < WRITES; i++) {
+		connection->request("/cell/replace?name_database=" + databaseName(db) + "&name_cube=data&name_path=item" + StringUtils::convertToString((uint64_t)i) + "&value=" + StringUtils::convertToString((uint64_t)(i + db)));
+		if (connection->lastStatus != 200) {
+			(*failures)++;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writers of different databases commit their first try
+////////////////////////////////////////////////////////////////////////////////
+
+static void testDifferentDatabases(TestServer &server)
+{
+	uint64_t conflicts = commitConflicts(server);
+
+	TestConnection *first = server.connect();
+	TestConnection *second = server.connect();
+	int failures[2] = {0, 0};
+	{
+		boost::thread firstWriter(writeCells, first, 1, &failures[0]);
+		boost::thread secondWriter(writeCells, second, 2, &failures[1]);
+		firstWriter.join();
+		secondWriter.join();
+	}
+	delete first;
+	delete second;
+
+	TEST_CHECK(failures[0] == 0);
+	TEST_CHECK(failures[1] == 0);
+	TEST_CHECK(commitConflicts(server) == conflicts);
+
+	for (int db = 1; db <= 2; db++) {
+		string body = server.request("/cell/value?name_database=" + databaseName(db) + "&name_cube=data&name_path=item" + StringUtils::convertToString((uint64_t)(WRITES - 1)));
+		TEST_CHECK(body.find(";" + StringUtils::convertToString((uint64_t)(WRITES - 1 + db)) + ";") != string::npos);
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	{
+		TestServer server;
+
+		createDatabase(server, 1);
+		createDatabase(server, 2);
+		testDifferentDatabases(server);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,178 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include "Engine/GroupByProcessor.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t ITEMS = 10;
+
+static string itemName(size_t i)
+{
+	return (i < 10 ? "item0" : "item") + StringUtils::convertToString((uint64_t)i);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cube with the values 1 to 10 for item01 to item10
+////////////////////////////////////////////////////////////////////////////////
+
+static void createCube(TestServer &server)
+{
+	server.request("/database/create?new_name=test");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/dimension/create?name_database=test&new_name=items");
+	server.request("/dimension/create?name_database=test&new_name=measure");
+
+	string names;
+	for (size_t i = 1; i <= ITEMS; i++) {
+		names += (i > 1 ? "," : "") + itemName(i);
+	}
+	server.request("/element/create_bulk?name_database=test&name_dimension=items&type=1&name_elements=" + names);
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/element/create?name_database=test&name_dimension=measure&type=1&new_name=value");
+
+	server.request("/cube/create?name_database=test&new_name=data&name_dimensions=items,measure");
+	TEST_CHECK(server.lastStatus == 200);
+
+	for (size_t i = 1; i <= ITEMS; i++) {
+		server.request("/cell/replace?name_database=test&name_cube=data&name_path=" + itemName(i) + ",value&value=" + StringUtils::convertToString((uint64_t)i));
+		TEST_CHECK(server.lastStatus == 200);
+	}
+}
+
+static string filter(TestServer &server, int mode, const string &values, size_t items = ITEMS, const string &measure = "0")
+{
+	string area;
+	for (size_t i = 0; i < items; i++) {
+		area += (i ? ":" : "") + StringUtils::convertToString((uint64_t)i);
+	}
+
+	string body = server.request("/dimension/dfilter?name_database=test&name_dimension=items&name_cube=data&area=" + area + "," + measure + "&mode=" + StringUtils::convertToString((int32_t)mode) + "&values=" + values);
+	TEST_CHECK(server.lastStatus == 200);
+	return body;
+}
+
+static bool contains(const string &body, size_t first, size_t last)
+{
+	for (size_t i = 1; i <= ITEMS; i++) {
+		bool found = body.find(itemName(i)) != string::npos;
+		if (found != (first <= i && i <= last)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the values sum up to 55, the upper and the lower 20% (11) are
+/// reached with 10 and with 1 + 2 + 3 + 4
+////////////////////////////////////////////////////////////////////////////////
+
+static void testPercentage(TestServer &server)
+{
+	TEST_CHECK(contains(filter(server, DataFilterBase::DATA_SUM | DataFilterBase::UPPER_PERCENTAGE, "0:20:0"), 10, 10));
+	TEST_CHECK(contains(filter(server, DataFilterBase::DATA_SUM | DataFilterBase::LOWER_PERCENTAGE, "0:0:20"), 1, 4));
+
+	// the middle keeps everything between both limits
+	TEST_CHECK(contains(filter(server, DataFilterBase::DATA_SUM | DataFilterBase::MID_PERCENTAGE, "0:20:20"), 5, 9));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief low (10) consolidates item01 to item05, high (11) item06 to item10
+/// twice, both (2) consolidates value and half of value2 (10 times value)
+////////////////////////////////////////////////////////////////////////////////
+
+static void addConsolidations(TestServer &server)
+{
+	server.request("/element/create?name_database=test&name_dimension=items&type=4&new_name=low&name_children=" + itemName(1) + "," + itemName(2) + "," + itemName(3) + "," + itemName(4) + "," + itemName(5));
+	server.request("/element/create?name_database=test&name_dimension=items&type=4&new_name=high&name_children=" + itemName(6) + "," + itemName(7) + "," + itemName(8) + "," + itemName(9) + "," + itemName(10) + "&weights=2,2,2,2,2");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/element/create?name_database=test&name_dimension=measure&type=1&new_name=value2");
+	server.request("/element/create?name_database=test&name_dimension=measure&type=4&new_name=both&name_children=value,value2&weights=1,0.5");
+	TEST_CHECK(server.lastStatus == 200);
+
+	for (size_t i = 1; i <= ITEMS; i++) {
+		server.request("/cell/replace?name_database=test&name_cube=data&name_path=" + itemName(i) + ",value2&value=" + StringUtils::convertToString((uint64_t)(10 * i)));
+		TEST_CHECK(server.lastStatus == 200);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief filters with the grouping and with the aggregation by element
+////////////////////////////////////////////////////////////////////////////////
+
+static string compareFilter(TestServer &server, int mode, const string &values, const string &measure)
+{
+	server.request("/cube/clear_cache?name_database=test&name_cube=data");
+	string grouped = filter(server, mode, values, ITEMS + 2, measure);
+
+	GroupByProcessor::setEnabled(false);
+	server.request("/cube/clear_cache?name_database=test&name_cube=data");
+	string expected = filter(server, mode, values, ITEMS + 2, measure);
+	GroupByProcessor::setEnabled(true);
+
+	if (grouped != expected) {
+		cerr << "mode " << mode << " values " << values << " measure " << measure << ":" << endl << grouped << "instead of" << endl << expected;
+	}
+	TEST_CHECK(grouped == expected);
+	return grouped;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the consolidated items are mapped to themselves, the consolidated
+/// measure is aggregated through the fused child aggregation, the items are
+/// item01 to item10 with 6 to 60, low with 90 and high with 480
+////////////////////////////////////////////////////////////////////////////////
+
+static void testConsolidated(TestServer &server)
+{
+	string body = compareFilter(server, DataFilterBase::DATA_SUM | DataFilterBase::TOP, "3:0:0", "2");
+	TEST_CHECK(body.find("high") != string::npos && body.find("low") != string::npos && contains(body, 10, 10));
+
+	compareFilter(server, DataFilterBase::DATA_SUM | DataFilterBase::UPPER_PERCENTAGE, "0:80:0", "2");
+	compareFilter(server, DataFilterBase::DATA_SUM | DataFilterBase::TOP, "5:0:0", "0");
+	compareFilter(server, DataFilterBase::DATA_SUM | DataFilterBase::LOWER_PERCENTAGE, "0:0:20", "0:1");
+	compareFilter(server, DataFilterBase::DATA_AVERAGE | DataFilterBase::TOP, "4:0:0", "2");
+	compareFilter(server, DataFilterBase::DATA_AVERAGE | DataFilterBase::MID_PERCENTAGE, "0:10:30", "0:2");
+}
+
+int main(int argc, char * argv[])
+{
+	{
+		TestServer server;
+
+		createCube(server);
+		testPercentage(server);
+		addConsolidations(server);
+		testConsolidated(server);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,195 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include "Olap/Dimension.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t FAN_OUT = 100;
+static const size_t NEW_ELEMENTS = 10000;
+
+static string numberName(size_t i)
+{
+	return StringUtils::convertToString((uint64_t)i);
+}
+
+static string joinNames(const vector<string> &names, size_t first, size_t last)
+{
+	string result;
+	for (size_t i = first; i < last; i++) {
+		result += (i > first ? "," : "") + names[i];
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates consolidated elements for groups of FAN_OUT children and
+/// returns their names
+////////////////////////////////////////////////////////////////////////////////
+
+static vector<string> consolidate(TestServer &server, const string &db, const vector<string> &children, const string &prefix)
+{
+	vector<string> parents;
+	string names;
+	string childNames;
+
+	for (size_t i = 0; i < children.size(); i++) {
+		if (i % FAN_OUT == 0) {
+			parents.push_back(prefix + numberName(parents.size()));
+			names += (parents.size() > 1 ? "," : "") + parents.back();
+			childNames += parents.size() > 1 ? ":" : "";
+		} else {
+			childNames += ",";
+		}
+		childNames += children[i];
+	}
+
+	server.request("/element/create_bulk", "name_database=" + db + "&name_dimension=tree&type=4&name_elements=" + names + "&name_children=" + childNames);
+	TEST_CHECK(server.lastStatus == 200);
+	return parents;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates NEW_ELEMENTS leaves and appends them in groups of FAN_OUT to
+/// the first consolidations above the base elements
+////////////////////////////////////////////////////////////////////////////////
+
+static double appendLeaves(TestServer &server, const string &db, const vector<string> &parents, const string &prefix)
+{
+	vector<string> leaves;
+	for (size_t i = 0; i < NEW_ELEMENTS; i++) {
+		leaves.push_back(prefix + numberName(i));
+	}
+
+	double start = testMilliseconds();
+	server.request("/element/create_bulk", "name_database=" + db + "&name_dimension=tree&type=1&name_elements=" + joinNames(leaves, 0, leaves.size()));
+	TEST_CHECK(server.lastStatus == 200);
+	for (size_t i = 0; i < leaves.size(); i += FAN_OUT) {
+		server.request("/element/append", "name_database=" + db + "&name_dimension=tree&name_element=" + parents[(i / FAN_OUT) % parents.size()] + "&name_children=" + joinNames(leaves, i, min(i + FAN_OUT, leaves.size())));
+		TEST_CHECK(server.lastStatus == 200);
+	}
+	return testMilliseconds() - start;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates consolidations of NEW_ELEMENTS existing base elements
+////////////////////////////////////////////////////////////////////////////////
+
+static double addConsolidations(TestServer &server, const string &db, const vector<string> &base, const string &prefix)
+{
+	vector<string> children;
+	for (size_t i = 0; i < NEW_ELEMENTS; i++) {
+		children.push_back(base[i * base.size() / NEW_ELEMENTS]);
+	}
+
+	double start = testMilliseconds();
+	consolidate(server, db, children, prefix);
+	return testMilliseconds() - start;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief measures the update of levels, base elements, depth and indent
+///
+/// For each size a dimension with a balanced tree is built with bulk
+/// requests. Then NEW_ELEMENTS new leaves are appended to the existing
+/// consolidations and NEW_ELEMENTS base elements are consolidated by new
+/// elements, once updating the changed elements only
+/// (Dimension::updateChangedElementsInfo) and once updating the whole
+/// dimension. The base elements of a full update are built level by level
+/// on the thread pool (Dimension::BaseElementsJob) if there is more than one
+/// core.
+///
+/// usage: DimensionBenchmark [base elements ...]
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char * argv[])
+{
+	vector<size_t> sizes;
+	for (int i = 1; i < argc; i++) {
+		sizes.push_back((size_t)atol(argv[i]));
+	}
+	if (sizes.empty()) {
+		sizes.push_back(20000);
+		sizes.push_back(100000);
+		sizes.push_back(500000);
+	}
+
+	{
+		TestServer server;
+		cout << "cores: " << Server::getInstance(false)->getThreadPool()->getCoreCount() << endl;
+
+		for (size_t s = 0; s < sizes.size(); s++) {
+			size_t baseCount = max(sizes[s], NEW_ELEMENTS);
+			string db = "bench" + numberName(s);
+
+			server.request("/database/create?new_name=" + db);
+			server.request("/dimension/create?name_database=" + db + "&new_name=tree");
+			TEST_CHECK(server.lastStatus == 200);
+
+			vector<string> base;
+			for (size_t i = 0; i < baseCount; i++) {
+				base.push_back("b" + numberName(i));
+			}
+
+			double start = testMilliseconds();
+			server.request("/element/create_bulk", "name_database=" + db + "&name_dimension=tree&type=1&name_elements=" + joinNames(base, 0, base.size()));
+			TEST_CHECK(server.lastStatus == 200);
+			double baseTime = testMilliseconds() - start;
+
+			start = testMilliseconds();
+			vector<string> level = consolidate(server, db, base, "c1_");
+			vector<string> bottom = level;
+			for (size_t depth = 2; level.size() > 1; depth++) {
+				level = consolidate(server, db, level, "c" + numberName(depth) + "_");
+			}
+			double treeTime = testMilliseconds() - start;
+
+			Dimension::setIncrementalElementsInfo(true);
+			double appendIncremental = appendLeaves(server, db, bottom, "inc");
+			double consolidateIncremental = addConsolidations(server, db, base, "extra_inc");
+
+			Dimension::setIncrementalElementsInfo(false);
+			double appendFull = appendLeaves(server, db, bottom, "full");
+			double consolidateFull = addConsolidations(server, db, base, "extra_full");
+			Dimension::setIncrementalElementsInfo(true);
+
+			cout << endl;
+			cout << "base elements:                           " << baseCount << endl;
+			cout << "create base elements:                    " << baseTime << " ms" << endl;
+			cout << "create consolidations:                   " << treeTime << " ms" << endl;
+			cout << "append " << NEW_ELEMENTS << " leaves (incremental):      " << appendIncremental << " ms" << endl;
+			cout << "append " << NEW_ELEMENTS << " leaves (full):             " << appendFull << " ms" << endl;
+			cout << "consolidate " << NEW_ELEMENTS << " elements (incremental): " << consolidateIncremental << " ms" << endl;
+			cout << "consolidate " << NEW_ELEMENTS << " elements (full):        " << consolidateFull << " ms" << endl;
+		}
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,152 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include "Olap/Database.h"
+#include "Olap/Dimension.h"
+#include "Olap/Element.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief level, indent, depth and weighted base elements of all elements
+////////////////////////////////////////////////////////////////////////////////
+
+static map<string, string> elementsInfo(const string &dimension)
+{
+	CPServer server = Server::getInstance(false);
+	CPDimension dim = server->lookupDatabaseByName("test", false)->findDimensionByName(dimension, PUser(), false);
+	const StringVector &names = dim->getElemNamesVector();
+	ElementsType elements = dim->getElements(PUser(), false);
+
+	map<string, string> result;
+	for (ElementsType::const_iterator it = elements.begin(); it != elements.end(); ++it) {
+		stringstream info;
+		info << "level " << (*it)->getLevel() << ", indent " << (*it)->getIndent() << ", depth " << (*it)->getDepth() << ", base elements";
+
+		const WeightedSet *baseElements = (*it)->getBaseElements();
+		if (baseElements && (*it)->getElementType() == Element::CONSOLIDATED) {
+			map<string, double> weights;
+			for (WeightedSet::const_iterator base = baseElements->begin(); base != baseElements->end(); ++base) {
+				weights[dim->lookupElement(base.first(), false)->getName(names)] = base.second();
+			}
+			for (map<string, double>::const_iterator base = weights.begin(); base != weights.end(); ++base) {
+				info << " " << base->first << ":" << base->second;
+			}
+		}
+		result[(*it)->getName(names)] = info.str();
+	}
+	return result;
+}
+
+static string replaceDimension(const string &request, const string &dimension)
+{
+	string result = request;
+	size_t pos = result.find("DIM");
+	if (pos != string::npos) {
+		result.replace(pos, 3, dimension);
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sends the request for the dimension inc with the update of changed
+/// elements and for the dimension full with the update of all elements, both
+/// have to end up with the same information
+////////////////////////////////////////////////////////////////////////////////
+
+static void step(TestServer &server, const string &request)
+{
+	Dimension::setIncrementalElementsInfo(true);
+	server.request(replaceDimension(request, "inc"));
+	TEST_CHECK(server.lastStatus == 200);
+
+	Dimension::setIncrementalElementsInfo(false);
+	server.request(replaceDimension(request, "full"));
+	TEST_CHECK(server.lastStatus == 200);
+	Dimension::setIncrementalElementsInfo(true);
+
+	map<string, string> incremental = elementsInfo("inc");
+	map<string, string> full = elementsInfo("full");
+	TEST_CHECK(incremental.size() == full.size());
+
+	for (map<string, string>::const_iterator it = full.begin(); it != full.end(); ++it) {
+		map<string, string>::const_iterator found = incremental.find(it->first);
+		if (found == incremental.end() || found->second != it->second) {
+			cerr << request << endl << "  " << it->first << ": " << (found == incremental.end() ? "missing" : found->second) << " instead of " << it->second << endl;
+			TEST_CHECK(false);
+		}
+	}
+}
+
+static string leaves(size_t first, size_t last)
+{
+	string result;
+	for (size_t i = first; i <= last; i++) {
+		result += (i > first ? "," : "") + string("b") + StringUtils::convertToString((uint64_t)i);
+	}
+	return result;
+}
+
+int main(int argc, char * argv[])
+{
+	{
+		TestServer server;
+
+		server.request("/database/create?new_name=test");
+		server.request("/dimension/create?name_database=test&new_name=inc");
+		server.request("/dimension/create?name_database=test&new_name=full");
+		TEST_CHECK(server.lastStatus == 200);
+
+		// new consolidations of base elements and above them
+		step(server, "/element/create_bulk?name_database=test&name_dimension=DIM&type=1&name_elements=" + leaves(0, 29));
+		step(server, "/element/create_bulk?name_database=test&name_dimension=DIM&type=4&name_elements=g0,g1&name_children=" + leaves(0, 9) + ":" + leaves(10, 19));
+		step(server, "/element/create?name_database=test&name_dimension=DIM&type=4&new_name=top&name_children=g0,g1&weights=1,2");
+
+		// elements with multiple parents
+		step(server, "/element/create?name_database=test&name_dimension=DIM&type=4&new_name=h0&name_children=b5,b15,b25&weights=0.5,1,-1");
+		step(server, "/element/create?name_database=test&name_dimension=DIM&type=4&new_name=top2&name_children=h0,g1,b26");
+
+		// base elements with parents become consolidated
+		step(server, "/element/create_bulk?name_database=test&name_dimension=DIM&type=1&name_elements=" + leaves(30, 33));
+		step(server, "/element/replace?name_database=test&name_dimension=DIM&name_element=b25&type=4&name_children=b30,b31&weights=3,1");
+		step(server, "/element/replace?name_database=test&name_dimension=DIM&name_element=b5&type=4&name_children=b32,b33");
+
+		// a new root above roots and new leaves appended to existing consolidations
+		step(server, "/element/create?name_database=test&name_dimension=DIM&type=4&new_name=root&name_children=top,top2,b29");
+		step(server, "/element/create_bulk?name_database=test&name_dimension=DIM&type=1&name_elements=" + leaves(34, 36));
+		step(server, "/element/append?name_database=test&name_dimension=DIM&name_element=g1&name_children=b34,b35&weights=1,4");
+		step(server, "/element/append?name_database=test&name_dimension=DIM&name_element=b30&name_children=b36");
+
+		// consolidation of a whole sub tree below a new parent
+		step(server, "/element/create?name_database=test&name_dimension=DIM&type=4&new_name=deep&name_children=root,h0");
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,325 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <limits.h>
+#include <math.h>
+
+#include "Olap/Cube.h"
+#include "Olap/GoalSeekSolver.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t CHUNK = 2000;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief siblings of the goal seek per dimension below the root R, the
+/// levels of consolidations below each sibling and their fan out
+////////////////////////////////////////////////////////////////////////////////
+
+struct Shape {
+	string name;
+	vector<int> siblings;
+	int depth;
+	int fanOut;
+	bool uneven;
+};
+
+static Shape shape(const string &name, int d0, int d1, int d2, int depth, int fanOut, bool uneven)
+{
+	Shape s;
+	s.name = name;
+	s.siblings.push_back(d0);
+	s.siblings.push_back(d1);
+	if (d2) {
+		s.siblings.push_back(d2);
+	}
+	s.depth = depth;
+	s.fanOut = fanOut;
+	s.uneven = uneven;
+	return s;
+}
+
+// uneven weights of the children, every fifth child doesn't count
+static string weight(int i, bool uneven)
+{
+	static const char *weights[] = {"1", "0.5", "2", "0", "1.5"};
+	return uneven ? weights[i % 5] : "1";
+}
+
+static string dimensionName(size_t d)
+{
+	return "d" + StringUtils::convertToString((uint64_t)d);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates the consolidations below an element and returns the leaves
+////////////////////////////////////////////////////////////////////////////////
+
+static void createTree(TestServer &server, const string &db, const string &dim, const string &parent, int depth, const Shape &s, vector<string> &leaves)
+{
+	if (depth == 0) {
+		server.request("/element/create?name_database=" + db + "&name_dimension=" + dim + "&type=1&new_name=" + parent);
+		TEST_CHECK(server.lastStatus == 200);
+		leaves.push_back(parent);
+		return;
+	}
+
+	string children;
+	string weights;
+	for (int i = 0; i < s.fanOut; i++) {
+		string child = parent + "_" + StringUtils::convertToString((int32_t)i);
+		createTree(server, db, dim, child, depth - 1, s, leaves);
+		children += (i ? "," : "") + child;
+		weights += (i ? "," : "") + weight(i + 1, s.uneven);
+	}
+	server.request("/element/create?name_database=" + db + "&name_dimension=" + dim + "&type=4&new_name=" + parent + "&name_children=" + children + "&weights=" + weights);
+	TEST_CHECK(server.lastStatus == 200);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates the cube and fills all base cells with the same values
+/// for each database
+////////////////////////////////////////////////////////////////////////////////
+
+static void createCube(TestServer &server, const string &db, const Shape &s)
+{
+	server.request("/database/create?new_name=" + db);
+	TEST_CHECK(server.lastStatus == 200);
+
+	vector<vector<string> > leaves(s.siblings.size());
+	string dimensions;
+	for (size_t d = 0; d < s.siblings.size(); d++) {
+		string dim = dimensionName(d);
+		server.request("/dimension/create?name_database=" + db + "&new_name=" + dim);
+		dimensions += (d ? "," : "") + dim;
+
+		string siblings;
+		string weights;
+		for (int i = 0; i < s.siblings[d]; i++) {
+			string sibling = "s" + StringUtils::convertToString((int32_t)i);
+			createTree(server, db, dim, sibling, s.depth, s, leaves[d]);
+			siblings += (i ? "," : "") + sibling;
+			weights += (i ? "," : "") + weight(i, s.uneven);
+		}
+		server.request("/element/create?name_database=" + db + "&name_dimension=" + dim + "&type=4&new_name=R&name_children=" + siblings + "&weights=" + weights);
+		TEST_CHECK(server.lastStatus == 200);
+	}
+	server.request("/cube/create?name_database=" + db + "&new_name=data&name_dimensions=" + dimensions);
+	TEST_CHECK(server.lastStatus == 200);
+
+	size_t cells = 1;
+	for (size_t d = 0; d < leaves.size(); d++) {
+		cells *= leaves[d].size();
+	}
+
+	srand(4711);
+	for (size_t first = 0; first < cells; first += CHUNK) {
+		string paths;
+		string values;
+		for (size_t cell = first; cell < min(first + CHUNK, cells); cell++) {
+			vector<string> path(leaves.size());
+			size_t rest = cell;
+			for (size_t d = leaves.size(); d-- > 0;) {
+				path[d] = leaves[d][rest % leaves[d].size()];
+				rest /= leaves[d].size();
+			}
+			for (size_t d = 0; d < path.size(); d++) {
+				paths += (d ? "," : (cell > first ? ":" : "")) + path[d];
+			}
+			values += (cell > first ? ":" : "") + StringUtils::convertToString((int32_t)(100 + rand() % 1000));
+		}
+		server.request("/cell/replace_bulk", "name_database=" + db + "&name_cube=data&name_paths=" + paths + "&values=" + values);
+		TEST_CHECK(server.lastStatus == 200);
+	}
+}
+
+static string target(const Shape &s)
+{
+	string path;
+	for (size_t d = 0; d < s.siblings.size(); d++) {
+		path += (d ? "," : "") + string("s0");
+	}
+	return path;
+}
+
+static double cellValue(TestServer &server, const string &db, const string &path)
+{
+	string body = server.request("/cell/value?name_database=" + db + "&name_cube=data&name_path=" + path);
+	TEST_CHECK(server.lastStatus == 200);
+	// type;exists;value;
+	size_t start = body.find(';', body.find(';') + 1);
+	size_t end = body.find(';', start + 1);
+	return end == string::npos ? 0 : StringUtils::stringToDouble(body.substr(start + 1, end - start - 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief values of the siblings and of R, the lines through R are the sums
+/// kept by the goal seek, a key is marked with R if it contains R
+////////////////////////////////////////////////////////////////////////////////
+
+static map<string, double> readSlice(TestServer &server, const string &db, const Shape &s)
+{
+	string area;
+	for (size_t d = 0; d < s.siblings.size(); d++) {
+		area += d ? "," : "";
+		for (int i = 0; i < s.siblings[d]; i++) {
+			area += "s" + StringUtils::convertToString((int32_t)i) + ":";
+		}
+		area += "R";
+	}
+	string body = server.request("/cell/area?name_database=" + db + "&name_cube=data&name_area=" + area);
+	TEST_CHECK(server.lastStatus == 200);
+
+	map<string, double> result;
+	vector<string> lines;
+	StringUtils::splitString(body, &lines, '\n');
+	for (size_t i = 0; i < lines.size(); i++) {
+		vector<string> fields;
+		StringUtils::splitString(lines[i], &fields, ';');
+		if (fields.size() >= 4) {
+			result[fields[3]] = fields[2].empty() ? 0 : StringUtils::stringToDouble(fields[2]);
+		}
+	}
+	return result;
+}
+
+static bool containsRoot(const string &key, const Shape &s)
+{
+	// the id of R follows the elements below the siblings
+	vector<string> ids;
+	StringUtils::splitString(key, &ids, ',');
+	for (size_t d = 0; d < ids.size(); d++) {
+		size_t perSibling = 1;
+		for (int level = 0; level < s.depth; level++) {
+			perSibling = perSibling * s.fanOut + 1;
+		}
+		if (StringUtils::stringToUnsignedInteger(ids[d]) == s.siblings[d] * perSibling) {
+			return true;
+		}
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief doubles the target in two equal cubes, with the dense elimination
+/// and with the sparse solver, and compares the results
+////////////////////////////////////////////////////////////////////////////////
+
+static void run(TestServer &server, const Shape &s, bool unique)
+{
+	string dense = s.name + "_dense";
+	string sparse = s.name + "_sparse";
+	createCube(server, dense, s);
+	createCube(server, sparse, s);
+
+	map<string, double> before = readSlice(server, dense, s);
+	double goal = 2 * cellValue(server, dense, target(s));
+
+	goalseeksolver::setSparseVariables(INT_MAX);
+	double start = testMilliseconds();
+	server.request("/cell/goalseek?name_database=" + dense + "&name_cube=data&name_path=" + target(s) + "&value=" + StringUtils::convertToString(goal));
+	double denseTime = testMilliseconds() - start;
+	TEST_CHECK(server.lastStatus == 200);
+
+	goalseeksolver::setSparseVariables(0);
+	start = testMilliseconds();
+	server.request("/cell/goalseek?name_database=" + sparse + "&name_cube=data&name_path=" + target(s) + "&value=" + StringUtils::convertToString(goal));
+	double sparseTime = testMilliseconds() - start;
+	TEST_CHECK(server.lastStatus == 200);
+	goalseeksolver::setSparseVariables(200);
+
+	map<string, double> denseSlice = readSlice(server, dense, s);
+	map<string, double> sparseSlice = readSlice(server, sparse, s);
+	TEST_CHECK(denseSlice.size() == before.size() && sparseSlice.size() == before.size());
+	TEST_CHECK(fabs(cellValue(server, dense, target(s)) - goal) < 1e-6 * goal);
+	TEST_CHECK(fabs(cellValue(server, sparse, target(s)) - goal) < 1e-6 * goal);
+
+	// the sums have to be kept by both, the single cells only if the
+	// solution is unique
+	double maxDifference = 0;
+	for (map<string, double>::const_iterator it = before.begin(); it != before.end(); ++it) {
+		double a = denseSlice[it->first];
+		double b = sparseSlice[it->first];
+		double tolerance = 1e-6 * max(1.0, fabs(it->second));
+		if (containsRoot(it->first, s)) {
+			if (fabs(a - it->second) > tolerance || fabs(b - it->second) > tolerance) {
+				cerr << s.name << " " << it->first << ": sum " << it->second << " changed to " << a << " (dense) and " << b << " (sparse)" << endl;
+				TEST_CHECK(false);
+			}
+		} else {
+			maxDifference = max(maxDifference, fabs(a - b));
+			if (unique && fabs(a - b) > tolerance) {
+				cerr << s.name << " " << it->first << ": " << a << " (dense) and " << b << " (sparse)" << endl;
+				TEST_CHECK(false);
+			}
+		}
+	}
+
+	size_t cells = 1;
+	for (size_t d = 0; d < s.siblings.size(); d++) {
+		cells *= s.siblings[d];
+	}
+	cout << s.name << ": " << cells << " cells, dense " << denseTime << " ms, sparse " << sparseTime << " ms, largest difference of a cell " << maxDifference << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief complete goal seek (cell/goalseek) on hierarchies of several shapes
+///
+/// Each shape is built twice, the target cell at the first sibling of every
+/// dimension is doubled once with the dense elimination and once with the
+/// conjugate gradients on the sparse matrix (CSR). The siblings are
+/// consolidations if the shape is deep, their values are splashed to the
+/// base cells. Both solvers have to keep the weighted sums of all lines of
+/// siblings and the target value; the remaining freedom is filled by the
+/// proportional estimates (dense) or the smallest correction of them
+/// (sparse), so single cells are compared only if the solution is unique.
+///
+/// usage: GoalSeekBenchmark
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char * argv[])
+{
+	Cube::setGoalseekCellLimit(INT_MAX);
+	Cube::setGoalseekTimeout(0);
+
+	{
+		// the sparse solver multiplies on the thread pool of the server
+		TestServer server;
+
+		run(server, shape("unique", 2, 2, 2, 0, 0, true), true);
+		run(server, shape("months_products_regions", 12, 10, 8, 0, 0, false), false);
+		run(server, shape("uneven_weights", 12, 10, 8, 0, 0, true), false);
+		run(server, shape("wide", 300, 4, 0, 0, 0, true), false);
+		run(server, shape("deep", 12, 10, 0, 3, 2, true), false);
+		run(server, shape("large", 20, 15, 5, 0, 0, true), false);
+	}
+
+	return TEST_RESULT();
+}
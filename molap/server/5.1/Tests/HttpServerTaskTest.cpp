@@ -0,0 +1,158 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <sys/socket.h>
+
+#include "HttpServer/DirectHttpResponse.h"
+#include "HttpServer/HttpRequestHandler.h"
+#include "HttpServer/HttpResponse.h"
+#include "HttpServer/HttpServer.h"
+#include "HttpServer/HttpServerTask.h"
+
+#include "Tests/TestUtils.h"
+
+using namespace palo;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief answers every request with the value of the "name" parameter
+////////////////////////////////////////////////////////////////////////////////
+
+class EchoRequestHandler : public HttpRequestHandler {
+public:
+	HttpJobRequest * handleHttpRequest(HttpRequest* request, const HttpServerTask*) {
+		HttpResponse* response = new HttpResponse(HttpResponse::OK);
+		response->getBody().appendText("<" + request->getValue("name") + ">");
+		return new DirectHttpResponse(request->getRequestPath(), response);
+	}
+};
+
+static void sendText(socket_t fd, const string& text)
+{
+	TEST_CHECK(send(fd, text.c_str(), text.size(), 0) == (ssize_t)text.size());
+}
+
+static void flushTask(HttpServerTask& task)
+{
+	while (task.canHandleWrite()) {
+		TEST_CHECK(task.handleWrite());
+	}
+}
+
+static string receiveText(socket_t fd)
+{
+	string result;
+	char buffer[4096];
+	ssize_t nr;
+
+	while ((nr = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+		result.append(buffer, nr);
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a complete request followed by the first part of a POST request
+/// in one read, the POST body must survive the answer of the first request
+////////////////////////////////////////////////////////////////////////////////
+
+static void testRequestWithPartialPost()
+{
+	int fds[2];
+	TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+	HttpServer server;
+	server.addHandler("/echo", new EchoRequestHandler());
+
+	{
+		HttpServerTask task(fds[0], &server, 0);
+
+		sendText(fds[1], "GET /echo?name=first HTTP/1.1\r\n\r\n"
+			"POST /echo HTTP/1.1\r\nContent-Length: 11\r\n\r\nname=se");
+		TEST_CHECK(task.canHandleRead());
+		TEST_CHECK(task.handleRead());
+		flushTask(task);
+
+		string answer = receiveText(fds[1]);
+		TEST_CHECK(answer.find("<first>") != string::npos);
+		TEST_CHECK(answer.find("<second>") == string::npos);
+
+		// the rest of the POST body
+		sendText(fds[1], "cond");
+		TEST_CHECK(task.canHandleRead());
+		TEST_CHECK(task.handleRead());
+		flushTask(task);
+
+		answer = receiveText(fds[1]);
+		TEST_CHECK(answer.find("<second>") != string::npos);
+	}
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a POST request whose header and body arrive in separate reads
+////////////////////////////////////////////////////////////////////////////////
+
+static void testSplitPost()
+{
+	int fds[2];
+	TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+	HttpServer server;
+	server.addHandler("/echo", new EchoRequestHandler());
+
+	{
+		HttpServerTask task(fds[0], &server, 0);
+
+		sendText(fds[1], "POST /echo HTTP/1.1\r\nContent-Length: 10\r\n\r\n");
+		TEST_CHECK(task.handleRead());
+		flushTask(task);
+		TEST_CHECK(receiveText(fds[1]).empty());
+
+		sendText(fds[1], "name=body");
+		TEST_CHECK(task.handleRead());
+		sendText(fds[1], "!");
+		TEST_CHECK(task.handleRead());
+		flushTask(task);
+
+		TEST_CHECK(receiveText(fds[1]).find("<body!>") != string::npos);
+	}
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+int main(int argc, char * argv[])
+{
+	testRequestWithPartialPost();
+	testSplitPost();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,155 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "Collections/StringBuffer.h"
+#include "Collections/StringUtils.h"
+
+#include "Tests/TestUtils.h"
+
+using namespace palo;
+
+static const size_t VALUES = 1000000;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief values of a typical cube, prices, quantities and rates
+////////////////////////////////////////////////////////////////////////////////
+
+static vector<double> createValues()
+{
+	vector<double> values;
+	srand(4711);
+	for (size_t i = 0; i < VALUES; i++) {
+		switch (i % 4) {
+		case 0:
+			values.push_back((rand() % 10000000) / 100.0);
+			break;
+		case 1:
+			values.push_back((double)(rand() % 100000));
+			break;
+		case 2:
+			values.push_back((rand() % 1000) / 1000.0);
+			break;
+		default:
+			values.push_back(ldexp((double)rand() / RAND_MAX, rand() % 40));
+			break;
+		}
+	}
+	return values;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief values of a /cell/replace_bulk request separated by colons
+////////////////////////////////////////////////////////////////////////////////
+
+static string createPayload(const vector<double> &values)
+{
+	StringBuffer sb;
+	for (size_t i = 0; i < values.size(); i++) {
+		if (i) {
+			sb.appendChar(':');
+		}
+		sb.appendDecimal(values[i]);
+	}
+	return sb.c_str();
+}
+
+static double parse(const string &payload, bool fast, double &sum)
+{
+	double start = testMilliseconds();
+	const char *p = payload.c_str();
+	const char *end = p + payload.size();
+	while (p < end) {
+		const char *q = p;
+		while (q < end && *q != ':') {
+			q++;
+		}
+		double value = 0;
+		if (fast) {
+			TEST_CHECK(StringUtils::parseDouble(p, q, value));
+		} else {
+			value = strtod(string(p, q).c_str(), 0);
+		}
+		sum += value;
+		p = q + 1;
+	}
+	return (testMilliseconds() - start) * 1e6 / VALUES;
+}
+
+static double format(const vector<double> &values, bool fast, size_t &length)
+{
+	char buffer[64];
+	double start = testMilliseconds();
+	for (size_t i = 0; i < values.size(); i++) {
+		size_t written = fast ? StringBuffer::formatDecimal(buffer, values[i]) : 0;
+		if (!written) {
+			written = snprintf(buffer, sizeof(buffer), "%.15g", values[i]);
+		}
+		length += written;
+	}
+	return (testMilliseconds() - start) * 1e6 / VALUES;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number parsing and formatting of request and response payloads
+///
+/// Parses the values of a bulk request with StringUtils::parseDouble and with
+/// strtod and formats them with StringBuffer::formatDecimal and with
+/// snprintf("%.15g"). Both ways have to give the same values and lengths.
+///
+/// usage: NumberCodecBenchmark
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char * argv[])
+{
+	vector<double> values = createValues();
+	string payload = createPayload(values);
+
+	double fastSum = 0;
+	double strtodSum = 0;
+	double fastParse = parse(payload, true, fastSum);
+	double strtodParse = parse(payload, false, strtodSum);
+	TEST_CHECK(fastSum == strtodSum);
+
+	size_t fastLength = 0;
+	size_t snprintfLength = 0;
+	double fastFormat = format(values, true, fastLength);
+	double snprintfFormat = format(values, false, snprintfLength);
+	TEST_CHECK(fastLength == snprintfLength);
+
+	cout << "values:             " << VALUES << endl;
+	cout << "payload:            " << payload.size() << " bytes" << endl;
+	cout << "parseDouble:        " << fastParse << " ns" << endl;
+	cout << "strtod:             " << strtodParse << " ns" << endl;
+	cout << "formatDecimal:      " << fastFormat << " ns" << endl;
+	cout << "snprintf:           " << snprintfFormat << " ns" << endl;
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,190 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Collections/StringBuffer.h"
+#include "Collections/StringUtils.h"
+
+#include "Tests/TestUtils.h"
+
+using namespace palo;
+
+static bool sameBits(double a, double b)
+{
+	return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parses the text and compares the bits with strtod
+////////////////////////////////////////////////////////////////////////////////
+
+static void checkParse(const string &text)
+{
+	double value = -1;
+	bool parsed = StringUtils::parseDouble(text.c_str(), text.c_str() + text.size(), value);
+	double expected = strtod(text.c_str(), 0);
+
+	TEST_CHECK(parsed);
+	if (!sameBits(value, expected)) {
+		cerr << text << ": " << StringUtils::convertToString(value) << " instead of " << StringUtils::convertToString(expected) << endl;
+		TEST_CHECK(false);
+	}
+}
+
+static string format(const char *pattern, double value)
+{
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), pattern, value);
+	return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief mantissas up to 2^53 with powers of ten up to 1e22 are converted
+/// exactly without strtod
+////////////////////////////////////////////////////////////////////////////////
+
+static void testFastPath()
+{
+	const char *texts[] = {
+		"0", "-0", "+0", "1", "-1", "0.1", "0.5", "12.25", "-3.75", "100", "1234.5678",
+		"0.0001", "1e22", "1E-22", "1.5e-22", "9.999e21", "123456789012345", "0.123456789012345",
+		"1234567890123456", "9007199254740992", "9007199254740.992", "-9007199254740992e-5",
+		".5", "5.", "007", "0000000000000000000000001", "1.000000000000000000"
+	};
+
+	for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+		checkParse(texts[i]);
+	}
+
+	double value;
+	TEST_CHECK(StringUtils::parseDouble("9007199254740992", "9007199254740992" + 16, value) && value == 9007199254740992.0);
+	TEST_CHECK(StringUtils::parseDouble("-0", "-0" + 2, value) && value == 0 && signbit(value));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief longer mantissas, large exponents and denormals go to strtod
+////////////////////////////////////////////////////////////////////////////////
+
+static void testFallback()
+{
+	const char *texts[] = {
+		"9007199254740993", "9007199254740995", "18014398509481985", "12345678901234567",
+		"0.30000000000000004", "0.1000000000000000055511151231257827", "1e23", "1e-23", "8.5e-300",
+		"1.7976931348623157e308", "2.2250738585072014e-308", "2.2250738585072009e-308",
+		"4.9406564584124654e-324", "5e-324", "2e-324", "1e-400", "1e400", "-1e400",
+		"123456789012345678901234567890", "0.00000000000000000000000000001"
+	};
+
+	for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+		checkParse(texts[i]);
+	}
+
+	double value;
+	TEST_CHECK(StringUtils::parseDouble("5e-324", "5e-324" + 6, value) && value == 4.9406564584124654e-324 && value > 0);
+	TEST_CHECK(StringUtils::parseDouble("2.2250738585072009e-308", "2.2250738585072009e-308" + 23, value) && value < DBL_MIN && value > 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief illegal characters are rejected by both paths
+////////////////////////////////////////////////////////////////////////////////
+
+static void testIllegal()
+{
+	const char *texts[] = {"abc", "1a", "1.2.3", "1e5x", "--1", "1,5"};
+	for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+		double value;
+		TEST_CHECK(!StringUtils::parseDouble(texts[i], texts[i] + strlen(texts[i]), value));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief printed doubles of 15, 16 and 17 digits are read back as by strtod
+////////////////////////////////////////////////////////////////////////////////
+
+static void testRandomDigits()
+{
+	srand(4711);
+	for (int i = 0; i < 100000; i++) {
+		double mantissa = (double)rand() / RAND_MAX + (double)rand() / RAND_MAX / RAND_MAX;
+		double value = ldexp(mantissa, rand() % 200 - 100) * (rand() % 2 ? 1 : -1);
+		checkParse(format("%.15g", value));
+		checkParse(format("%.16g", value));
+		checkParse(format("%.17g", value));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief formats the value and compares it with "%.15g"
+////////////////////////////////////////////////////////////////////////////////
+
+static void checkFormat(double value)
+{
+	StringBuffer sb;
+	sb.appendDecimal(value);
+	string expected = format("%.15g", value);
+	if (sb.c_str() != expected) {
+		cerr << expected << " formatted as " << sb.c_str() << endl;
+		TEST_CHECK(false);
+	}
+}
+
+static void testFormat()
+{
+	const double values[] = {
+		0.0, -0.0, 1, -1, 0.1, 0.5, 12.25, 1e-4, 9.99999999999999e-5, 0.00012345, 1e15, 999999999999999, 1e15 - 0.5,
+		123456789012345, 1234567890123456, 0.1 + 0.2, 1.0 / 3, 2.0 / 3, 9007199254740992.0, 1e300, 4.9406564584124654e-324,
+		-2.5e-310, 100, 1000000, 0.30000000000000004, 33.33, -7.125
+	};
+
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+		checkFormat(values[i]);
+	}
+
+	srand(815);
+	for (int i = 0; i < 100000; i++) {
+		// prices with two decimals, integers and arbitrary doubles
+		checkFormat((rand() % 10000000) / 100.0);
+		checkFormat((double)(rand() % 1000000));
+		checkFormat(ldexp((double)rand() / RAND_MAX, rand() % 80 - 30));
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	testFastPath();
+	testFallback();
+	testIllegal();
+	testRandomDigits();
+	testFormat();
+
+	return TEST_RESULT();
+}
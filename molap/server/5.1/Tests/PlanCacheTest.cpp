@@ -0,0 +1,206 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include "Olap/Cube.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static string encode(const string &text)
+{
+	string result;
+	for (size_t i = 0; i < text.size(); i++) {
+		unsigned char c = text[i];
+		if (isalnum(c)) {
+			result += c;
+		} else {
+			char buffer[4];
+			snprintf(buffer, sizeof(buffer), "%%%02X", c);
+			result += buffer;
+		}
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief b is calculated from a for all items, c only for item1
+////////////////////////////////////////////////////////////////////////////////
+
+static void createCube(TestServer &server)
+{
+	server.request("/database/create?new_name=test");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/dimension/create?name_database=test&new_name=items");
+	server.request("/dimension/create?name_database=test&new_name=measure");
+	server.request("/element/create_bulk?name_database=test&name_dimension=items&type=1&name_elements=item1,item2,item3,item4");
+	server.request("/element/create?name_database=test&name_dimension=items&type=4&new_name=total&name_children=item1,item2,item3,item4");
+	server.request("/element/create_bulk?name_database=test&name_dimension=measure&type=1&name_elements=a,b,c");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/cube/create?name_database=test&new_name=data&name_dimensions=items,measure");
+	TEST_CHECK(server.lastStatus == 200);
+
+	server.request("/rule/create?name_database=test&name_cube=data&definition=" + encode("['b'] = ['a'] * 2"));
+	server.request("/rule/create?name_database=test&name_cube=data&definition=" + encode("['c','item1'] = 5"));
+	TEST_CHECK(server.lastStatus == 200);
+
+	for (int i = 1; i <= 4; i++) {
+		string item = "item" + StringUtils::convertToString((int32_t)i);
+		server.request("/cell/replace?name_database=test&name_cube=data&name_path=" + item + ",a&value=" + StringUtils::convertToString((int32_t)i));
+		server.request("/cell/replace?name_database=test&name_cube=data&name_path=" + item + ",c&value=" + StringUtils::convertToString((int32_t)(10 * i)));
+		TEST_CHECK(server.lastStatus == 200);
+	}
+}
+
+struct Counters {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t rebinds;
+};
+
+static uint64_t counter(const string &body, const string &name)
+{
+	size_t pos = body.find("\n" + name + " ");
+	TEST_CHECK(pos != string::npos);
+	if (pos == string::npos) {
+		return 0;
+	}
+	pos += name.size() + 2;
+	return StringUtils::stringToUnsignedInteger(body.substr(pos, body.find('\n', pos) - pos));
+}
+
+static Counters counters(TestServer &server)
+{
+	string body = server.request("/server/metrics");
+	TEST_CHECK(server.lastStatus == 200);
+	Counters result;
+	result.hits = counter(body, "palo_plan_cache_hits_total");
+	result.misses = counter(body, "palo_plan_cache_misses_total");
+	result.rebinds = counter(body, "palo_plan_cache_rebinds_total");
+	return result;
+}
+
+enum Lookup {
+	HIT, MISS, REBIND
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reads a cell and checks its value and how its plan was found
+////////////////////////////////////////////////////////////////////////////////
+
+static void checkCell(TestServer &server, const string &path, double expected, Lookup lookup)
+{
+	Counters before = counters(server);
+	string body = server.request("/cell/value?name_database=test&name_cube=data&name_path=" + path);
+	TEST_CHECK(server.lastStatus == 200);
+	Counters after = counters(server);
+
+	// type;exists;value;
+	size_t start = body.find(';', body.find(';') + 1);
+	size_t end = body.find(';', start + 1);
+	double value = end == string::npos ? -1 : StringUtils::stringToDouble(body.substr(start + 1, end - start - 1));
+	if (value != expected) {
+		cerr << path << ": " << value << " instead of " << expected << endl;
+	}
+	TEST_CHECK(value == expected);
+
+	switch (lookup) {
+	case HIT:
+		TEST_CHECK(after.hits > before.hits && after.misses == before.misses && after.rebinds == before.rebinds);
+		break;
+	case MISS:
+		TEST_CHECK(after.misses > before.misses && after.rebinds == before.rebinds);
+		break;
+	case REBIND:
+		TEST_CHECK(after.rebinds > before.rebinds && after.misses == before.misses);
+		break;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the same cell hits, other base cells re-bind the plan
+////////////////////////////////////////////////////////////////////////////////
+
+static void testTemplates(TestServer &server)
+{
+	checkCell(server, "item2,b", 4, MISS);
+	checkCell(server, "item2,b", 4, HIT);
+	checkCell(server, "item3,b", 6, REBIND);
+	checkCell(server, "item3,b", 6, HIT);
+	checkCell(server, "item4,b", 8, REBIND);
+
+	// consolidated elements are no base elements
+	checkCell(server, "total,b", 20, MISS);
+
+	// the rule of c applies to item1 only
+	checkCell(server, "item2,c", 20, MISS);
+	checkCell(server, "item1,c", 5, MISS);
+	checkCell(server, "item3,c", 30, REBIND);
+
+	// a and b are distinguished by the first rule
+	checkCell(server, "item2,a", 2, MISS);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief changed rules, dimensions and cubes drop the plans
+////////////////////////////////////////////////////////////////////////////////
+
+static void testInvalidation(TestServer &server)
+{
+	checkCell(server, "item2,b", 4, HIT);
+	server.request("/rule/create?name_database=test&name_cube=data&definition=" + encode("['a','item4'] = 1"));
+	TEST_CHECK(server.lastStatus == 200);
+	checkCell(server, "item2,b", 4, MISS);
+	checkCell(server, "item4,b", 2, MISS);
+
+	checkCell(server, "item2,b", 4, HIT);
+	server.request("/element/create?name_database=test&name_dimension=items&type=1&new_name=item5");
+	TEST_CHECK(server.lastStatus == 200);
+	checkCell(server, "item2,b", 4, MISS);
+
+	checkCell(server, "item2,b", 4, HIT);
+	server.request("/cell/replace?name_database=test&name_cube=data&name_path=item2,a&value=7");
+	TEST_CHECK(server.lastStatus == 200);
+	checkCell(server, "item2,b", 14, MISS);
+	checkCell(server, "item2,b", 14, HIT);
+}
+
+int main(int argc, char * argv[])
+{
+	// rule values are not kept in the value cache, its snapshot stays the same
+	Cube::setCacheBarrier(0);
+	{
+		TestServer server;
+
+		createCube(server);
+		testTemplates(server);
+		testInvalidation(server);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,200 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include "InputOutput/FileWriterBF.h"
+#include "Olap/RollbackStorage.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t ITEMS = 60;
+
+static string ids(size_t count)
+{
+	string result;
+	for (size_t i = 0; i < count; i++) {
+		result += (i ? ":" : "") + StringUtils::convertToString((uint64_t)i);
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the measures are the number 0 and the string 1, two of three
+/// numbers and every fourth string are filled
+////////////////////////////////////////////////////////////////////////////////
+
+static void createCube(TestServer &server, const string &db)
+{
+	server.request("/database/create?new_name=" + db);
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/dimension/create?name_database=" + db + "&new_name=items");
+	server.request("/dimension/create?name_database=" + db + "&new_name=measure");
+
+	string names;
+	for (size_t i = 0; i < ITEMS; i++) {
+		names += (i ? "," : "") + string("item") + StringUtils::convertToString((uint64_t)i);
+	}
+	server.request("/element/create_bulk?name_database=" + db + "&name_dimension=items&type=1&name_elements=" + names);
+	server.request("/element/create?name_database=" + db + "&name_dimension=measure&type=1&new_name=number");
+	server.request("/element/create?name_database=" + db + "&name_dimension=measure&type=2&new_name=text");
+	server.request("/cube/create?name_database=" + db + "&new_name=data&name_dimensions=items,measure");
+	TEST_CHECK(server.lastStatus == 200);
+
+	for (size_t i = 0; i < ITEMS; i++) {
+		string item = StringUtils::convertToString((uint64_t)i);
+		if (i % 3) {
+			server.request("/cell/replace?name_database=" + db + "&name_cube=data&path=" + item + ",0&value=" + StringUtils::convertToString((uint64_t)(i + 1)));
+		}
+		if (i % 4 == 0) {
+			server.request("/cell/replace?name_database=" + db + "&name_cube=data&path=" + item + ",1&value=a" + item);
+		}
+		TEST_CHECK(server.lastStatus == 200);
+	}
+}
+
+static string readArea(TestServer &server, const string &db)
+{
+	string body = server.request("/cell/area?name_database=" + db + "&name_cube=data&area=" + ids(ITEMS) + ",0:1");
+	TEST_CHECK(server.lastStatus == 200);
+	return body;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes the measure of the items with item % step == 0 in one step
+////////////////////////////////////////////////////////////////////////////////
+
+static void write(TestServer &server, const string &db, size_t measure, size_t step, const string &prefix, size_t offset)
+{
+	string paths;
+	string values;
+	for (size_t i = 0; i < ITEMS; i += step) {
+		paths += (paths.empty() ? "" : ":") + StringUtils::convertToString((uint64_t)i) + "," + StringUtils::convertToString((uint64_t)measure);
+		values += (values.empty() ? "" : ":") + prefix + StringUtils::convertToString((uint64_t)(offset ? offset + i : 0));
+	}
+	server.request("/cell/replace_bulk?name_database=" + db + "&name_cube=data&paths=" + paths + "&values=" + values);
+	TEST_CHECK(server.lastStatus == 200);
+}
+
+static vector<string> pageFiles;
+
+static int collectPage(const char *path, const struct stat *, int type, struct FTW *)
+{
+	if (type == FTW_F && strstr(path, "_lock_")) {
+		pageFiles.push_back(path);
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the spilled pages are binary pages or encrypted text pages
+////////////////////////////////////////////////////////////////////////////////
+
+static void checkPages(TestServer &server, bool encrypted)
+{
+	pageFiles.clear();
+	nftw(server.getDataDirectory().c_str(), collectPage, 16, FTW_PHYS);
+	TEST_CHECK(pageFiles.size() > 2);
+
+	for (vector<string>::const_iterator file = pageFiles.begin(); file != pageFiles.end(); ++file) {
+		FILE *f = fopen(file->c_str(), "rb");
+		TEST_CHECK(f != 0);
+		if (!f) {
+			continue;
+		}
+		char start[32];
+		size_t length = fread(start, 1, sizeof(start), f);
+		fclose(f);
+
+		if (encrypted) {
+			size_t ident = strlen(bffilebuf::BF_FILE_IDENTIFICATOR);
+			TEST_CHECK(length > ident && memcmp(start, bffilebuf::BF_FILE_IDENTIFICATOR, ident) == 0);
+		} else {
+			uint32_t magic = 0;
+			memcpy(&magic, start, sizeof(magic));
+			TEST_CHECK(length >= sizeof(magic) && magic == 0x50524c42);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief four steps are spilled to page files and rolled back
+///
+/// The second step writes numbers of the first one again, the third one
+/// writes the strings and the last one clears numbers, so cells of several
+/// steps are restored to their oldest value only.
+////////////////////////////////////////////////////////////////////////////////
+
+static void testRoundTrip(TestServer &server, const string &db, bool encrypted)
+{
+	createCube(server, db);
+	string initial = readArea(server, db);
+
+	string lock = TestServer::firstField(server.request("/cube/lock?name_database=" + db + "&name_cube=data&area=" + ids(ITEMS) + ",0:1"));
+	TEST_CHECK(server.lastStatus == 200);
+
+	write(server, db, 0, 1, "", 1000);
+	string first = readArea(server, db);
+	write(server, db, 0, 2, "", 2000);
+	write(server, db, 1, 1, "b", 3000);
+	string second = readArea(server, db);
+	write(server, db, 0, 5, "", 0);
+	TEST_CHECK(readArea(server, db) != second);
+
+	checkPages(server, encrypted);
+
+	string rollback = "/cube/rollback?name_database=" + db + "&name_cube=data&lock=" + lock;
+	server.request(rollback + "&steps=1");
+	TEST_CHECK(server.lastStatus == 200);
+	TEST_CHECK(readArea(server, db) == second);
+
+	server.request(rollback + "&steps=2");
+	TEST_CHECK(server.lastStatus == 200);
+	TEST_CHECK(readArea(server, db) == first);
+
+	server.request(rollback);
+	TEST_CHECK(server.lastStatus == 200);
+	TEST_CHECK(readArea(server, db) == initial);
+}
+
+int main(int argc, char * argv[])
+{
+	// a few cells per page, every step spills pages
+	RollbackStorage::setMaximumMemoryRollbackSize(200);
+	{
+		TestServer server;
+
+		testRoundTrip(server, "plain", false);
+
+		bffilebuf::setOptions("rollback", 1234567, true);
+		testRoundTrip(server, "encrypted", true);
+		bffilebuf::setOptions("", 0, false);
+	}
+
+	return TEST_RESULT();
+}
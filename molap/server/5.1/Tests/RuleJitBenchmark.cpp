@@ -0,0 +1,136 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include "Engine/Legacy/NativeCode.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t CHUNK = 1000;
+static const size_t ROUNDS = 10;
+
+static string encode(const string &text)
+{
+	string result;
+	for (size_t i = 0; i < text.size(); i++) {
+		unsigned char c = text[i];
+		if (isalnum(c)) {
+			result += c;
+		} else {
+			char buffer[4];
+			snprintf(buffer, sizeof(buffer), "%%%02X", c);
+			result += buffer;
+		}
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reads the consolidated rule value ROUNDS times and returns the
+/// average time, the value cache is cleared before every read
+////////////////////////////////////////////////////////////////////////////////
+
+static double run(TestServer &server, bool jit, string &value)
+{
+	paloLegacy::native_code::setEnabled(jit);
+	double time = 0;
+	for (size_t round = 0; round < ROUNDS; round++) {
+		server.request("/cube/clear_cache?name_database=bench&name_cube=data");
+		double start = testMilliseconds();
+		value = server.request("/cell/value?name_database=bench&name_cube=data&name_path=all,r");
+		time += testMilliseconds() - start;
+		TEST_CHECK(server.lastStatus == 200);
+	}
+	paloLegacy::native_code::setEnabled(true);
+	return time / ROUNDS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief numeric rule computed by the interpreter and by native code
+///
+/// A rule-heavy cube has one base rule over three filled measures of every
+/// item. Reading the consolidation of all items evaluates the rule for all
+/// base cells in batches of the vector_machine, once interpreted (as with
+/// --no-rule-jit) and once by the compiled program. Both have to return the
+/// same value.
+///
+/// usage: RuleJitBenchmark [items]
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char * argv[])
+{
+	size_t itemCount = argc > 1 ? (size_t)atol(argv[1]) : 100000;
+
+	{
+		TestServer server;
+
+		server.request("/database/create?new_name=bench");
+		server.request("/dimension/create?name_database=bench&new_name=items");
+		server.request("/dimension/create?name_database=bench&new_name=measure");
+		TEST_CHECK(server.lastStatus == 200);
+
+		string names;
+		for (size_t i = 0; i < itemCount; i++) {
+			names += (i ? "," : "") + string("i") + StringUtils::convertToString((uint64_t)i);
+		}
+		server.request("/element/create_bulk", "name_database=bench&name_dimension=items&type=1&name_elements=" + names);
+		server.request("/element/create", "name_database=bench&name_dimension=items&type=4&new_name=all&name_children=" + names);
+		server.request("/element/create_bulk?name_database=bench&name_dimension=measure&type=1&name_elements=a,b,c,r");
+		server.request("/cube/create?name_database=bench&new_name=data&name_dimensions=items,measure");
+		TEST_CHECK(server.lastStatus == 200);
+
+		server.request("/rule/create?name_database=bench&name_cube=data&definition=" + encode("['r'] = N: (['a'] * 2 + ['b'] / 4 - ABS(['c'])) * ['a'] + SQRT(ABS(['c'] - ['b'])) / 3"));
+		TEST_CHECK(server.lastStatus == 200);
+
+		for (size_t first = 0; first < itemCount; first += CHUNK) {
+			string paths;
+			string values;
+			for (size_t i = first; i < min(first + CHUNK, itemCount); i++) {
+				string item = StringUtils::convertToString((uint64_t)i);
+				paths += (i > first ? ":" : "") + item + ",0:" + item + ",1:" + item + ",2";
+				values += (i > first ? ":" : "") + StringUtils::convertToString((int32_t)(i % 7) - 3) + ":" + StringUtils::convertToString((uint64_t)(i % 5)) + ":" + StringUtils::convertToString((uint64_t)(i % 11));
+			}
+			server.request("/cell/replace_bulk", "name_database=bench&name_cube=data&paths=" + paths + "&values=" + values);
+			TEST_CHECK(server.lastStatus == 200);
+		}
+
+		string interpretedValue;
+		string compiledValue;
+		double interpreted = run(server, false, interpretedValue);
+		double compiled = run(server, true, compiledValue);
+		TEST_CHECK(interpretedValue == compiledValue);
+
+		cout << "items:               " << itemCount << endl;
+		cout << "interpreted:         " << interpreted << " ms" << endl;
+		cout << "native code:         " << compiled << " ms" << endl;
+		cout << "speedup:             " << (compiled > 0 ? interpreted / compiled : 0) << endl;
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,288 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <math.h>
+
+#include "Engine/Legacy/NativeCode.h"
+#include "Olap/Cube.h"
+#include "Olap/Database.h"
+#include "Olap/Rule.h"
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t ITEMS = 200;
+
+enum RuleMeasure {
+	A, B, C, R1, R2, R3, S1, S2, P1, P2, MEASURES
+};
+
+static const char *measureNames[MEASURES] = {"a", "b", "c", "r1", "r2", "r3", "s1", "s2", "p1", "p2"};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief r1 to r3 use the opcodes of the compiler only, s1 and s2 string
+/// functions and p1 and p2 palo functions which are interpreted
+////////////////////////////////////////////////////////////////////////////////
+
+static const char *ruleDefinitions[MEASURES] = {
+	0, 0, 0,
+	"['r1'] = N: ['a'] * 2 + ['b'] / 4 - ABS(['c'])",
+	"['r2'] = N: SQRT(ABS(['a'] * ['c'])) - 1.5",
+	"['r3'] = N: ['a'] / ['b']",
+	"['s1'] = N: LEN(CONCATENATE(\"ab\", \"cde\")) * ['a']",
+	"['s2'] = N: VALUE(STR(['a'], 4, 0)) + ['b']",
+	"['p1'] = N: PALO.ECOUNT(\"test\", \"items\") + ['a']",
+	"['p2'] = N: PALO.ELEVEL(\"test\", \"items\", !'items') + ['a'] - ['c']"
+};
+
+static IdentifierType ruleIds[MEASURES];
+
+static string encode(const string &text)
+{
+	string result;
+	for (size_t i = 0; i < text.size(); i++) {
+		unsigned char c = text[i];
+		if (isalnum(c)) {
+			result += c;
+		} else {
+			char buffer[4];
+			snprintf(buffer, sizeof(buffer), "%%%02X", c);
+			result += buffer;
+		}
+	}
+	return result;
+}
+
+static double valueOf(size_t item, RuleMeasure measure)
+{
+	switch (measure) {
+	case A:
+		return (double)(item % 7) - 3;
+	case B:
+		return (double)(item % 5);
+	case C:
+		return item * 0.25;
+	default:
+		return 0;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the value of a rule for a base item, NaN if not checked
+////////////////////////////////////////////////////////////////////////////////
+
+static double expectedValue(size_t item, RuleMeasure measure)
+{
+	double a = valueOf(item, A);
+	double b = valueOf(item, B);
+	double c = valueOf(item, C);
+
+	switch (measure) {
+	case R1:
+		return a * 2 + b / 4 - fabs(c);
+	case R2:
+		return sqrt(fabs(a * c)) - 1.5;
+	case R3:
+		return b == 0 ? 0 : a / b;
+	case S1:
+		return 5 * a;
+	case P1:
+		return ITEMS + 1 + a;
+	case P2:
+		return a - c;
+	case S2:
+		return NAN;
+	default:
+		return valueOf(item, measure);
+	}
+}
+
+static string ids(size_t first, size_t count)
+{
+	string result;
+	for (size_t i = first; i < first + count; i++) {
+		result += (i > first ? ":" : "") + StringUtils::convertToString((uint64_t)i);
+	}
+	return result;
+}
+
+static void createCube(TestServer &server)
+{
+	server.request("/database/create?new_name=test");
+	TEST_CHECK(server.lastStatus == 200);
+	server.request("/dimension/create?name_database=test&new_name=items");
+	server.request("/dimension/create?name_database=test&new_name=measure");
+
+	string names;
+	for (size_t i = 0; i < ITEMS; i++) {
+		names += (i ? "," : "") + string("i") + StringUtils::convertToString((uint64_t)i);
+	}
+	server.request("/element/create_bulk?name_database=test&name_dimension=items&type=1&name_elements=" + names);
+	server.request("/element/create?name_database=test&name_dimension=items&type=4&new_name=all&name_children=" + names);
+	TEST_CHECK(server.lastStatus == 200);
+
+	names.clear();
+	for (size_t m = 0; m < MEASURES; m++) {
+		names += (m ? "," : "") + string(measureNames[m]);
+	}
+	server.request("/element/create_bulk?name_database=test&name_dimension=measure&type=1&name_elements=" + names);
+	server.request("/cube/create?name_database=test&new_name=data&name_dimensions=items,measure");
+	TEST_CHECK(server.lastStatus == 200);
+
+	for (size_t m = R1; m < MEASURES; m++) {
+		string body = server.request("/rule/create?name_database=test&name_cube=data&definition=" + encode(ruleDefinitions[m]));
+		TEST_CHECK(server.lastStatus == 200);
+		ruleIds[m] = StringUtils::stringToUnsignedInteger(body.substr(0, body.find(';')));
+	}
+
+	string paths;
+	string values;
+	for (size_t i = 0; i < ITEMS; i++) {
+		for (size_t m = A; m <= C; m++) {
+			paths += (paths.empty() ? "" : ":") + StringUtils::convertToString((uint64_t)i) + "," + StringUtils::convertToString((uint64_t)m);
+			values += (values.empty() ? "" : ":") + StringUtils::convertToString(valueOf(i, (RuleMeasure)m));
+		}
+	}
+	server.request("/cell/replace_bulk", "name_database=test&name_cube=data&paths=" + paths + "&values=" + values);
+	TEST_CHECK(server.lastStatus == 200);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief base items and their consolidation for all measures
+////////////////////////////////////////////////////////////////////////////////
+
+static string readArea(TestServer &server, bool jit)
+{
+	paloLegacy::native_code::setEnabled(jit);
+	server.request("/cube/clear_cache?name_database=test&name_cube=data");
+	string body = server.request("/cell/area?name_database=test&name_cube=data&area=" + ids(0, ITEMS + 1) + "," + ids(0, MEASURES));
+	TEST_CHECK(server.lastStatus == 200);
+	paloLegacy::native_code::setEnabled(true);
+	return body;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks the values of the base cells, a line is type;exists;value;path
+////////////////////////////////////////////////////////////////////////////////
+
+static void checkValues(const string &body)
+{
+	size_t checked = 0;
+	for (size_t pos = 0; pos < body.size();) {
+		size_t end = body.find('\n', pos);
+		if (end == string::npos) {
+			end = body.size();
+		}
+		vector<string> fields;
+		StringUtils::splitString(body.substr(pos, end - pos), &fields, ';');
+		pos = end + 1;
+		if (fields.size() < 4) {
+			continue;
+		}
+
+		vector<string> path;
+		StringUtils::splitString(fields[3], &path, ',');
+		size_t item = StringUtils::stringToUnsignedInteger(path[0]);
+		RuleMeasure measure = (RuleMeasure)StringUtils::stringToUnsignedInteger(path[1]);
+		double expected = expectedValue(item, measure);
+		if (item == ITEMS || expected != expected) {
+			continue;
+		}
+
+		double value = fields[2].empty() ? 0 : StringUtils::stringToDouble(fields[2]);
+		if (fabs(value - expected) > 1e-9 * max(1.0, fabs(expected))) {
+			cerr << measureNames[measure] << " of i" << item << ": " << value << " instead of " << expected << endl;
+			TEST_CHECK(false);
+		}
+		checked++;
+	}
+	TEST_CHECK(checked == ITEMS * (MEASURES - 1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the compiled rules calculate the values of the interpreter, the
+/// rules with string and palo functions fall back to the interpreter
+////////////////////////////////////////////////////////////////////////////////
+
+static void testSameResults(TestServer &server)
+{
+	string interpreted = readArea(server, false);
+	string compiled = readArea(server, true);
+
+	TEST_CHECK(compiled == interpreted);
+	checkValues(interpreted);
+	checkValues(compiled);
+
+	CPCube cube = Server::getInstance(false)->lookupDatabaseByName("test", false)->lookupCubeByName("data", false);
+	for (size_t m = R1; m < MEASURES; m++) {
+		paloLegacy::PNativeCode code = cube->findRule(ruleIds[m])->getNativeCode();
+		bool isCompiled = code && code->is_compiled();
+#if defined(ENABLE_RULE_JIT) && defined(__x86_64__) && defined(__linux__)
+		TEST_CHECK(isCompiled == (m <= R3));
+#else
+		TEST_CHECK(!isCompiled);
+#endif
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief single cells are calculated the same way
+////////////////////////////////////////////////////////////////////////////////
+
+static void testSingleCells(TestServer &server)
+{
+	for (size_t i = 0; i < ITEMS; i += 13) {
+		for (size_t m = R1; m < MEASURES; m++) {
+			string path = StringUtils::convertToString((uint64_t)i) + "," + StringUtils::convertToString((uint64_t)m);
+
+			paloLegacy::native_code::setEnabled(false);
+			server.request("/cube/clear_cache?name_database=test&name_cube=data");
+			string interpreted = server.request("/cell/value?name_database=test&name_cube=data&path=" + path);
+			paloLegacy::native_code::setEnabled(true);
+			server.request("/cube/clear_cache?name_database=test&name_cube=data");
+			string compiled = server.request("/cell/value?name_database=test&name_cube=data&path=" + path);
+
+			TEST_CHECK(server.lastStatus == 200);
+			TEST_CHECK(compiled == interpreted);
+		}
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	{
+		TestServer server;
+
+		createCube(server);
+		testSameResults(server);
+		testSingleCells(server);
+	}
+
+	return TEST_RESULT();
+}
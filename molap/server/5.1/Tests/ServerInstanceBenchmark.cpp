@@ -0,0 +1,112 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#include "palo.h"
+
+#include <boost/thread.hpp>
+
+#include "Tests/TestServer.h"
+
+using namespace palo;
+
+static const size_t ACQUIRES = 1000000;
+
+enum Mode {
+	GET_INSTANCE, ATOMIC_LOAD, COPY
+};
+
+static PServer shared;
+
+static void acquire(Mode mode, boost::barrier *start)
+{
+	start->wait();
+	for (size_t i = 0; i < ACQUIRES; i++) {
+		PServer server;
+		switch (mode) {
+		case GET_INSTANCE:
+			server = Server::getInstance(false);
+			break;
+		case ATOMIC_LOAD:
+			server = boost::atomic_load(&shared);
+			break;
+		case COPY:
+			server = shared;
+			break;
+		}
+		TEST_CHECK(server);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the nanoseconds of one acquire with all threads running
+////////////////////////////////////////////////////////////////////////////////
+
+static double run(Mode mode, size_t threadCount)
+{
+	boost::barrier start((unsigned int)threadCount + 1);
+	boost::thread_group threads;
+	for (size_t i = 0; i < threadCount; i++) {
+		threads.create_thread(boost::bind(acquire, mode, &start));
+	}
+
+	start.wait();
+	double begin = testMilliseconds();
+	threads.join_all();
+	return (testMilliseconds() - begin) * 1e6 / ACQUIRES;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read-acquire of the server snapshot by many threads
+///
+/// Every thread takes the reader snapshot ACQUIRES times. Server::getInstance
+/// takes the snapshot pinned by its thread, boost::atomic_load goes through
+/// the spinlock pool of boost as getInstance did before, a plain copy of a
+/// shared pointer costs the reference count only, which all ways share.
+///
+/// usage: ServerInstanceBenchmark [threads]
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char * argv[])
+{
+	size_t maxThreads = argc > 1 ? (size_t)atol(argv[1]) : 64;
+
+	{
+		TestServer server;
+		shared = Server::getInstance(false);
+
+		cout << "threads  getInstance  atomic_load  copy (ns per acquire)" << endl;
+		for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 4) {
+			cout << setw(7) << threadCount;
+			cout << setw(13) << run(GET_INSTANCE, threadCount);
+			cout << setw(13) << run(ATOMIC_LOAD, threadCount);
+			cout << setw(6) << run(COPY, threadCount) << endl;
+		}
+
+		shared.reset();
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,223 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef TESTS_TEST_SERVER_H
+#define TESTS_TEST_SERVER_H 1
+
+#include "palo.h"
+
+#include <ftw.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include "HttpServer/HttpServerTask.h"
+#include "Olap/Context.h"
+#include "Olap/PaloSession.h"
+#include "Olap/Server.h"
+#include "PaloDispatcher/PaloJobAnalyser.h"
+#include "PaloHttpServer/PaloHttpServer.h"
+#include "PaloJobs/AreaJob.h"
+#include "Programs/PaloLoader.h"
+
+#include "Tests/TestUtils.h"
+
+namespace palo {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief connection to the palo http server of a TestServer
+///
+/// The requests are answered by a connection task of the palo http server
+/// in the calling thread, so requests and responses have to fit into the
+/// buffers of the socket pair. Each thread needs its own connection.
+////////////////////////////////////////////////////////////////////////////////
+
+class TestConnection {
+public:
+	TestConnection(PaloHttpServer *httpServer, PaloJobAnalyser *analyser) :
+		lastStatus(0), task(0) {
+		socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+		task = new HttpServerTask(fds[0], httpServer, analyser);
+	}
+
+	~TestConnection() {
+		delete task;
+		close(fds[0]);
+		close(fds[1]);
+	}
+
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sends a request with the fake session and returns the body of
+	/// the response, the status is kept in lastStatus
+	////////////////////////////////////////////////////////////////////////////////
+
+	string request(const string &path, const string &body = "") {
+		string text = path + (path.find('?') == string::npos ? "?" : "&") + "sid=" + PaloSession::FAKE_SESSION;
+
+		if (body.empty()) {
+			text = "GET " + text + " HTTP/1.1\r\n\r\n";
+		} else {
+			text = "POST " + text + " HTTP/1.1\r\nContent-Length: " + StringUtils::convertToString((uint64_t)body.size()) + "\r\n\r\n" + body;
+		}
+
+		// feed the connection in pieces the read buffer can take
+		for (size_t pos = 0; pos < text.size();) {
+			ssize_t nr = send(fds[1], text.c_str() + pos, min(text.size() - pos, (size_t)65536), 0);
+			if (nr <= 0) {
+				break;
+			}
+			pos += nr;
+
+			int available = 0;
+			do {
+				task->handleRead();
+				ioctl(fds[0], FIONREAD, &available);
+			} while (available > 0);
+		}
+
+		while (task->canHandleWrite()) {
+			task->handleWrite();
+		}
+
+		string response;
+		char buffer[65536];
+		ssize_t nr;
+		while ((nr = recv(fds[1], buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+			response.append(buffer, nr);
+		}
+
+		size_t headerEnd = response.find("\r\n\r\n");
+		lastStatus = atoi(response.c_str() + min(response.size(), (size_t)9));
+
+		return headerEnd == string::npos ? "" : response.substr(headerEnd + 4);
+	}
+
+public:
+	int lastStatus;
+
+private:
+	TestConnection(const TestConnection &);
+	TestConnection &operator=(const TestConnection &);
+
+	HttpServerTask *task;
+	int fds[2];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief server with an empty data directory for tests and benchmarks
+///
+/// The requests of the server itself go through its first connection.
+////////////////////////////////////////////////////////////////////////////////
+
+class TestServer {
+public:
+	TestServer() :
+		lastStatus(0), httpServer(""), connection(0) {
+		char tmpl[] = "/tmp/palotest-XXXXXX";
+		dataDirectory = mkdtemp(tmpl);
+
+		Server::create(FileName(dataDirectory, "palo", "csv"));
+
+		// the context created by the first commit doesn't know the engines yet
+		Context::reset();
+		{
+			PaloLoader loader(false, dataDirectory);
+			loader.load(false, false);
+			loader.finalize(true);
+		}
+
+		httpServer.enablePalo();
+
+		// the default of the options, areas of the tests stay below it
+		AreaJob::setMaxCellCount(20000);
+
+		connection = connect();
+	}
+
+	~TestServer() {
+		delete connection;
+
+		Context::reset();
+		Server::destroy();
+		nftw(dataDirectory.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+	}
+
+public:
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief sends a request with the fake session and returns the body of
+	/// the response, the status is kept in lastStatus
+	////////////////////////////////////////////////////////////////////////////////
+
+	string request(const string &path, const string &body = "") {
+		string response = connection->request(path, body);
+		lastStatus = connection->lastStatus;
+		return response;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief opens another connection, to be deleted by the caller
+	////////////////////////////////////////////////////////////////////////////////
+
+	TestConnection *connect() {
+		return new TestConnection(&httpServer, &analyser);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief first field of the first line of a response
+	////////////////////////////////////////////////////////////////////////////////
+
+	static string firstField(const string &body) {
+		return body.substr(0, body.find_first_of(";\n"));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// @brief data directory of the server
+	////////////////////////////////////////////////////////////////////////////////
+
+	const string &getDataDirectory() const {
+		return dataDirectory;
+	}
+
+public:
+	int lastStatus;
+
+private:
+	static int removeEntry(const char *path, const struct stat *, int, struct FTW *) {
+		return remove(path);
+	}
+
+	string dataDirectory;
+	PaloHttpServer httpServer;
+	PaloJobAnalyser analyser;
+	TestConnection *connection;
+};
+
+}
+
+#endif
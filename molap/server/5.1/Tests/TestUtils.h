@@ -0,0 +1,69 @@
+/*
+ *
+ * Copyright (C) 2006-2014 Jedox AG
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License (Version 2) as published
+ * by the Free Software Foundation at http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * If you are developing and distributing open source applications under the
+ * GPL License, then you are free to use Palo under the GPL License.  For OEMs,
+ * ISVs, and VARs who distribute Palo with their products, and do not license
+ * and distribute their source code under the GPL, Jedox provides a flexible
+ * OEM Commercial License.
+ *
+ *
+ */
+
+#ifndef TESTS_TEST_UTILS_H
+#define TESTS_TEST_UTILS_H 1
+
+#include <iostream>
+
+#include <sys/time.h>
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of failed checks of the test program
+////////////////////////////////////////////////////////////////////////////////
+
+static int testFailures = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks a condition and reports it if it does not hold
+////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::cerr << __FILE__ << "@" << __LINE__ << ": check failed: " << #condition << std::endl; \
+			testFailures++; \
+		} \
+	} while (0)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief exit code of the test program
+////////////////////////////////////////////////////////////////////////////////
+
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wall clock in milliseconds for the benchmarks
+////////////////////////////////////////////////////////////////////////////////
+
+static inline double testMilliseconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+#endif